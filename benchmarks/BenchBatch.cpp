@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchCommon.hh"
+#include "Core/matrix_batch.hh"
+#include "Core/matrix_product.hh"
+#include "Core/small_matrix.hh"
+
+using namespace LimnoBench;
+
+namespace
+{
+    //count diagonally dominant _N x _N matrices, as a batch and one by one
+    template<int _N>
+    Limno::_detail::matrix_batch<double, _N, _N> batch(size_t count)
+    {
+        const std::vector<double> v = values(count*_N*_N);
+        Limno::_detail::matrix_batch<double, _N, _N> result(count);
+        for(size_t b = 0; b < count; ++b)
+            for(size_t r = 0; r < _N; ++r)
+                for(size_t c = 0; c < _N; ++c)
+                    result(b, r, c) = v[(b*_N + r)*_N + c] + (r == c ? 256.0 : 0.0);
+        return result;
+    }
+
+    template<int _N>
+    std::vector<Limno::_detail::LimnoMatrixBase<double, _N, _N>> unbatched(size_t count)
+    {
+        const auto b = batch<_N>(count);
+        std::vector<Limno::_detail::LimnoMatrixBase<double, _N, _N>> result;
+        result.reserve(count);
+        for(size_t i = 0; i < count; ++i)
+            result.push_back(b.get(i));
+        return result;
+    }
+
+    void batchSizes(benchmark::internal::Benchmark* b)
+    {
+        for(std::int64_t n : {1 << 10, 1 << 16})
+            b->Arg(n);
+    }
+}
+
+//One fixed-size matmul per pair of matrices
+template<int _N>
+static void BM_Batch_MatmulLoop(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    const auto a = unbatched<_N>(count);
+    std::vector<Limno::_detail::LimnoMatrixBase<double, _N, _N>> c(count);
+    for(auto _ : state)
+    {
+        for(size_t i = 0; i < count; ++i)
+            c[i] = Limno::_detail::matmul(a[i], a[i]);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*count*_N*_N*sizeof(double), 2.0*count*_N*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Batch_MatmulLoop, 3)->Apply(batchSizes);
+BENCHMARK_TEMPLATE(BM_Batch_MatmulLoop, 6)->Apply(batchSizes);
+
+template<int _N>
+static void BM_Batch_Matmul(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    const auto a = batch<_N>(count);
+    for(auto _ : state)
+    {
+        auto c = Limno::_detail::matmul(a, a);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*count*_N*_N*sizeof(double), 2.0*count*_N*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Batch_Matmul, 3)->Apply(batchSizes);
+BENCHMARK_TEMPLATE(BM_Batch_Matmul, 6)->Apply(batchSizes);
+
+//One fixed-size inverse per matrix
+template<int _N>
+static void BM_Batch_InverseLoop(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    const auto a = unbatched<_N>(count);
+    std::vector<Limno::_detail::LimnoMatrixBase<double, _N, _N>> inv(count);
+    for(auto _ : state)
+    {
+        for(size_t i = 0; i < count; ++i)
+            inv[i] = Limno::_detail::inverse(a[i]);
+        benchmark::DoNotOptimize(inv.data());
+    }
+    setThroughput(state, 2.0*count*_N*_N*sizeof(double), 2.0*count*_N*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Batch_InverseLoop, 3)->Apply(batchSizes);
+BENCHMARK_TEMPLATE(BM_Batch_InverseLoop, 6)->Apply(batchSizes);
+
+template<int _N>
+static void BM_Batch_Inverse(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    const auto a = batch<_N>(count);
+    for(auto _ : state)
+    {
+        auto inv = Limno::_detail::inverse(a);
+        benchmark::DoNotOptimize(inv.data());
+    }
+    setThroughput(state, 2.0*count*_N*_N*sizeof(double), 2.0*count*_N*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Batch_Inverse, 3)->Apply(batchSizes);
+BENCHMARK_TEMPLATE(BM_Batch_Inverse, 6)->Apply(batchSizes);
@@ -0,0 +1,60 @@
+#ifndef BENCH_COMMON_HH
+#define BENCH_COMMON_HH 1
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Core/matrix_base.hh"
+#include "config.hh"
+
+namespace LimnoBench
+{
+    using Limno::_detail::DYNAMIC;
+    using Limno::_detail::LimnoMatrixBase;
+
+    using dynamic_matrix = LimnoMatrixBase<double, DYNAMIC, DYNAMIC>;
+
+    //Square sizes swept by the DYNAMIC benchmarks
+    inline void dynamicSizes(benchmark::internal::Benchmark* b, std::int64_t maxDim = 8192)
+    {
+        for(std::int64_t n = 2; n <= maxDim; n *= 4)
+            b->Arg(n);
+        b->Unit(benchmark::kMicrosecond);
+    }
+
+    //Reports the bytes moved and floating point operations of one iteration 
+    //as rates, shown as GB=x/s and GFLOP=y/s
+    inline void setThroughput(benchmark::State& state, double bytes, double flops = 0)
+    {
+        state.counters["GB"] = benchmark::Counter(bytes*1e-9, benchmark::Counter::kIsIterationInvariantRate);
+        if (flops > 0)
+            state.counters["GFLOP"] = benchmark::Counter(flops*1e-9, benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    //Deterministic non-trivial values so kernels can't be folded away
+    inline std::vector<double> values(size_t n)
+    {
+        std::vector<double> result(n);
+        for(size_t i = 0; i < n; ++i)
+            result[i] = static_cast<double>(i % 251)*0.25 - 31.0;
+        return result;
+    }
+
+    inline dynamic_matrix dynamicMatrix(size_t numRows, size_t numCols)
+    {
+        const std::vector<double> v = values(numRows*numCols);
+        return dynamic_matrix(v.begin(), v.end(), numRows, numCols);
+    }
+
+    template<int _N>
+    LimnoMatrixBase<double, _N, _N> staticMatrix()
+    {
+        const std::vector<double> v = values(static_cast<size_t>(_N*_N));
+        return LimnoMatrixBase<double, _N, _N>(v.begin(), v.end());
+    }
+}
+
+#endif
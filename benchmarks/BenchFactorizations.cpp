@@ -0,0 +1,138 @@
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchCommon.hh"
+#include "Core/factorizations.hh"
+#include "Core/matrix_product.hh"
+
+using namespace LimnoBench;
+
+namespace
+{
+    //Diagonally dominant, so it is also a well conditioned SPD matrix
+    dynamic_matrix system(size_t n)
+    {
+        dynamic_matrix a = dynamicMatrix(n, n);
+        for(size_t i = 0; i < n; ++i)
+            for(size_t j = 0; j < i; ++j)
+                a(j, i) = a(i, j);
+        for(size_t i = 0; i < n; ++i)
+            a(i, i) = 32.0*static_cast<double>(n);
+        return a;
+    }
+
+    void systemSizes(benchmark::internal::Benchmark* b)
+    {
+        for(std::int64_t n : {200, 500, 1000, 2000})
+            b->Arg(n);
+        b->Unit(benchmark::kMillisecond);
+    }
+}
+
+//Textbook right-looking elimination with partial pivoting, one column at a
+//time, on the same row-major storage
+static void BM_LU_Unblocked(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = system(n);
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        dynamic_matrix m = a;
+        state.ResumeTiming();
+        for(size_t k = 0; k < n; ++k)
+        {
+            size_t p = k;
+            for(size_t i = k + 1; i < n; ++i)
+                p = (std::abs(m(i, k)) > std::abs(m(p, k))) ? i : p;
+            for(size_t c = 0; c < n; ++c)
+                std::swap(m(k, c), m(p, c));
+            for(size_t i = k + 1; i < n; ++i)
+            {
+                const double l = (m(i, k) /= m(k, k));
+                for(size_t c = k + 1; c < n; ++c)
+                    m(i, c) -= l*m(k, c);
+            }
+        }
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 0, 2.0/3.0*n*n*n);
+}
+BENCHMARK(BM_LU_Unblocked)->Apply(systemSizes);
+
+template<typename _PolicyTp>
+static void luInPlaceBench(benchmark::State& state, _PolicyTp policy)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = system(n);
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        dynamic_matrix m = a;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(luInPlace(policy, m).data());
+    }
+    setThroughput(state, 0, 2.0/3.0*n*n*n);
+}
+
+static void BM_LU_Blocked(benchmark::State& state)
+{
+    luInPlaceBench(state, Limno::seq);
+}
+BENCHMARK(BM_LU_Blocked)->Apply(systemSizes);
+
+static void BM_LU_Parallel(benchmark::State& state)
+{
+    luInPlaceBench(state, Limno::par);
+}
+BENCHMARK(BM_LU_Parallel)->Apply(systemSizes)->UseRealTime();
+
+static void BM_Cholesky_Parallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = system(n);
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        dynamic_matrix m = a;
+        state.ResumeTiming();
+        choleskyInPlace(Limno::par, m);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 0, 1.0/3.0*n*n*n);
+}
+BENCHMARK(BM_Cholesky_Parallel)->Apply(systemSizes)->UseRealTime();
+
+static void BM_QR_Parallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = system(n);
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        dynamic_matrix m = a;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(qrInPlace(Limno::par, m).data());
+    }
+    setThroughput(state, 0, 4.0/3.0*n*n*n);
+}
+BENCHMARK(BM_QR_Parallel)->Apply(systemSizes)->UseRealTime();
+
+//Factor and solve for one right-hand side
+static void BM_Solve_Parallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = system(n);
+    const dynamic_matrix b = dynamicMatrix(n, 1);
+    for(auto _ : state)
+    {
+        auto x = solve(Limno::par, a, b);
+        benchmark::DoNotOptimize(x.data());
+    }
+    setThroughput(state, 0, 2.0/3.0*n*n*n);
+}
+BENCHMARK(BM_Solve_Parallel)->Apply(systemSizes)->UseRealTime();
@@ -0,0 +1,390 @@
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchCommon.hh"
+#include "Core/execution.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/reductions.hh"
+#include "Core/transpose.hh"
+
+using namespace LimnoBench;
+using Limno::_detail::matmul;
+
+//Element-wise c = a*b + 2 evaluated in a single pass
+static void BM_ElementWise_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    const dynamic_matrix b = dynamicMatrix(n, n);
+    dynamic_matrix c = a;
+    for(auto _ : state)
+    {
+        c = a*b + 2.0;
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*n*n*sizeof(double), 2.0*n*n);
+}
+BENCHMARK(BM_ElementWise_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_ElementWise_Parallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    const dynamic_matrix b = dynamicMatrix(n, n);
+    dynamic_matrix c = a;
+    for(auto _ : state)
+    {
+        c.assign(Limno::par, a*b + 2.0);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*n*n*sizeof(double), 2.0*n*n);
+}
+BENCHMARK(BM_ElementWise_Parallel)->Apply([](auto* b) { dynamicSizes(b); })->UseRealTime();
+
+static void BM_ElementWise_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> a = values(n*n);
+    const std::vector<double> b = values(n*n);
+    std::vector<double> c(n*n);
+    for(auto _ : state)
+    {
+        for(size_t i = 0; i < n*n; ++i)
+            c[i] = a[i]*b[i] + 2.0;
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*n*n*sizeof(double), 2.0*n*n);
+}
+BENCHMARK(BM_ElementWise_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+template<int _N>
+static void BM_ElementWise_Static(benchmark::State& state)
+{
+    const auto a = staticMatrix<_N>();
+    const auto b = staticMatrix<_N>();
+    LimnoMatrixBase<double, _N, _N> c;
+    for(auto _ : state)
+    {
+        c = a*b + 2.0;
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*_N*_N*sizeof(double), 2.0*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_ElementWise_Static, 2);
+BENCHMARK_TEMPLATE(BM_ElementWise_Static, 4);
+BENCHMARK_TEMPLATE(BM_ElementWise_Static, 8);
+BENCHMARK_TEMPLATE(BM_ElementWise_Static, 16);
+BENCHMARK_TEMPLATE(BM_ElementWise_Static, 32);
+BENCHMARK_TEMPLATE(BM_ElementWise_Static, 64);
+
+//Reductions
+static void BM_Sum_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(a));
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Sum_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Sum_Parallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(Limno::par, a));
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Sum_Parallel)->Apply([](auto* b) { dynamicSizes(b); })->UseRealTime();
+
+static void BM_Sum_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> a = values(n*n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::accumulate(a.begin(), a.end(), 0.0));
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Sum_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+template<int _N>
+static void BM_Sum_Static(benchmark::State& state)
+{
+    const auto a = staticMatrix<_N>();
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(a));
+    setThroughput(state, 1.0*_N*_N*sizeof(double), 1.0*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Sum_Static, 2);
+BENCHMARK_TEMPLATE(BM_Sum_Static, 4);
+BENCHMARK_TEMPLATE(BM_Sum_Static, 8);
+BENCHMARK_TEMPLATE(BM_Sum_Static, 16);
+BENCHMARK_TEMPLATE(BM_Sum_Static, 32);
+BENCHMARK_TEMPLATE(BM_Sum_Static, 64);
+
+//Per-row and per-column sums against a naive loop down the columns
+static void BM_Sum_Rowwise(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(a, Limno::rowwise).data());
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Sum_Rowwise)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Sum_Colwise(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(a, Limno::colwise).data());
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Sum_Colwise)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Sum_ColwiseParallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(Limno::par, a, Limno::colwise).data());
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Sum_ColwiseParallel)->Apply([](auto* b) { dynamicSizes(b); })->UseRealTime();
+
+static void BM_Sum_ColwiseBaseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> a = values(n*n);
+    std::vector<double> result(n);
+    for(auto _ : state)
+    {
+        for(size_t c = 0; c < n; ++c)
+        {
+            double s = 0;
+            for(size_t r = 0; r < n; ++r)
+                s += a[r*n + c];
+            result[c] = s;
+        }
+        benchmark::DoNotOptimize(result.data());
+    }
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Sum_ColwiseBaseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+//Compensated summation over the fixed reduction tree
+static void BM_Sum_Deterministic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(a, Limno::deterministic));
+    setThroughput(state, 1.0*n*n*sizeof(double), 4.0*n*n);
+}
+BENCHMARK(BM_Sum_Deterministic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Sum_DeterministicParallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(Limno::par, a, Limno::deterministic));
+    setThroughput(state, 1.0*n*n*sizeof(double), 4.0*n*n);
+}
+BENCHMARK(BM_Sum_DeterministicParallel)->Apply([](auto* b) { dynamicSizes(b); })->UseRealTime();
+
+static void BM_Dot_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    const dynamic_matrix b = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(dot(a, b));
+    setThroughput(state, 2.0*n*n*sizeof(double), 2.0*n*n);
+}
+BENCHMARK(BM_Dot_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Dot_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> a = values(n*n);
+    const std::vector<double> b = values(n*n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::inner_product(a.begin(), a.end(), b.begin(), 0.0));
+    setThroughput(state, 2.0*n*n*sizeof(double), 2.0*n*n);
+}
+BENCHMARK(BM_Dot_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Norm_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(norm(a));
+    setThroughput(state, 1.0*n*n*sizeof(double), 2.0*n*n);
+}
+BENCHMARK(BM_Norm_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+//Transposes. transposeInto walks bands of register-blocked tiles and
+//writes into existing storage, the column walk copy reads through the
+//column iterators and the view copy strides through the source
+static void BM_Transpose_ColumnWalk(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+    {
+        dynamic_matrix t(a.columnBegin(), a.columnEnd(), n, n);
+        benchmark::DoNotOptimize(t.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Transpose_ColumnWalk)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Transpose_Tiled(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    dynamic_matrix t = a;
+    for(auto _ : state)
+    {
+        transposeInto(a.view(), t.view());
+        benchmark::DoNotOptimize(t.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Transpose_Tiled)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Transpose_Parallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    dynamic_matrix t = a;
+    for(auto _ : state)
+    {
+        transposeInto(Limno::par, a.view(), t.view());
+        benchmark::DoNotOptimize(t.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Transpose_Parallel)->Apply([](auto* b) { dynamicSizes(b); })->UseRealTime();
+
+static void BM_Transpose_InPlace(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+    {
+        transposeInPlace(a);
+        benchmark::DoNotOptimize(a.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Transpose_InPlace)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_TransposeView_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    for(auto _ : state)
+    {
+        dynamic_matrix t(a.view().transpose());
+        benchmark::DoNotOptimize(t.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_TransposeView_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Transpose_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> a = values(n*n);
+    for(auto _ : state)
+    {
+        std::vector<double> t(n*n);
+        for(size_t r = 0; r < n; ++r)
+            for(size_t c = 0; c < n; ++c)
+                t[c*n + r] = a[r*n + c];
+        benchmark::DoNotOptimize(t.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Transpose_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+//Products. Capped at 2048 since an 8192 cube takes minutes per iteration 
+//with the naive baseline
+static void BM_Product_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    const dynamic_matrix b = dynamicMatrix(n, n);
+    dynamic_matrix c(0.0, n, n);
+    for(auto _ : state)
+    {
+        matmul(a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*n*n*sizeof(double), 2.0*n*n*n);
+}
+BENCHMARK(BM_Product_Dynamic)->Apply([](auto* b) { dynamicSizes(b, 2048); });
+
+static void BM_Product_Parallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = dynamicMatrix(n, n);
+    const dynamic_matrix b = dynamicMatrix(n, n);
+    dynamic_matrix c(0.0, n, n);
+    for(auto _ : state)
+    {
+        matmul(Limno::par, a, b, c);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*n*n*sizeof(double), 2.0*n*n*n);
+}
+BENCHMARK(BM_Product_Parallel)->Apply([](auto* b) { dynamicSizes(b, 2048); })->UseRealTime();
+
+static void BM_Product_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> a = values(n*n);
+    const std::vector<double> b = values(n*n);
+    std::vector<double> c(n*n);
+    for(auto _ : state)
+    {
+        std::fill(c.begin(), c.end(), 0.0);
+        for(size_t i = 0; i < n; ++i)
+            for(size_t k = 0; k < n; ++k)
+                for(size_t j = 0; j < n; ++j)
+                    c[i*n + j] += a[i*n + k]*b[k*n + j];
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*n*n*sizeof(double), 2.0*n*n*n);
+}
+BENCHMARK(BM_Product_Baseline)->Apply([](auto* b) { dynamicSizes(b, 2048); });
+
+template<int _N>
+static void BM_Product_Static(benchmark::State& state)
+{
+    const auto a = staticMatrix<_N>();
+    const auto b = staticMatrix<_N>();
+    for(auto _ : state)
+    {
+        auto c = matmul(a, b);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 3.0*_N*_N*sizeof(double), 2.0*_N*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Product_Static, 2);
+BENCHMARK_TEMPLATE(BM_Product_Static, 4);
+BENCHMARK_TEMPLATE(BM_Product_Static, 8);
+BENCHMARK_TEMPLATE(BM_Product_Static, 16);
+BENCHMARK_TEMPLATE(BM_Product_Static, 32);
+BENCHMARK_TEMPLATE(BM_Product_Static, 64);
+
+BENCHMARK_MAIN();
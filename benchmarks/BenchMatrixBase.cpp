@@ -0,0 +1,233 @@
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchCommon.hh"
+#include "Core/matrix_base.hh"
+
+using namespace LimnoBench;
+
+//Construction from a range of values
+static void BM_Construct_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> v = values(n*n);
+    for(auto _ : state)
+    {
+        dynamic_matrix m(v.begin(), v.end(), n, n);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Construct_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Construct_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> v = values(n*n);
+    for(auto _ : state)
+    {
+        std::vector<double> m(v.begin(), v.end());
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Construct_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+template<int _N>
+static void BM_Construct_Static(benchmark::State& state)
+{
+    const std::vector<double> v = values(_N*_N);
+    for(auto _ : state)
+    {
+        LimnoMatrixBase<double, _N, _N> m(v.begin(), v.end());
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 2.0*_N*_N*sizeof(double));
+}
+BENCHMARK_TEMPLATE(BM_Construct_Static, 2);
+BENCHMARK_TEMPLATE(BM_Construct_Static, 4);
+BENCHMARK_TEMPLATE(BM_Construct_Static, 8);
+BENCHMARK_TEMPLATE(BM_Construct_Static, 16);
+BENCHMARK_TEMPLATE(BM_Construct_Static, 32);
+BENCHMARK_TEMPLATE(BM_Construct_Static, 64);
+
+//Sized construction without copying values in
+static void BM_Construct_Zeros(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    for(auto _ : state)
+    {
+        dynamic_matrix m(Limno::zeros, n, n);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 1.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Construct_Zeros)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Construct_Uninitialized(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    for(auto _ : state)
+    {
+        dynamic_matrix m(Limno::uninitialized, n, n);
+        benchmark::DoNotOptimize(m.data());
+    }
+}
+BENCHMARK(BM_Construct_Uninitialized)->Apply([](auto* b) { dynamicSizes(b); });
+
+//Filled construction
+static void BM_Fill_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    for(auto _ : state)
+    {
+        dynamic_matrix m(1.5, n, n);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 1.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Fill_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Fill_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    for(auto _ : state)
+    {
+        std::vector<double> m(n*n, 1.5);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 1.0*n*n*sizeof(double));
+}
+BENCHMARK(BM_Fill_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+template<int _N>
+static void BM_Fill_Static(benchmark::State& state)
+{
+    for(auto _ : state)
+    {
+        LimnoMatrixBase<double, _N, _N> m(1.5);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, 1.0*_N*_N*sizeof(double));
+}
+BENCHMARK_TEMPLATE(BM_Fill_Static, 2);
+BENCHMARK_TEMPLATE(BM_Fill_Static, 4);
+BENCHMARK_TEMPLATE(BM_Fill_Static, 8);
+BENCHMARK_TEMPLATE(BM_Fill_Static, 16);
+BENCHMARK_TEMPLATE(BM_Fill_Static, 32);
+BENCHMARK_TEMPLATE(BM_Fill_Static, 64);
+
+//Read-modify-write through begin()/end()
+static void BM_Iterate_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    dynamic_matrix m = dynamicMatrix(n, n);
+    for(auto _ : state)
+    {
+        for(auto it = m.begin(); it != m.end(); ++it)
+            *it += 1.0;
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Iterate_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Iterate_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    std::vector<double> m = values(n*n);
+    for(auto _ : state)
+    {
+        for(auto it = m.begin(); it != m.end(); ++it)
+            *it += 1.0;
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, 2.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Iterate_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+//Column-major walk, which strides through the row-major storage
+static void BM_IterateColumns_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix m = dynamicMatrix(n, n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::accumulate(m.columnBegin(), m.columnEnd(), 0.0));
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_IterateColumns_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+template<int _N>
+static void BM_Iterate_Static(benchmark::State& state)
+{
+    auto m = staticMatrix<_N>();
+    for(auto _ : state)
+    {
+        for(auto it = m.begin(); it != m.end(); ++it)
+            *it += 1.0;
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, 2.0*_N*_N*sizeof(double), 1.0*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Iterate_Static, 2);
+BENCHMARK_TEMPLATE(BM_Iterate_Static, 4);
+BENCHMARK_TEMPLATE(BM_Iterate_Static, 8);
+BENCHMARK_TEMPLATE(BM_Iterate_Static, 16);
+BENCHMARK_TEMPLATE(BM_Iterate_Static, 32);
+BENCHMARK_TEMPLATE(BM_Iterate_Static, 64);
+
+//Element access through operator()
+static void BM_Access_Dynamic(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix m = dynamicMatrix(n, n);
+    for(auto _ : state)
+    {
+        double total = 0;
+        for(size_t r = 0; r < n; ++r)
+            for(size_t c = 0; c < n; ++c)
+                total += m(r, c);
+        benchmark::DoNotOptimize(total);
+    }
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Access_Dynamic)->Apply([](auto* b) { dynamicSizes(b); });
+
+static void BM_Access_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::vector<double> m = values(n*n);
+    for(auto _ : state)
+    {
+        double total = 0;
+        for(size_t r = 0; r < n; ++r)
+            for(size_t c = 0; c < n; ++c)
+                total += m[r*n + c];
+        benchmark::DoNotOptimize(total);
+    }
+    setThroughput(state, 1.0*n*n*sizeof(double), 1.0*n*n);
+}
+BENCHMARK(BM_Access_Baseline)->Apply([](auto* b) { dynamicSizes(b); });
+
+template<int _N>
+static void BM_Access_Static(benchmark::State& state)
+{
+    const auto m = staticMatrix<_N>();
+    for(auto _ : state)
+    {
+        double total = 0;
+        for(size_t r = 0; r < _N; ++r)
+            for(size_t c = 0; c < _N; ++c)
+                total += m(r, c);
+        benchmark::DoNotOptimize(total);
+    }
+    setThroughput(state, 1.0*_N*_N*sizeof(double), 1.0*_N*_N);
+}
+BENCHMARK_TEMPLATE(BM_Access_Static, 2);
+BENCHMARK_TEMPLATE(BM_Access_Static, 4);
+BENCHMARK_TEMPLATE(BM_Access_Static, 8);
+BENCHMARK_TEMPLATE(BM_Access_Static, 16);
+BENCHMARK_TEMPLATE(BM_Access_Static, 32);
+BENCHMARK_TEMPLATE(BM_Access_Static, 64);
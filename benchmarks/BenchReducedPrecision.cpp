@@ -0,0 +1,105 @@
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchCommon.hh"
+#include "Core/matrix_product.hh"
+#include "Core/reduced_precision.hh"
+#include "Core/reductions.hh"
+
+using namespace LimnoBench;
+
+namespace
+{
+    using float_matrix = LimnoMatrixBase<float, DYNAMIC, DYNAMIC>;
+
+    float_matrix floatMatrix(size_t n)
+    {
+        return Limno::_detail::convert<float>(dynamicMatrix(n, n));
+    }
+
+    void productSizes(benchmark::internal::Benchmark* b)
+    {
+        for(std::int64_t n : {128, 512, 1024})
+            b->Arg(n);
+        b->Unit(benchmark::kMicrosecond);
+    }
+}
+
+//float to float16 and back, through the bulk conversion kernels
+static void BM_ReducedPrecision_ConvertHalf(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto a = floatMatrix(n);
+    for(auto _ : state)
+    {
+        auto h = Limno::_detail::convert<Limno::_detail::float16>(a);
+        auto back = Limno::_detail::convert<float>(h);
+        benchmark::DoNotOptimize(back.data());
+    }
+    setThroughput(state, 12.0*n*n);
+}
+BENCHMARK(BM_ReducedPrecision_ConvertHalf)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+//Sum of the same values stored as float and as bfloat16
+static void BM_ReducedPrecision_SumFloat(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto a = floatMatrix(n);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(Limno::_detail::sum(a));
+    setThroughput(state, 4.0*n*n, 1.0*n*n);
+}
+BENCHMARK(BM_ReducedPrecision_SumFloat)->Arg(2048)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReducedPrecision_SumBfloat(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto a = Limno::_detail::convert<Limno::_detail::bfloat16>(floatMatrix(n));
+    for(auto _ : state)
+        benchmark::DoNotOptimize(Limno::_detail::sum(a));
+    setThroughput(state, 2.0*n*n, 1.0*n*n);
+}
+BENCHMARK(BM_ReducedPrecision_SumBfloat)->Arg(2048)->Unit(benchmark::kMicrosecond);
+
+//Products of float, float16 and int8 matrices, all with float results
+static void BM_ReducedPrecision_MatmulFloat(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto a = floatMatrix(n);
+    for(auto _ : state)
+    {
+        auto c = Limno::_detail::matmul(a, a);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 12.0*n*n, 2.0*n*n*n);
+}
+BENCHMARK(BM_ReducedPrecision_MatmulFloat)->Apply(productSizes);
+
+static void BM_ReducedPrecision_MatmulHalf(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto a = Limno::_detail::convert<Limno::_detail::float16>(floatMatrix(n));
+    for(auto _ : state)
+    {
+        auto c = Limno::_detail::matmul(a, a);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 8.0*n*n, 2.0*n*n*n);
+}
+BENCHMARK(BM_ReducedPrecision_MatmulHalf)->Apply(productSizes);
+
+static void BM_ReducedPrecision_MatmulInt8(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto a = floatMatrix(n);
+    const auto q = Limno::_detail::chooseQuantization(a);
+    const auto a8 = Limno::_detail::quantize(a, q);
+    for(auto _ : state)
+    {
+        auto c = Limno::_detail::matmul(a8, q, a8, q);
+        benchmark::DoNotOptimize(c.data());
+    }
+    setThroughput(state, 6.0*n*n, 2.0*n*n*n);
+}
+BENCHMARK(BM_ReducedPrecision_MatmulInt8)->Apply(productSizes);
@@ -0,0 +1,124 @@
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchCommon.hh"
+#include "Core/matrix_product.hh"
+#include "Core/sparse_matrix.hh"
+
+using namespace LimnoBench;
+using Limno::_detail::coo_matrix;
+using Limno::_detail::csc_matrix;
+using Limno::_detail::csr_matrix;
+
+namespace
+{
+    //Graph-like n x n matrix with about 16 non-zeros per row. Row i has
+    //degree proportional to 1/(i % 64 + 1), so a few rows hold most of them
+    coo_matrix<double, std::uint32_t> graph(size_t n)
+    {
+        coo_matrix<double, std::uint32_t> coo(n, n);
+        coo.reserve(16*n);
+        std::uint64_t state = 88172645463325252ull;
+        for(size_t i = 0; i < n; ++i)
+        {
+            const size_t degree = 64/(i % 64 + 1) + 1;
+            for(size_t k = 0; k < degree; ++k)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                coo.insert(i, state % n, 1.0/static_cast<double>(degree));
+            }
+        }
+        return coo;
+    }
+
+    void sparseSizes(benchmark::internal::Benchmark* b)
+    {
+        for(std::int64_t n = 1 << 12; n <= 1 << 20; n *= 16)
+            b->Arg(n);
+        b->Unit(benchmark::kMicrosecond);
+    }
+}
+
+static void BM_Sparse_Assemble(benchmark::State& state)
+{
+    const auto coo = graph(static_cast<size_t>(state.range(0)));
+    for(auto _ : state)
+    {
+        csr_matrix<double, std::uint32_t> csr(coo);
+        benchmark::DoNotOptimize(csr.values().data());
+    }
+    setThroughput(state, coo.nonZeros()*(sizeof(double) + 2*sizeof(std::uint32_t)));
+}
+BENCHMARK(BM_Sparse_Assemble)->Apply(sparseSizes);
+
+//SpMV. Each non-zero reads a value, an index and a scattered element of x
+template<typename _MatTp>
+static void sparseMatVec(benchmark::State& state, bool parallel)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const _MatTp a(graph(n));
+    const dynamic_matrix x = dynamicMatrix(n, 1);
+    dynamic_matrix y(n, 1);
+    for(auto _ : state)
+    {
+        if (parallel)
+            matmul(Limno::par, a, x, y);
+        else
+            matmul(a, x, y);
+        benchmark::DoNotOptimize(y.data());
+    }
+    setThroughput(state, a.nonZeros()*(2*sizeof(double) + sizeof(std::uint32_t)) + n*sizeof(double), 2.0*a.nonZeros());
+}
+
+static void BM_SpMV_Csr(benchmark::State& state)
+{
+    sparseMatVec<csr_matrix<double, std::uint32_t>>(state, false);
+}
+BENCHMARK(BM_SpMV_Csr)->Apply(sparseSizes);
+
+static void BM_SpMV_CsrParallel(benchmark::State& state)
+{
+    sparseMatVec<csr_matrix<double, std::uint32_t>>(state, true);
+}
+BENCHMARK(BM_SpMV_CsrParallel)->Apply(sparseSizes)->UseRealTime();
+
+static void BM_SpMV_Csc(benchmark::State& state)
+{
+    sparseMatVec<csc_matrix<double, std::uint32_t>>(state, false);
+}
+BENCHMARK(BM_SpMV_Csc)->Apply(sparseSizes);
+
+//The same product with the matrix stored dense, while it still fits
+static void BM_SpMV_DenseBaseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix a = graph(n).toDense();
+    const dynamic_matrix x = dynamicMatrix(n, 1);
+    for(auto _ : state)
+    {
+        auto y = matmul(a, x);
+        benchmark::DoNotOptimize(y.data());
+    }
+    setThroughput(state, n*n*sizeof(double), 2.0*n*n);
+}
+BENCHMARK(BM_SpMV_DenseBaseline)->Arg(1 << 12)->Unit(benchmark::kMicrosecond);
+
+//SpMM against a tall block of 16 vectors
+static void BM_SpMM_CsrParallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const csr_matrix<double, std::uint32_t> a(graph(n));
+    const dynamic_matrix x = dynamicMatrix(n, 16);
+    dynamic_matrix y(n, 16);
+    for(auto _ : state)
+    {
+        matmul(Limno::par, a, x, y);
+        benchmark::DoNotOptimize(y.data());
+    }
+    setThroughput(state, a.nonZeros()*(17*sizeof(double) + sizeof(std::uint32_t)), 32.0*a.nonZeros());
+}
+BENCHMARK(BM_SpMM_CsrParallel)->Apply(sparseSizes)->UseRealTime();
@@ -0,0 +1,114 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchCommon.hh"
+#include "IO/text_format.hh"
+
+using namespace LimnoBench;
+using Limno::_detail::formattedSize;
+using Limno::_detail::parseMatrix;
+using Limno::_detail::text_format;
+using Limno::_detail::toChars;
+using Limno::_detail::toString;
+
+//Formatting into a reused caller buffer
+static void BM_Text_Format(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix m = dynamicMatrix(n, n);
+    std::vector<char> buffer(formattedSize<double>(n, n, text_format::csv));
+    for(auto _ : state)
+    {
+        const auto end = toChars(buffer.data(), buffer.data() + buffer.size(), m, text_format::csv);
+        benchmark::DoNotOptimize(end.ptr);
+    }
+    setThroughput(state, n*n*sizeof(double));
+}
+BENCHMARK(BM_Text_Format)->Apply([](auto* b) { dynamicSizes(b, 2048); });
+
+//operator<< into a string stream
+static void BM_Text_Ostream(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix m = dynamicMatrix(n, n);
+    for(auto _ : state)
+    {
+        std::ostringstream os;
+        os << m;
+        benchmark::DoNotOptimize(os.str().data());
+    }
+    setThroughput(state, n*n*sizeof(double));
+}
+BENCHMARK(BM_Text_Ostream)->Apply([](auto* b) { dynamicSizes(b, 2048); });
+
+//Element by element through iostreams, as operator<< does, in CSV
+static void BM_Text_Baseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const dynamic_matrix m = dynamicMatrix(n, n);
+    for(auto _ : state)
+    {
+        std::ostringstream os;
+        for(size_t i = 0; i < n; ++i)
+        {
+            for(size_t j = 0; j < n; ++j)
+                os << m(i, j) << ",";
+            os << "\n";
+        }
+        benchmark::DoNotOptimize(os.str().data());
+    }
+    setThroughput(state, n*n*sizeof(double));
+}
+BENCHMARK(BM_Text_Baseline)->Apply([](auto* b) { dynamicSizes(b, 2048); });
+
+static void BM_Text_Parse(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::string text = toString(dynamicMatrix(n, n), text_format::csv);
+    for(auto _ : state)
+    {
+        dynamic_matrix m = parseMatrix<double>(text, text_format::csv);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, text.size());
+}
+BENCHMARK(BM_Text_Parse)->Apply([](auto* b) { dynamicSizes(b, 2048); });
+
+static void BM_Text_ParseParallel(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::string text = toString(dynamicMatrix(n, n), text_format::csv);
+    for(auto _ : state)
+    {
+        dynamic_matrix m = parseMatrix<double>(Limno::par, text, text_format::csv);
+        benchmark::DoNotOptimize(m.data());
+    }
+    setThroughput(state, text.size());
+}
+BENCHMARK(BM_Text_ParseParallel)->Apply([](auto* b) { dynamicSizes(b, 2048); })->UseRealTime();
+
+//Parsing through a string stream
+static void BM_Text_ParseBaseline(benchmark::State& state)
+{
+    const size_t n = static_cast<size_t>(state.range(0));
+    const std::string text = toString(dynamicMatrix(n, n), text_format::csv);
+    for(auto _ : state)
+    {
+        std::istringstream is{text};
+        std::vector<double> v;
+        v.reserve(n*n);
+        double x;
+        //Skips the comma or newline after each value
+        while(is >> x)
+        {
+            v.push_back(x);
+            is.ignore(1);
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+    setThroughput(state, text.size());
+}
+BENCHMARK(BM_Text_ParseBaseline)->Apply([](auto* b) { dynamicSizes(b, 2048); });
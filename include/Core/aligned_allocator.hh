@@ -0,0 +1,175 @@
+#ifndef ALIGNED_ALLOCATOR_HH
+#define ALIGNED_ALLOCATOR_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "config.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Allocator returning memory aligned to _Alignment bytes, usable as the
+    //_AllocTp of LimnoMatrixBase. If _PadRows is set, dynamic matrices using it
+    //also round every row up to a multiple of _Alignment bytes so each row
+    //starts on its own cache line.
+    template<typename _Tp, size_t _Alignment = LIMNO_CACHE_LINE, bool _PadRows = false>
+    struct aligned_allocator
+    {
+        static_assert((_Alignment & (_Alignment - 1)) == 0 && _Alignment >= alignof(_Tp),
+            "Alignment must be a power of two no smaller than the alignment of the type!");
+
+        //Allocator requirements
+        using value_type = _Tp;
+        using is_always_equal = std::true_type;
+
+        template<typename _UTp>
+        struct rebind
+        {
+            using other = aligned_allocator<_UTp, _Alignment, _PadRows>;
+        };
+
+        static constexpr size_t alignment = _Alignment;
+        static constexpr bool padRows = _PadRows;
+
+        constexpr aligned_allocator() noexcept = default;
+
+        template<typename _UTp>
+        constexpr aligned_allocator(const aligned_allocator<_UTp, _Alignment, _PadRows>&) noexcept
+        {
+
+        }
+
+        _Tp* allocate(size_t n)
+        {
+            if (n > std::numeric_limits<size_t>::max()/sizeof(_Tp))
+                throw std::bad_array_new_length();
+            return static_cast<_Tp*>(::operator new(n*sizeof(_Tp), std::align_val_t{_Alignment}));
+        }
+
+        void deallocate(_Tp* p, size_t) noexcept
+        {
+            ::operator delete(p, std::align_val_t{_Alignment});
+        }
+    };
+
+    template<typename _Tp1, typename _Tp2, size_t _Alignment, bool _PadRows>
+    constexpr bool operator==(const aligned_allocator<_Tp1, _Alignment, _PadRows>&,
+        const aligned_allocator<_Tp2, _Alignment, _PadRows>&) noexcept
+    {
+        return true;
+    }
+
+    template<typename _Tp1, typename _Tp2, size_t _Alignment, bool _PadRows>
+    constexpr bool operator!=(const aligned_allocator<_Tp1, _Alignment, _PadRows>&,
+        const aligned_allocator<_Tp2, _Alignment, _PadRows>&) noexcept
+    {
+        return false;
+    }
+
+    //Aligned allocator that also pads rows to whole cache lines
+    template<typename _Tp, size_t _Alignment = LIMNO_CACHE_LINE>
+    using padded_allocator = aligned_allocator<_Tp, _Alignment, true>;
+
+    //True if matrices using _AllocTp should pad their rows
+    template<typename _AllocTp, typename = void>
+    static constexpr bool _padsRows = false;
+
+    template<typename _AllocTp>
+    constexpr bool _padsRows<_AllocTp, std::void_t<decltype(_AllocTp::padRows)>> = _AllocTp::padRows;
+
+    //Number of bytes padded rows are rounded up to
+    template<typename _AllocTp, typename = void>
+    static constexpr size_t _rowAlignment = LIMNO_CACHE_LINE;
+
+    template<typename _AllocTp>
+    constexpr size_t _rowAlignment<_AllocTp, std::void_t<decltype(_AllocTp::alignment)>> = _AllocTp::alignment;
+
+    //Wraps an allocator so that value-less construction default-initializes.
+    //Containers using it size their storage without zeroing it first, so
+    //elements are only written once; every other construction goes through
+    //_AllocTp unchanged
+    template<typename _AllocTp>
+    class _DefaultInitAllocator : public _AllocTp
+    {
+        using _Traits = std::allocator_traits<_AllocTp>;
+        public:
+        template<typename _UTp>
+        struct rebind
+        {
+            using other = _DefaultInitAllocator<typename _Traits::template rebind_alloc<_UTp>>;
+        };
+
+        _DefaultInitAllocator() = default;
+
+        _DefaultInitAllocator(const _AllocTp& alloc) noexcept
+            : _AllocTp(alloc)
+        {
+
+        }
+
+        template<typename _UAllocTp>
+        _DefaultInitAllocator(const _DefaultInitAllocator<_UAllocTp>& other) noexcept
+            : _AllocTp(static_cast<const _UAllocTp&>(other))
+        {
+
+        }
+
+        _DefaultInitAllocator select_on_container_copy_construction() const
+        {
+            return _DefaultInitAllocator(_Traits::select_on_container_copy_construction(*this));
+        }
+
+        template<typename _UTp>
+        void construct(_UTp* p) noexcept(std::is_nothrow_default_constructible_v<_UTp>)
+        {
+            ::new(static_cast<void*>(p)) _UTp;
+        }
+
+        template<typename _UTp, typename... _ArgsTp>
+        void construct(_UTp* p, _ArgsTp&&... args)
+        {
+            _Traits::construct(static_cast<_AllocTp&>(*this), p, std::forward<_ArgsTp>(args)...);
+        }
+
+        friend bool operator==(const _DefaultInitAllocator& lhs, const _DefaultInitAllocator& rhs) noexcept
+        {
+            return static_cast<const _AllocTp&>(lhs) == static_cast<const _AllocTp&>(rhs);
+        }
+
+        friend bool operator!=(const _DefaultInitAllocator& lhs, const _DefaultInitAllocator& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+    };
+
+    //True if _AllocTp asks for a specific alignment
+    template<typename _AllocTp, typename = void>
+    static constexpr bool _hasAlignment = false;
+
+    template<typename _AllocTp>
+    constexpr bool _hasAlignment<_AllocTp, std::void_t<decltype(_AllocTp::alignment)>> = true;
+
+    //Alignment of fixed-size storage: the widest power of two up to an SSE
+    //vector that divides its size, so e.g. float 4x4 loads as aligned vectors
+    //without growing small matrices. Matrices opt in to wider
+    //alignment through an allocator with an alignment, e.g. aligned_allocator
+    //for a cache line
+    template<typename _Tp, size_t _N, typename _AllocTp>
+    constexpr size_t _staticAlignment() noexcept
+    {
+        size_t alignment = alignof(_Tp);
+        while (alignment < 16 && (_N*sizeof(_Tp)) % (alignment*2) == 0)
+            alignment *= 2;
+        if constexpr(_hasAlignment<_AllocTp>)
+            return std::max(alignment, _AllocTp::alignment);
+        else
+            return alignment;
+    }
+}
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef ARENA_ALLOCATOR_HH
+#define ARENA_ALLOCATOR_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "config.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Counters kept by every memory_arena. heapAllocations only moves when the
+    //arena has to grab a new block from the heap, so a steady-state loop over
+    //an arena should leave it unchanged
+    struct arena_stats
+    {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t bytesRequested = 0;
+        size_t heapAllocations = 0;
+        size_t heapBytes = 0;
+        size_t peakBytes = 0;
+        size_t resets = 0;
+    };
+
+    //Bump-pointer region allocator. Memory is carved out of large blocks and
+    //is only given back in bulk, by release() to an earlier mark or reset();
+    //deallocate() reclaims space only for the most recent allocation. Blocks
+    //are kept after a reset so later iterations don't touch the heap. Not
+    //thread-safe: use one arena per thread (see threadArena())
+    class memory_arena
+    {
+        public:
+        //Position in the arena returned by mark()
+        struct marker
+        {
+            size_t block;
+            size_t offset;
+        };
+
+        explicit memory_arena(size_t blockSize = LIMNO_ARENA_BLOCK_SIZE) noexcept
+            : _blocks{}, _current{0}, _offset{0}, _usedBefore{0}, _blockSize{std::max<size_t>(blockSize, LIMNO_CACHE_LINE)}, _stats{}
+        {
+
+        }
+
+        memory_arena(const memory_arena&) = delete;
+        memory_arena& operator=(const memory_arena&) = delete;
+
+        ~memory_arena()
+        {
+            _freeBlocks();
+        }
+
+        //Returns bytes of storage aligned to alignment, which must be a power of two
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+        {
+            for(;;)
+            {
+                if (_current < _blocks.size())
+                {
+                    const _Block& block = _blocks[_current];
+                    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data);
+                    const size_t start = static_cast<size_t>(((base + _offset + alignment - 1) & ~(alignment - 1)) - base);
+                    if (start <= block.size && bytes <= block.size - start)
+                    {
+                        _offset = start + bytes;
+                        ++_stats.allocations;
+                        _stats.bytesRequested += bytes;
+                        _stats.peakBytes = std::max(_stats.peakBytes, used());
+                        return block.data + start;
+                    }
+                    //Doesn't fit, move on to the next block
+                    _usedBefore += block.size;
+                    ++_current;
+                    _offset = 0;
+                }
+                else
+                {
+                    const size_t last = _blocks.empty() ? 0 : _blocks.back().size;
+                    _newBlock(std::max({_blockSize, 2*last, bytes + alignment}));
+                }
+            }
+        }
+
+        //Reclaims the storage only if p was the last allocation
+        void deallocate(void* p, size_t bytes) noexcept
+        {
+            ++_stats.deallocations;
+            if (_current < _blocks.size() && p != nullptr)
+            {
+                std::byte* data = _blocks[_current].data;
+                std::byte* end = static_cast<std::byte*>(p) + bytes;
+                if (end == data + _offset && static_cast<std::byte*>(p) >= data)
+                    _offset = static_cast<size_t>(static_cast<std::byte*>(p) - data);
+            }
+        }
+
+        marker mark() const noexcept
+        {
+            return marker{_current, _offset};
+        }
+
+        //Frees everything allocated since m was taken in O(1)
+        void release(marker m) noexcept
+        {
+            if (m.block > _current || (m.block == _current && m.offset >= _offset))
+                return;
+            while (_current > m.block)
+            {
+                --_current;
+                _usedBefore -= _blocks[_current].size;
+            }
+            _offset = m.offset;
+        }
+
+        //Frees everything. If the last cycle spilled into several blocks they
+        //are merged into one large enough for all of them, so the next cycle
+        //fits without going back to the heap
+        void reset()
+        {
+            ++_stats.resets;
+            if (_blocks.size() > 1)
+            {
+                size_t total = 0;
+                for(const _Block& block : _blocks)
+                    total += block.size;
+                _freeBlocks();
+                _newBlock(total);
+            }
+            _current = 0;
+            _offset = 0;
+            _usedBefore = 0;
+        }
+
+        //Bytes handed out since the last reset, including alignment padding
+        size_t used() const noexcept
+        {
+            return _usedBefore + _offset;
+        }
+
+        //Bytes held from the heap
+        size_t capacity() const noexcept
+        {
+            size_t total = 0;
+            for(const _Block& block : _blocks)
+                total += block.size;
+            return total;
+        }
+
+        const arena_stats& stats() const noexcept
+        {
+            return _stats;
+        }
+
+        void resetStats() noexcept
+        {
+            _stats = arena_stats{};
+        }
+
+        private:
+        struct _Block
+        {
+            std::byte* data;
+            size_t size;
+        };
+
+        void _newBlock(size_t size)
+        {
+            size = (size + LIMNO_CACHE_LINE - 1)/LIMNO_CACHE_LINE*LIMNO_CACHE_LINE;
+            _blocks.reserve(_blocks.size() + 1);
+            std::byte* data = static_cast<std::byte*>(::operator new(size, std::align_val_t{LIMNO_CACHE_LINE}));
+            _blocks.push_back(_Block{data, size});
+            ++_stats.heapAllocations;
+            _stats.heapBytes += size;
+        }
+
+        void _freeBlocks() noexcept
+        {
+            for(const _Block& block : _blocks)
+                ::operator delete(block.data, std::align_val_t{LIMNO_CACHE_LINE});
+            _blocks.clear();
+        }
+
+        std::vector<_Block> _blocks;
+        //Block currently being bumped and the offset into it
+        size_t _current;
+        size_t _offset;
+        //Total size of the blocks before _current
+        size_t _usedBefore;
+        size_t _blockSize;
+        arena_stats _stats;
+    };
+
+    //Arena belonging to the calling thread
+    inline memory_arena& threadArena() noexcept
+    {
+        thread_local memory_arena arena;
+        return arena;
+    }
+
+    //Frees everything allocated from an arena during its lifetime when it is
+    //destroyed. Objects using the arena must be declared after the scope so
+    //they are destroyed first
+    class arena_scope
+    {
+        public:
+        arena_scope() noexcept
+            : arena_scope(threadArena())
+        {
+
+        }
+
+        explicit arena_scope(memory_arena& arena) noexcept
+            : _arena{arena}, _mark{arena.mark()}
+        {
+
+        }
+
+        arena_scope(const arena_scope&) = delete;
+        arena_scope& operator=(const arena_scope&) = delete;
+
+        ~arena_scope()
+        {
+            _arena.release(_mark);
+        }
+
+        private:
+        memory_arena& _arena;
+        memory_arena::marker _mark;
+    };
+
+    //Allocator drawing from a memory_arena, usable as the _AllocTp of
+    //LimnoMatrixBase. Default-constructed allocators use the calling thread's
+    //arena. Storage is aligned to _Alignment bytes like aligned_allocator
+    template<typename _Tp, size_t _Alignment = LIMNO_CACHE_LINE>
+    class arena_allocator
+    {
+        static_assert((_Alignment & (_Alignment - 1)) == 0 && _Alignment >= alignof(_Tp),
+            "Alignment must be a power of two no smaller than the alignment of the type!");
+        public:
+        //Allocator requirements
+        using value_type = _Tp;
+        using is_always_equal = std::false_type;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        template<typename _UTp>
+        struct rebind
+        {
+            using other = arena_allocator<_UTp, _Alignment>;
+        };
+
+        static constexpr size_t alignment = _Alignment;
+        static constexpr bool padRows = false;
+
+        arena_allocator() noexcept
+            : _arena{&threadArena()}
+        {
+
+        }
+
+        explicit arena_allocator(memory_arena& arena) noexcept
+            : _arena{&arena}
+        {
+
+        }
+
+        template<typename _UTp>
+        arena_allocator(const arena_allocator<_UTp, _Alignment>& other) noexcept
+            : _arena{&other.arena()}
+        {
+
+        }
+
+        _Tp* allocate(size_t n)
+        {
+            if (n > std::numeric_limits<size_t>::max()/sizeof(_Tp))
+                throw std::bad_array_new_length();
+            return static_cast<_Tp*>(_arena->allocate(n*sizeof(_Tp), _Alignment));
+        }
+
+        void deallocate(_Tp* p, size_t n) noexcept
+        {
+            _arena->deallocate(p, n*sizeof(_Tp));
+        }
+
+        memory_arena& arena() const noexcept
+        {
+            return *_arena;
+        }
+        private:
+        memory_arena* _arena;
+    };
+
+    template<typename _Tp1, typename _Tp2, size_t _Alignment>
+    bool operator==(const arena_allocator<_Tp1, _Alignment>& lhs, const arena_allocator<_Tp2, _Alignment>& rhs) noexcept
+    {
+        return &lhs.arena() == &rhs.arena();
+    }
+
+    template<typename _Tp1, typename _Tp2, size_t _Alignment>
+    bool operator!=(const arena_allocator<_Tp1, _Alignment>& lhs, const arena_allocator<_Tp2, _Alignment>& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+}
+
+#endif
@@ -0,0 +1,684 @@
+#ifndef NDARRAY_BASE_HH
+#define NDARRAY_BASE_HH 1
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+#include "Core/aligned_allocator.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+#include "Core/shape.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Shape of an N-dimensional array. Every extent is either a compile-time
+    //constant or DYNAMIC, generalizing the _Nrows/_Ncols scheme of the
+    //matrices; only the dynamic extents are stored
+    template<int... _Dims>
+    class _Extents
+    {
+        static_assert(sizeof...(_Dims) > 0, "Array must have at least one dimension!");
+        static_assert(((_Dims > 0 || _Dims == DYNAMIC) && ...), "Array extents must be positive or DYNAMIC!");
+
+        static constexpr std::array<int, sizeof...(_Dims)> _static{_Dims...};
+        public:
+        using size_type = size_t;
+
+        static constexpr size_t rank = sizeof...(_Dims);
+        static constexpr size_t rankDynamic = ((_Dims == DYNAMIC) + ... + 0);
+        static constexpr bool isStatic = rankDynamic == 0;
+
+        //Extent i, or DYNAMIC if it is only known at runtime
+        static constexpr int staticExtent(size_t i) noexcept
+        {
+            return _static[i];
+        }
+
+        //True if the row-major stride of dimension i is known at compile-time,
+        //i.e. every later extent is
+        static constexpr bool hasStaticStride(size_t i) noexcept
+        {
+            for(size_t j = i + 1; j < rank; ++j)
+            {
+                if (_static[j] == DYNAMIC)
+                    return false;
+            }
+            return true;
+        }
+
+        //Row-major stride of dimension i; only meaningful if hasStaticStride(i)
+        static constexpr size_type staticStride(size_t i) noexcept
+        {
+            size_type stride = 1;
+            for(size_t j = i + 1; j < rank; ++j)
+                stride *= static_cast<size_type>(_static[j]);
+            return stride;
+        }
+
+        //Every dynamic extent is zero
+        constexpr _Extents() noexcept
+            : _dynamic{}
+        {
+
+        }
+
+        //Takes the dynamic extents in order
+        template<typename... _SizeTp,
+            std::enable_if_t<sizeof...(_SizeTp) == rankDynamic && (sizeof...(_SizeTp) > 0) &&
+                (std::is_integral_v<_SizeTp> && ...), int> = 0>
+        constexpr explicit _Extents(_SizeTp... dynamicExtents) noexcept
+            : _dynamic{static_cast<size_type>(dynamicExtents)...}
+        {
+
+        }
+
+        //Takes every extent; the static ones must match
+        constexpr explicit _Extents(const std::array<size_type, rank>& extents)
+            : _dynamic{}
+        {
+            size_t d = 0;
+            for(size_t i = 0; i < rank; ++i)
+            {
+                if (_static[i] == DYNAMIC)
+                    _dynamic[d++] = extents[i];
+                else if (static_cast<size_type>(_static[i]) != extents[i])
+                    throw std::invalid_argument("Array dimensions do not match!");
+            }
+        }
+
+        constexpr size_type extent(size_t i) const noexcept
+        {
+            if (_static[i] != DYNAMIC)
+                return static_cast<size_type>(_static[i]);
+            size_t d = 0;
+            for(size_t j = 0; j < i; ++j)
+                d += (_static[j] == DYNAMIC);
+            return _dynamic[d];
+        }
+
+        //Number of elements
+        constexpr size_type size() const noexcept
+        {
+            size_type n = 1;
+            for(size_t i = 0; i < rank; ++i)
+                n *= extent(i);
+            return n;
+        }
+
+        constexpr std::array<size_type, rank> toArray() const noexcept
+        {
+            std::array<size_type, rank> extents{};
+            for(size_t i = 0; i < rank; ++i)
+                extents[i] = extent(i);
+            return extents;
+        }
+
+        friend constexpr bool operator==(const _Extents& lhs, const _Extents& rhs) noexcept
+        {
+            return lhs._dynamic == rhs._dynamic;
+        }
+
+        friend constexpr bool operator!=(const _Extents& lhs, const _Extents& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+        private:
+        std::array<size_type, rankDynamic> _dynamic;
+    };
+
+    //Walks the elements of two arrays of the same shape in row-major order,
+    //calling f(*p, *q) on corresponding elements. The innermost dimension is a
+    //plain strided loop; the outer ones are stepped like an odometer
+    template<size_t _Rank, typename _PTp, typename _QTp, typename _FuncTp>
+    constexpr void _forEachElement(const std::array<size_t, _Rank>& extents,
+        _PTp* p, const std::array<std::ptrdiff_t, _Rank>& pStrides,
+        _QTp* q, const std::array<std::ptrdiff_t, _Rank>& qStrides, _FuncTp&& f)
+    {
+        for(size_t i = 0; i < _Rank; ++i)
+        {
+            if (extents[i] == 0)
+                return;
+        }
+
+        constexpr size_t inner = _Rank - 1;
+        const std::ptrdiff_t pInner = pStrides[inner];
+        const std::ptrdiff_t qInner = qStrides[inner];
+        std::array<size_t, _Rank> index{};
+        for(;;)
+        {
+            for(size_t i = 0; i < extents[inner]; ++i)
+                f(p[static_cast<std::ptrdiff_t>(i)*pInner], q[static_cast<std::ptrdiff_t>(i)*qInner]);
+
+            size_t d = inner;
+            for(;;)
+            {
+                if (d == 0)
+                    return;
+                --d;
+                p += pStrides[d];
+                q += qStrides[d];
+                if (++index[d] < extents[d])
+                    break;
+                p -= pStrides[d]*static_cast<std::ptrdiff_t>(extents[d]);
+                q -= qStrides[d]*static_cast<std::ptrdiff_t>(extents[d]);
+                index[d] = 0;
+            }
+        }
+    }
+
+    //Non-owning strided window onto N-dimensional storage, the counterpart
+    //of LimnoMatrixView. Element (i0, ..., iN-1) lives at
+    //data[i0*stride(0) + ... + iN-1*stride(N-1)], so slices, sub-arrays and
+    //permutations of the dimensions are views onto the same memory. Extents
+    //are always runtime values. Constness is shallow like LimnoMatrixView.
+    template<typename _Tp, size_t _Rank>
+    class LimnoArrayView
+    {
+        static_assert(_Rank > 0, "Array must have at least one dimension!");
+        public:
+        using value_type = std::remove_cv_t<_Tp>;
+        using element_type = _Tp;
+        using reference = _Tp&;
+        using const_reference = const _Tp&;
+        using pointer = _Tp*;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using extents_type = std::array<size_type, _Rank>;
+        using strides_type = std::array<difference_type, _Rank>;
+
+        static constexpr size_t rank = _Rank;
+
+        constexpr LimnoArrayView() noexcept
+            : _data{nullptr}, _extents{}, _strides{}
+        {
+
+        }
+
+        //View over dense row-major storage
+        constexpr LimnoArrayView(pointer data, const extents_type& extents) noexcept
+            : _data{data}, _extents{extents}, _strides{}
+        {
+            difference_type stride = 1;
+            for(size_t i = _Rank; i-- > 0;)
+            {
+                _strides[i] = stride;
+                stride *= static_cast<difference_type>(extents[i]);
+            }
+        }
+
+        constexpr LimnoArrayView(pointer data, const extents_type& extents, const strides_type& strides) noexcept
+            : _data{data}, _extents{extents}, _strides{strides}
+        {
+
+        }
+
+        //Allows mutable view -> read-only view conversion
+        template<typename _UTp,
+            std::enable_if_t<std::is_same_v<const _UTp, _Tp> && !std::is_same_v<_UTp, _Tp>, int> = 0>
+        constexpr LimnoArrayView(const LimnoArrayView<_UTp, _Rank>& other) noexcept
+            : _data{other.data()}, _extents{other.extents()}, _strides{other.strides()}
+        {
+
+        }
+
+        //Shape and layout
+        constexpr size_type extent(size_t i) const noexcept
+        {
+            return _extents[i];
+        }
+
+        constexpr difference_type stride(size_t i) const noexcept
+        {
+            return _strides[i];
+        }
+
+        constexpr const extents_type& extents() const noexcept
+        {
+            return _extents;
+        }
+
+        constexpr const strides_type& strides() const noexcept
+        {
+            return _strides;
+        }
+
+        constexpr size_type size() const noexcept
+        {
+            size_type n = 1;
+            for(size_t i = 0; i < _Rank; ++i)
+                n *= _extents[i];
+            return n;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        constexpr pointer data() const noexcept
+        {
+            return _data;
+        }
+
+        //True if the elements are dense and in row-major order
+        constexpr bool isContiguous() const noexcept
+        {
+            difference_type stride = 1;
+            for(size_t i = _Rank; i-- > 0;)
+            {
+                if (_extents[i] != 1 && _strides[i] != stride)
+                    return false;
+                stride *= static_cast<difference_type>(_extents[i]);
+            }
+            return true;
+        }
+
+        //Element access
+        template<typename... _IdxTp>
+        constexpr reference operator()(_IdxTp... idx) const noexcept
+        {
+            static_assert(sizeof...(_IdxTp) == _Rank, "Number of indices does not match array rank!");
+            return _data[_offset(std::index_sequence_for<_IdxTp...>{}, idx...)];
+        }
+
+        //Sub-array at index i of the first dimension, e.g. one sample of a
+        //batch
+        constexpr LimnoArrayView<_Tp, _Rank - 1> operator[](size_type i) const
+        {
+            static_assert(_Rank > 1, "Indexing a one dimensional view gives an element, use operator()!");
+            if (i >= _extents[0])
+                throw std::out_of_range("Index exceeds array dimensions!");
+            std::array<size_type, _Rank - 1> extents{};
+            std::array<difference_type, _Rank - 1> strides{};
+            for(size_t d = 1; d < _Rank; ++d)
+            {
+                extents[d - 1] = _extents[d];
+                strides[d - 1] = _strides[d];
+            }
+            return LimnoArrayView<_Tp, _Rank - 1>{_data + static_cast<difference_type>(i)*_strides[0], extents, strides};
+        }
+
+        //Every step-th index in [first, last) of dimension dim
+        constexpr LimnoArrayView slice(size_t dim, size_type first, size_type last, size_type step = 1) const
+        {
+            if (step == 0)
+                throw std::invalid_argument("Slice step must be positive!");
+            if (dim >= _Rank || first > last || last > _extents[dim])
+                throw std::out_of_range("Slice exceeds array dimensions!");
+            LimnoArrayView result{*this};
+            result._data += static_cast<difference_type>(first)*_strides[dim];
+            result._extents[dim] = (last - first + step - 1)/step;
+            result._strides[dim] *= static_cast<difference_type>(step);
+            return result;
+        }
+
+        //Dimension i of the result is dimension order[i] of this view, so
+        //permute({0, 2, 3, 1}) turns NCHW into NHWC without copying
+        constexpr LimnoArrayView permute(const std::array<size_t, _Rank>& order) const
+        {
+            std::array<bool, _Rank> seen{};
+            LimnoArrayView result{*this};
+            for(size_t i = 0; i < _Rank; ++i)
+            {
+                if (order[i] >= _Rank || seen[order[i]])
+                    throw std::invalid_argument("Permutation must name every dimension once!");
+                seen[order[i]] = true;
+                result._extents[i] = _extents[order[i]];
+                result._strides[i] = _strides[order[i]];
+            }
+            return result;
+        }
+
+        //Views the array as a matrix whose rows run over dimensions [0, split)
+        //and columns over [split, rank), so matrix kernels can run on it
+        //without a copy. Each group must be collapsible into a single stride
+        constexpr LimnoMatrixView<_Tp> asMatrix(size_t split) const
+        {
+            if (split > _Rank)
+                throw std::out_of_range("Split exceeds array rank!");
+            size_type numRows = 1;
+            size_type numCols = 1;
+            difference_type rowStride = 0;
+            difference_type colStride = 1;
+            if (!_collapse(0, split, numRows, rowStride) || !_collapse(split, _Rank, numCols, colStride))
+                throw std::invalid_argument("Dimensions can not be merged without a copy!");
+            if (split == 0)
+                rowStride = static_cast<difference_type>(numCols)*colStride;
+            return LimnoMatrixView<_Tp>{_data, numRows, numCols, rowStride, colStride};
+        }
+
+        //Calls f on every element in row-major order
+        template<typename _FuncTp>
+        constexpr void forEach(_FuncTp f) const
+        {
+            _forEachElement(_extents, _data, _strides, _data, _strides, [&](reference x, reference) { f(x); });
+        }
+
+        //Writing through the view
+        constexpr void fill(const value_type& value) const
+        {
+            forEach([&](reference x) { x = value; });
+        }
+
+        template<typename _UTp>
+        constexpr void assign(const LimnoArrayView<_UTp, _Rank>& src) const
+        {
+            if (src.extents() != _extents)
+                throw std::invalid_argument("Array dimensions do not match!");
+            _forEachElement(_extents, _data, _strides, src.data(), src.strides(),
+                [](reference x, const std::remove_cv_t<_UTp>& y) { x = y; });
+        }
+        private:
+        template<size_t... _Is, typename... _IdxTp>
+        constexpr difference_type _offset(std::index_sequence<_Is...>, _IdxTp... idx) const noexcept
+        {
+            return ((static_cast<difference_type>(idx)*_strides[_Is]) + ...);
+        }
+
+        //Merges dimensions [first, last) into one of the given extent and
+        //stride if they are nested like a row-major block
+        constexpr bool _collapse(size_t first, size_t last, size_type& extent, difference_type& stride) const noexcept
+        {
+            extent = 1;
+            for(size_t i = last; i-- > first;)
+            {
+                if (_extents[i] == 1)
+                    continue;
+                if (extent == 1)
+                    stride = _strides[i];
+                else if (_strides[i] != stride*static_cast<difference_type>(extent))
+                    return false;
+                extent *= _extents[i];
+            }
+            return true;
+        }
+
+        pointer _data;
+        extents_type _extents;
+        strides_type _strides;
+    };
+
+    //N-dimensional array owning dense row-major storage. Static extents are
+    //part of the type; strides that only depend on static extents are
+    //compile-time constants, so an all-static shape indexes with fully
+    //inlined arithmetic. All-static arrays live in aligned inline storage,
+    //anything else in a vector using _AllocTp (rows are never padded).
+    template<typename _Tp, typename _ExtentsTp, typename _AllocTp = std::allocator<_Tp>>
+    class LimnoArrayBase;
+
+    template<typename _Tp, int... _Dims, typename _AllocTp>
+    class LimnoArrayBase<_Tp, _Extents<_Dims...>, _AllocTp>
+    {
+        public:
+        using extents_type = _Extents<_Dims...>;
+        private:
+        using storage_type = std::conditional_t<extents_type::isStatic,
+            std::array<_Tp, extents_type{}.size()>,
+            std::vector<_Tp, _AllocTp>>;
+        //Strides are only stored if some are runtime values
+        static constexpr size_t _numStrides = extents_type::isStatic ? 0 : extents_type::rank;
+        public:
+        using value_type = _Tp;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+        using iterator = _Iterator<_Tp>;
+        using const_iterator = _ConstIterator<_Tp>;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using view_type = LimnoArrayView<_Tp, sizeof...(_Dims)>;
+        using const_view_type = LimnoArrayView<const _Tp, sizeof...(_Dims)>;
+
+        static constexpr size_t rank = extents_type::rank;
+        static constexpr bool isStatic = extents_type::isStatic;
+
+        //Static arrays are left uninitialized like the static matrices;
+        //dynamic arrays start out empty
+        constexpr LimnoArrayBase() noexcept
+            : _extents{}, _strides{}
+        {
+            _computeStrides();
+        }
+
+        //Fills a static array with the specified value
+        template<bool _Static = isStatic, std::enable_if_t<_Static, int> = 0>
+        constexpr explicit LimnoArrayBase(const _Tp& fillValue)
+            : _extents{}, _strides{}
+        {
+            for(auto& x : _data)
+                x = fillValue;
+        }
+
+        //Value-initialized array with the given dynamic extents, in order
+        template<typename... _SizeTp,
+            std::enable_if_t<sizeof...(_SizeTp) == extents_type::rankDynamic && (sizeof...(_SizeTp) > 0) &&
+                (std::is_integral_v<_SizeTp> && ...), int> = 0>
+        CONSTEXPR20 explicit LimnoArrayBase(_SizeTp... dynamicExtents)
+            : LimnoArrayBase(extents_type{dynamicExtents...})
+        {
+
+        }
+
+        CONSTEXPR20 explicit LimnoArrayBase(const extents_type& extents, const _Tp& fillValue = _Tp{})
+            : _extents{extents}, _strides{}
+        {
+            _computeStrides();
+            if constexpr(isStatic)
+            {
+                for(auto& x : _data)
+                    x = fillValue;
+            }
+            else
+                _data.assign(_extents.size(), fillValue);
+        }
+
+        //Copies elements in row-major order; missing elements are zero
+        template<typename _InputIt,
+            std::enable_if_t<!std::is_integral_v<_InputIt>, int> = 0>
+        CONSTEXPR20 LimnoArrayBase(const extents_type& extents, _InputIt first, _InputIt last)
+            : LimnoArrayBase(extents, _Tp{})
+        {
+            for(size_type i = 0; i < size() && first != last; ++i)
+                _data[i] = *first++;
+        }
+
+        //Materializes a view, e.g. a permuted or sliced one, into dense storage
+        template<typename _UTp>
+        CONSTEXPR20 explicit LimnoArrayBase(const LimnoArrayView<_UTp, sizeof...(_Dims)>& view)
+            : LimnoArrayBase(extents_type{view.extents()}, _Tp{})
+        {
+            this->view().assign(view);
+        }
+
+        //Shape and layout
+        constexpr size_type extent(size_t i) const noexcept
+        {
+            return _extents.extent(i);
+        }
+
+        constexpr difference_type stride(size_t i) const noexcept
+        {
+            if constexpr(isStatic)
+                return static_cast<difference_type>(extents_type::staticStride(i));
+            else
+                return _strides[i];
+        }
+
+        constexpr const extents_type& extents() const noexcept
+        {
+            return _extents;
+        }
+
+        constexpr size_type size() const noexcept
+        {
+            if constexpr(isStatic)
+                return std::tuple_size_v<storage_type>;
+            else
+                return _data.size();
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        constexpr pointer data() noexcept
+        {
+            return _data.data();
+        }
+
+        constexpr const_pointer data() const noexcept
+        {
+            return _data.data();
+        }
+
+        //Element access
+        template<typename... _IdxTp>
+        constexpr reference operator()(_IdxTp... idx) noexcept
+        {
+            static_assert(sizeof...(_IdxTp) == rank, "Number of indices does not match array rank!");
+            return _data[_offset(std::index_sequence_for<_IdxTp...>{}, idx...)];
+        }
+
+        template<typename... _IdxTp>
+        constexpr const_reference operator()(_IdxTp... idx) const noexcept
+        {
+            static_assert(sizeof...(_IdxTp) == rank, "Number of indices does not match array rank!");
+            return _data[_offset(std::index_sequence_for<_IdxTp...>{}, idx...)];
+        }
+
+        //Iterators, in row-major order
+        constexpr iterator begin() noexcept
+        {
+            return iterator{data()};
+        }
+
+        constexpr iterator end() noexcept
+        {
+            return iterator{data() + size()};
+        }
+
+        constexpr const_iterator begin() const noexcept
+        {
+            return const_iterator{data()};
+        }
+
+        constexpr const_iterator end() const noexcept
+        {
+            return const_iterator{data() + size()};
+        }
+
+        constexpr const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        constexpr const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        constexpr void fill(const _Tp& value)
+        {
+            for(auto& x : _data)
+                x = value;
+        }
+
+        //Views
+        constexpr view_type view() noexcept
+        {
+            return view_type{data(), _extents.toArray(), _stridesArray()};
+        }
+
+        constexpr const_view_type view() const noexcept
+        {
+            return const_view_type{data(), _extents.toArray(), _stridesArray()};
+        }
+
+        constexpr auto operator[](size_type i)
+        {
+            return view()[i];
+        }
+
+        constexpr auto operator[](size_type i) const
+        {
+            return view()[i];
+        }
+
+        //Matrix over the same storage with rows running over dimensions
+        //[0, split) and columns over [split, rank)
+        constexpr LimnoMatrixView<_Tp> asMatrix(size_t split)
+        {
+            return view().asMatrix(split);
+        }
+
+        constexpr LimnoMatrixView<const _Tp> asMatrix(size_t split) const
+        {
+            return view().asMatrix(split);
+        }
+        private:
+        //Strides known at compile-time are folded in as constants, the rest
+        //come from _strides
+        template<size_t _I>
+        constexpr difference_type _stride() const noexcept
+        {
+            if constexpr(extents_type::hasStaticStride(_I))
+                return static_cast<difference_type>(extents_type::staticStride(_I));
+            else
+                return _strides[_I];
+        }
+
+        template<size_t... _Is, typename... _IdxTp>
+        constexpr size_type _offset(std::index_sequence<_Is...>, _IdxTp... idx) const noexcept
+        {
+            return static_cast<size_type>(((static_cast<difference_type>(idx)*_stride<_Is>()) + ...));
+        }
+
+        constexpr void _computeStrides() noexcept
+        {
+            if constexpr(!isStatic)
+            {
+                difference_type stride = 1;
+                for(size_t i = rank; i-- > 0;)
+                {
+                    _strides[i] = stride;
+                    stride *= static_cast<difference_type>(_extents.extent(i));
+                }
+            }
+        }
+
+        constexpr std::array<difference_type, rank> _stridesArray() const noexcept
+        {
+            std::array<difference_type, rank> strides{};
+            for(size_t i = 0; i < rank; ++i)
+                strides[i] = stride(i);
+            return strides;
+        }
+
+        static constexpr size_t _storageAlignment() noexcept
+        {
+            if constexpr(isStatic)
+                return _staticAlignment<_Tp, extents_type{}.size(), _AllocTp>();
+            else
+                return alignof(storage_type);
+        }
+
+        extents_type _extents;
+        std::array<difference_type, _numStrides> _strides;
+        alignas(_storageAlignment()) storage_type _data;
+    };
+
+    //N-dimensional array with a static or DYNAMIC extent per dimension,
+    //e.g. LimnoArray<float, DYNAMIC, 3, 224, 224> for a batch of RGB images
+    template<typename _Tp, int... _Dims>
+    using LimnoArray = LimnoArrayBase<_Tp, _Extents<_Dims...>>;
+}
+
+#endif
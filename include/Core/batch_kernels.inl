@@ -0,0 +1,186 @@
+//Batched small matrix kernels shared by every instruction set. Like
+//simd_kernels.inl this file has no include guard: matrix_batch.hh includes it
+//once per instruction set, inside a namespace that has the _Reg register
+//wrappers and the matching target enabled. Matrices are stored in packs of
+//_batchLanes<_Tp> with each element of a pack contiguous across the matrices,
+//so every register below holds the same element of _V::width matrices and
+//each step of a kernel runs on all of them at once.
+
+//c = a*b for every matrix of the packs; a is _M x _K and b is _K x _N
+template<typename _V, size_t _M, size_t _K, size_t _N>
+void _batchProduct(const typename _V::value_type* a, const typename _V::value_type* b,
+    typename _V::value_type* c, size_t packs) noexcept
+{
+    using reg = typename _V::reg;
+    constexpr size_t lanes = _batchLanes<typename _V::value_type>;
+    static_assert(lanes % _V::width == 0, "Packs must fill whole registers!");
+    for(size_t p = 0; p < packs; ++p)
+    {
+        const typename _V::value_type* pa = a + p*_M*_K*lanes;
+        const typename _V::value_type* pb = b + p*_K*_N*lanes;
+        typename _V::value_type* pc = c + p*_M*_N*lanes;
+        for(size_t g = 0; g < lanes; g += _V::width)
+            for(size_t i = 0; i < _M; ++i)
+            {
+                reg row[_K];
+                for(size_t k = 0; k < _K; ++k)
+                    row[k] = _V::load(pa + (i*_K + k)*lanes + g);
+                for(size_t j = 0; j < _N; ++j)
+                {
+                    reg acc = _V::mul(row[0], _V::load(pb + j*lanes + g));
+                    for(size_t k = 1; k < _K; ++k)
+                        acc = _V::add(acc, _V::mul(row[k], _V::load(pb + (k*_N + j)*lanes + g)));
+                    _V::store(pc + (i*_N + j)*lanes + g, acc);
+                }
+            }
+    }
+}
+
+//Solves a x = b for every matrix of the packs by Gauss-Jordan elimination on
+//[a | b] with partial pivoting. Matrices sharing a register may need
+//different pivot rows, so each candidate row below the diagonal is
+//compare-and-swapped into the pivot row with a select instead of a gather.
+//A null b solves against the identity, giving the inverse. Returns false if
+//any of the first count matrices is singular; the others are padding
+template<typename _V, size_t _N, size_t _K>
+bool _batchGaussJordan(const typename _V::value_type* a, const typename _V::value_type* b,
+    typename _V::value_type* x, size_t packs, size_t count) noexcept
+{
+    using _Tp = typename _V::value_type;
+    using reg = typename _V::reg;
+    constexpr size_t lanes = _batchLanes<_Tp>;
+    constexpr size_t width = _N + _K;
+    static_assert(lanes % _V::width == 0, "Packs must fill whole registers!");
+    bool regular = true;
+    for(size_t p = 0; p < packs; ++p)
+    {
+        const _Tp* pa = a + p*_N*_N*lanes;
+        const _Tp* pb = b ? b + p*_N*_K*lanes : nullptr;
+        _Tp* px = x + p*_N*_K*lanes;
+        for(size_t g = 0; g < lanes; g += _V::width)
+        {
+            reg w[_N][width];
+            for(size_t r = 0; r < _N; ++r)
+            {
+                for(size_t c = 0; c < _N; ++c)
+                    w[r][c] = _V::load(pa + (r*_N + c)*lanes + g);
+                for(size_t c = 0; c < _K; ++c)
+                    w[r][_N + c] = pb ? _V::load(pb + (r*_K + c)*lanes + g) : _V::broadcast(_Tp(r == c ? 1 : 0));
+            }
+
+            //Smallest pivot magnitude of each matrix; zero means singular
+            reg smallest = _V::broadcast(std::numeric_limits<_Tp>::max());
+            for(size_t k = 0; k < _N; ++k)
+            {
+                for(size_t r = k + 1; r < _N; ++r)
+                {
+                    const typename _V::mask larger = _V::greater(_V::abs(w[r][k]), _V::abs(w[k][k]));
+                    for(size_t c = k; c < width; ++c)
+                    {
+                        const reg u = w[k][c];
+                        w[k][c] = _V::select(larger, w[r][c], u);
+                        w[r][c] = _V::select(larger, u, w[r][c]);
+                    }
+                }
+
+                smallest = _V::min(smallest, _V::abs(w[k][k]));
+                const reg scale = _V::div(_V::broadcast(_Tp(1)), w[k][k]);
+                for(size_t c = k + 1; c < width; ++c)
+                    w[k][c] = _V::mul(w[k][c], scale);
+                for(size_t r = 0; r < _N; ++r)
+                {
+                    if (r == k)
+                        continue;
+                    const reg factor = w[r][k];
+                    for(size_t c = k + 1; c < width; ++c)
+                        w[r][c] = _V::sub(w[r][c], _V::mul(factor, w[k][c]));
+                }
+            }
+
+            for(size_t r = 0; r < _N; ++r)
+                for(size_t c = 0; c < _K; ++c)
+                    _V::store(px + (r*_K + c)*lanes + g, w[r][_N + c]);
+
+            _Tp pivots[_V::width];
+            _V::store(pivots, smallest);
+            for(size_t l = 0; l < _V::width && p*lanes + g + l < count; ++l)
+                regular = regular && pivots[l] != _Tp{};
+        }
+    }
+    return regular;
+}
+
+//p*q - r*s
+template<typename _V>
+inline typename _V::reg _batchCross(typename _V::reg p, typename _V::reg q, typename _V::reg r, typename _V::reg s) noexcept
+{
+    return _V::sub(_V::mul(p, q), _V::mul(r, s));
+}
+
+//Inverse of every matrix of the packs. Up to 3x3 this is the adjugate over
+//the determinant, as in _smallInverse, which needs no pivoting; larger
+//matrices go through _batchGaussJordan. Returns false if any of the first
+//count matrices is singular
+template<typename _V, size_t _N>
+bool _batchInverse(const typename _V::value_type* a, typename _V::value_type* x, size_t packs, size_t count) noexcept
+{
+    if constexpr(_N > 3)
+        return _batchGaussJordan<_V, _N, _N>(a, nullptr, x, packs, count);
+    else
+    {
+        using _Tp = typename _V::value_type;
+        using reg = typename _V::reg;
+        constexpr size_t lanes = _batchLanes<_Tp>;
+        static_assert(lanes % _V::width == 0, "Packs must fill whole registers!");
+        bool regular = true;
+        for(size_t p = 0; p < packs; ++p)
+        {
+            const _Tp* pa = a + p*_N*_N*lanes;
+            _Tp* px = x + p*_N*_N*lanes;
+            for(size_t g = 0; g < lanes; g += _V::width)
+            {
+                reg m[_N*_N];
+                for(size_t i = 0; i < _N*_N; ++i)
+                    m[i] = _V::load(pa + i*lanes + g);
+                reg adj[_N*_N];
+                reg det;
+                if constexpr(_N == 1)
+                {
+                    adj[0] = _V::broadcast(_Tp(1));
+                    det = m[0];
+                }
+                else if constexpr(_N == 2)
+                {
+                    adj[0] = m[3];
+                    adj[1] = _V::sub(_V::zero(), m[1]);
+                    adj[2] = _V::sub(_V::zero(), m[2]);
+                    adj[3] = m[0];
+                    det = _batchCross<_V>(m[0], m[3], m[1], m[2]);
+                }
+                else
+                {
+                    adj[0] = _batchCross<_V>(m[4], m[8], m[5], m[7]);
+                    adj[1] = _batchCross<_V>(m[2], m[7], m[1], m[8]);
+                    adj[2] = _batchCross<_V>(m[1], m[5], m[2], m[4]);
+                    adj[3] = _batchCross<_V>(m[5], m[6], m[3], m[8]);
+                    adj[4] = _batchCross<_V>(m[0], m[8], m[2], m[6]);
+                    adj[5] = _batchCross<_V>(m[2], m[3], m[0], m[5]);
+                    adj[6] = _batchCross<_V>(m[3], m[7], m[4], m[6]);
+                    adj[7] = _batchCross<_V>(m[1], m[6], m[0], m[7]);
+                    adj[8] = _batchCross<_V>(m[0], m[4], m[1], m[3]);
+                    det = _V::add(_V::add(_V::mul(m[0], adj[0]), _V::mul(m[1], adj[3])), _V::mul(m[2], adj[6]));
+                }
+
+                const reg scale = _V::div(_V::broadcast(_Tp(1)), det);
+                for(size_t i = 0; i < _N*_N; ++i)
+                    _V::store(px + i*lanes + g, _V::mul(adj[i], scale));
+
+                _Tp dets[_V::width];
+                _V::store(dets, det);
+                for(size_t l = 0; l < _V::width && p*lanes + g + l < count; ++l)
+                    regular = regular && dets[l] != _Tp{};
+            }
+        }
+        return regular;
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef BLOCKS_HH
+#define BLOCKS_HH 1
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "config.hh"
+#include "Core/construction.hh"
+#include "Core/matrix_base.hh"
+#include "Core/shape.hh"
+#include "Core/small_matrix.hh"
+
+//Block extraction and concatenation. Result extents are computed from the
+//operand extents at compile-time, so blocks and concatenations of static
+//matrices are static matrices in std::array storage, and only the extents
+//that are dynamic are checked at runtime
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Result of a shape-changing operation. Small static results are zeroed
+    //first so they can be built at compile-time, as in matmul
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    constexpr LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> _shapedResult(size_t numRows, size_t numCols)
+    {
+        using result_type = LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>;
+        if constexpr(runtimeDim<_Nrows, _Ncols>)
+            return result_type(Limno::uninitialized, numRows, numCols);
+        else if constexpr(_smallDim<_Nrows, _Ncols>)
+            return result_type(_Tp{});
+        else
+            return result_type();
+    }
+
+    //Copies the numRows x numCols block of src at (r0, c0) to dst at (r1, c1)
+    template<typename _SrcTp, typename _DstTp>
+    constexpr void _copyBlock(const _SrcTp& src, size_t r0, size_t c0, _DstTp& dst, size_t r1, size_t c1,
+        size_t numRows, size_t numCols)
+    {
+        for(size_t r = 0; r < numRows; ++r)
+            for(size_t c = 0; c < numCols; ++c)
+                dst(r1 + r, c1 + c) = src(r0 + r, c0 + c);
+    }
+
+    //_Nblock x _Mblock block of m whose top-left element is (r0, c0). The
+    //block's extents are static whatever the extents of m
+    template<int _Nblock, int _Mblock, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    constexpr LimnoMatrixBase<_Tp, _Nblock, _Mblock, _AllocTp> block(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m,
+        size_t r0, size_t c0)
+    {
+        static_assert(_Nblock >= 0 && _Mblock >= 0, "Block dimensions must be static!");
+        static_assert((_Nrows == DYNAMIC || _Nblock <= _Nrows) && (_Ncols == DYNAMIC || _Mblock <= _Ncols),
+            "Block exceeds matrix dimensions!");
+        if (r0 > m.numRows() || _Nblock > m.numRows() - r0 || c0 > m.numCols() || _Mblock > m.numCols() - c0)
+            throw std::out_of_range("Block exceeds matrix dimensions!");
+        auto result = _shapedResult<_Tp, _Nblock, _Mblock, _AllocTp>(_Nblock, _Mblock);
+        _copyBlock(m, r0, c0, result, 0, 0, _Nblock, _Mblock);
+        return result;
+    }
+
+    //Block at a static offset. Taken from a static matrix it is checked
+    //entirely at compile-time
+    template<int _R0, int _C0, int _Nblock, int _Mblock, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    constexpr LimnoMatrixBase<_Tp, _Nblock, _Mblock, _AllocTp> block(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        static_assert(_R0 >= 0 && _C0 >= 0 && _Nblock >= 0 && _Mblock >= 0, "Block dimensions must be static!");
+        static_assert((_Nrows == DYNAMIC || _R0 + _Nblock <= _Nrows) && (_Ncols == DYNAMIC || _C0 + _Mblock <= _Ncols),
+            "Block exceeds matrix dimensions!");
+        if constexpr(runtimeDim<_Nrows, _Ncols>)
+        {
+            if (_R0 + _Nblock > m.numRows() || _C0 + _Mblock > m.numCols())
+                throw std::out_of_range("Block exceeds matrix dimensions!");
+        }
+        auto result = _shapedResult<_Tp, _Nblock, _Mblock, _AllocTp>(_Nblock, _Mblock);
+        _copyBlock(m, _R0, _C0, result, 0, 0, _Nblock, _Mblock);
+        return result;
+    }
+
+    //[lhs rhs]. The result has the static row count of either operand and
+    //static columns if both operands have them
+    template<typename _Tp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2, typename _AllocTp1, typename _AllocTp2>
+    constexpr LimnoMatrixBase<_Tp, commonDim<_Nrows1, _Nrows2>, sumDim<_Ncols1, _Ncols2>, _AllocTp1> hconcat(
+        const LimnoMatrixBase<_Tp, _Nrows1, _Ncols1, _AllocTp1>& lhs, const LimnoMatrixBase<_Tp, _Nrows2, _Ncols2, _AllocTp2>& rhs)
+    {
+        static_assert(compatibleDim<_Nrows1, _Nrows2>, "Matrix dimensions do not match!");
+        if (!sameDim<_Nrows1, _Nrows2>(lhs.numRows(), rhs.numRows()))
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        auto result = _shapedResult<_Tp, commonDim<_Nrows1, _Nrows2>, sumDim<_Ncols1, _Ncols2>, _AllocTp1>(
+            lhs.numRows(), lhs.numCols() + rhs.numCols());
+        _copyBlock(lhs, 0, 0, result, 0, 0, lhs.numRows(), lhs.numCols());
+        _copyBlock(rhs, 0, 0, result, 0, lhs.numCols(), rhs.numRows(), rhs.numCols());
+        return result;
+    }
+
+    //lhs stacked on top of rhs
+    template<typename _Tp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2, typename _AllocTp1, typename _AllocTp2>
+    constexpr LimnoMatrixBase<_Tp, sumDim<_Nrows1, _Nrows2>, commonDim<_Ncols1, _Ncols2>, _AllocTp1> vconcat(
+        const LimnoMatrixBase<_Tp, _Nrows1, _Ncols1, _AllocTp1>& lhs, const LimnoMatrixBase<_Tp, _Nrows2, _Ncols2, _AllocTp2>& rhs)
+    {
+        static_assert(compatibleDim<_Ncols1, _Ncols2>, "Matrix dimensions do not match!");
+        if (!sameDim<_Ncols1, _Ncols2>(lhs.numCols(), rhs.numCols()))
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        auto result = _shapedResult<_Tp, sumDim<_Nrows1, _Nrows2>, commonDim<_Ncols1, _Ncols2>, _AllocTp1>(
+            lhs.numRows() + rhs.numRows(), lhs.numCols());
+        _copyBlock(lhs, 0, 0, result, 0, 0, lhs.numRows(), lhs.numCols());
+        _copyBlock(rhs, 0, 0, result, lhs.numRows(), 0, rhs.numRows(), rhs.numCols());
+        return result;
+    }
+}
+
+#endif
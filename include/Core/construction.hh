@@ -0,0 +1,27 @@
+#ifndef CONSTRUCTION_HH
+#define CONSTRUCTION_HH 1
+
+#include "config.hh"
+
+namespace LIB_NAMESPACE_BASE
+{
+    //Construction modes accepted as the first argument of the sized matrix
+    //constructors. Storage is allocated exactly once either way
+
+    //Elements are left uninitialized and must be written before being read
+    struct uninitialized_t
+    {
+
+    };
+
+    //Elements are zeroed in bulk
+    struct zeros_t
+    {
+
+    };
+
+    inline constexpr uninitialized_t uninitialized{};
+    inline constexpr zeros_t zeros{};
+}
+
+#endif
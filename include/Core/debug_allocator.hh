@@ -1,85 +1,323 @@
 #ifndef DEBUG_ALLOCATOR
 #define DEBUG_ALLOCATOR
 
-#include <memory>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "config.hh"
 
+#define LIMNO_STRINGIFY_IMPL(x) #x
+#define LIMNO_STRINGIFY(x) LIMNO_STRINGIFY_IMPL(x)
+//Label naming the source line it appears on, e.g. debug_allocator<double>{LIMNO_ALLOCATION_SITE}
+#define LIMNO_ALLOCATION_SITE __FILE__ ":" LIMNO_STRINGIFY(__LINE__)
+
 namespace LIB_NAMESPACE_BASE::_detail
 {
+    //Number of allocation size classes. Class i holds sizes in [2^(i-1), 2^i),
+    //the last one everything larger
+    static constexpr size_t _histogramBins = 32;
 
-    std::map<std::string, int> allocator_alloc_counts;
-    std::map<std::string, int> allocator_dealloc_counts;
-
-    static const std::string nameBase = "allocator";
+    //Totals for one label, summed over every thread
+    struct allocation_stats
+    {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t bytesAllocated = 0;
+        size_t bytesFreed = 0;
+        std::int64_t liveBytes = 0;
+        std::int64_t peakLiveBytes = 0;
+        std::array<size_t, _histogramBins> histogram{};
+    };
 
-    template<typename _Tp>
-    struct debug_allocator 
+    //Collects the allocations made through debug_allocator. Counters are kept
+    //per thread and label and only ever touched with relaxed atomics, so the
+    //hot path takes no locks; the registry mutex is only taken the first time
+    //a thread sees a label and when building a report. Live and peak bytes
+    //are shared per label and updated lock-free.
+    class allocation_profiler
     {
-        static const int count = 1;
-        //Allocator requirements
-        using value_type = _Tp;
-        using is_always_equal = std::false_type;
+        //Shared state of a label
+        struct _Label
+        {
+            std::string name;
+            std::atomic<std::int64_t> live{0};
+            std::atomic<std::int64_t> peak{0};
+        };
 
-        using allocator_base_type = std::allocator<_Tp>;
+        public:
+        //Counters of one thread for one label
+        struct _Counters
+        {
+            _Label* label;
+            std::atomic<size_t> allocations{0};
+            std::atomic<size_t> deallocations{0};
+            std::atomic<size_t> bytesAllocated{0};
+            std::atomic<size_t> bytesFreed{0};
+            std::array<std::atomic<size_t>, _histogramBins> histogram{};
+        };
 
-        debug_allocator()
-            : _base{}
+        //The profiler is never destroyed so allocations made during static
+        //destruction can still be recorded
+        static allocation_profiler& instance()
         {
-            _name = nameBase + std::to_string(count);
-            ++count;
+            static allocation_profiler* profiler = new allocation_profiler{};
+            return *profiler;
         }
 
-        template<typename _UTp>
-        debug_allocator(const debug_allocator<_UTp>& other)
-            : _base{other._base}
+        //Counters of the calling thread for label
+        _Counters& counters(const char* label)
         {
-            _name = other._name;
-            _name.append("_copy");
+            thread_local std::unordered_map<const char*, _Counters*> cache;
+            auto it = cache.find(label);
+            if (it != cache.end())
+                return *it->second;
+
+            std::lock_guard<std::mutex> lock{_mutex};
+            std::unique_ptr<_Label>& shared = _labels[label];
+            if (!shared)
+            {
+                shared = std::make_unique<_Label>();
+                shared->name = label;
+            }
+            _counters.push_back(std::make_unique<_Counters>());
+            _counters.back()->label = shared.get();
+            cache.emplace(label, _counters.back().get());
+            return *_counters.back();
         }
 
-        debug_allocator(const debug_allocator<_Tp>& other)
-            : _base{other._base}
+        static void recordAllocation(_Counters& counters, size_t bytes) noexcept
         {
-            _name = other._name;
-            _name.append("_copy");
+            counters.allocations.fetch_add(1, std::memory_order_relaxed);
+            counters.bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+            counters.histogram[_sizeClass(bytes)].fetch_add(1, std::memory_order_relaxed);
+
+            _Label& label = *counters.label;
+            const std::int64_t live = label.live.fetch_add(static_cast<std::int64_t>(bytes), std::memory_order_relaxed) +
+                static_cast<std::int64_t>(bytes);
+            std::int64_t peak = label.peak.load(std::memory_order_relaxed);
+            while (live > peak && !label.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            {
+
+            }
         }
 
-        _Tp* allocate(size_t n)
+        static void recordDeallocation(_Counters& counters, size_t bytes) noexcept
+        {
+            counters.deallocations.fetch_add(1, std::memory_order_relaxed);
+            counters.bytesFreed.fetch_add(bytes, std::memory_order_relaxed);
+            counters.label->live.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+        }
+
+        //Totals per label. Counters may still be moving while this runs
+        std::map<std::string, allocation_stats> snapshot() const
         {
-            void* retVal = _base.allocate(n);
-            ++allocator_alloc_counts[_name];
+            std::map<std::string, allocation_stats> result;
+            std::lock_guard<std::mutex> lock{_mutex};
+            for(const auto& counters : _counters)
+            {
+                allocation_stats& stats = result[counters->label->name];
+                stats.allocations += counters->allocations.load(std::memory_order_relaxed);
+                stats.deallocations += counters->deallocations.load(std::memory_order_relaxed);
+                stats.bytesAllocated += counters->bytesAllocated.load(std::memory_order_relaxed);
+                stats.bytesFreed += counters->bytesFreed.load(std::memory_order_relaxed);
+                for(size_t i = 0; i < _histogramBins; ++i)
+                    stats.histogram[i] += counters->histogram[i].load(std::memory_order_relaxed);
+                stats.liveBytes = counters->label->live.load(std::memory_order_relaxed);
+                stats.peakLiveBytes = counters->label->peak.load(std::memory_order_relaxed);
+            }
+            return result;
         }
 
-        void deallocate(_Tp* p, size_t n) noexcept 
+        //Totals for a single label
+        allocation_stats stats(const std::string& label) const
         {
-            _base.deallocate(p, n);
-            try 
+            const auto all = snapshot();
+            const auto it = all.find(label);
+            return (it == all.end()) ? allocation_stats{} : it->second;
+        }
+
+        //Zeroes every counter. Peak live bytes restart from the current live bytes
+        void reset() noexcept
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            for(const auto& counters : _counters)
             {
-                ++allocator_dealloc_counts[_name];
+                counters->allocations.store(0, std::memory_order_relaxed);
+                counters->deallocations.store(0, std::memory_order_relaxed);
+                counters->bytesAllocated.store(0, std::memory_order_relaxed);
+                counters->bytesFreed.store(0, std::memory_order_relaxed);
+                for(auto& bin : counters->histogram)
+                    bin.store(0, std::memory_order_relaxed);
             }
-            catch (...)
+            for(const auto& label : _labels)
+                label.second->peak.store(label.second->live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        //Writes one line per label followed by its non-empty size classes
+        void report(std::ostream& os) const
+        {
+            os << std::left << std::setw(40) << "label" << std::right
+                << std::setw(12) << "allocs" << std::setw(12) << "frees"
+                << std::setw(16) << "bytes" << std::setw(16) << "live" << std::setw(16) << "peak live" << '\n';
+            for(const auto& [name, stats] : snapshot())
             {
+                os << std::left << std::setw(40) << name << std::right
+                    << std::setw(12) << stats.allocations << std::setw(12) << stats.deallocations
+                    << std::setw(16) << stats.bytesAllocated << std::setw(16) << stats.liveBytes
+                    << std::setw(16) << stats.peakLiveBytes << '\n';
+                for(size_t i = 0; i < _histogramBins; ++i)
+                {
+                    if (stats.histogram[i] == 0)
+                        continue;
+                    os << "    [" << ((i == 0) ? 0 : (size_t{1} << (i - 1))) << ", ";
+                    if (i + 1 < _histogramBins)
+                        os << (size_t{1} << i) << ")";
+                    else
+                        os << "inf)";
+                    os << ": " << stats.histogram[i] << '\n';
+                }
+            }
+        }
+
+        private:
+        allocation_profiler() = default;
 
+        static size_t _sizeClass(size_t bytes) noexcept
+        {
+            size_t bin = 0;
+            while (bytes != 0 && bin + 1 < _histogramBins)
+            {
+                bytes >>= 1;
+                ++bin;
             }
+            return bin;
+        }
+
+        mutable std::mutex _mutex;
+        //Keyed by name so equal labels from different call sites are merged
+        std::map<std::string, std::unique_ptr<_Label>> _labels;
+        std::vector<std::unique_ptr<_Counters>> _counters;
+    };
+
+    //Label used by default-constructed debug_allocators on this thread
+    inline const char*& _currentAllocationLabel() noexcept
+    {
+        thread_local const char* label = "unlabelled";
+        return label;
+    }
+
+    //Attributes allocations made by unlabelled debug_allocators to label
+    //while in scope. Scopes nest
+    class allocation_label
+    {
+        public:
+        explicit allocation_label(const char* label) noexcept
+            : _previous{_currentAllocationLabel()}
+        {
+            _currentAllocationLabel() = label;
+        }
+
+        allocation_label(const allocation_label&) = delete;
+        allocation_label& operator=(const allocation_label&) = delete;
+
+        ~allocation_label()
+        {
+            _currentAllocationLabel() = _previous;
+        }
+
+        private:
+        const char* _previous;
+    };
+
+    //Allocator recording every allocation with allocation_profiler. Labels
+    //must be string literals or otherwise outlive the program's use of the
+    //profiler. Each block carries a header remembering whose counters it was
+    //charged to, so frees are credited to the same label and thread even if
+    //they happen elsewhere
+    template<typename _Tp>
+    struct debug_allocator
+    {
+        //Allocator requirements
+        using value_type = _Tp;
+        using is_always_equal = std::true_type;
+
+        //Unlabelled allocators use the innermost allocation_label
+        debug_allocator() noexcept
+            : _label{nullptr}
+        {
+
+        }
+
+        explicit debug_allocator(const char* label) noexcept
+            : _label{label}
+        {
+
+        }
+
+        template<typename _UTp>
+        debug_allocator(const debug_allocator<_UTp>& other) noexcept
+            : _label{other.label()}
+        {
+
+        }
+
+        _Tp* allocate(size_t n)
+        {
+            if (n > (std::numeric_limits<size_t>::max() - _header)/sizeof(_Tp))
+                throw std::bad_array_new_length();
+            const char* label = (_label != nullptr) ? _label : _currentAllocationLabel();
+            auto& counters = allocation_profiler::instance().counters(label);
+
+            std::byte* block = static_cast<std::byte*>(::operator new(_header + n*sizeof(_Tp), std::align_val_t{_header}));
+            *reinterpret_cast<allocation_profiler::_Counters**>(block) = &counters;
+            allocation_profiler::recordAllocation(counters, n*sizeof(_Tp));
+            return reinterpret_cast<_Tp*>(block + _header);
         }
 
-    private:
-        template<typename _Tp1, typename _Tp2>
-        friend bool operator==(const debug_allocator<_Tp1>& lhs, const debug_allocator<_Tp2>& rhs) noexcept;
-    private:
-        allocator_base_type _base;
-        std::string _name;
+        void deallocate(_Tp* p, size_t n) noexcept
+        {
+            std::byte* block = reinterpret_cast<std::byte*>(p) - _header;
+            allocation_profiler::recordDeallocation(**reinterpret_cast<allocation_profiler::_Counters**>(block), n*sizeof(_Tp));
+            ::operator delete(block, std::align_val_t{_header});
+        }
+
+        //Label given at construction, nullptr if unlabelled
+        const char* label() const noexcept
+        {
+            return _label;
+        }
+        private:
+        //Header in front of every block; a multiple of the type's alignment
+        static constexpr size_t _header = std::max({alignof(_Tp), alignof(std::max_align_t), sizeof(void*)});
+
+        const char* _label;
     };
 
     template<typename _Tp1, typename _Tp2>
-    bool operator==(const debug_allocator<_Tp1>& lhs, const debug_allocator<_Tp2>& rhs) noexcept 
+    bool operator==(const debug_allocator<_Tp1>&, const debug_allocator<_Tp2>&) noexcept
+    {
+        return true;
+    }
+
+    template<typename _Tp1, typename _Tp2>
+    bool operator!=(const debug_allocator<_Tp1>&, const debug_allocator<_Tp2>&) noexcept
     {
-        return lhs._name == rhs._name;
+        return false;
     }
 } // namespace L
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,107 @@
+#ifndef EXECUTION_HH
+#define EXECUTION_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "config.hh"
+#include "Core/thread_pool.hh"
+
+namespace LIB_NAMESPACE_BASE
+{
+    //Execution policies accepted as the first argument of matrix kernels, in
+    //the style of the standard parallel algorithms
+    struct sequenced_policy
+    {
+
+    };
+
+    //Splits the kernel over the shared work-stealing thread pool
+    struct parallel_policy
+    {
+
+    };
+
+    inline constexpr sequenced_policy seq{};
+    inline constexpr parallel_policy par{};
+
+    namespace _detail
+    {
+        template<typename _Tp>
+        static constexpr bool _isExecutionPolicy = std::is_same_v<std::decay_t<_Tp>, sequenced_policy> ||
+            std::is_same_v<std::decay_t<_Tp>, parallel_policy>;
+
+        template<typename _Tp>
+        static constexpr bool _isParallelPolicy = std::is_same_v<std::decay_t<_Tp>, parallel_policy>;
+
+        //Split of [0, n) into chunks. The first chunk ends after head elements
+        //(or a full chunk if head is 0) and every later boundary is a multiple
+        //of quantum past it, so chunks can be made to start on cache lines or
+        //rows
+        struct _Partition
+        {
+            size_t n;
+            size_t head;
+            size_t chunk;
+
+            size_t count() const noexcept
+            {
+                if (n == 0)
+                    return 0;
+                if (head >= n)
+                    return 1;
+                return (head != 0) + (n - head + chunk - 1)/chunk;
+            }
+
+            size_t begin(size_t i) const noexcept
+            {
+                if (i == 0)
+                    return 0;
+                return std::min(n, head + (i - (head != 0))*chunk);
+            }
+
+            size_t end(size_t i) const noexcept
+            {
+                return begin(i + 1);
+            }
+        };
+
+        //Partitions n elements into chunks of at least grain elements that are
+        //whole multiples of quantum after the first head elements, with enough
+        //chunks to keep every thread of the pool busy
+        inline _Partition _partition(size_t n, size_t quantum, size_t head = 0, size_t grain = LIMNO_PARALLEL_GRAIN) noexcept
+        {
+            quantum = std::max<size_t>(quantum, 1);
+            head = std::min(head, n);
+            const size_t threads = _threadPool().size();
+            //Several chunks per thread so stealing can even out the load
+            size_t chunk = std::max(grain, (n + 4*threads - 1)/(4*threads));
+            chunk = (chunk + quantum - 1)/quantum*quantum;
+            return _Partition{n, head, chunk};
+        }
+
+        //Partitions the elements of a contiguous array so that no two chunks
+        //write to the same cache line
+        template<typename _Tp>
+        _Partition _linePartition(const _Tp* data, size_t n, size_t grain = LIMNO_PARALLEL_GRAIN) noexcept
+        {
+            constexpr size_t perLine = std::max<size_t>(1, LIMNO_CACHE_LINE/sizeof(_Tp));
+            const size_t misalignment = reinterpret_cast<std::uintptr_t>(data) % LIMNO_CACHE_LINE;
+            size_t head = 0;
+            if (misalignment != 0 && misalignment % sizeof(_Tp) == 0)
+                head = (LIMNO_CACHE_LINE - misalignment)/sizeof(_Tp);
+            return _partition(n, perLine, head, grain);
+        }
+
+        //Runs f(first, last) over every chunk of the partition on the pool
+        template<typename _FuncTp>
+        void _parallelChunks(const _Partition& partition, _FuncTp f)
+        {
+            _threadPool().parallelFor(partition.count(), [&](size_t i) { f(partition.begin(i), partition.end(i)); });
+        }
+    }
+}
+
+#endif
@@ -2,34 +2,273 @@
 #define EXPRESSION_TEMPLATES_HH 1
 
 
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <stdexcept>
 #include <tuple>
+#include <type_traits>
 
 #include "config.hh"
 #include "concepts.hh"
+#include "Core/shape.hh"
 
 
 
 namespace LIB_NAMESPACE_BASE:: _detail
 {
+    //Describes an operand of an element-wise expression. Anything that isn't
+    //specialized is treated as a scalar which is broadcast to every element.
+    //Matrix types specialize this in their own headers.
+    template<typename _Tp>
+    struct _OperandTraits
+    {
+        using value_type = _Tp;
+        static constexpr bool isMatrix = false;
+        static constexpr bool storedByValue = true;
+        static constexpr bool contiguous = true;
+        static constexpr int rows = DYNAMIC;
+        static constexpr int cols = DYNAMIC;
+
+        static constexpr const _Tp& at(const _Tp& s, size_t) noexcept
+        {
+            return s;
+        }
+
+        static constexpr const _Tp& at(const _Tp& s, size_t, size_t) noexcept
+        {
+            return s;
+        }
+    };
+
+    template<typename _Tp>
+    using _OperandValue_t = typename _OperandTraits<_Tp>::value_type;
+
+    //Matrices are held by reference; sub-expressions and scalars are cheap
+    //and usually temporaries, so they are held by value
+    template<typename _Tp>
+    using _StoredOperand_t = std::conditional_t<_OperandTraits<_Tp>::storedByValue, _Tp, const _Tp&>;
+
+    //Something that may appear on either side of an element-wise operator
+    template<typename _Tp>
+    static constexpr bool _isOperand = _OperandTraits<_Tp>::isMatrix || std::is_arithmetic_v<_Tp>;
+
+    //Operators are only provided if at least one side is a matrix
+    template<typename _LTp, typename _RTp>
+    static constexpr bool _isMatrixOperation = _isOperand<_LTp> && _isOperand<_RTp> &&
+        (_OperandTraits<_LTp>::isMatrix || _OperandTraits<_RTp>::isMatrix);
+
+    //First static extent among the matrix operands, DYNAMIC if there is none
+    template<typename... _ArgsTp>
+    constexpr int _commonRows() noexcept
+    {
+        int result = DYNAMIC;
+        ((result = (_OperandTraits<_ArgsTp>::isMatrix && result == DYNAMIC) ? _OperandTraits<_ArgsTp>::rows : result), ...);
+        return result;
+    }
+
+    template<typename... _ArgsTp>
+    constexpr int _commonCols() noexcept
+    {
+        int result = DYNAMIC;
+        ((result = (_OperandTraits<_ArgsTp>::isMatrix && result == DYNAMIC) ? _OperandTraits<_ArgsTp>::cols : result), ...);
+        return result;
+    }
 
+    //Element-wise expression node. Evaluating element (r, c) applies the
+    //callable to element (r, c) of every operand, so a whole tree is
+    //evaluated in one pass without intermediate matrices.
     #if __cplusplus > 201703L
-    template<typename _Callable, typename... _ArgsTp> requires Callable<_Callable, _ArgsTp...>
-    #else 
+    template<typename _Callable, typename... _ArgsTp> requires Callable<_Callable, _OperandValue_t<_ArgsTp>...>
+    #else
     template<typename _Callable, typename... _ArgsTp>
     #endif
-    class _Expr 
+    class _Expr
     {
         public:
+            using value_type = std::decay_t<std::invoke_result_t<const _Callable&, _OperandValue_t<_ArgsTp>...>>;
+            using size_type = size_t;
+
+            static constexpr int rows = _commonRows<_ArgsTp...>();
+            static constexpr int cols = _commonCols<_ArgsTp...>();
+            //True if every operand can be addressed by a flat row-major index
+            static constexpr bool contiguous = (... && _OperandTraits<_ArgsTp>::contiguous);
+
             _Expr(_Callable f, _ArgsTp const&... args)
-                : _args(args...), _f(f)
+                : _args(args...), _f(f), _numRows{0}, _numCols{0}
+            {
+                static_assert((... && (!_OperandTraits<_ArgsTp>::isMatrix ||
+                    (compatibleDim<_OperandTraits<_ArgsTp>::rows, rows> && compatibleDim<_OperandTraits<_ArgsTp>::cols, cols>))),
+                    "Matrix dimensions do not match!");
+                bool first = true;
+                (_mergeShape(args, first), ...);
+            }
+
+            constexpr size_type numRows() const noexcept
+            {
+                return _numRows;
+            }
+
+            constexpr size_type numCols() const noexcept
+            {
+                return _numCols;
+            }
+
+            constexpr size_type size() const noexcept
+            {
+                return _numRows*_numCols;
+            }
+
+            //Operands as stored in the node, used by kernels that evaluate
+            //specific expression shapes directly
+            const std::tuple<_StoredOperand_t<_ArgsTp>...>& _operands() const noexcept
+            {
+                return _args;
+            }
+
+            //Evaluates a single element of the expression
+            value_type operator()(size_type r, size_type c) const
+            {
+                return std::apply([&](const auto&... args) {
+                    return _f(_OperandTraits<std::decay_t<decltype(args)>>::at(args, r, c)...);
+                }, _args);
+            }
+
+            //Evaluates the element at flat row-major index i. Only valid if
+            //the expression is contiguous
+            value_type _at(size_type i) const
+            {
+                return std::apply([&](const auto&... args) {
+                    return _f(_OperandTraits<std::decay_t<decltype(args)>>::at(args, i)...);
+                }, _args);
+            }
+        private:
+            //If every operand's shape is known at compile-time no runtime checks are needed
+            static constexpr bool _staticShape = (... && (!_OperandTraits<_ArgsTp>::isMatrix || 
+                !runtimeDim<_OperandTraits<_ArgsTp>::rows, _OperandTraits<_ArgsTp>::cols>));
+
+            template<typename _Tp>
+            void _mergeShape(const _Tp& arg, bool& first)
             {
-                
+                using traits = _OperandTraits<_Tp>;
+                if constexpr(traits::isMatrix)
+                {
+                    if (first)
+                    {
+                        _numRows = arg.numRows();
+                        _numCols = arg.numCols();
+                        first = false;
+                    }
+                    else if constexpr(!_staticShape)
+                    {
+                        if (arg.numRows() != _numRows || arg.numCols() != _numCols)
+                            throw std::invalid_argument("Matrix dimensions do not match!");
+                    }
+                }
             }
         private:
-            std::tuple<_ArgsTp const&...> _args;
+            std::tuple<_StoredOperand_t<_ArgsTp>...> _args;
             _Callable _f;
+            size_type _numRows;
+            size_type _numCols;
     };
+
+    template<typename _Tp>
+    static constexpr bool _isExpr = false;
+
+    template<typename _Callable, typename... _ArgsTp>
+    constexpr bool _isExpr<_Expr<_Callable, _ArgsTp...>> = true;
+
+    template<typename _Callable, typename... _ArgsTp>
+    struct _OperandTraits<_Expr<_Callable, _ArgsTp...>>
+    {
+        using expr_type = _Expr<_Callable, _ArgsTp...>;
+        using value_type = typename expr_type::value_type;
+        static constexpr bool isMatrix = true;
+        static constexpr bool storedByValue = true;
+        static constexpr bool contiguous = expr_type::contiguous;
+        static constexpr int rows = expr_type::rows;
+        static constexpr int cols = expr_type::cols;
+
+        static value_type at(const expr_type& e, size_t i)
+        {
+            return e._at(i);
+        }
+
+        static value_type at(const expr_type& e, size_t r, size_t c)
+        {
+            return e(r, c);
+        }
+    };
+
+    //Operations applied per element and matrix operands read by an operand or
+    //expression tree, for the FLOP and byte counts of instrumented evaluations
+    template<typename _Tp>
+    struct _ExprCost
+    {
+        static constexpr size_t ops = 0;
+        static constexpr size_t matrices = _OperandTraits<_Tp>::isMatrix ? 1 : 0;
+    };
+
+    template<typename _Callable, typename... _ArgsTp>
+    struct _ExprCost<_Expr<_Callable, _ArgsTp...>>
+    {
+        static constexpr size_t ops = 1 + (0 + ... + _ExprCost<_ArgsTp>::ops);
+        static constexpr size_t matrices = (0 + ... + _ExprCost<_ArgsTp>::matrices);
+    };
+
+    //Element-wise operators. Matrix operands must have the same shape,
+    //scalar operands are applied to every element.
+    #if __cplusplus > 201703L
+    template<typename _LTp, typename _RTp> requires _isMatrixOperation<_LTp, _RTp>
+    #else
+    template<typename _LTp, typename _RTp, std::enable_if_t<_isMatrixOperation<_LTp, _RTp>, int> = 0>
+    #endif
+    _Expr<std::plus<>, _LTp, _RTp> operator+(const _LTp& lhs, const _RTp& rhs)
+    {
+        return _Expr<std::plus<>, _LTp, _RTp>{std::plus<>{}, lhs, rhs};
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _LTp, typename _RTp> requires _isMatrixOperation<_LTp, _RTp>
+    #else
+    template<typename _LTp, typename _RTp, std::enable_if_t<_isMatrixOperation<_LTp, _RTp>, int> = 0>
+    #endif
+    _Expr<std::minus<>, _LTp, _RTp> operator-(const _LTp& lhs, const _RTp& rhs)
+    {
+        return _Expr<std::minus<>, _LTp, _RTp>{std::minus<>{}, lhs, rhs};
+    }
+
+    //Element-wise (Hadamard) product
+    #if __cplusplus > 201703L
+    template<typename _LTp, typename _RTp> requires _isMatrixOperation<_LTp, _RTp>
+    #else
+    template<typename _LTp, typename _RTp, std::enable_if_t<_isMatrixOperation<_LTp, _RTp>, int> = 0>
+    #endif
+    _Expr<std::multiplies<>, _LTp, _RTp> operator*(const _LTp& lhs, const _RTp& rhs)
+    {
+        return _Expr<std::multiplies<>, _LTp, _RTp>{std::multiplies<>{}, lhs, rhs};
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _LTp, typename _RTp> requires _isMatrixOperation<_LTp, _RTp>
+    #else
+    template<typename _LTp, typename _RTp, std::enable_if_t<_isMatrixOperation<_LTp, _RTp>, int> = 0>
+    #endif
+    _Expr<std::divides<>, _LTp, _RTp> operator/(const _LTp& lhs, const _RTp& rhs)
+    {
+        return _Expr<std::divides<>, _LTp, _RTp>{std::divides<>{}, lhs, rhs};
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _Tp> requires _OperandTraits<_Tp>::isMatrix
+    #else
+    template<typename _Tp, std::enable_if_t<_OperandTraits<_Tp>::isMatrix, int> = 0>
+    #endif
+    _Expr<std::negate<>, _Tp> operator-(const _Tp& operand)
+    {
+        return _Expr<std::negate<>, _Tp>{std::negate<>{}, operand};
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
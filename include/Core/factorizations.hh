@@ -0,0 +1,668 @@
+#ifndef FACTORIZATIONS_HH
+#define FACTORIZATIONS_HH 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+#include "Core/execution.hh"
+#include "Core/instrumentation.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/matrix_view.hh"
+#include "Core/shape.hh"
+#include "Core/small_matrix.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Width of the panels of the blocked factorizations. A panel is factored
+    //with vector operations and everything to its right is updated with GEMM,
+    //which does nearly all of the work once n is a few times larger
+    static constexpr size_t _factorBlock = 64;
+
+    //The matrix a factorization works on. Views are rebound, matrices viewed
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    LimnoMatrixView<_Tp> _factorView(LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m) noexcept
+    {
+        return m.view();
+    }
+
+    template<typename _Tp>
+    LimnoMatrixView<_Tp> _factorView(const LimnoMatrixView<_Tp>& v) noexcept
+    {
+        static_assert(!std::is_const_v<_Tp>, "View must be mutable!");
+        return v;
+    }
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    LimnoMatrixView<const _Tp> _factorConstView(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m) noexcept
+    {
+        return m.view();
+    }
+
+    template<typename _Tp>
+    LimnoMatrixView<const std::remove_cv_t<_Tp>> _factorConstView(const LimnoMatrixView<_Tp>& v) noexcept
+    {
+        return v;
+    }
+
+    //Copy factored by the non-destructive variants; views are copied into a
+    //dynamic matrix
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> _factorCopy(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        return m;
+    }
+
+    template<typename _Tp>
+    LimnoMatrixBase<std::remove_cv_t<_Tp>, DYNAMIC, DYNAMIC> _factorCopy(const LimnoMatrixView<_Tp>& v)
+    {
+        return LimnoMatrixBase<std::remove_cv_t<_Tp>, DYNAMIC, DYNAMIC>(v);
+    }
+
+    //c += alpha*a*b, the update step of every blocked factorization. Under
+    //Limno::par the rows of c are split over the pool
+    template<typename _PolicyTp, typename _ATp, typename _BTp, typename _Tp>
+    void _gemmUpdate(_PolicyTp&& policy, _Tp alpha, const LimnoMatrixView<_ATp>& a, const LimnoMatrixView<_BTp>& b,
+        const LimnoMatrixView<_Tp>& c)
+    {
+        _gemm(policy, c.numRows(), c.numCols(), a.numCols(), alpha, static_cast<const _Tp*>(a.data()), a.rowStride(), a.colStride(),
+            static_cast<const _Tp*>(b.data()), b.rowStride(), b.colStride(), _Tp{1}, c.data(), c.rowStride(), c.colStride());
+    }
+
+    //Solves t*x = b in place of columns [first, last) of b for a small
+    //triangular t. Columns are taken _factorBlock at a time so the rows being
+    //combined stay in L1, even when b is a transposed view
+    template<typename _TTp, typename _Tp>
+    void _triangularSolveBlock(const LimnoMatrixView<_TTp>& t, bool lower, bool unitDiag,
+        const LimnoMatrixView<_Tp>& b, size_t first, size_t last) noexcept
+    {
+        using index = std::ptrdiff_t;
+        const size_t n = t.numRows();
+        const index cs = b.colStride();
+        for(size_t c0 = first; c0 < last; c0 += _factorBlock)
+        {
+            const size_t c1 = std::min(last, c0 + _factorBlock);
+            for(size_t s = 0; s < n; ++s)
+            {
+                const size_t i = lower ? s : n - 1 - s;
+                _Tp* bi = b.data() + static_cast<index>(i)*b.rowStride();
+                const size_t r0 = lower ? 0 : i + 1;
+                const size_t r1 = lower ? i : n;
+                for(size_t r = r0; r < r1; ++r)
+                {
+                    const _Tp f = t(i, r);
+                    if (f == _Tp{})
+                        continue;
+                    const _Tp* br = b.data() + static_cast<index>(r)*b.rowStride();
+                    for(size_t c = c0; c < c1; ++c)
+                        bi[static_cast<index>(c)*cs] -= f*br[static_cast<index>(c)*cs];
+                }
+                if (!unitDiag)
+                {
+                    const _Tp d = t(i, i);
+                    for(size_t c = c0; c < c1; ++c)
+                        bi[static_cast<index>(c)*cs] /= d;
+                }
+            }
+        }
+    }
+
+    //Solves t*x = b in place of b for a square triangular view t. Blocks off
+    //the diagonal are applied with GEMM and only the diagonal blocks are
+    //solved directly, split by columns of b under Limno::par. unitDiag
+    //treats the diagonal of t as ones without reading it
+    template<typename _PolicyTp, typename _TTp, typename _Tp>
+    void _triangularSolve(_PolicyTp&& policy, const LimnoMatrixView<_TTp>& t, bool lower, bool unitDiag,
+        const LimnoMatrixView<_Tp>& b)
+    {
+        const size_t n = t.numRows();
+        const size_t numCols = b.numCols();
+        LIMNO_INSTRUMENT_OPERATION("triangularSolve", static_cast<double>(n)*n*numCols, (n*n/2 + 2*n*numCols)*sizeof(_Tp));
+        for(size_t step = 0; step < n; step += _factorBlock)
+        {
+            //Top down for lower triangles, bottom up for upper ones
+            const size_t size = std::min(_factorBlock, n - step);
+            const size_t i0 = lower ? step : n - step - size;
+            const size_t i1 = i0 + size;
+            const LimnoMatrixView<_Tp> rows = b.block(i0, 0, size, numCols);
+            if (lower && i0 > 0)
+                _gemmUpdate(policy, _Tp{-1}, t.block(i0, 0, size, i0), b.block(0, 0, i0, numCols), rows);
+            if (!lower && i1 < n)
+                _gemmUpdate(policy, _Tp{-1}, t.block(i0, i1, size, n - i1), b.block(i1, 0, n - i1, numCols), rows);
+
+            const LimnoMatrixView<_TTp> diagonal = t.block(i0, i0, size, size);
+            if constexpr(_isParallelPolicy<_PolicyTp>)
+            {
+                const _Partition chunks = _partition(numCols, _factorBlock, 0,
+                    std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/(size*size)));
+                _parallelChunks(chunks, [&](size_t first, size_t last)
+                {
+                    _triangularSolveBlock(diagonal, lower, unitDiag, rows, first, last);
+                });
+            }
+            else
+                _triangularSolveBlock(diagonal, lower, unitDiag, rows, 0, numCols);
+        }
+    }
+
+    //Unblocked LU of columns [k0, k0 + kb) from row k0 down. Pivot rows are
+    //swapped across the whole matrix, which is cheap for row-major storage and
+    //leaves nothing to apply later
+    template<typename _Tp>
+    void _luPanel(const LimnoMatrixView<_Tp>& a, size_t k0, size_t kb, size_t* pivots)
+    {
+        using std::abs;
+        const size_t n = a.numRows();
+        const size_t k1 = k0 + kb;
+        for(size_t j = k0; j < k1; ++j)
+        {
+            size_t p = j;
+            for(size_t i = j + 1; i < n; ++i)
+            {
+                if (abs(a(i, j)) > abs(a(p, j)))
+                    p = i;
+            }
+            pivots[j] = p;
+            if (a(p, j) == _Tp{})
+                throw std::invalid_argument("Matrix is singular!");
+            if (p != j)
+            {
+                for(size_t c = 0; c < a.numCols(); ++c)
+                    std::swap(a(j, c), a(p, c));
+            }
+
+            const _Tp inverse = _Tp{1}/a(j, j);
+            for(size_t i = j + 1; i < n; ++i)
+            {
+                const _Tp l = (a(i, j) *= inverse);
+                for(size_t c = j + 1; c < k1; ++c)
+                    a(i, c) -= l*a(j, c);
+            }
+        }
+    }
+
+    //Right-looking blocked LU: factor a panel, solve for the block row of U
+    //to its right, then update the trailing matrix with one GEMM
+    template<typename _PolicyTp, typename _Tp>
+    void _luFactor(_PolicyTp&& policy, const LimnoMatrixView<_Tp>& a, size_t* pivots)
+    {
+        const size_t n = a.numRows();
+        LIMNO_INSTRUMENT_OPERATION("lu", 2.0/3.0*n*n*n, 2*n*n*sizeof(_Tp));
+        for(size_t k0 = 0; k0 < n; k0 += _factorBlock)
+        {
+            const size_t kb = std::min(_factorBlock, n - k0);
+            const size_t k1 = k0 + kb;
+            _luPanel(a, k0, kb, pivots);
+            if (k1 < n)
+            {
+                //U12 = L11^-1 A12, A22 -= L21 U12
+                const LimnoMatrixView<_Tp> u12 = a.block(k0, k1, kb, n - k1);
+                _triangularSolve(policy, a.block(k0, k0, kb, kb), true, true, u12);
+                _gemmUpdate(policy, _Tp{-1}, a.block(k1, k0, n - k1, kb), u12, a.block(k1, k1, n - k1, n - k1));
+            }
+        }
+    }
+
+    //Unblocked Cholesky of a diagonal block, reading only its lower triangle
+    template<typename _Tp>
+    void _choleskyBlock(const LimnoMatrixView<_Tp>& a)
+    {
+        const size_t n = a.numRows();
+        for(size_t j = 0; j < n; ++j)
+        {
+            //Also rejects NaN
+            if (!(a(j, j) > _Tp{}))
+                throw std::invalid_argument("Matrix is not positive definite!");
+            const _Tp d = std::sqrt(a(j, j));
+            a(j, j) = d;
+            for(size_t i = j + 1; i < n; ++i)
+                a(i, j) /= d;
+            for(size_t i = j + 1; i < n; ++i)
+            {
+                const _Tp l = a(i, j);
+                for(size_t c = j + 1; c <= i; ++c)
+                    a(i, c) -= l*a(c, j);
+            }
+        }
+    }
+
+    //Right-looking blocked Cholesky. The trailing update only needs the lower
+    //triangle, so it is one GEMM per block column below the diagonal
+    template<typename _PolicyTp, typename _Tp>
+    void _choleskyFactor(_PolicyTp&& policy, const LimnoMatrixView<_Tp>& a)
+    {
+        const size_t n = a.numRows();
+        LIMNO_INSTRUMENT_OPERATION("cholesky", 1.0/3.0*n*n*n, n*n*sizeof(_Tp));
+        for(size_t k0 = 0; k0 < n; k0 += _factorBlock)
+        {
+            const size_t kb = std::min(_factorBlock, n - k0);
+            const size_t k1 = k0 + kb;
+            _choleskyBlock(a.block(k0, k0, kb, kb));
+            if (k1 < n)
+            {
+                //L21 = A21 L11^-T, i.e. L11 L21^T = A21^T
+                _triangularSolve(policy, a.block(k0, k0, kb, kb), true, false, a.block(k1, k0, n - k1, kb).transpose());
+                for(size_t j0 = k1; j0 < n; j0 += _factorBlock)
+                {
+                    const size_t jb = std::min(_factorBlock, n - j0);
+                    _gemmUpdate(policy, _Tp{-1}, a.block(j0, k0, n - j0, kb), a.block(j0, k0, jb, kb).transpose(),
+                        a.block(j0, j0, n - j0, jb));
+                }
+            }
+        }
+        for(size_t i = 0; i < n; ++i)
+            for(size_t c = i + 1; c < n; ++c)
+                a(i, c) = _Tp{};
+    }
+
+    //Unblocked Householder QR of a panel. Column j becomes beta e_j, with the
+    //reflector v (v_j = 1 implied) stored below the diagonal, so that
+    //(I - tau v v^T) x = beta e_j as in LAPACK's geqr2
+    template<typename _Tp>
+    void _qrPanel(const LimnoMatrixView<_Tp>& p, _Tp* tau)
+    {
+        const size_t m = p.numRows();
+        const size_t kb = std::min(m, p.numCols());
+        std::vector<_Tp> w(p.numCols());
+        for(size_t j = 0; j < kb; ++j)
+        {
+            const _Tp alpha = p(j, j);
+            _Tp sumSquares{};
+            for(size_t i = j + 1; i < m; ++i)
+                sumSquares += p(i, j)*p(i, j);
+            if (sumSquares == _Tp{})
+            {
+                tau[j] = _Tp{};
+                continue;
+            }
+            const _Tp beta = -std::copysign(std::hypot(alpha, std::sqrt(sumSquares)), alpha);
+            tau[j] = (beta - alpha)/beta;
+            const _Tp scale = _Tp{1}/(alpha - beta);
+            for(size_t i = j + 1; i < m; ++i)
+                p(i, j) *= scale;
+            p(j, j) = beta;
+
+            //Apply the reflector to the rest of the panel: w = v^T P, P -= tau v w
+            for(size_t c = j + 1; c < p.numCols(); ++c)
+                w[c] = p(j, c);
+            for(size_t i = j + 1; i < m; ++i)
+            {
+                const _Tp v = p(i, j);
+                for(size_t c = j + 1; c < p.numCols(); ++c)
+                    w[c] += v*p(i, c);
+            }
+            for(size_t c = j + 1; c < p.numCols(); ++c)
+                p(j, c) -= tau[j]*w[c];
+            for(size_t i = j + 1; i < m; ++i)
+            {
+                const _Tp v = tau[j]*p(i, j);
+                for(size_t c = j + 1; c < p.numCols(); ++c)
+                    p(i, c) -= v*w[c];
+            }
+        }
+    }
+
+    //Applies Q^T = (H_1 ... H_kb)^T to c, where the reflectors are stored in
+    //panel as by _qrPanel. Uses the compact WY form Q = I - V T V^T, so all
+    //but O(kb^2) of the work is two GEMMs
+    template<typename _PolicyTp, typename _PTp, typename _Tp>
+    void _applyBlockReflector(_PolicyTp&& policy, const LimnoMatrixView<_PTp>& panel, const _Tp* tau,
+        const LimnoMatrixView<_Tp>& c)
+    {
+        const size_t m = panel.numRows();
+        const size_t kb = std::min(m, panel.numCols());
+        const size_t n = c.numCols();
+        if (kb == 0 || n == 0)
+            return;
+
+        //V as an explicit unit lower trapezoidal matrix
+        std::vector<_Tp> vStorage(m*kb);
+        const LimnoMatrixView<_Tp> v{vStorage.data(), m, kb};
+        for(size_t i = 0; i < m; ++i)
+            for(size_t j = 0; j < std::min(i, kb); ++j)
+                v(i, j) = panel(i, j);
+        for(size_t j = 0; j < kb; ++j)
+            v(j, j) = _Tp{1};
+
+        //T is upper triangular with T(0:j, j) = -tau_j T(0:j, 0:j) V(:, 0:j)^T v_j,
+        //as in LAPACK's larft
+        std::vector<_Tp> tStorage(kb*kb), z(kb);
+        const LimnoMatrixView<_Tp> t{tStorage.data(), kb, kb};
+        for(size_t j = 0; j < kb; ++j)
+        {
+            std::fill(z.begin(), z.begin() + static_cast<std::ptrdiff_t>(j), _Tp{});
+            for(size_t i = j; i < m; ++i)
+            {
+                const _Tp vij = v(i, j);
+                for(size_t r = 0; r < j; ++r)
+                    z[r] += v(i, r)*vij;
+            }
+            for(size_t r = 0; r < j; ++r)
+            {
+                _Tp sum{};
+                for(size_t s = r; s < j; ++s)
+                    sum += t(r, s)*z[s];
+                t(r, j) = -tau[j]*sum;
+            }
+            t(j, j) = tau[j];
+        }
+
+        //W = T^T V^T C, then C -= V W. Rows of T^T W are built bottom up so
+        //each only reads rows not yet overwritten
+        std::vector<_Tp> wStorage(kb*n);
+        const LimnoMatrixView<_Tp> w{wStorage.data(), kb, n};
+        _gemmUpdate(policy, _Tp{1}, v.transpose(), c, w);
+        for(size_t i = kb; i-- > 0;)
+        {
+            for(size_t col = 0; col < n; ++col)
+                w(i, col) *= t(i, i);
+            for(size_t r = 0; r < i; ++r)
+            {
+                const _Tp f = t(r, i);
+                for(size_t col = 0; col < n; ++col)
+                    w(i, col) += f*w(r, col);
+            }
+        }
+        _gemmUpdate(policy, _Tp{-1}, LimnoMatrixView<const _Tp>(v), LimnoMatrixView<const _Tp>(w), c);
+    }
+
+    //Blocked Householder QR: factor a panel, then apply its block reflector to
+    //everything to the right
+    template<typename _PolicyTp, typename _Tp>
+    void _qrFactor(_PolicyTp&& policy, const LimnoMatrixView<_Tp>& a, _Tp* tau)
+    {
+        const size_t m = a.numRows();
+        const size_t n = a.numCols();
+        const size_t k = std::min(m, n);
+        LIMNO_INSTRUMENT_OPERATION("qr", 2.0*m*n*k - static_cast<double>(m + n)*k*k + 2.0/3.0*k*k*k, 2*m*n*sizeof(_Tp));
+        for(size_t k0 = 0; k0 < k; k0 += _factorBlock)
+        {
+            const size_t kb = std::min(_factorBlock, k - k0);
+            const size_t k1 = k0 + kb;
+            const LimnoMatrixView<_Tp> panel = a.block(k0, k0, m - k0, kb);
+            _qrPanel(panel, tau + k0);
+            if (k1 < n)
+                _applyBlockReflector(policy, panel, tau + k0, a.block(k0, k1, m - k0, n - k1));
+        }
+    }
+
+    //LU factorization with partial pivoting, P*m = L*U, in place. The strict
+    //lower triangle of m is replaced by L, whose unit diagonal is implied, and
+    //the upper triangle by U. Returns the pivots: row i was swapped with row
+    //pivots[i], for i in increasing order. Throws std::invalid_argument if m
+    //is singular, leaving it partially factored. Under Limno::par the
+    //triangular solves and trailing updates run on the thread pool
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    std::vector<size_t> luInPlace(_PolicyTp&& policy, _MatTp&& m)
+    {
+        const auto a = _factorView(m);
+        using value_type = typename decltype(a)::value_type;
+        static_assert(std::is_floating_point_v<value_type>, "LU requires a floating point type!");
+        if (a.numRows() != a.numCols())
+            throw std::invalid_argument("Matrix must be square!");
+        std::vector<size_t> pivots(a.numRows());
+        _luFactor(policy, a, pivots.data());
+        return pivots;
+    }
+
+    template<typename _MatTp>
+    std::vector<size_t> luInPlace(_MatTp&& m)
+    {
+        return luInPlace(Limno::seq, m);
+    }
+
+    //Cholesky factorization m = L*L^T of a symmetric positive definite
+    //matrix, in place. Only the lower triangle of m is read; m is replaced
+    //by L with its strict upper triangle zeroed. Throws std::invalid_argument
+    //if m is not positive definite
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    void choleskyInPlace(_PolicyTp&& policy, _MatTp&& m)
+    {
+        const auto a = _factorView(m);
+        using value_type = typename decltype(a)::value_type;
+        static_assert(std::is_floating_point_v<value_type>, "Cholesky requires a floating point type!");
+        if (a.numRows() != a.numCols())
+            throw std::invalid_argument("Matrix must be square!");
+        _choleskyFactor(policy, a);
+    }
+
+    template<typename _MatTp>
+    void choleskyInPlace(_MatTp&& m)
+    {
+        choleskyInPlace(Limno::seq, m);
+    }
+
+    //Householder QR factorization m = Q*R of an r x c matrix, in place, in
+    //LAPACK's geqrf layout: R is the upper triangle of m and the Householder
+    //vectors of Q are below the diagonal. Returns their min(r, c) scale factors
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto qrInPlace(_PolicyTp&& policy, _MatTp&& m)
+    {
+        const auto a = _factorView(m);
+        using value_type = typename decltype(a)::value_type;
+        static_assert(std::is_floating_point_v<value_type>, "QR requires a floating point type!");
+        std::vector<value_type> tau(std::min(a.numRows(), a.numCols()));
+        _qrFactor(policy, a, tau.data());
+        return tau;
+    }
+
+    template<typename _MatTp>
+    auto qrInPlace(_MatTp&& m)
+    {
+        return qrInPlace(Limno::seq, m);
+    }
+
+    //Copying variants, returning the factors alongside the pivots or scale
+    //factors
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto lu(_PolicyTp&& policy, const _MatTp& m)
+    {
+        auto factors = _factorCopy(m);
+        std::vector<size_t> pivots = luInPlace(policy, factors);
+        return std::make_pair(std::move(factors), std::move(pivots));
+    }
+
+    template<typename _MatTp>
+    auto lu(const _MatTp& m)
+    {
+        return lu(Limno::seq, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto cholesky(_PolicyTp&& policy, const _MatTp& m)
+    {
+        auto factor = _factorCopy(m);
+        choleskyInPlace(policy, factor);
+        return factor;
+    }
+
+    template<typename _MatTp>
+    auto cholesky(const _MatTp& m)
+    {
+        return cholesky(Limno::seq, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto qr(_PolicyTp&& policy, const _MatTp& m)
+    {
+        auto factors = _factorCopy(m);
+        auto tau = qrInPlace(policy, factors);
+        return std::make_pair(std::move(factors), std::move(tau));
+    }
+
+    template<typename _MatTp>
+    auto qr(const _MatTp& m)
+    {
+        return qr(Limno::seq, m);
+    }
+
+    //Solves a*x = b in place of b, one right-hand side per column, from the
+    //result of luInPlace
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _LuTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _LuTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    void luSolveInPlace(_PolicyTp&& policy, const _LuTp& lu, const std::vector<size_t>& pivots, _MatTp&& b)
+    {
+        const auto factors = _factorConstView(lu);
+        const auto x = _factorView(b);
+        if (factors.numRows() != factors.numCols() || pivots.size() != factors.numRows() || x.numRows() != factors.numRows())
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        for(size_t i = 0; i < pivots.size(); ++i)
+        {
+            if (pivots[i] != i)
+            {
+                for(size_t c = 0; c < x.numCols(); ++c)
+                    std::swap(x(i, c), x(pivots[i], c));
+            }
+        }
+        _triangularSolve(policy, factors, true, true, x);
+        _triangularSolve(policy, factors, false, false, x);
+    }
+
+    template<typename _LuTp, typename _MatTp>
+    void luSolveInPlace(const _LuTp& lu, const std::vector<size_t>& pivots, _MatTp&& b)
+    {
+        luSolveInPlace(Limno::seq, lu, pivots, b);
+    }
+
+    //Solves a*x = b in place of b from the result of choleskyInPlace
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _LTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _LTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    void choleskySolveInPlace(_PolicyTp&& policy, const _LTp& l, _MatTp&& b)
+    {
+        const auto factor = _factorConstView(l);
+        const auto x = _factorView(b);
+        if (factor.numRows() != factor.numCols() || x.numRows() != factor.numRows())
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        _triangularSolve(policy, factor, true, false, x);
+        _triangularSolve(policy, factor.transpose(), false, false, x);
+    }
+
+    template<typename _LTp, typename _MatTp>
+    void choleskySolveInPlace(const _LTp& l, _MatTp&& b)
+    {
+        choleskySolveInPlace(Limno::seq, l, b);
+    }
+
+    //Least squares solution of a*x = b from the result of qrInPlace on an
+    //r x c matrix a with r >= c: applies Q^T to a copy of b and solves with
+    //R. Throws std::invalid_argument if a does not have full column rank
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _QrTp, typename _MatTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _QrTp, typename _MatTp, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto qrSolve(_PolicyTp&& policy, const _QrTp& qr, const std::vector<_OperandValue_t<_QrTp>>& tau, const _MatTp& b)
+    {
+        using value_type = _OperandValue_t<_QrTp>;
+        const LimnoMatrixView<const value_type> factors = _factorConstView(qr);
+        const size_t m = factors.numRows();
+        const size_t n = factors.numCols();
+        if (m < n || tau.size() != n || b.numRows() != m)
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        for(size_t i = 0; i < n; ++i)
+        {
+            if (factors(i, i) == value_type{})
+                throw std::invalid_argument("Matrix is singular!");
+        }
+
+        LimnoMatrixBase<value_type, DYNAMIC, DYNAMIC> y(_factorConstView(b));
+        for(size_t k0 = 0; k0 < n; k0 += _factorBlock)
+        {
+            const size_t kb = std::min(_factorBlock, n - k0);
+            _applyBlockReflector(policy, factors.block(k0, k0, m - k0, kb), tau.data() + k0,
+                y.view().block(k0, 0, m - k0, y.numCols()));
+        }
+        LimnoMatrixBase<value_type, DYNAMIC, DYNAMIC> x(y.view().block(0, 0, n, y.numCols()));
+        _triangularSolve(policy, factors.block(0, 0, n, n), false, false, x.view());
+        return x;
+    }
+
+    template<typename _QrTp, typename _MatTp>
+    auto qrSolve(const _QrTp& qr, const std::vector<_OperandValue_t<_QrTp>>& tau, const _MatTp& b)
+    {
+        return qrSolve(Limno::seq, qr, tau, b);
+    }
+
+    //Solves a*x = b for matrices too large for the unrolled kernel, by LU
+    //with partial pivoting on a copy of a. Throws std::invalid_argument if a
+    //is singular
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _N1, int _N2, int _M, int _K, typename _AllocTp1, typename _AllocTp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _N1, int _N2, int _M, int _K, typename _AllocTp1, typename _AllocTp2,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<_Tp, _M, _K, _AllocTp2> solve(_PolicyTp&& policy, const LimnoMatrixBase<_Tp, _N1, _N2, _AllocTp1>& a,
+        const LimnoMatrixBase<_Tp, _M, _K, _AllocTp2>& b)
+    {
+        static_assert(compatibleDim<_N1, _N2>, "Solve requires a square matrix!");
+        static_assert(compatibleDim<_N2, _M>, "Matrix dimensions do not match!");
+        static_assert(std::is_floating_point_v<_Tp>, "Solve requires a floating point type!");
+        LimnoMatrixBase<_Tp, _N1, _N2, _AllocTp1> factors = a;
+        const std::vector<size_t> pivots = luInPlace(policy, factors);
+        LimnoMatrixBase<_Tp, _M, _K, _AllocTp2> x = b;
+        luSolveInPlace(policy, factors, pivots, x);
+        return x;
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _Tp, int _N1, int _N2, int _M, int _K, typename _AllocTp1, typename _AllocTp2>
+        requires (!(_smallDim<_N1, _N2> && _smallDim<_M, _K>))
+    #else
+    template<typename _Tp, int _N1, int _N2, int _M, int _K, typename _AllocTp1, typename _AllocTp2,
+        std::enable_if_t<!(_smallDim<_N1, _N2> && _smallDim<_M, _K>), int> = 0>
+    #endif
+    LimnoMatrixBase<_Tp, _M, _K, _AllocTp2> solve(const LimnoMatrixBase<_Tp, _N1, _N2, _AllocTp1>& a,
+        const LimnoMatrixBase<_Tp, _M, _K, _AllocTp2>& b)
+    {
+        return solve(Limno::seq, a, b);
+    }
+}
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef INSTRUMENTATION_HH
+#define INSTRUMENTATION_HH 1
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+
+#if LIMNO_INSTRUMENT && LIMNO_INSTRUMENT_ITT
+    #include <ittnotify.h>
+#endif
+
+//Records one call of the enclosing kernel under name, with the FLOPs and
+//bytes it moves, from here to the end of the scope. Expands to nothing, and
+//evaluates none of its arguments, unless LIMNO_INSTRUMENT is set
+#if LIMNO_INSTRUMENT
+    #define LIMNO_INSTRUMENT_OPERATION(name, flops, bytes) \
+        const ::LIB_NAMESPACE_BASE::_detail::operation_scope _limnoOperationScope{(name), \
+            static_cast<double>(flops), static_cast<double>(bytes)}
+#else
+    #define LIMNO_INSTRUMENT_OPERATION(name, flops, bytes) static_cast<void>(0)
+#endif
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Operations are binned by the bytes they move, which says more about
+    //where they sit on the roofline than their dimensions do: small ones fit
+    //in L1 and are dominated by call overhead, medium ones in the outer
+    //caches, and large ones stream from memory
+    enum class shape_class
+    {
+        small,
+        medium,
+        large
+    };
+
+    static constexpr size_t _shapeClasses = 3;
+
+    inline shape_class _shapeClass(double bytes) noexcept
+    {
+        if (bytes <= LIMNO_INSTRUMENT_SMALL_BYTES)
+            return shape_class::small;
+        if (bytes <= LIMNO_INSTRUMENT_LARGE_BYTES)
+            return shape_class::medium;
+        return shape_class::large;
+    }
+
+    inline const char* _shapeClassName(shape_class shape) noexcept
+    {
+        switch(shape)
+        {
+            case shape_class::small:
+                return "small";
+            case shape_class::medium:
+                return "medium";
+            default:
+                return "large";
+        }
+    }
+
+    //Totals for one operation and shape class, summed over every thread
+    struct operation_stats
+    {
+        std::uint64_t calls = 0;
+        std::uint64_t nanoseconds = 0;
+        double flops = 0;
+        double bytes = 0;
+
+        double seconds() const noexcept
+        {
+            return static_cast<double>(nanoseconds)*1e-9;
+        }
+
+        double gflopsPerSecond() const noexcept
+        {
+            return (nanoseconds == 0) ? 0.0 : flops/static_cast<double>(nanoseconds);
+        }
+
+        double gbytesPerSecond() const noexcept
+        {
+            return (nanoseconds == 0) ? 0.0 : bytes/static_cast<double>(nanoseconds);
+        }
+
+        //FLOPs per byte; compared with the machine balance it tells whether
+        //the operation is bound by bandwidth or by compute
+        double intensity() const noexcept
+        {
+            return (bytes == 0) ? 0.0 : flops/bytes;
+        }
+    };
+
+    //Hooks called on entry to and exit from every instrumented operation, to
+    //drive an external profiler's markers (perf, NVTX, a tracing library).
+    //They must not throw
+    struct instrumentation_markers
+    {
+        void (*begin)(const char* operation) = nullptr;
+        void (*end)(const char* operation) = nullptr;
+    };
+
+    //Collects the operations recorded by LIMNO_INSTRUMENT_OPERATION. Like
+    //allocation_profiler, counters are kept per thread and operation and
+    //updated with relaxed atomics, so recording takes no locks; the registry
+    //mutex is only taken the first time a thread sees an operation and when
+    //building a report. Times of nested operations are inclusive, e.g. an
+    //LU factorization includes the GEMMs it runs
+    class operation_profiler
+    {
+        public:
+        struct _Slot
+        {
+            std::atomic<std::uint64_t> calls{0};
+            std::atomic<std::uint64_t> nanoseconds{0};
+            std::atomic<double> flops{0};
+            std::atomic<double> bytes{0};
+        };
+
+        //Counters of one thread for one operation
+        struct _Counters
+        {
+            const std::string* name;
+            std::array<_Slot, _shapeClasses> slots;
+            #if LIMNO_INSTRUMENT && LIMNO_INSTRUMENT_ITT
+            __itt_string_handle* task;
+            #endif
+        };
+
+        //Never destroyed so operations run during static destruction can
+        //still be recorded
+        static operation_profiler& instance()
+        {
+            static operation_profiler* profiler = new operation_profiler{};
+            return *profiler;
+        }
+
+        //Counters of the calling thread for operation
+        _Counters& counters(const char* operation)
+        {
+            thread_local std::unordered_map<const char*, _Counters*> cache;
+            auto it = cache.find(operation);
+            if (it != cache.end())
+                return *it->second;
+
+            std::lock_guard<std::mutex> lock{_mutex};
+            const auto name = _names.emplace(operation).first;
+            _counters.push_back(std::make_unique<_Counters>());
+            _counters.back()->name = &*name;
+            #if LIMNO_INSTRUMENT && LIMNO_INSTRUMENT_ITT
+            _counters.back()->task = __itt_string_handle_create(operation);
+            #endif
+            cache.emplace(operation, _counters.back().get());
+            return *_counters.back();
+        }
+
+        static void record(_Counters& counters, std::uint64_t nanoseconds, double flops, double bytes) noexcept
+        {
+            _Slot& slot = counters.slots[static_cast<size_t>(_shapeClass(bytes))];
+            slot.calls.fetch_add(1, std::memory_order_relaxed);
+            slot.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+            _add(slot.flops, flops);
+            _add(slot.bytes, bytes);
+        }
+
+        //Totals per operation and shape class; classes with no calls are left
+        //out. Counters may still be moving while this runs
+        std::map<std::pair<std::string, shape_class>, operation_stats> snapshot() const
+        {
+            std::map<std::pair<std::string, shape_class>, operation_stats> result;
+            std::lock_guard<std::mutex> lock{_mutex};
+            for(const auto& counters : _counters)
+                for(size_t s = 0; s < _shapeClasses; ++s)
+                {
+                    const _Slot& slot = counters->slots[s];
+                    const std::uint64_t calls = slot.calls.load(std::memory_order_relaxed);
+                    if (calls == 0)
+                        continue;
+                    operation_stats& stats = result[{*counters->name, static_cast<shape_class>(s)}];
+                    stats.calls += calls;
+                    stats.nanoseconds += slot.nanoseconds.load(std::memory_order_relaxed);
+                    stats.flops += slot.flops.load(std::memory_order_relaxed);
+                    stats.bytes += slot.bytes.load(std::memory_order_relaxed);
+                }
+            return result;
+        }
+
+        //Totals for one operation over every shape class
+        operation_stats stats(const std::string& operation) const
+        {
+            operation_stats result;
+            for(const auto& [key, stats] : snapshot())
+            {
+                if (key.first != operation)
+                    continue;
+                result.calls += stats.calls;
+                result.nanoseconds += stats.nanoseconds;
+                result.flops += stats.flops;
+                result.bytes += stats.bytes;
+            }
+            return result;
+        }
+
+        //Zeros every counter. Calls still running are counted after the reset
+        void reset() noexcept
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            for(const auto& counters : _counters)
+                for(_Slot& slot : counters->slots)
+                {
+                    slot.calls.store(0, std::memory_order_relaxed);
+                    slot.nanoseconds.store(0, std::memory_order_relaxed);
+                    slot.flops.store(0, std::memory_order_relaxed);
+                    slot.bytes.store(0, std::memory_order_relaxed);
+                }
+        }
+
+        //Writes one line per operation and shape class, the most time
+        //consuming first
+        void report(std::ostream& os) const
+        {
+            os << std::left << std::setw(24) << "operation" << std::setw(8) << "shape" << std::right
+                << std::setw(12) << "calls" << std::setw(14) << "time (ms)" << std::setw(12) << "GFLOP/s"
+                << std::setw(12) << "GB/s" << std::setw(12) << "FLOP/byte" << '\n';
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+            os << std::fixed << std::setprecision(3);
+            for(const auto& [key, stats] : _byTime())
+            {
+                os << std::left << std::setw(24) << key.first << std::setw(8) << _shapeClassName(key.second) << std::right
+                    << std::setw(12) << stats.calls << std::setw(14) << stats.seconds()*1e3
+                    << std::setw(12) << stats.gflopsPerSecond() << std::setw(12) << stats.gbytesPerSecond()
+                    << std::setw(12) << stats.intensity() << '\n';
+            }
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+        //Same as report as a JSON array of objects. Operation names are
+        //identifiers and need no escaping
+        void reportJson(std::ostream& os) const
+        {
+            const auto precision = os.precision();
+            os << std::setprecision(17) << '[';
+            bool first = true;
+            for(const auto& [key, stats] : _byTime())
+            {
+                os << (first ? "" : ",") << "\n  {\"operation\": \"" << key.first << "\", \"shape\": \""
+                    << _shapeClassName(key.second) << "\", \"calls\": " << stats.calls
+                    << ", \"nanoseconds\": " << stats.nanoseconds << ", \"flops\": " << stats.flops
+                    << ", \"bytes\": " << stats.bytes << '}';
+                first = false;
+            }
+            os << (first ? "]" : "\n]") << '\n';
+            os.precision(precision);
+        }
+
+        void setMarkers(instrumentation_markers markers) noexcept
+        {
+            _begin.store(markers.begin, std::memory_order_relaxed);
+            _end.store(markers.end, std::memory_order_relaxed);
+        }
+
+        void markBegin([[maybe_unused]] const _Counters& counters) const noexcept
+        {
+            #if LIMNO_INSTRUMENT && LIMNO_INSTRUMENT_ITT
+            __itt_task_begin(_domain, __itt_null, __itt_null, counters.task);
+            #endif
+            if (auto begin = _begin.load(std::memory_order_relaxed))
+                begin(counters.name->c_str());
+        }
+
+        void markEnd([[maybe_unused]] const _Counters& counters) const noexcept
+        {
+            if (auto end = _end.load(std::memory_order_relaxed))
+                end(counters.name->c_str());
+            #if LIMNO_INSTRUMENT && LIMNO_INSTRUMENT_ITT
+            __itt_task_end(_domain);
+            #endif
+        }
+
+        private:
+        operation_profiler() = default;
+
+        //Atomic add for doubles, which have no fetch_add before C++20. A reset
+        //from another thread may race with the owning thread's update, so a
+        //plain load and store could undo it
+        static void _add(std::atomic<double>& counter, double value) noexcept
+        {
+            double expected = counter.load(std::memory_order_relaxed);
+            while (!counter.compare_exchange_weak(expected, expected + value, std::memory_order_relaxed))
+                ;
+        }
+
+        std::vector<std::pair<std::pair<std::string, shape_class>, operation_stats>> _byTime() const
+        {
+            const auto all = snapshot();
+            std::vector<std::pair<std::pair<std::string, shape_class>, operation_stats>> result(all.begin(), all.end());
+            std::stable_sort(result.begin(), result.end(), [](const auto& a, const auto& b)
+                { return a.second.nanoseconds > b.second.nanoseconds; });
+            return result;
+        }
+
+        mutable std::mutex _mutex;
+        //Names of the operations seen so far; node based, so they never move
+        std::set<std::string> _names;
+        std::vector<std::unique_ptr<_Counters>> _counters;
+        std::atomic<void (*)(const char*)> _begin{nullptr};
+        std::atomic<void (*)(const char*)> _end{nullptr};
+        #if LIMNO_INSTRUMENT && LIMNO_INSTRUMENT_ITT
+        __itt_domain* _domain = __itt_domain_create("Limno");
+        #endif
+    };
+
+    //Times the enclosing scope and records it with operation_profiler. Used
+    //through LIMNO_INSTRUMENT_OPERATION. Names must be string literals or
+    //otherwise outlive the program. Never throws, so instrumented kernels can
+    //stay noexcept: if the counters can't be allocated the call goes
+    //unrecorded
+    class operation_scope
+    {
+        public:
+        operation_scope(const char* operation, double flops, double bytes) noexcept
+            : _counters{_find(operation)}, _flops{flops}, _bytes{bytes}
+        {
+            if (_counters)
+                operation_profiler::instance().markBegin(*_counters);
+            _start = std::chrono::steady_clock::now();
+        }
+
+        operation_scope(const operation_scope&) = delete;
+        operation_scope& operator=(const operation_scope&) = delete;
+
+        ~operation_scope()
+        {
+            if (!_counters)
+                return;
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+            operation_profiler::instance().markEnd(*_counters);
+            operation_profiler::record(*_counters, static_cast<std::uint64_t>(elapsed.count()), _flops, _bytes);
+        }
+
+        private:
+        static operation_profiler::_Counters* _find(const char* operation) noexcept
+        {
+            try
+            {
+                return &operation_profiler::instance().counters(operation);
+            }
+            catch(...)
+            {
+                return nullptr;
+            }
+        }
+
+        operation_profiler::_Counters* _counters;
+        double _flops;
+        double _bytes;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+#endif
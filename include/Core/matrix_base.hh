@@ -1,33 +1,42 @@
 #ifndef ARRAY_BASE_HH
 #define ARRAY_BASE_HH
 
+#include <algorithm>
 #include <array>
 #include <concepts>
+#include <cstring>
+#include <functional>
 #include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "concepts.hh"
 #include "config.hh"
+#include "Core/aligned_allocator.hh"
+#include "Core/construction.hh"
+#include "Core/execution.hh"
+#include "Core/expression_templates.hh"
+#include "Core/instrumentation.hh"
+#include "Core/matrix_view.hh"
+#include "Core/shape.hh"
+#include "Core/simd.hh"
+#include "Core/strided_iterator.hh"
 
 namespace LIB_NAMESPACE_BASE 
 {
     namespace _detail
     {
-
-        //Indicate dimension isn't known at compile-time
-        static constexpr int DYNAMIC = -1;
-        
-        //Convenience variable indicating if dimensions known at 
-        //compile-time
-        template<int _Nrows, int _Ncols>
-        static constexpr bool runtimeDim = _Nrows == DYNAMIC || _Ncols == DYNAMIC;
-
         template<typename _Tp>
-        //Satisfies LegacyContiguousIterator requirements (std::contiguous_iterator<_Iterator> is true)
+        //Satisfies LegacyContiguousIterator requirements (std::contiguous_iterator<_Iterator> is true).
+        //_Iterator<const _Tp> is the matching const iterator
         struct _Iterator
         {
-            using value_type = _Tp;
+            using value_type = std::remove_cv_t<_Tp>;
+            using element_type = _Tp;
             using reference = _Tp&;
             using pointer = _Tp*;
             using iterator_category = std::random_access_iterator_tag;
@@ -36,188 +45,137 @@ namespace LIB_NAMESPACE_BASE
             #endif
             using difference_type = std::ptrdiff_t;
 
-            _Iterator() :
-                _isRowOrder{true}, _curr{}, _data{}
+            _Iterator() noexcept
+                : _curr{}
+            {
+
+            }
+
+            explicit _Iterator(pointer curr) noexcept
+                : _curr{curr}
             {
 
             }
 
-            _Iterator(pointer curr, pointer data, bool isRowOrder = true)
-                : _isRowOrder{isRowOrder}, _curr{curr}, _data{data}
+            //Allows iterator -> const_iterator conversion
+            template<typename _UTp, 
+                std::enable_if_t<std::is_same_v<const _UTp, _Tp> && !std::is_same_v<_UTp, _Tp>, int> = 0>
+            _Iterator(const _Iterator<_UTp>& other) noexcept
+                : _curr{other.operator->()}
             {
 
             }
 
             //LegacyForwardIterator requiremtns
-            reference operator*() const
+            reference operator*() const noexcept
             {
                 return *_curr;
             }
 
-            pointer operator->() const
+            pointer operator->() const noexcept
             {
                 return _curr;
             }
 
-            _Iterator<_Tp>& operator++()
+            _Iterator& operator++() noexcept
             {
-                if (_isRowOrder)
-                {
-                    ++_curr;
-                }
+                ++_curr;
                 return *this;
             }
 
-            _Iterator<_Tp> operator++(int) const 
+            _Iterator operator++(int) noexcept
             {
-                _Iterator<_Tp> temp{*this};
-                ++(*this);
+                _Iterator temp{*this};
+                ++_curr;
                 return temp;
             }
 
-            _Iterator<_Tp>& operator--() 
+            _Iterator& operator--() noexcept
             {
-                if (_isRowOrder)
-                {
-                    --_curr;
-                }
+                --_curr;
                 return *this;
             }
 
-             _Iterator<_Tp> operator--(int) const 
+            _Iterator operator--(int) noexcept
             {
-                _Iterator<_Tp> temp{*this};
-                --(*this);
+                _Iterator temp{*this};
+                --_curr;
                 return temp;
             }
 
-            _Iterator<_Tp>& operator+=(difference_type n) 
+            _Iterator& operator+=(difference_type n) noexcept
             {
-                if (_isRowOrder)
-                {
-                    _curr += n;
-                }
+                _curr += n;
                 return *this;
             }
 
-            _Iterator<_Tp>& operator-=(difference_type n)
+            _Iterator& operator-=(difference_type n) noexcept
             {
-                if (_isRowOrder)
-                {
-                    _curr -= n;
-                }
+                _curr -= n;
                 return *this;
             }
 
-            reference operator[](difference_type n) const
+            reference operator[](difference_type n) const noexcept
             {
-                return *(_curr + n);
+                return _curr[n];
             }
 
             private:
-            template<typename _UTp>
-            friend bool operator!=(const _Iterator<_UTp>& lhs, const _Iterator<_UTp>& rhs)
+            friend bool operator==(const _Iterator& lhs, const _Iterator& rhs) noexcept
             {
-                if(!lhs._curr)
-                    return !rhs._curr && lhs._isRowOrder == rhs._isRowOrder;
-                return lhs._curr != rhs._curr || lhs._isRowOrder != rhs._isRowOrder;
+                return lhs._curr == rhs._curr;
             }
-            template<typename _UTp>
-            friend bool operator==(const _Iterator<_UTp>& lhs, const _Iterator<_UTp>& rhs)
+
+            friend bool operator!=(const _Iterator& lhs, const _Iterator& rhs) noexcept
             {
-                return !(lhs != rhs);
+                return lhs._curr != rhs._curr;
             }
 
-            template<typename _UTp>
-            friend _Iterator<_UTp> operator+(_Iterator<_UTp> lhs, difference_type n)
+            friend _Iterator operator+(_Iterator lhs, difference_type n) noexcept
             {
-                _Iterator<_Tp> temp = lhs;
-                temp += n;
-                return temp;
+                return lhs += n;
             }
-            template<typename _UTp>
-            friend _Iterator<_UTp> operator+(difference_type n, _Iterator<_UTp> rhs)
+
+            friend _Iterator operator+(difference_type n, _Iterator rhs) noexcept
             {
-                _Iterator<_Tp> temp = rhs;
-                temp += n;
-                return temp;
+                return rhs += n;
             }
-            template<typename _UTp>
-            friend _Iterator<_UTp> operator-(const _Iterator<_UTp>& lhs, difference_type n)
+
+            friend _Iterator operator-(_Iterator lhs, difference_type n) noexcept
             {
-                _Iterator<_Tp> temp = lhs;
-                temp -= n;
-                return temp;
+                return lhs -= n;
             }
-            template<typename _UTp>
-            friend difference_type operator-(const _Iterator<_UTp>& lhs, const _Iterator<_UTp>& rhs)
+
+            friend difference_type operator-(const _Iterator& lhs, const _Iterator& rhs) noexcept
             {
-                if (lhs._isRowOrder && rhs._isRowOrder)
-                {
-                    return lhs._curr - rhs._curr;
-                }
+                return lhs._curr - rhs._curr;
             }
 
-            template<typename _UTp>
-            friend bool operator<(const _Iterator<_UTp>& lhs, const _Iterator<_UTp>& rhs)
+            friend bool operator<(const _Iterator& lhs, const _Iterator& rhs) noexcept
             {
-                if (lhs._isRowOrder && rhs._isRowOrder)
-                {
-                    return lhs._curr < rhs._curr;
-                }
+                return lhs._curr < rhs._curr;
             }
 
-            template<typename _UTp>
-            friend bool operator>(const _Iterator<_UTp>& lhs, const _Iterator<_UTp>& rhs)
+            friend bool operator>(const _Iterator& lhs, const _Iterator& rhs) noexcept
             {
-                if (lhs._isRowOrder && rhs._isRowOrder)
-                {
-                    return lhs._curr > rhs._curr;
-                }
+                return lhs._curr > rhs._curr;
             }
-            template<typename _UTp>
-            friend bool operator<=(const _Iterator<_UTp>& lhs, const _Iterator<_UTp>& rhs)
+
+            friend bool operator<=(const _Iterator& lhs, const _Iterator& rhs) noexcept
             {
-                return !(lhs > rhs);
+                return lhs._curr <= rhs._curr;
             }
-            template<typename _UTp>
-            friend bool operator>=(const _Iterator<_UTp>& lhs, const _Iterator<_UTp>& rhs)
+
+            friend bool operator>=(const _Iterator& lhs, const _Iterator& rhs) noexcept
             {
-                return !(lhs < rhs);
+                return lhs._curr >= rhs._curr;
             }
             private:
-            //Flag indicating if iterator show ierator through rows or columns of matrix
-            bool _isRowOrder;
             pointer _curr;
-            pointer _data;
         };
 
         template<typename _Tp>
-        struct _ConstIterator
-        {
-            using value_type = _Tp;
-            using reference = const value_type&;
-            using pointer = const value_type*;
-            using iterator_category = std::random_access_iterator_tag;
-            using difference_type = std::ptrdiff_t;
-
-            _ConstIterator()
-                : _curr{nullptr}, _data{nullptr}
-            {
-
-            }
-            
-            _ConstIterator(_Iterator<_Tp> iter)
-                : _curr{iter._curr}, _data{iter._data}, _isRowOrder(iter._isRow)
-            {
-                
-            }
-
-            private:
-            bool _isRowOrder;
-            pointer _curr;
-            pointer _data;
-        };
+        using _ConstIterator = _Iterator<const _Tp>;
 
         //Base implemenation of Matrix, handles memory and some
         //C++ container requirements.
@@ -230,13 +188,21 @@ namespace LIB_NAMESPACE_BASE
             private:
             using storage_type = std::conditional_t<!runtimeDim<_Nrows, _Ncols>,
                 std::array<_Tp, static_cast<size_t>(_Nrows*_Ncols)>, 
-                std::vector<_Tp, _AllocTp>>;
+                std::vector<_Tp, _DefaultInitAllocator<_AllocTp>>>;
             public:
+            //True if rows are padded to whole cache lines, so leadingDim() may 
+            //differ from numCols(). Only dynamic matrices are padded
+            static constexpr bool isPadded = runtimeDim<_Nrows, _Ncols> && _padsRows<_AllocTp>;
+
             using value_type = _Tp;
             using reference = value_type&;
             using const_reference = const value_type&;
-            using iterator = _Iterator<_Tp>;
-            using const_iterator = _ConstIterator<_Tp>;
+            using iterator = std::conditional_t<isPadded, _StridedIterator<_Tp>, _Iterator<_Tp>>;
+            using const_iterator = std::conditional_t<isPadded, _StridedIterator<const _Tp>, _ConstIterator<_Tp>>;
+            //Column-major traversal of the row-major storage. Exposes its strides
+            //so algorithms can switch to a tiled traversal
+            using column_iterator = _StridedIterator<_Tp>;
+            using const_column_iterator = _StridedIterator<const _Tp>;
             using size_type = size_t;
             using difference_type = std::ptrdiff_t;
 
@@ -258,17 +224,49 @@ namespace LIB_NAMESPACE_BASE
             }
             //Constructor for num rows and cols, only participates overload resolution
             //for dynamic initialization. Allocates but does not initialize 
-            //memory
+            //memory, same as passing Limno::uninitialized
             CONSTEXPR20 LimnoMatrixBase(size_type numRows, size_type numCols)
-                : _numRows(numRows), _numCols(numCols)
+                : LimnoMatrixBase(uninitialized, numRows, numCols)
+            {
+
+            }
+
+            //Allocates numRows*numCols elements once and leaves them 
+            //uninitialized; dimensions must be dynamic
+            CONSTEXPR20 LimnoMatrixBase(uninitialized_t, size_type numRows, size_type numCols)
+                : _numRows{0}, _numCols{0}
             {
                 static_assert(runtimeDim<_Nrows, _Ncols>, "Dimensions must not be known at compile-time!");
-                _data.reserve(numRows*numCols);
+                _allocate(numRows, numCols);
+            }
+
+            //Allocates numRows*numCols elements once and zeroes them in bulk;
+            //dimensions must be dynamic
+            CONSTEXPR20 LimnoMatrixBase(zeros_t, size_type numRows, size_type numCols)
+                : LimnoMatrixBase(uninitialized, numRows, numCols)
+            {
+                _zeroFrom(0);
+            }
+
+            //Same as the default constructor; dimensions must be static
+            constexpr explicit LimnoMatrixBase(uninitialized_t) noexcept
+                : LimnoMatrixBase()
+            {
+                static_assert(!runtimeDim<_Nrows, _Ncols>, "Dimensions must be known at compile-time!");
             }
 
-            //Fills matrix with specified value; requires that dimensions be known at compile-time
+            //Zero matrix; dimensions must be static
+            constexpr explicit LimnoMatrixBase(zeros_t) noexcept
+                : _numRows{static_cast<size_type>(_Nrows)}, _numCols{static_cast<size_type>(_Ncols)}, _data{}
+            {
+                static_assert(!runtimeDim<_Nrows, _Ncols>, "Dimensions must be known at compile-time!");
+            }
+
+            //Fills matrix with specified value; requires that dimensions be known at compile-time.
+            //Storage is value-initialized first so the constructor is usable in
+            //constant expressions under C++17
             constexpr LimnoMatrixBase(_Tp fillValue)
-                : _numRows{static_cast<size_type>(_Nrows)}, _numCols{static_cast<size_type>(_Ncols)}
+                : _numRows{static_cast<size_type>(_Nrows)}, _numCols{static_cast<size_type>(_Ncols)}, _data{}
             {
                 static_assert(!runtimeDim<_Nrows, _Ncols>, "Dimensions must be known at compile-time!");
                 for(size_type i = 0; i < _data.size(); ++i)
@@ -280,7 +278,7 @@ namespace LIB_NAMESPACE_BASE
                 : _numRows{numRows}, _numCols{numCols}, _data{}
             {
                 static_assert(runtimeDim<_Nrows, _Ncols>, "Dimensions must be dynamic!");
-                _data.resize(numRows*numCols);
+                _data.assign(numRows*leadingDim(), fillValue);
             }
 
 
@@ -299,12 +297,7 @@ namespace LIB_NAMESPACE_BASE
             LimnoMatrixBase(_IterTp begin, _IterTp end) noexcept
                 : _numRows{static_cast<size_type>(_Nrows)}, _numCols{static_cast<size_type>(_Ncols)}
             {
-                int count = 0;
-                for(; count < _Nrows*_Ncols && begin != end; ++count)
-                    _data[count] = *begin++;
-                
-                for(; count < _Nrows*_Ncols; ++count)
-                    _data[count] = 0;
+                _copyFrom(begin, end);
             } 
 
             //Constructor from pair of iterators + dimensions of matrix. Only participates 
@@ -320,16 +313,20 @@ namespace LIB_NAMESPACE_BASE
                 runtimeDim<_Nrows, _Ncols>, int> = 0>
             #endif 
             LimnoMatrixBase(_IterTp begin, _IterTp end, size_type numRows, size_type numCols)
-                : _numRows{numRows}, _numCols{numCols}
+                : _numRows{0}, _numCols{0}
             {
-                size_type size = numRows*numCols;
-                size_type count = 0;
+                _allocate(numRows, numCols);
 
-                for(; count < size && begin != end; ++count)
-                    _data.push_back(*begin++);
-                
-                for(; count < size; ++count)
-                    _data.push_back(0);
+                //Column walks are copied in cache-line tiles, which makes this
+                //a blocked transpose
+                if constexpr(_isStridedIterator<_IterTp> && !isPadded)
+                {
+                    const size_type count = std::min(size(), static_cast<size_type>(end - begin));
+                    _stridedCopy(begin, begin + static_cast<difference_type>(count), _data.data());
+                    _zeroFrom(count);
+                }
+                else 
+                    _copyFrom(begin, end);
             }
 
             //Constructor from arbitrary container
@@ -341,36 +338,35 @@ namespace LIB_NAMESPACE_BASE
             #endif
             LimnoMatrixBase(const _CTp2<_CTp1, _ArgsTp...>& c) noexcept(!runtimeDim<_Nrows, _Ncols>)
             {
-                size_type size = std::begin(c)->size()*c.size();
-                size_type contSize = (runtimeDim<_Nrows, _Ncols>) ? size : _Nrows*_Ncols;
                 if constexpr(runtimeDim<_Nrows, _Ncols>)
                 {
-                    _numRows = c.size();
-                    _numCols = std::begin(c)->size();
-                    _data.resize(size);
+                    _numRows = 0;
+                    _numCols = 0;
+                    _allocate(c.size(), (c.size() == 0) ? 0 : std::begin(c)->size());
                 }
                 else 
                 {
                     _numRows = static_cast<size_type>(_Nrows);
                     _numCols = static_cast<size_type>(_Ncols);
                 }
-                
-                auto rowIt = std::begin(c);
-                auto colIt = std::begin(*rowIt);
 
+                //Each inner container is copied in one go
+                const size_type total = size();
                 size_type count = 0;
-                for(; count < contSize && rowIt != std::end(c); ++count)
+                for(auto rowIt = std::begin(c); rowIt != std::end(c) && count < total; ++rowIt)
                 {
-                    _data[count] = *colIt++;
-                    if (colIt == std::end(*rowIt))
+                    const size_type n = std::min(static_cast<size_type>(rowIt->size()), total - count);
+                    if constexpr(isPadded)
                     {
-                        ++rowIt;
-                        colIt = std::begin(*rowIt);
+                        auto colIt = std::begin(*rowIt);
+                        for(size_type i = 0; i < n; ++i, ++colIt)
+                            _data[_storageIndex(count + i)] = *colIt;
                     }
+                    else 
+                        std::copy_n(std::begin(*rowIt), n, _data.data() + count);
+                    count += n;
                 }
-
-                for(; count < contSize; ++count)
-                    _data[count] = _Tp{};
+                _zeroFrom(count);
             }
 
             //Constructor from array. Only participates in overload resoluation 
@@ -385,15 +381,18 @@ namespace LIB_NAMESPACE_BASE
                     !runtimeDim<_Nrows, _Ncols>, int>>
             #endif
             constexpr LimnoMatrixBase(_UTp (& c)[N]) noexcept 
-                : _numRows{static_cast<size_type>(_Nrows)}, _numCols{static_cast<size_type>(_Ncols)}
+                : _numRows{static_cast<size_type>(_Nrows)}, _numCols{static_cast<size_type>(_Ncols)}, _data{}
             {
                 static_assert(!runtimeDim<_Nrows, _Ncols>, "Constructor requires dimensions known at compile-time!");
-                size_type count = 0; 
-                for(; count < _Nrows*_Ncols && count < N; ++count)
-                    _data[count] = c[count];
-                
-                for(; count < _Nrows*_Ncols; ++count)
-                    _data[count] = 0;
+                //Storage is already zeroed, so only the given elements are copied
+                const size_type count = std::min(static_cast<size_type>(N), _data.size());
+                if (LIMNO_IS_CONSTANT_EVALUATED())
+                {
+                    for(size_type i = 0; i < count; ++i)
+                        _data[i] = c[i];
+                }
+                else 
+                    std::copy_n(c, count, _data.data());
             }
 
              //Constructor from array and shape. Only participates in overload resoluation 
@@ -408,17 +407,29 @@ namespace LIB_NAMESPACE_BASE
                     runtimeDim<_Nrows, _Ncols>, int> = 0>
             #endif
             LimnoMatrixBase(_UTp (& c)[N], size_type numRows, size_type numCols) 
+                : _numRows{0}, _numCols{0}
             {
                 static_assert(runtimeDim<_Nrows, _Ncols>, "Constructor requires dimensions not known at compile-time!");
-                size_type size = numRows*numCols;
-                _data.resize(size);
+                _allocate(numRows, numCols);
+                _copyFrom(c, c + N);
+            }
 
-                size_type count = 0;
-                for(; count < size && count < N; ++count)
-                    _data[count] = c[count];
-                
-                for(; count < size; ++count)
-                    _data[count] = 0;
+            //Constructor from element-wise expression. The expression is evaluated
+            //in a single pass directly into the matrix's storage
+            template<typename _Callable, typename... _ArgsTp>
+            LimnoMatrixBase(const _Expr<_Callable, _ArgsTp...>& expr)
+                : LimnoMatrixBase()
+            {
+                _evaluate(expr);
+            }
+
+            //Constructor from a view. The elements are copied out of the viewed
+            //storage
+            template<typename _UTp>
+            explicit LimnoMatrixBase(const LimnoMatrixView<_UTp>& view)
+                : LimnoMatrixBase()
+            {
+                _evaluate(view);
             }
 
             //Container compliance methods
@@ -428,67 +439,75 @@ namespace LIB_NAMESPACE_BASE
             //Traverse in row-major order
             constexpr iterator begin() noexcept
             {
-                return iterator{_data.data(), _data.data()};
+                return _rowIterator<iterator>(_data.data(), 0);
             }
 
             constexpr const_iterator begin() const noexcept
             {
-                return const_iterator(_data.data(), _data.data());
+                return _rowIterator<const_iterator>(_data.data(), 0);
             }
 
             constexpr const_iterator cbegin() const noexcept 
             {
-                //return const_iterator{_data.data(), _data.data()};
+                return begin();
             }
 
             constexpr iterator end() noexcept
             {
-                return iterator{_data.data() + _data.size(), _data.data()};
+                return _rowIterator<iterator>(_data.data(), size());
             }
 
             constexpr const_iterator end() const noexcept
             {
-                
+                return _rowIterator<const_iterator>(_data.data(), size());
             }
 
             constexpr const_iterator cend() const noexcept 
             {
-                
+                return end();
             }
 
             //Traverse in column major order 
-            constexpr iterator columnBegin() noexcept 
+            constexpr column_iterator columnBegin() noexcept 
             {
-
+                return _columnIterator<column_iterator>(_data.data(), 0);
             }
 
-
-            constexpr const_iterator columnBegin() const noexcept 
+            constexpr const_column_iterator columnBegin() const noexcept 
             {
-
+                return _columnIterator<const_column_iterator>(_data.data(), 0);
             }
 
-            constexpr const_iterator ccolumnBegin() const noexcept 
+            constexpr const_column_iterator ccolumnBegin() const noexcept 
             {
-
+                return columnBegin();
             }
 
-            constexpr iterator columnEnd() noexcept 
+            constexpr column_iterator columnEnd() noexcept 
             {
-
+                return _columnIterator<column_iterator>(_data.data(), size());
             }
 
-
-            constexpr const_iterator columnEnd() const noexcept 
+            constexpr const_column_iterator columnEnd() const noexcept 
             {
-
+                return _columnIterator<const_column_iterator>(_data.data(), size());
             }
 
-            constexpr const_iterator ccolumnEnd() const noexcept 
+            constexpr const_column_iterator ccolumnEnd() const noexcept 
             {
+                return columnEnd();
+            }
 
+            //Underlying storage. Rows start leadingDim() elements apart
+            constexpr _Tp* data() noexcept
+            {
+                return _data.data();
             }
 
+            constexpr const _Tp* data() const noexcept
+            {
+                return _data.data();
+            }
 
             constexpr size_type max_size() const noexcept
             {
@@ -497,7 +516,10 @@ namespace LIB_NAMESPACE_BASE
 
             constexpr size_type size() const noexcept 
             {
-                return _data.size();
+                if constexpr(isPadded)
+                    return _numRows*_numCols;
+                else 
+                    return _data.size();
             }
 
             constexpr bool empty() const noexcept 
@@ -516,15 +538,401 @@ namespace LIB_NAMESPACE_BASE
                 return static_cast<size_type>(_numCols);
             }
 
+            //Distance in elements between the starts of consecutive rows. Equal 
+            //to numCols() unless the matrix is padded
+            constexpr size_type leadingDim() const noexcept 
+            {
+                if constexpr(isPadded)
+                {
+                    constexpr size_type perLine = std::max<size_type>(1, _rowAlignment<_AllocTp>/sizeof(_Tp));
+                    return (_numCols + perLine - 1)/perLine*perLine;
+                }
+                else 
+                {
+                    return static_cast<size_type>(_numCols);
+                }
+            }
+
+            //Strides in elements used by views of this matrix
+            constexpr difference_type rowStride() const noexcept
+            {
+                return static_cast<difference_type>(leadingDim());
+            }
+
+            constexpr difference_type colStride() const noexcept
+            {
+                return 1;
+            }
+
+            //Zero-copy views. The views are invalidated by anything that 
+            //reallocates the matrix's storage
+            LimnoMatrixView<_Tp> view() noexcept
+            {
+                return LimnoMatrixView<_Tp>{_data.data(), numRows(), numCols(), rowStride(), colStride()};
+            }
+
+            LimnoMatrixView<const _Tp> view() const noexcept
+            {
+                return LimnoMatrixView<const _Tp>{_data.data(), numRows(), numCols(), rowStride(), colStride()};
+            }
+
+            LimnoMatrixView<_Tp> row(size_type r)
+            {
+                return view().row(r);
+            }
+
+            LimnoMatrixView<const _Tp> row(size_type r) const
+            {
+                return view().row(r);
+            }
+
+            LimnoMatrixView<_Tp> col(size_type c)
+            {
+                return view().col(c);
+            }
+
+            LimnoMatrixView<const _Tp> col(size_type c) const
+            {
+                return view().col(c);
+            }
+
+            LimnoMatrixView<_Tp> block(size_type r0, size_type c0, size_type numRows, size_type numCols)
+            {
+                return view().block(r0, c0, numRows, numCols);
+            }
+
+            LimnoMatrixView<const _Tp> block(size_type r0, size_type c0, size_type numRows, size_type numCols) const
+            {
+                return view().block(r0, c0, numRows, numCols);
+            }
+
+            LimnoMatrixView<_Tp> slice(size_type rowBegin, size_type rowEnd, size_type rowStep,
+                size_type colBegin, size_type colEnd, size_type colStep)
+            {
+                return view().slice(rowBegin, rowEnd, rowStep, colBegin, colEnd, colStep);
+            }
+
+            LimnoMatrixView<const _Tp> slice(size_type rowBegin, size_type rowEnd, size_type rowStep,
+                size_type colBegin, size_type colEnd, size_type colStep) const
+            {
+                return view().slice(rowBegin, rowEnd, rowStep, colBegin, colEnd, colStep);
+            }
+
             //Operators
             constexpr reference operator()(size_type r, size_type c) 
             {
-                return _data[r*_numCols + c];
+                return _data[r*leadingDim() + c];
             }
 
             constexpr const_reference operator()(size_type r, size_type c) const 
             {
-                return _data[r*_numCols + c];
+                return _data[r*leadingDim() + c];
+            }
+
+            //Evaluates an element-wise expression into this matrix. Each element
+            //of the result only depends on the same element of the operands, so 
+            //the matrix itself may appear in the expression. A view of its
+            //storage may read it in another layout (e.g. its transpose), so then
+            //the expression is evaluated into a temporary first
+            template<typename _Callable, typename... _ArgsTp>
+            LimnoMatrixBase& operator=(const _Expr<_Callable, _ArgsTp...>& expr)
+            {
+                if (_viewedBy(expr))
+                {
+                    LimnoMatrixBase result;
+                    result._evaluate(expr);
+                    *this = std::move(result);
+                    return *this;
+                }
+                _evaluate(expr);
+                return *this;
+            }
+
+            //Copies the elements of a view into this matrix. A view of this
+            //matrix's own storage (e.g. its transpose) is copied out first
+            template<typename _UTp>
+            LimnoMatrixBase& operator=(const LimnoMatrixView<_UTp>& view)
+            {
+                if (_viewedBy(view))
+                {
+                    const LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> copy(view);
+                    _evaluate(copy.view());
+                    return *this;
+                }
+                _evaluate(view);
+                return *this;
+            }
+
+            #if __cplusplus > 201703L
+            template<typename _OperandTp> requires _isOperand<_OperandTp>
+            #else 
+            template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+            #endif
+            LimnoMatrixBase& operator+=(const _OperandTp& other)
+            {
+                return *this = *this + other;
+            }
+
+            #if __cplusplus > 201703L
+            template<typename _OperandTp> requires _isOperand<_OperandTp>
+            #else 
+            template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+            #endif
+            LimnoMatrixBase& operator-=(const _OperandTp& other)
+            {
+                return *this = *this - other;
+            }
+
+            #if __cplusplus > 201703L
+            template<typename _OperandTp> requires _isOperand<_OperandTp>
+            #else 
+            template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+            #endif
+            LimnoMatrixBase& operator*=(const _OperandTp& other)
+            {
+                return *this = *this * other;
+            }
+
+            #if __cplusplus > 201703L
+            template<typename _OperandTp> requires _isOperand<_OperandTp>
+            #else 
+            template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+            #endif
+            LimnoMatrixBase& operator/=(const _OperandTp& other)
+            {
+                return *this = *this / other;
+            }
+
+            //Evaluates an element-wise expression into this matrix using the given
+            //execution policy. Under Limno::par the matrix is split into chunks
+            //of whole cache lines (whole rows if padded) evaluated on the thread
+            //pool, so no two threads write to the same line. As with operator=,
+            //expressions over views of this matrix go through a temporary
+            #if __cplusplus > 201703L
+            template<typename _PolicyTp, typename _ExprTp> 
+                requires _isExecutionPolicy<_PolicyTp> && _OperandTraits<_ExprTp>::isMatrix
+            #else 
+            template<typename _PolicyTp, typename _ExprTp, 
+                std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _OperandTraits<_ExprTp>::isMatrix, int> = 0>
+            #endif
+            LimnoMatrixBase& assign(_PolicyTp&& policy, const _ExprTp& expr)
+            {
+                if (_viewedBy(expr))
+                {
+                    LimnoMatrixBase result;
+                    result.assign(policy, expr);
+                    *this = std::move(result);
+                    return *this;
+                }
+                if constexpr(_isParallelPolicy<_PolicyTp>)
+                {
+                    _reshape(expr);
+                    LIMNO_INSTRUMENT_OPERATION("elementwise", _ExprCost<_ExprTp>::ops*size(), 
+                        (_ExprCost<_ExprTp>::matrices + 1)*size()*sizeof(_Tp));
+                    if constexpr(isPadded)
+                    {
+                        const _Partition rows = _partition(_numRows, 1, 0, 
+                            std::max<size_type>(1, LIMNO_PARALLEL_GRAIN/std::max<size_type>(1, _numCols)));
+                        _parallelChunks(rows, [&](size_type first, size_type last) 
+                            { _evaluateRange(expr, first*_numCols, last*_numCols); });
+                    }
+                    else 
+                    {
+                        _parallelChunks(_linePartition(_data.data(), size()), [&](size_type first, size_type last) 
+                            { _evaluateRange(expr, first, last); });
+                    }
+                }
+                else 
+                {
+                    _evaluate(expr);
+                }
+                return *this;
+            }
+            private:
+            //True if operand is, or is an expression over, a view whose
+            //elements lie in this matrix's storage
+            template<typename _OperandTp>
+            bool _viewedBy(const _OperandTp& operand) const noexcept
+            {
+                if constexpr(_isExpr<_OperandTp>)
+                {
+                    return std::apply([this](const auto&... args) { return (... || _viewedBy(args)); }, operand._operands());
+                }
+                else if constexpr(_isView<_OperandTp>)
+                {
+                    const _Tp* first = _data.data();
+                    const _Tp* last = first + _data.size();
+                    return !std::less<const void*>{}(operand.data(), first) && std::less<const void*>{}(operand.data(), last);
+                }
+                else 
+                {
+                    return false;
+                }
+            }
+
+            template<typename _ExprTp>
+            void _evaluate(const _ExprTp& expr)
+            {
+                _reshape(expr);
+                //Every matrix operand is read and the result written once
+                LIMNO_INSTRUMENT_OPERATION("elementwise", _ExprCost<_ExprTp>::ops*size(), 
+                    (_ExprCost<_ExprTp>::matrices + 1)*size()*sizeof(_Tp));
+                _evaluateRange(expr, 0, _numRows*_numCols);
+            }
+
+            //Checks that expr has a compatible shape, resizing dynamic matrices
+            template<typename _ExprTp>
+            void _reshape(const _ExprTp& expr)
+            {
+                using traits = _OperandTraits<_ExprTp>;
+                static_assert(compatibleDim<_Nrows, traits::rows> && compatibleDim<_Ncols, traits::cols>, 
+                    "Matrix dimensions do not match!");
+                if constexpr(runtimeDim<_Nrows, _Ncols>)
+                {
+                    if ((_Nrows != DYNAMIC && expr.numRows() != static_cast<size_type>(_Nrows)) ||
+                        (_Ncols != DYNAMIC && expr.numCols() != static_cast<size_type>(_Ncols)))
+                        throw std::invalid_argument("Matrix dimensions do not match!");
+                    _allocate(expr.numRows(), expr.numCols());
+                }
+                else if constexpr(runtimeDim<traits::rows, traits::cols>)
+                {
+                    if (expr.numRows() != _numRows || expr.numCols() != _numCols)
+                        throw std::invalid_argument("Matrix dimensions do not match!");
+                }
+            }
+
+            //Evaluates the elements with flat row-major indices in [first, last)
+            template<typename _ExprTp>
+            void _evaluateRange(const _ExprTp& expr, size_type first, size_type last)
+            {
+                using traits = _OperandTraits<_ExprTp>;
+                _Tp* out = _data.data();
+                if constexpr(_SimdEvaluable<_Tp, _ExprTp>::value && !isPadded)
+                {
+                    _simdEvaluate(expr, out, first, last);
+                }
+                else if constexpr(_simdConvertsScalar<_Tp, _ExprTp>)
+                {
+                    //Padded rows round the scalar to _Tp first like the kernels
+                    _evaluateRange(_withScalarAs<_Tp>(expr), first, last);
+                }
+                else if constexpr(traits::contiguous && !isPadded)
+                {
+                    for(size_type i = first; i < last; ++i)
+                        out[i] = static_cast<_Tp>(traits::at(expr, i));
+                }
+                else if (first < last)
+                {
+                    const size_type ld = leadingDim();
+                    size_type r = first/_numCols;
+                    size_type c = first % _numCols;
+                    for(size_type i = first; i < last; ++i)
+                    {
+                        out[r*ld + c] = static_cast<_Tp>(expr(r, c));
+                        if (++c == _numCols)
+                        {
+                            c = 0;
+                            ++r;
+                        }
+                    }
+                }
+            }
+
+            template<typename _IterTp, typename _PtrTp>
+            constexpr _IterTp _rowIterator(_PtrTp base, size_type index) const noexcept
+            {
+                if constexpr(isPadded)
+                    return _IterTp{base, static_cast<difference_type>(index), static_cast<difference_type>(_numCols), 
+                        1, static_cast<difference_type>(leadingDim())};
+                else 
+                    return _IterTp{base + index};
+            }
+
+            //Walks down each column before moving to the next one
+            template<typename _IterTp, typename _PtrTp>
+            constexpr _IterTp _columnIterator(_PtrTp base, size_type index) const noexcept
+            {
+                return _IterTp{base, static_cast<difference_type>(index), static_cast<difference_type>(_numRows),
+                    static_cast<difference_type>(leadingDim()), 1};
+            }
+
+            //Sizes the storage for numRows x numCols. Elements are left
+            //uninitialized so they are only written once; row padding is zeroed
+            CONSTEXPR20 void _allocate(size_type numRows, size_type numCols)
+            {
+                _numRows = numRows;
+                _numCols = numCols;
+                _data.resize(numRows*leadingDim());
+                if constexpr(isPadded)
+                {
+                    for(size_type r = 0; r < numRows; ++r)
+                        _fillZero(_data.data() + r*leadingDim() + numCols, leadingDim() - numCols);
+                }
+            }
+
+            static CONSTEXPR20 void _fillZero(_Tp* first, size_type n) noexcept
+            {
+                if constexpr(std::is_arithmetic_v<_Tp>)
+                {
+                    if (n != 0)
+                        std::memset(first, 0, n*sizeof(_Tp));
+                }
+                else 
+                    std::fill_n(first, n, _Tp{});
+            }
+
+            //Zeroes the elements from flat row-major index first onwards
+            CONSTEXPR20 void _zeroFrom(size_type first)
+            {
+                if (first >= size())
+                    return;
+                if constexpr(isPadded)
+                {
+                    //Rest of the first row, then everything after it in one go
+                    const size_type row = first/_numCols;
+                    const size_type col = first % _numCols;
+                    _fillZero(_data.data() + row*leadingDim() + col, _numCols - col);
+                    _fillZero(_data.data() + (row + 1)*leadingDim(), _data.size() - (row + 1)*leadingDim());
+                }
+                else 
+                    _fillZero(_data.data() + first, size() - first);
+            }
+
+            //Copies up to size() elements of [begin, end) in row-major order and
+            //zeroes the rest. Random access ranges are copied row by row in bulk
+            template<typename _IterTp>
+            CONSTEXPR20 void _copyFrom(_IterTp begin, _IterTp end)
+            {
+                using category = typename std::iterator_traits<_IterTp>::iterator_category;
+                const size_type total = size();
+                size_type count = 0;
+                if constexpr(std::is_base_of_v<std::random_access_iterator_tag, category>)
+                {
+                    count = std::min(total, static_cast<size_type>(std::max<difference_type>(end - begin, 0)));
+                    if constexpr(isPadded)
+                    {
+                        for(size_type first = 0; first < count; first += _numCols)
+                            std::copy_n(begin + static_cast<difference_type>(first), std::min(_numCols, count - first),
+                                _data.data() + (first/_numCols)*leadingDim());
+                    }
+                    else 
+                        std::copy_n(begin, count, _data.data());
+                }
+                else 
+                {
+                    for(; count < total && begin != end; ++count)
+                        _data[_storageIndex(count)] = *begin++;
+                }
+                _zeroFrom(count);
+            }
+
+            //Position in storage of the element at flat row-major index i
+            constexpr size_type _storageIndex(size_type i) const noexcept 
+            {
+                if constexpr(isPadded)
+                    return (i/_numCols)*leadingDim() + i % _numCols;
+                else 
+                    return i;
             }
             private:
                 template<typename _UTp,
@@ -532,11 +940,23 @@ namespace LIB_NAMESPACE_BASE
                     int _Ncols1>
                 friend std::ostream& operator<<(std::ostream& os, const LimnoMatrixBase<_UTp, _Nrows1, _Ncols1>& mat);
             private:
+            //Fixed-size storage takes the alignment of an aligned _AllocTp, and is
+            //otherwise only aligned as far as it costs no padding
+            static constexpr size_t _storageAlignment() noexcept
+            {
+                if constexpr(runtimeDim<_Nrows, _Ncols>)
+                    return alignof(storage_type);
+                else 
+                    return _staticAlignment<_Tp, static_cast<size_t>(_Nrows*_Ncols), _AllocTp>();
+            }
+            private:
             size_type _numRows;
             size_type _numCols;
-            storage_type _data;
+            alignas(_storageAlignment()) storage_type _data;
         };
 
+        //Elements are written with the stream's own formatting state. toChars
+        //and toString in text_format.hh give the shortest round-trip form
         template<typename _UTp,
             int _Nrows, 
             int _Ncols>
@@ -561,6 +981,28 @@ namespace LIB_NAMESPACE_BASE
             }
             return os;
         }
+
+        template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        struct _OperandTraits<LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>>
+        {
+            using matrix_type = LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>;
+            using value_type = _Tp;
+            static constexpr bool isMatrix = true;
+            static constexpr bool storedByValue = false;
+            static constexpr bool contiguous = !matrix_type::isPadded;
+            static constexpr int rows = _Nrows;
+            static constexpr int cols = _Ncols;
+
+            static constexpr const _Tp& at(const matrix_type& m, size_t i) noexcept
+            {
+                return m.data()[i];
+            }
+
+            static constexpr const _Tp& at(const matrix_type& m, size_t r, size_t c) noexcept
+            {
+                return m(r, c);
+            }
+        };
     } // namespace _detail
 }
 
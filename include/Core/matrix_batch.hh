@@ -0,0 +1,503 @@
+#ifndef MATRIX_BATCH_HH
+#define MATRIX_BATCH_HH 1
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "config.hh"
+#include "Core/aligned_allocator.hh"
+#include "Core/construction.hh"
+#include "Core/execution.hh"
+#include "Core/instrumentation.hh"
+#include "Core/expression_templates.hh"
+#include "Core/matrix_base.hh"
+#include "Core/shape.hh"
+#include "Core/simd.hh"
+#include "Core/small_matrix.hh"
+
+//Batches of small matrices of one static shape. Looping over thousands of
+//3x3 or 6x6 matrices one at a time leaves the vector units mostly idle, as
+//each product or inverse is too small to fill a register. A matrix_batch
+//stores its matrices interleaved instead, so one vector instruction applies
+//the same step to a whole pack of matrices
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Matrices per pack; element (r, c) of every matrix in a pack fills one
+    //cache line
+    template<typename _Tp>
+    static constexpr size_t _batchLanes = std::max<size_t>(1, LIMNO_CACHE_LINE/sizeof(_Tp));
+
+    template<typename _Tp, size_t _M, size_t _K, size_t _N>
+    using _batch_product_fn = void (*)(const _Tp*, const _Tp*, _Tp*, size_t);
+
+    template<typename _Tp, size_t _N, size_t _K>
+    using _batch_solve_fn = bool (*)(const _Tp*, const _Tp*, _Tp*, size_t, size_t);
+
+    template<typename _Tp, size_t _N>
+    using _batch_inverse_fn = bool (*)(const _Tp*, _Tp*, size_t, size_t);
+
+    namespace _scalar
+    {
+        #include "Core/batch_kernels.inl"
+    }
+
+    #if LIMNO_SIMD_X86
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("sse2")
+    #endif
+    namespace _sse2
+    {
+        #include "Core/batch_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("avx2")
+    #endif
+    namespace _avx2
+    {
+        #include "Core/batch_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("avx512f")
+    #endif
+    namespace _avx512
+    {
+        #include "Core/batch_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+    #endif // LIMNO_SIMD_X86
+
+    //Kernels for an instruction set. The caller must make sure the CPU
+    //supports it. Only float and double have vector kernels
+    template<typename _Tp, size_t _M, size_t _K, size_t _N>
+    _batch_product_fn<_Tp, _M, _K, _N> _batchProductFor([[maybe_unused]] _SimdIsa isa) noexcept
+    {
+        #if LIMNO_SIMD_X86
+        if constexpr(std::is_same_v<_Tp, float> || std::is_same_v<_Tp, double>)
+        {
+            switch(isa)
+            {
+                case _SimdIsa::avx512:
+                    return &_avx512::_batchProduct<_avx512::_Reg<_Tp>, _M, _K, _N>;
+                case _SimdIsa::avx2:
+                    return &_avx2::_batchProduct<_avx2::_Reg<_Tp>, _M, _K, _N>;
+                case _SimdIsa::sse2:
+                    return &_sse2::_batchProduct<_sse2::_Reg<_Tp>, _M, _K, _N>;
+                default:
+                    break;
+            }
+        }
+        #endif
+        return &_scalar::_batchProduct<_scalar::_Reg<_Tp>, _M, _K, _N>;
+    }
+
+    template<typename _Tp, size_t _N, size_t _K>
+    _batch_solve_fn<_Tp, _N, _K> _batchSolveFor([[maybe_unused]] _SimdIsa isa) noexcept
+    {
+        #if LIMNO_SIMD_X86
+        if constexpr(std::is_same_v<_Tp, float> || std::is_same_v<_Tp, double>)
+        {
+            switch(isa)
+            {
+                case _SimdIsa::avx512:
+                    return &_avx512::_batchGaussJordan<_avx512::_Reg<_Tp>, _N, _K>;
+                case _SimdIsa::avx2:
+                    return &_avx2::_batchGaussJordan<_avx2::_Reg<_Tp>, _N, _K>;
+                case _SimdIsa::sse2:
+                    return &_sse2::_batchGaussJordan<_sse2::_Reg<_Tp>, _N, _K>;
+                default:
+                    break;
+            }
+        }
+        #endif
+        return &_scalar::_batchGaussJordan<_scalar::_Reg<_Tp>, _N, _K>;
+    }
+
+    template<typename _Tp, size_t _N>
+    _batch_inverse_fn<_Tp, _N> _batchInverseFor([[maybe_unused]] _SimdIsa isa) noexcept
+    {
+        #if LIMNO_SIMD_X86
+        if constexpr(std::is_same_v<_Tp, float> || std::is_same_v<_Tp, double>)
+        {
+            switch(isa)
+            {
+                case _SimdIsa::avx512:
+                    return &_avx512::_batchInverse<_avx512::_Reg<_Tp>, _N>;
+                case _SimdIsa::avx2:
+                    return &_avx2::_batchInverse<_avx2::_Reg<_Tp>, _N>;
+                case _SimdIsa::sse2:
+                    return &_sse2::_batchInverse<_sse2::_Reg<_Tp>, _N>;
+                default:
+                    break;
+            }
+        }
+        #endif
+        return &_scalar::_batchInverse<_scalar::_Reg<_Tp>, _N>;
+    }
+
+    //Batch of matrices of one static shape, stored in packs of
+    //_batchLanes<_Tp> matrices. Within a pack, element (r, c) of matrix l is
+    //at (r*_Ncols + c)*lanes + l, so each element of a pack is a contiguous
+    //run across the matrices. The last pack is padded with zeros
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp = aligned_allocator<_Tp>>
+    class matrix_batch
+    {
+        static_assert(!runtimeDim<_Nrows, _Ncols>, "Dimensions must be known at compile-time!");
+        public:
+        using value_type = _Tp;
+        using size_type = size_t;
+        using reference = _Tp&;
+        using const_reference = const _Tp&;
+        using matrix_type = LimnoMatrixBase<_Tp, _Nrows, _Ncols>;
+
+        static constexpr size_type lanes = _batchLanes<_Tp>;
+        static constexpr size_type packSize = static_cast<size_type>(_Nrows)*_Ncols*lanes;
+
+        matrix_batch() noexcept = default;
+
+        //Allocates but does not initialize the matrices, like LimnoMatrixBase
+        explicit matrix_batch(size_type count)
+            : matrix_batch(Limno::uninitialized, count)
+        {
+
+        }
+
+        matrix_batch(uninitialized_t, size_type count)
+            : _count{count}, _data(_packs(count)*packSize)
+        {
+            _clearPadding();
+        }
+
+        matrix_batch(zeros_t, size_type count)
+            : _count{count}, _data(_packs(count)*packSize, _Tp{})
+        {
+
+        }
+
+        //Batch holding a copy of each matrix in a range
+        template<typename _IterTp>
+        matrix_batch(_IterTp first, _IterTp last)
+            : matrix_batch(Limno::uninitialized, static_cast<size_type>(std::distance(first, last)))
+        {
+            for(size_type b = 0; first != last; ++first, ++b)
+                set(b, *first);
+        }
+
+        //Shape
+        size_type size() const noexcept
+        {
+            return _count;
+        }
+
+        bool empty() const noexcept
+        {
+            return _count == 0;
+        }
+
+        static constexpr size_type numRows() noexcept
+        {
+            return static_cast<size_type>(_Nrows);
+        }
+
+        static constexpr size_type numCols() noexcept
+        {
+            return static_cast<size_type>(_Ncols);
+        }
+
+        //Number of packs, including the padded one
+        size_type packs() const noexcept
+        {
+            return _packs(_count);
+        }
+
+        //Element (r, c) of matrix b
+        reference operator()(size_type b, size_type r, size_type c) noexcept
+        {
+            return _data[_index(b, r, c)];
+        }
+
+        const_reference operator()(size_type b, size_type r, size_type c) const noexcept
+        {
+            return _data[_index(b, r, c)];
+        }
+
+        //Copy of matrix b
+        matrix_type get(size_type b) const noexcept
+        {
+            matrix_type m;
+            for(size_type r = 0; r < numRows(); ++r)
+                for(size_type c = 0; c < numCols(); ++c)
+                    m(r, c) = (*this)(b, r, c);
+            return m;
+        }
+
+        //Overwrites matrix b with a matrix or expression of the same shape
+        template<typename _SrcTp>
+        void set(size_type b, const _SrcTp& m) noexcept
+        {
+            static_assert(compatibleDim<_OperandTraits<_SrcTp>::rows, _Nrows> && compatibleDim<_OperandTraits<_SrcTp>::cols, _Ncols>,
+                "Matrix dimensions do not match!");
+            for(size_type r = 0; r < numRows(); ++r)
+                for(size_type c = 0; c < numCols(); ++c)
+                    (*this)(b, r, c) = _OperandTraits<_SrcTp>::at(m, r, c);
+        }
+
+        template<typename _SrcTp>
+        void push_back(const _SrcTp& m)
+        {
+            if (_count % lanes == 0)
+                _data.resize(_data.size() + packSize, _Tp{});
+            set(_count++, m);
+        }
+
+        //Interleaved storage, packs() * packSize elements
+        _Tp* data() noexcept
+        {
+            return _data.data();
+        }
+
+        const _Tp* data() const noexcept
+        {
+            return _data.data();
+        }
+
+        //Element-wise arithmetic. Padding lanes take part too, which keeps the
+        //loops over the whole buffer branch free
+        matrix_batch& operator+=(const matrix_batch& other)
+        {
+            return _apply(other, _SimdOp::add);
+        }
+
+        matrix_batch& operator-=(const matrix_batch& other)
+        {
+            return _apply(other, _SimdOp::sub);
+        }
+
+        matrix_batch& operator*=(_Tp scalar) noexcept
+        {
+            return _apply(scalar, _SimdOp::mul);
+        }
+
+        matrix_batch& operator/=(_Tp scalar) noexcept
+        {
+            return _apply(scalar, _SimdOp::div);
+        }
+
+        friend matrix_batch operator+(matrix_batch lhs, const matrix_batch& rhs)
+        {
+            return lhs += rhs;
+        }
+
+        friend matrix_batch operator-(matrix_batch lhs, const matrix_batch& rhs)
+        {
+            return lhs -= rhs;
+        }
+
+        friend matrix_batch operator*(matrix_batch lhs, _Tp scalar) noexcept
+        {
+            return lhs *= scalar;
+        }
+
+        friend matrix_batch operator*(_Tp scalar, matrix_batch rhs) noexcept
+        {
+            return rhs *= scalar;
+        }
+
+        friend matrix_batch operator/(matrix_batch lhs, _Tp scalar) noexcept
+        {
+            return lhs /= scalar;
+        }
+        private:
+        static constexpr size_type _packs(size_type count) noexcept
+        {
+            return (count + lanes - 1)/lanes;
+        }
+
+        static constexpr size_type _index(size_type b, size_type r, size_type c) noexcept
+        {
+            return (b/lanes)*packSize + (r*numCols() + c)*lanes + b % lanes;
+        }
+
+        //Zeros the unused lanes of the last pack, so padding never holds
+        //values that are slow to compute with
+        void _clearPadding() noexcept
+        {
+            if (_count % lanes == 0)
+                return;
+            _Tp* last = _data.data() + (packs() - 1)*packSize;
+            for(size_type e = 0; e < packSize/lanes; ++e)
+                std::fill(last + e*lanes + _count % lanes, last + (e + 1)*lanes, _Tp{});
+        }
+
+        matrix_batch& _apply(const matrix_batch& other, _SimdOp op)
+        {
+            if (other._count != _count)
+                throw std::invalid_argument("Batch sizes do not match!");
+            LIMNO_INSTRUMENT_OPERATION("batchElementwise", _data.size(), 3*_data.size()*sizeof(_Tp));
+            _simdKernels<_Tp>().binary[static_cast<size_t>(op)](_data.data(), other._data.data(), _data.data(), _data.size());
+            return *this;
+        }
+
+        matrix_batch& _apply(_Tp scalar, _SimdOp op) noexcept
+        {
+            LIMNO_INSTRUMENT_OPERATION("batchElementwise", _data.size(), 2*_data.size()*sizeof(_Tp));
+            _simdKernels<_Tp>().binaryScalarRhs[static_cast<size_t>(op)](_data.data(), scalar, _data.data(), _data.size());
+            return *this;
+        }
+
+        size_type _count{};
+        std::vector<_Tp, _DefaultInitAllocator<_AllocTp>> _data;
+    };
+
+    //Runs f(firstPack, lastPack) over the packs of a batch; under Limno::par
+    //the packs are split into chunks on the thread pool, sized by the
+    //operations each pack costs
+    template<typename _PolicyTp, typename _FuncTp>
+    void _batchPacks(size_t packs, size_t workPerPack, _FuncTp f)
+    {
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+            _parallelChunks(_partition(packs, 1, 0, std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/workPerPack)), f);
+        else
+            f(size_t{0}, packs);
+    }
+
+    //Product of each pair of matrices of two batches of the same size
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _M, int _K, int _N, typename _AllocTp1, typename _AllocTp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _M, int _K, int _N, typename _AllocTp1, typename _AllocTp2,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    matrix_batch<_Tp, _M, _N, _AllocTp1> matmul(_PolicyTp&&, const matrix_batch<_Tp, _M, _K, _AllocTp1>& lhs,
+        const matrix_batch<_Tp, _K, _N, _AllocTp2>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            throw std::invalid_argument("Batch sizes do not match!");
+        LIMNO_INSTRUMENT_OPERATION("batchMatmul", 2.0*lhs.size()*_M*_K*_N, lhs.size()*static_cast<size_t>(_M*_K + _K*_N + _M*_N)*sizeof(_Tp));
+        matrix_batch<_Tp, _M, _N, _AllocTp1> result(Limno::uninitialized, lhs.size());
+        static const _batch_product_fn<_Tp, _M, _K, _N> kernel = _batchProductFor<_Tp, _M, _K, _N>(simdIsa());
+        constexpr size_t lanes = _batchLanes<_Tp>;
+        _batchPacks<_PolicyTp>(lhs.packs(), static_cast<size_t>(_M*_K*_N)*lanes, [&](size_t first, size_t last)
+        {
+            kernel(lhs.data() + first*_M*_K*lanes, rhs.data() + first*_K*_N*lanes, result.data() + first*_M*_N*lanes, last - first);
+        });
+        return result;
+    }
+
+    template<typename _Tp, int _M, int _K, int _N, typename _AllocTp1, typename _AllocTp2>
+    matrix_batch<_Tp, _M, _N, _AllocTp1> matmul(const matrix_batch<_Tp, _M, _K, _AllocTp1>& lhs,
+        const matrix_batch<_Tp, _K, _N, _AllocTp2>& rhs)
+    {
+        return matmul(Limno::seq, lhs, rhs);
+    }
+
+    //Runs kernel(firstPack, lastPack, count) over the packs of a batch of
+    //count matrices, where count is the number of real matrices from
+    //firstPack on, and throws if any call reports a singular matrix
+    template<typename _PolicyTp, typename _Tp, typename _KernelTp>
+    void _batchSolve(size_t packs, size_t count, size_t workPerPack, _KernelTp kernel)
+    {
+        static_assert(std::is_floating_point_v<_Tp>, "Batched solves require a floating point type!");
+        constexpr size_t lanes = _batchLanes<_Tp>;
+        std::atomic<bool> regular{true};
+        _batchPacks<_PolicyTp>(packs, workPerPack, [&](size_t first, size_t last)
+        {
+            if (!kernel(first, last, count - std::min(count, first*lanes)))
+                regular.store(false, std::memory_order_relaxed);
+        });
+        if (!regular.load(std::memory_order_relaxed))
+            throw std::invalid_argument("Matrix is singular!");
+    }
+
+    //Inverse of each matrix of a batch
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _N, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _N, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    matrix_batch<_Tp, _N, _N, _AllocTp> inverse(_PolicyTp&&, const matrix_batch<_Tp, _N, _N, _AllocTp>& a)
+    {
+        LIMNO_INSTRUMENT_OPERATION("batchInverse", 2.0*a.size()*_N*_N*_N, 2*a.size()*static_cast<size_t>(_N*_N)*sizeof(_Tp));
+        matrix_batch<_Tp, _N, _N, _AllocTp> result(Limno::uninitialized, a.size());
+        static const _batch_inverse_fn<_Tp, _N> kernel = _batchInverseFor<_Tp, _N>(simdIsa());
+        constexpr size_t packSize = matrix_batch<_Tp, _N, _N, _AllocTp>::packSize;
+        _batchSolve<_PolicyTp, _Tp>(a.packs(), a.size(), static_cast<size_t>(2*_N)*packSize, [&](size_t first, size_t last, size_t count)
+        {
+            return kernel(a.data() + first*packSize, result.data() + first*packSize, last - first, count);
+        });
+        return result;
+    }
+
+    template<typename _Tp, int _N, typename _AllocTp>
+    matrix_batch<_Tp, _N, _N, _AllocTp> inverse(const matrix_batch<_Tp, _N, _N, _AllocTp>& a)
+    {
+        return inverse(Limno::seq, a);
+    }
+
+    //Solution x of a x = b for each pair of matrices of two batches
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _N, int _K, typename _AllocTp1, typename _AllocTp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _N, int _K, typename _AllocTp1, typename _AllocTp2,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    matrix_batch<_Tp, _N, _K, _AllocTp2> solve(_PolicyTp&&, const matrix_batch<_Tp, _N, _N, _AllocTp1>& a,
+        const matrix_batch<_Tp, _N, _K, _AllocTp2>& b)
+    {
+        if (a.size() != b.size())
+            throw std::invalid_argument("Batch sizes do not match!");
+        LIMNO_INSTRUMENT_OPERATION("batchSolve", a.size()*(2.0/3.0*_N*_N*_N + 2.0*_N*_N*_K), a.size()*static_cast<size_t>(_N*_N + 2*_N*_K)*sizeof(_Tp));
+        matrix_batch<_Tp, _N, _K, _AllocTp2> result(Limno::uninitialized, b.size());
+        static const _batch_solve_fn<_Tp, _N, _K> kernel = _batchSolveFor<_Tp, _N, _K>(simdIsa());
+        constexpr size_t lhsPack = matrix_batch<_Tp, _N, _N, _AllocTp1>::packSize;
+        constexpr size_t rhsPack = matrix_batch<_Tp, _N, _K, _AllocTp2>::packSize;
+        _batchSolve<_PolicyTp, _Tp>(a.packs(), a.size(), static_cast<size_t>(_N + _K)*lhsPack, [&](size_t first, size_t last, size_t count)
+        {
+            return kernel(a.data() + first*lhsPack, b.data() + first*rhsPack, result.data() + first*rhsPack, last - first, count);
+        });
+        return result;
+    }
+
+    template<typename _Tp, int _N, int _K, typename _AllocTp1, typename _AllocTp2>
+    matrix_batch<_Tp, _N, _K, _AllocTp2> solve(const matrix_batch<_Tp, _N, _N, _AllocTp1>& a,
+        const matrix_batch<_Tp, _N, _K, _AllocTp2>& b)
+    {
+        return solve(Limno::seq, a, b);
+    }
+}
+
+#endif
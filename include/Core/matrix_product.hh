@@ -0,0 +1,483 @@
+#ifndef MATRIX_PRODUCT_HH
+#define MATRIX_PRODUCT_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+#include "Core/aligned_allocator.hh"
+#include "Core/execution.hh"
+#include "Core/instrumentation.hh"
+#include "Core/matrix_base.hh"
+#include "Core/shape.hh"
+#include "Core/small_matrix.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Blocking parameters of the packed GEMM kernel. The micro-kernel keeps an
+    //MR x NR tile of C in registers, a packed MC x KC block of A is sized for
+    //L2 and a packed KC x NC panel of B for L3
+    template<typename _Tp>
+    struct _GemmBlocking
+    {
+        static constexpr size_t MR = 4;
+        static constexpr size_t NR = (sizeof(_Tp) >= 32) ? 1 : 32/sizeof(_Tp);
+        static constexpr size_t KC = 256;
+        static constexpr size_t MC = std::max(MR, (128*1024/(KC*sizeof(_Tp)))/MR*MR);
+        static constexpr size_t NC = std::max(NR, (4*1024*1024/(KC*sizeof(_Tp)))/NR*NR);
+        //Below this many multiply-adds packing costs more than it saves
+        static constexpr size_t smallProduct = 48*48*48;
+    };
+
+    //Per-thread scratch space for packed operands, reused across calls so the
+    //kernel doesn't allocate on every product
+    template<typename _Tp, int _Id>
+    _Tp* _gemmBuffer(size_t size)
+    {
+        thread_local std::vector<_Tp, aligned_allocator<_Tp>> buffer;
+        if (buffer.size() < size)
+            buffer.resize(size);
+        return buffer.data();
+    }
+
+    //Packs an mc x kc block of A into slivers of MR rows stored k-major, padding
+    //the last sliver with zeros. rsa and csa are the row and column strides of A
+    template<typename _Tp>
+    void _gemmPackA(size_t mc, size_t kc, const _Tp* a, std::ptrdiff_t rsa, std::ptrdiff_t csa, _Tp* packed) noexcept
+    {
+        constexpr size_t MR = _GemmBlocking<_Tp>::MR;
+        for(size_t i = 0; i < mc; i += MR)
+        {
+            const size_t mr = std::min(MR, mc - i);
+            for(size_t k = 0; k < kc; ++k)
+            {
+                const _Tp* col = a + static_cast<std::ptrdiff_t>(i)*rsa + static_cast<std::ptrdiff_t>(k)*csa;
+                size_t ii = 0;
+                for(; ii < mr; ++ii)
+                    *packed++ = col[static_cast<std::ptrdiff_t>(ii)*rsa];
+                for(; ii < MR; ++ii)
+                    *packed++ = _Tp{};
+            }
+        }
+    }
+
+    //Packs a kc x nc panel of B into slivers of NR columns stored k-major, padding
+    //the last sliver with zeros. rsb and csb are the row and column strides of B
+    template<typename _Tp>
+    void _gemmPackB(size_t kc, size_t nc, const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb, _Tp* packed) noexcept
+    {
+        constexpr size_t NR = _GemmBlocking<_Tp>::NR;
+        for(size_t j = 0; j < nc; j += NR)
+        {
+            const size_t nr = std::min(NR, nc - j);
+            for(size_t k = 0; k < kc; ++k)
+            {
+                const _Tp* row = b + static_cast<std::ptrdiff_t>(k)*rsb + static_cast<std::ptrdiff_t>(j)*csb;
+                size_t jj = 0;
+                if (csb == 1)
+                {
+                    for(; jj < nr; ++jj)
+                        *packed++ = row[jj];
+                }
+                else 
+                {
+                    for(; jj < nr; ++jj)
+                        *packed++ = row[static_cast<std::ptrdiff_t>(jj)*csb];
+                }
+                for(; jj < NR; ++jj)
+                    *packed++ = _Tp{};
+            }
+        }
+    }
+
+    //C[0:mr, 0:nr] += alpha*A*B for one sliver of packed A and B. The full
+    //MR x NR tile is always computed so the inner loops have constant trip
+    //counts and stay in registers; only the write back is clipped
+    template<typename _Tp>
+    void _gemmMicroKernel(size_t kc, _Tp alpha, const _Tp* a, const _Tp* b, _Tp* c, 
+        std::ptrdiff_t rsc, std::ptrdiff_t csc, size_t mr, size_t nr) noexcept
+    {
+        constexpr size_t MR = _GemmBlocking<_Tp>::MR;
+        constexpr size_t NR = _GemmBlocking<_Tp>::NR;
+
+        _Tp acc[MR][NR] = {};
+        for(size_t k = 0; k < kc; ++k)
+        {
+            const _Tp* ak = a + k*MR;
+            const _Tp* bk = b + k*NR;
+            for(size_t i = 0; i < MR; ++i)
+            {
+                const _Tp ai = ak[i];
+                for(size_t j = 0; j < NR; ++j)
+                    acc[i][j] += ai*bk[j];
+            }
+        }
+
+        for(size_t i = 0; i < mr; ++i)
+        {
+            _Tp* row = c + static_cast<std::ptrdiff_t>(i)*rsc;
+            for(size_t j = 0; j < nr; ++j)
+                row[static_cast<std::ptrdiff_t>(j)*csc] += alpha*acc[i][j];
+        }
+    }
+
+    //General matrix product C = beta*C + alpha*A*B where A is m x k, B is k x n 
+    //and C is m x n. Each operand is described by a pointer to its first element
+    //and its row and column strides, so transposed and sliced views are handled
+    //without copies; dense row-major storage has strides (ld, 1).
+    template<typename _Tp>
+    void _gemm(size_t m, size_t n, size_t k, _Tp alpha, 
+        const _Tp* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+        const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb, 
+        _Tp beta, _Tp* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+    {
+        using blocking = _GemmBlocking<_Tp>;
+        using index = std::ptrdiff_t;
+
+        for(size_t i = 0; i < m; ++i)
+        {
+            _Tp* row = c + static_cast<index>(i)*rsc;
+            for(size_t j = 0; j < n; ++j)
+            {
+                if (beta == _Tp{})
+                    row[static_cast<index>(j)*csc] = _Tp{};
+                else if (beta != _Tp{1})
+                    row[static_cast<index>(j)*csc] *= beta;
+            }
+        }
+
+        if (m == 0 || n == 0 || k == 0 || alpha == _Tp{})
+            return;
+
+        if (m*n*k <= blocking::smallProduct)
+        {
+            //i-k-j order keeps the innermost loop unit-stride over B and C when
+            //they are row-major
+            for(size_t i = 0; i < m; ++i)
+            {
+                _Tp* cRow = c + static_cast<index>(i)*rsc;
+                for(size_t p = 0; p < k; ++p)
+                {
+                    const _Tp aip = alpha*a[static_cast<index>(i)*rsa + static_cast<index>(p)*csa];
+                    const _Tp* bRow = b + static_cast<index>(p)*rsb;
+                    for(size_t j = 0; j < n; ++j)
+                        cRow[static_cast<index>(j)*csc] += aip*bRow[static_cast<index>(j)*csb];
+                }
+            }
+            return;
+        }
+
+        _Tp* aPacked = _gemmBuffer<_Tp, 0>(blocking::MC*blocking::KC);
+        _Tp* bPacked = _gemmBuffer<_Tp, 1>(blocking::KC*blocking::NC);
+
+        for(size_t jc = 0; jc < n; jc += blocking::NC)
+        {
+            const size_t nc = std::min(blocking::NC, n - jc);
+            for(size_t pc = 0; pc < k; pc += blocking::KC)
+            {
+                const size_t kc = std::min(blocking::KC, k - pc);
+                _gemmPackB(kc, nc, b + static_cast<index>(pc)*rsb + static_cast<index>(jc)*csb, rsb, csb, bPacked);
+
+                for(size_t ic = 0; ic < m; ic += blocking::MC)
+                {
+                    const size_t mc = std::min(blocking::MC, m - ic);
+                    _gemmPackA(mc, kc, a + static_cast<index>(ic)*rsa + static_cast<index>(pc)*csa, rsa, csa, aPacked);
+
+                    for(size_t jr = 0; jr < nc; jr += blocking::NR)
+                    {
+                        const size_t nr = std::min(blocking::NR, nc - jr);
+                        for(size_t ir = 0; ir < mc; ir += blocking::MR)
+                        {
+                            const size_t mr = std::min(blocking::MR, mc - ir);
+                            _gemmMicroKernel(kc, alpha, aPacked + ir*kc, bPacked + jr*kc,
+                                c + static_cast<index>(ic + ir)*rsc + static_cast<index>(jc + jr)*csc, rsc, csc, mr, nr);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //Work of a GEMM for the instrumentation hooks: every operand is read once
+    //and C written, and read too unless beta is 0
+    inline double _gemmFlops(size_t m, size_t n, size_t k) noexcept
+    {
+        return 2.0*static_cast<double>(m)*static_cast<double>(n)*static_cast<double>(k);
+    }
+
+    template<typename _Tp>
+    double _gemmBytes(size_t m, size_t n, size_t k, bool readsC) noexcept
+    {
+        return static_cast<double>(m*k + k*n + (readsC ? 2 : 1)*m*n)*sizeof(_Tp);
+    }
+
+    //Parallel GEMM. C is split into panels of whole rows, a multiple of MR 
+    //rows tall and, for line-aligned C, a whole number of cache lines long, so
+    //threads never write the same line. Each panel runs the sequential kernel
+    //with the packing buffers of the thread it lands on
+    template<typename _Tp>
+    void _gemm(parallel_policy, size_t m, size_t n, size_t k, _Tp alpha, 
+        const _Tp* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+        const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb, 
+        _Tp beta, _Tp* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+    {
+        LIMNO_INSTRUMENT_OPERATION("gemm", _gemmFlops(m, n, k), _gemmBytes<_Tp>(m, n, k, beta != _Tp{}));
+        using blocking = _GemmBlocking<_Tp>;
+        using index = std::ptrdiff_t;
+
+        //Smallest number of rows, in multiples of MR, spanning whole cache lines
+        size_t quantum = blocking::MR;
+        if (csc == 1 && rsc > 0)
+        {
+            const size_t rowBytes = static_cast<size_t>(rsc)*sizeof(_Tp);
+            while (quantum < 64*blocking::MR && (quantum*rowBytes) % LIMNO_CACHE_LINE != 0)
+                quantum += blocking::MR;
+        }
+        const size_t rowWork = std::max<size_t>(1, n*k);
+        const _Partition panels = _partition(m, quantum, 0, std::max<size_t>(1, blocking::smallProduct/rowWork));
+        if (panels.count() <= 1)
+        {
+            _gemm(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, rsc, csc);
+            return;
+        }
+
+        _parallelChunks(panels, [&](size_t first, size_t last) 
+        {
+            _gemm(last - first, n, k, alpha, a + static_cast<index>(first)*rsa, rsa, csa, 
+                b, rsb, csb, beta, c + static_cast<index>(first)*rsc, rsc, csc);
+        });
+    }
+
+    template<typename _Tp>
+    void _gemm(sequenced_policy, size_t m, size_t n, size_t k, _Tp alpha, 
+        const _Tp* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+        const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb, 
+        _Tp beta, _Tp* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+    {
+        LIMNO_INSTRUMENT_OPERATION("gemm", _gemmFlops(m, n, k), _gemmBytes<_Tp>(m, n, k, beta != _Tp{}));
+        _gemm(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, rsc, csc);
+    }
+
+    //Fully unrolled product used when every extent is known at compile-time
+    //and small. Each element of C is a fold over the shared dimension.
+    template<int _K, int _N, typename _Tp, size_t... _Ks>
+    constexpr _Tp _unrolledDot(const _Tp* a, const _Tp* b, size_t r, size_t c, std::index_sequence<_Ks...>) noexcept
+    {
+        return ((a[r*_K + _Ks]*b[_Ks*_N + c]) + ...);
+    }
+
+    template<int _K, int _N, typename _Tp, size_t... _Is>
+    constexpr void _unrolledProduct(const _Tp* a, const _Tp* b, _Tp* c, std::index_sequence<_Is...>) noexcept
+    {
+        ((c[_Is] = _unrolledDot<_K, _N>(a, b, _Is/_N, _Is % _N, std::make_index_sequence<_K>{})), ...);
+    }
+
+    //True if a product of the given extents uses the unrolled kernel
+    template<int _M, int _K, int _N>
+    static constexpr bool _unrolledProductDim = _smallDim<_M, _K> && _smallDim<_K, _N>;
+
+    //True if the result of a product shares storage with one of its operands.
+    //The kernels overwrite C while they still read A and B, so that is an error
+    template<typename _LhsTp, typename _RhsTp, typename _ResultTp>
+    bool _productAliases(const _LhsTp& lhs, const _RhsTp& rhs, const _ResultTp& result) noexcept
+    {
+        return _sharesStorage(result, lhs) || _sharesStorage(result, rhs);
+    }
+
+    //Computes lhs*rhs into result, which must already have the shape of the
+    //product and must not share storage with lhs or rhs
+    template<typename _Tp,
+        int _Nrows,
+        int _K1,
+        int _K2,
+        int _Ncols,
+        typename _AllocTp1,
+        typename _AllocTp2,
+        typename _AllocTp3>
+    constexpr void matmul(const LimnoMatrixBase<_Tp, _Nrows, _K1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_Tp, _K2, _Ncols, _AllocTp2>& rhs,
+        LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp3>& result)
+    {
+        static_assert(compatibleDim<_K1, _K2>, "Inner matrix dimensions do not match!");
+        if (!LIMNO_IS_CONSTANT_EVALUATED() && _productAliases(lhs, rhs, result))
+            throw std::invalid_argument("Result matrix overlaps an operand!");
+        //The unrolled kernels index every operand as dense, so they are only
+        //used when all extents are static, which also rules out padded rows
+        if constexpr(_unrolledProductDim<_Nrows, _K1, _Ncols> && !runtimeDim<_K2, _Ncols>)
+        {
+            #if LIMNO_SIMD_X86
+            if constexpr(_simd4x4<_Tp, _Nrows, _K1> && _Ncols == 4)
+            {
+                if (!LIMNO_IS_CONSTANT_EVALUATED())
+                {
+                    _simdProduct4x4(lhs.data(), rhs.data(), result.data());
+                    return;
+                }
+            }
+            #endif
+            _unrolledProduct<_K1, _Ncols>(lhs.data(), rhs.data(), result.data(),
+                std::make_index_sequence<static_cast<size_t>(_Nrows*_Ncols)>{});
+        }
+        else
+        {
+            //result shares its static extents with lhs and rhs, so only the
+            //dynamic ones need checking
+            if (!sameDim<_K1, _K2>(lhs.numCols(), rhs.numRows()))
+                throw std::invalid_argument("Inner matrix dimensions do not match!");
+            if (!sameDim<_Nrows, _Nrows>(result.numRows(), lhs.numRows()) || !sameDim<_Ncols, _Ncols>(result.numCols(), rhs.numCols()))
+                throw std::invalid_argument("Result matrix has the wrong dimensions!");
+            _gemm(Limno::seq, lhs.numRows(), rhs.numCols(), lhs.numCols(), _Tp{1},
+                lhs.data(), lhs.rowStride(), lhs.colStride(), rhs.data(), rhs.rowStride(), rhs.colStride(), 
+                _Tp{}, result.data(), result.rowStride(), result.colStride());
+        }
+    }
+
+    //Matrix product. Small matrices with static extents use a fully unrolled
+    //kernel, everything else the cache-blocked kernel
+    template<typename _Tp,
+        int _Nrows,
+        int _K1,
+        int _K2,
+        int _Ncols,
+        typename _AllocTp1,
+        typename _AllocTp2>
+    constexpr LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp1> matmul(const LimnoMatrixBase<_Tp, _Nrows, _K1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_Tp, _K2, _Ncols, _AllocTp2>& rhs)
+    {
+        using result_type = LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp1>;
+        if constexpr(runtimeDim<_Nrows, _Ncols>)
+        {
+            result_type result(_Tp{}, lhs.numRows(), rhs.numCols());
+            matmul(lhs, rhs, result);
+            return result;
+        }
+        else if constexpr(_unrolledProductDim<_Nrows, _K1, _Ncols>)
+        {
+            //Initialized so small products can be evaluated at compile-time
+            result_type result(_Tp{});
+            matmul(lhs, rhs, result);
+            return result;
+        }
+        else
+        {
+            result_type result;
+            matmul(lhs, rhs, result);
+            return result;
+        }
+    }
+
+    //Matrix product using the given execution policy. Under Limno::par the 
+    //rows of the result are split over the thread pool
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _LhsTp, typename _RhsTp, typename _ResultTp> 
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _LhsTp, typename _RhsTp, typename _ResultTp, 
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    void matmul(_PolicyTp&& policy, const _LhsTp& lhs, const _RhsTp& rhs, _ResultTp&& result)
+    {
+        using value_type = _OperandValue_t<_LhsTp>;
+        static_assert(_OperandTraits<_LhsTp>::isMatrix && _OperandTraits<_RhsTp>::isMatrix && 
+            !_isExpr<_LhsTp> && !_isExpr<_RhsTp>, "Operands must be matrices or views!");
+        static_assert(std::is_same_v<value_type, _OperandValue_t<_RhsTp>>, "Matrix types do not match!");
+        static_assert(compatibleDim<_OperandTraits<_LhsTp>::cols, _OperandTraits<_RhsTp>::rows>, 
+            "Inner matrix dimensions do not match!");
+        using result_traits = _OperandTraits<std::decay_t<_ResultTp>>;
+        static_assert(compatibleDim<result_traits::rows, _OperandTraits<_LhsTp>::rows> &&
+            compatibleDim<result_traits::cols, _OperandTraits<_RhsTp>::cols>, "Result matrix has the wrong dimensions!");
+        if (!sameDim<_OperandTraits<_LhsTp>::cols, _OperandTraits<_RhsTp>::rows>(lhs.numCols(), rhs.numRows()))
+            throw std::invalid_argument("Inner matrix dimensions do not match!");
+        if (!sameDim<result_traits::rows, _OperandTraits<_LhsTp>::rows>(result.numRows(), lhs.numRows()) ||
+            !sameDim<result_traits::cols, _OperandTraits<_RhsTp>::cols>(result.numCols(), rhs.numCols()))
+            throw std::invalid_argument("Result matrix has the wrong dimensions!");
+        if (_productAliases(lhs, rhs, result))
+            throw std::invalid_argument("Result matrix overlaps an operand!");
+        _gemm(policy, lhs.numRows(), rhs.numCols(), lhs.numCols(), value_type{1},
+            lhs.data(), lhs.rowStride(), lhs.colStride(), rhs.data(), rhs.rowStride(), rhs.colStride(),
+            value_type{}, result.data(), result.rowStride(), result.colStride());
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _LhsTp, typename _RhsTp> 
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _LhsTp, typename _RhsTp, 
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto matmul(_PolicyTp&& policy, const _LhsTp& lhs, const _RhsTp& rhs)
+    {
+        if constexpr(!_isParallelPolicy<_PolicyTp>)
+        {
+            return matmul(lhs, rhs);
+        }
+        else 
+        {
+            using value_type = _OperandValue_t<_LhsTp>;
+            constexpr int rows = _OperandTraits<_LhsTp>::rows;
+            constexpr int cols = _OperandTraits<_RhsTp>::cols;
+            if constexpr(runtimeDim<rows, cols>)
+            {
+                LimnoMatrixBase<value_type, rows, cols> result(value_type{}, lhs.numRows(), rhs.numCols());
+                matmul(policy, lhs, rhs, result);
+                return result;
+            }
+            else 
+            {
+                LimnoMatrixBase<value_type, rows, cols> result;
+                matmul(policy, lhs, rhs, result);
+                return result;
+            }
+        }
+    }
+
+    //Products involving views, e.g. matmul(a.transpose(), b) or matmul of two 
+    //blocks. The operands are read in place through their strides
+    template<typename _LhsTp, typename _RhsTp>
+    static constexpr bool _isViewProduct = (_isView<_LhsTp> || _isView<_RhsTp>) &&
+        _OperandTraits<_LhsTp>::isMatrix && _OperandTraits<_RhsTp>::isMatrix && !_isExpr<_LhsTp> && !_isExpr<_RhsTp> &&
+        std::is_same_v<_OperandValue_t<_LhsTp>, _OperandValue_t<_RhsTp>>;
+
+    //Computes lhs*rhs into result, which may be a matrix or a mutable view and
+    //must already have the shape of the product without overlapping lhs or rhs
+    #if __cplusplus > 201703L
+    template<typename _LhsTp, typename _RhsTp, typename _ResultTp> 
+        requires (!_isExecutionPolicy<_LhsTp> && (_isViewProduct<_LhsTp, _RhsTp> || _isView<std::remove_cv_t<std::remove_reference_t<_ResultTp>>>))
+    #else
+    template<typename _LhsTp, typename _RhsTp, typename _ResultTp, 
+        std::enable_if_t<!_isExecutionPolicy<_LhsTp> && 
+        (_isViewProduct<_LhsTp, _RhsTp> || _isView<std::remove_cv_t<std::remove_reference_t<_ResultTp>>>), int> = 0>
+    #endif
+    void matmul(const _LhsTp& lhs, const _RhsTp& rhs, _ResultTp&& result)
+    {
+        using value_type = _OperandValue_t<_LhsTp>;
+        if (lhs.numCols() != rhs.numRows())
+            throw std::invalid_argument("Inner matrix dimensions do not match!");
+        if (result.numRows() != lhs.numRows() || result.numCols() != rhs.numCols())
+            throw std::invalid_argument("Result matrix has the wrong dimensions!");
+        if (_productAliases(lhs, rhs, result))
+            throw std::invalid_argument("Result matrix overlaps an operand!");
+        _gemm(Limno::seq, lhs.numRows(), rhs.numCols(), lhs.numCols(), value_type{1},
+            lhs.data(), lhs.rowStride(), lhs.colStride(), rhs.data(), rhs.rowStride(), rhs.colStride(),
+            value_type{}, result.data(), result.rowStride(), result.colStride());
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _LhsTp, typename _RhsTp> requires _isViewProduct<_LhsTp, _RhsTp>
+    #else
+    template<typename _LhsTp, typename _RhsTp, std::enable_if_t<_isViewProduct<_LhsTp, _RhsTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<_OperandValue_t<_LhsTp>, DYNAMIC, DYNAMIC> matmul(const _LhsTp& lhs, const _RhsTp& rhs)
+    {
+        using value_type = _OperandValue_t<_LhsTp>;
+        LimnoMatrixBase<value_type, DYNAMIC, DYNAMIC> result(value_type{}, lhs.numRows(), rhs.numCols());
+        matmul(lhs, rhs, result);
+        return result;
+    }
+}
+
+#endif
@@ -0,0 +1,313 @@
+#ifndef MATRIX_VIEW_HH
+#define MATRIX_VIEW_HH 1
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "config.hh"
+#include "Core/expression_templates.hh"
+#include "Core/shape.hh"
+#include "Core/strided_iterator.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Non-owning window onto matrix storage. Element (r, c) lives at
+    //data[r*rowStride + c*colStride], so rows, columns, blocks, stepped slices
+    //and transposes are all views onto the same memory and never copy. Like
+    //std::span, constness is shallow: use LimnoMatrixView<const T> for read-only
+    //access. Copying a view rebinds it; assigning an expression or calling
+    //assign writes through it.
+    template<typename _Tp>
+    class LimnoMatrixView
+    {
+        public:
+        using value_type = std::remove_cv_t<_Tp>;
+        using element_type = _Tp;
+        using reference = _Tp&;
+        using const_reference = const _Tp&;
+        using pointer = _Tp*;
+        using iterator = _StridedIterator<_Tp>;
+        using const_iterator = _StridedIterator<const _Tp>;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+
+        constexpr LimnoMatrixView() noexcept
+            : _data{nullptr}, _numRows{0}, _numCols{0}, _rowStride{0}, _colStride{1}
+        {
+
+        }
+
+        //View over dense row-major storage
+        constexpr LimnoMatrixView(pointer data, size_type numRows, size_type numCols) noexcept
+            : _data{data}, _numRows{numRows}, _numCols{numCols},
+            _rowStride{static_cast<difference_type>(numCols)}, _colStride{1}
+        {
+
+        }
+
+        constexpr LimnoMatrixView(pointer data, size_type numRows, size_type numCols,
+            difference_type rowStride, difference_type colStride) noexcept
+            : _data{data}, _numRows{numRows}, _numCols{numCols}, _rowStride{rowStride}, _colStride{colStride}
+        {
+
+        }
+
+        //Allows mutable view -> read-only view conversion
+        template<typename _UTp,
+            std::enable_if_t<std::is_same_v<const _UTp, _Tp> && !std::is_same_v<_UTp, _Tp>, int> = 0>
+        constexpr LimnoMatrixView(const LimnoMatrixView<_UTp>& other) noexcept
+            : _data{other.data()}, _numRows{other.numRows()}, _numCols{other.numCols()},
+            _rowStride{other.rowStride()}, _colStride{other.colStride()}
+        {
+
+        }
+
+        //Shape and layout
+        constexpr size_type numRows() const noexcept
+        {
+            return _numRows;
+        }
+
+        constexpr size_type numCols() const noexcept
+        {
+            return _numCols;
+        }
+
+        constexpr size_type size() const noexcept
+        {
+            return _numRows*_numCols;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        constexpr difference_type rowStride() const noexcept
+        {
+            return _rowStride;
+        }
+
+        constexpr difference_type colStride() const noexcept
+        {
+            return _colStride;
+        }
+
+        constexpr pointer data() const noexcept
+        {
+            return _data;
+        }
+
+        //True if the elements are dense and in row-major order
+        constexpr bool isContiguous() const noexcept
+        {
+            return _colStride == 1 && (_numRows <= 1 || _rowStride == static_cast<difference_type>(_numCols));
+        }
+
+        //Element access
+        constexpr reference operator()(size_type r, size_type c) const noexcept
+        {
+            return _data[static_cast<difference_type>(r)*_rowStride + static_cast<difference_type>(c)*_colStride];
+        }
+
+        //Sub-views
+        constexpr LimnoMatrixView row(size_type r) const
+        {
+            return block(r, 0, 1, _numCols);
+        }
+
+        constexpr LimnoMatrixView col(size_type c) const
+        {
+            return block(0, c, _numRows, 1);
+        }
+
+        //numRows x numCols window whose top-left element is (r0, c0)
+        constexpr LimnoMatrixView block(size_type r0, size_type c0, size_type numRows, size_type numCols) const
+        {
+            if (r0 > _numRows || numRows > _numRows - r0 || c0 > _numCols || numCols > _numCols - c0)
+                throw std::out_of_range("Block exceeds matrix dimensions!");
+            return LimnoMatrixView{_data + static_cast<difference_type>(r0)*_rowStride + static_cast<difference_type>(c0)*_colStride,
+                numRows, numCols, _rowStride, _colStride};
+        }
+
+        //Every rowStep-th row in [rowBegin, rowEnd) and every colStep-th column
+        //in [colBegin, colEnd)
+        constexpr LimnoMatrixView slice(size_type rowBegin, size_type rowEnd, size_type rowStep,
+            size_type colBegin, size_type colEnd, size_type colStep) const
+        {
+            if (rowStep == 0 || colStep == 0)
+                throw std::invalid_argument("Slice step must be positive!");
+            if (rowBegin > rowEnd || rowEnd > _numRows || colBegin > colEnd || colEnd > _numCols)
+                throw std::out_of_range("Slice exceeds matrix dimensions!");
+            return LimnoMatrixView{_data + static_cast<difference_type>(rowBegin)*_rowStride + static_cast<difference_type>(colBegin)*_colStride,
+                (rowEnd - rowBegin + rowStep - 1)/rowStep, (colEnd - colBegin + colStep - 1)/colStep,
+                _rowStride*static_cast<difference_type>(rowStep), _colStride*static_cast<difference_type>(colStep)};
+        }
+
+        //Swaps the roles of rows and columns without moving any data
+        constexpr LimnoMatrixView transpose() const noexcept
+        {
+            return LimnoMatrixView{_data, _numCols, _numRows, _colStride, _rowStride};
+        }
+
+        //Traverse in row-major order
+        iterator begin() const noexcept
+        {
+            return iterator{_data, 0, static_cast<difference_type>(_numCols), _colStride, _rowStride};
+        }
+
+        iterator end() const noexcept
+        {
+            return iterator{_data, static_cast<difference_type>(size()), static_cast<difference_type>(_numCols), _colStride, _rowStride};
+        }
+
+        //Traverse in column-major order
+        iterator columnBegin() const noexcept
+        {
+            return iterator{_data, 0, static_cast<difference_type>(_numRows), _rowStride, _colStride};
+        }
+
+        iterator columnEnd() const noexcept
+        {
+            return iterator{_data, static_cast<difference_type>(size()), static_cast<difference_type>(_numRows), _rowStride, _colStride};
+        }
+
+        //Writes the elements of a matrix, view or expression with the same shape
+        //through the view. The source must not overlap the view unless every
+        //element only depends on the element at the same position
+        template<typename _SrcTp>
+        const LimnoMatrixView& assign(const _SrcTp& src) const
+        {
+            static_assert(!std::is_const_v<_Tp>, "Cannot assign through a read-only view!");
+            static_assert(_OperandTraits<_SrcTp>::isMatrix, "Source must be a matrix, view or expression!");
+            if (src.numRows() != _numRows || src.numCols() != _numCols)
+                throw std::invalid_argument("Matrix dimensions do not match!");
+            for(size_type r = 0; r < _numRows; ++r)
+            {
+                pointer row = _data + static_cast<difference_type>(r)*_rowStride;
+                for(size_type c = 0; c < _numCols; ++c)
+                    row[static_cast<difference_type>(c)*_colStride] = static_cast<value_type>(src(r, c));
+            }
+            return *this;
+        }
+
+        //Fills every element of the view
+        const LimnoMatrixView& fill(const value_type& value) const
+        {
+            static_assert(!std::is_const_v<_Tp>, "Cannot assign through a read-only view!");
+            for(size_type r = 0; r < _numRows; ++r)
+                for(size_type c = 0; c < _numCols; ++c)
+                    (*this)(r, c) = value;
+            return *this;
+        }
+
+        template<typename _Callable, typename... _ArgsTp>
+        const LimnoMatrixView& operator=(const _Expr<_Callable, _ArgsTp...>& expr) const
+        {
+            return assign(expr);
+        }
+
+        #if __cplusplus > 201703L
+        template<typename _OperandTp> requires _isOperand<_OperandTp>
+        #else
+        template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+        #endif
+        const LimnoMatrixView& operator+=(const _OperandTp& other) const
+        {
+            return assign(*this + other);
+        }
+
+        #if __cplusplus > 201703L
+        template<typename _OperandTp> requires _isOperand<_OperandTp>
+        #else
+        template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+        #endif
+        const LimnoMatrixView& operator-=(const _OperandTp& other) const
+        {
+            return assign(*this - other);
+        }
+
+        #if __cplusplus > 201703L
+        template<typename _OperandTp> requires _isOperand<_OperandTp>
+        #else
+        template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+        #endif
+        const LimnoMatrixView& operator*=(const _OperandTp& other) const
+        {
+            return assign(*this * other);
+        }
+
+        #if __cplusplus > 201703L
+        template<typename _OperandTp> requires _isOperand<_OperandTp>
+        #else
+        template<typename _OperandTp, std::enable_if_t<_isOperand<_OperandTp>, int> = 0>
+        #endif
+        const LimnoMatrixView& operator/=(const _OperandTp& other) const
+        {
+            return assign(*this / other);
+        }
+        private:
+        pointer _data;
+        size_type _numRows;
+        size_type _numCols;
+        difference_type _rowStride;
+        difference_type _colStride;
+    };
+
+    template<typename _Tp>
+    static constexpr bool _isView = false;
+
+    template<typename _Tp>
+    constexpr bool _isView<LimnoMatrixView<_Tp>> = true;
+
+    //Lowest and highest addresses of the elements of a non-empty matrix or view
+    template<typename _MatTp>
+    std::pair<const void*, const void*> _addressRange(const _MatTp& m) noexcept
+    {
+        const std::ptrdiff_t rowSpan = static_cast<std::ptrdiff_t>(m.numRows() - 1)*m.rowStride();
+        const std::ptrdiff_t colSpan = static_cast<std::ptrdiff_t>(m.numCols() - 1)*m.colStride();
+        const auto* first = m.data();
+        return {first + std::min<std::ptrdiff_t>(rowSpan, 0) + std::min<std::ptrdiff_t>(colSpan, 0),
+            first + std::max<std::ptrdiff_t>(rowSpan, 0) + std::max<std::ptrdiff_t>(colSpan, 0)};
+    }
+
+    //True if the address ranges of two matrices or views overlap. Kernels that
+    //overwrite their output while still reading their inputs reject that
+    template<typename _ATp, typename _BTp>
+    bool _sharesStorage(const _ATp& a, const _BTp& b) noexcept
+    {
+        if (a.numRows() == 0 || a.numCols() == 0 || b.numRows() == 0 || b.numCols() == 0)
+            return false;
+        const auto ra = _addressRange(a);
+        const auto rb = _addressRange(b);
+        return !std::less<const void*>{}(ra.second, rb.first) && !std::less<const void*>{}(rb.second, ra.first);
+    }
+
+    //Views are small and usually temporaries, so expressions hold them by value
+    template<typename _Tp>
+    struct _OperandTraits<LimnoMatrixView<_Tp>>
+    {
+        using view_type = LimnoMatrixView<_Tp>;
+        using value_type = std::remove_cv_t<_Tp>;
+        static constexpr bool isMatrix = true;
+        static constexpr bool storedByValue = true;
+        static constexpr bool contiguous = false;
+        static constexpr int rows = DYNAMIC;
+        static constexpr int cols = DYNAMIC;
+
+        static constexpr const _Tp& at(const view_type& v, size_t i) noexcept
+        {
+            return v(i/v.numCols(), i % v.numCols());
+        }
+
+        static constexpr const _Tp& at(const view_type& v, size_t r, size_t c) noexcept
+        {
+            return v(r, c);
+        }
+    };
+}
+
+#endif
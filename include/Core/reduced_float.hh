@@ -0,0 +1,170 @@
+#ifndef REDUCED_FLOAT_HH
+#define REDUCED_FLOAT_HH 1
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+
+#include "config.hh"
+
+//16-bit floating point element types. They only change how elements are
+//stored: values convert implicitly to float, so arithmetic on them is done
+//in float, and converting back rounds to nearest even
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    inline std::uint32_t _floatBits(float f) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+
+    inline float _bitsFloat(std::uint32_t bits) noexcept
+    {
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    //IEEE 754 binary16: 5 exponent bits and 10 mantissa bits. Overflow gives
+    //infinity and NaNs stay (quiet) NaNs
+    struct _Binary16
+    {
+        static std::uint16_t narrow(float f) noexcept
+        {
+            constexpr std::uint32_t infinity = 255u << 23;
+            constexpr std::uint32_t overflow = (127u + 16) << 23;
+            constexpr std::uint32_t smallestNormal = 113u << 23;
+            //Adding this moves the subnormal mantissa bits to the bottom of the
+            //float, letting the FPU do the rounding
+            constexpr std::uint32_t subnormalMagic = ((127u - 15) + (23 - 10) + 1) << 23;
+
+            std::uint32_t bits = _floatBits(f);
+            const std::uint32_t sign = bits & 0x80000000u;
+            bits ^= sign;
+            std::uint32_t result;
+            if (bits >= overflow)
+                result = (bits > infinity) ? 0x7E00u : 0x7C00u;
+            else if (bits < smallestNormal)
+                result = _floatBits(_bitsFloat(bits) + _bitsFloat(subnormalMagic)) - subnormalMagic;
+            else
+            {
+                const std::uint32_t odd = (bits >> 13) & 1u;
+                bits += ((15u - 127u) << 23) + 0xFFFu + odd;
+                result = bits >> 13;
+            }
+            return static_cast<std::uint16_t>(result | (sign >> 16));
+        }
+
+        static float widen(std::uint16_t h) noexcept
+        {
+            constexpr std::uint32_t exponentMask = 0x7C00u << 13;
+            std::uint32_t bits = (h & 0x7FFFu) << 13;
+            const std::uint32_t exponent = bits & exponentMask;
+            bits += (127u - 15u) << 23;
+            if (exponent == exponentMask)
+                bits += (128u - 16u) << 23;
+            else if (exponent == 0)
+            {
+                //Subnormal or zero; renormalized by the FPU
+                bits += 1u << 23;
+                bits = _floatBits(_bitsFloat(bits) - _bitsFloat(113u << 23));
+            }
+            return _bitsFloat(bits | (static_cast<std::uint32_t>(h & 0x8000u) << 16));
+        }
+    };
+
+    //bfloat16: the top half of a float, with the full float exponent range
+    //and 7 mantissa bits
+    struct _Bfloat16
+    {
+        static std::uint16_t narrow(float f) noexcept
+        {
+            const std::uint32_t bits = _floatBits(f);
+            if ((bits & 0x7FFFFFFFu) > 0x7F800000u)
+                return static_cast<std::uint16_t>((bits >> 16) | 0x40u);
+            return static_cast<std::uint16_t>((bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16);
+        }
+
+        static float widen(std::uint16_t b) noexcept
+        {
+            return _bitsFloat(static_cast<std::uint32_t>(b) << 16);
+        }
+    };
+
+    //16-bit float stored in the given format. Like the built-in types it is
+    //left uninitialized by default construction
+    template<typename _FormatTp>
+    class _ReducedFloat
+    {
+        public:
+        using format_type = _FormatTp;
+
+        _ReducedFloat() noexcept = default;
+
+        _ReducedFloat(float f) noexcept
+            : _bits{_FormatTp::narrow(f)}
+        {
+
+        }
+
+        operator float() const noexcept
+        {
+            return _FormatTp::widen(_bits);
+        }
+
+        static _ReducedFloat fromBits(std::uint16_t bits) noexcept
+        {
+            _ReducedFloat result;
+            result._bits = bits;
+            return result;
+        }
+
+        std::uint16_t bits() const noexcept
+        {
+            return _bits;
+        }
+
+        //Compound assignment computes in float and rounds once
+        _ReducedFloat& operator+=(float f) noexcept
+        {
+            return *this = static_cast<float>(*this) + f;
+        }
+
+        _ReducedFloat& operator-=(float f) noexcept
+        {
+            return *this = static_cast<float>(*this) - f;
+        }
+
+        _ReducedFloat& operator*=(float f) noexcept
+        {
+            return *this = static_cast<float>(*this)*f;
+        }
+
+        _ReducedFloat& operator/=(float f) noexcept
+        {
+            return *this = static_cast<float>(*this)/f;
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, _ReducedFloat f)
+        {
+            return os << static_cast<float>(f);
+        }
+        private:
+        std::uint16_t _bits;
+    };
+
+    using float16 = _ReducedFloat<_Binary16>;
+    using bfloat16 = _ReducedFloat<_Bfloat16>;
+
+    static_assert(sizeof(float16) == 2 && std::is_trivially_copyable_v<float16>, "float16 must be a 16-bit trivial type!");
+
+    template<typename _Tp>
+    static constexpr bool _isReducedFloat = false;
+
+    template<typename _FormatTp>
+    static constexpr bool _isReducedFloat<_ReducedFloat<_FormatTp>> = true;
+}
+
+#endif
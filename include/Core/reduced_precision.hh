@@ -0,0 +1,748 @@
+#ifndef REDUCED_PRECISION_HH
+#define REDUCED_PRECISION_HH 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "config.hh"
+#include "Core/construction.hh"
+#include "Core/execution.hh"
+#include "Core/instrumentation.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/reduced_float.hh"
+#include "Core/reductions.hh"
+#include "Core/shape.hh"
+#include "Core/simd.hh"
+
+//Kernels for matrices stored in reduced precision: float16 and bfloat16,
+//which halve the storage of float, and int8 with a scale and zero point,
+//which quarters it. Storage is the only thing that loses precision. Sums,
+//dot products and products widen their inputs a block at a time and
+//accumulate in float, or in int32 for int8
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Affine mapping between int8 values and reals: real = scale*(q - zeroPoint)
+    struct quantization
+    {
+        float scale = 1.0f;
+        std::int32_t zeroPoint = 0;
+    };
+
+    //Throws std::invalid_argument unless q has a positive scale and a zero
+    //point representable in int8
+    inline void _checkQuantization(quantization q)
+    {
+        if (!(q.scale > 0.0f) || q.zeroPoint < -128 || q.zeroPoint > 127)
+            throw std::invalid_argument("Invalid quantization!");
+    }
+
+    //Elements widened to float at a time by the reductions; fits in L1
+    static constexpr size_t _widenChunk = 1024;
+
+    //Depth and width of the int8 product panels of B: 128 pairs of rows of
+    //256 int16, 128KB, which stays in L2 while every row of A streams past
+    static constexpr size_t _quantizedKc = 256;
+    static constexpr size_t _quantizedNc = 256;
+    //Depth over which products of int8 values less their zero points, at
+    //most 255*255 in magnitude, can be summed in int32 without overflowing
+    static constexpr size_t _quantizedSafeDepth = static_cast<size_t>(std::numeric_limits<std::int32_t>::max()/(255*255));
+
+    template<typename _FormatTp>
+    struct _ReducedKernels
+    {
+        void (*widen)(const _ReducedFloat<_FormatTp>*, float*, size_t);
+        void (*narrow)(const float*, _ReducedFloat<_FormatTp>*, size_t);
+    };
+
+    struct _QuantizedKernels
+    {
+        void (*quantize)(const float*, std::int8_t*, size_t, float, std::int32_t);
+        void (*dequantize)(const std::int8_t*, float*, size_t, float, std::int32_t);
+        //c[i][j] += sum over q of the products of the pair q of row i of a
+        //with the pair q of column j of the panel, for an m x n block of c
+        void (*product)(size_t, size_t, size_t, const std::int16_t*, const std::int16_t*, std::int32_t*, size_t);
+    };
+
+    namespace _scalar
+    {
+        template<typename _FormatTp>
+        void _widen(const _ReducedFloat<_FormatTp>* src, float* dst, size_t n) noexcept
+        {
+            for(size_t i = 0; i < n; ++i)
+                dst[i] = src[i];
+        }
+
+        template<typename _FormatTp>
+        void _narrow(const float* src, _ReducedFloat<_FormatTp>* dst, size_t n) noexcept
+        {
+            for(size_t i = 0; i < n; ++i)
+                dst[i] = src[i];
+        }
+
+        //Clamped in float first, with NaN going to the bottom of the range as
+        //in the vector kernels, so the conversion can't overflow
+        inline std::int8_t _quantizeOne(float x, float inverseScale, float zeroPoint) noexcept
+        {
+            float v = x*inverseScale + zeroPoint;
+            v = (v > -128.0f) ? v : -128.0f;
+            v = (v < 127.0f) ? v : 127.0f;
+            return static_cast<std::int8_t>(std::lrint(v));
+        }
+
+        inline void _quantize(const float* src, std::int8_t* dst, size_t n, float scale, std::int32_t zeroPoint) noexcept
+        {
+            const float inverseScale = 1.0f/scale;
+            for(size_t i = 0; i < n; ++i)
+                dst[i] = _quantizeOne(src[i], inverseScale, static_cast<float>(zeroPoint));
+        }
+
+        inline void _dequantize(const std::int8_t* src, float* dst, size_t n, float scale, std::int32_t zeroPoint) noexcept
+        {
+            for(size_t i = 0; i < n; ++i)
+                dst[i] = static_cast<float>(src[i] - zeroPoint)*scale;
+        }
+
+        inline void _quantizedProduct(size_t m, size_t n, size_t pairs, const std::int16_t* a, const std::int16_t* panel,
+            std::int32_t* c, size_t ldc) noexcept
+        {
+            for(size_t i = 0; i < m; ++i)
+            {
+                const std::int16_t* ai = a + i*2*pairs;
+                std::int32_t* ci = c + i*ldc;
+                for(size_t q = 0; q < pairs; ++q)
+                {
+                    const std::int32_t a0 = ai[2*q];
+                    const std::int32_t a1 = ai[2*q + 1];
+                    const std::int16_t* pq = panel + q*2*n;
+                    for(size_t j = 0; j < n; ++j)
+                        ci[j] += a0*pq[2*j] + a1*pq[2*j + 1];
+                }
+            }
+        }
+    }
+
+    #if LIMNO_SIMD_X86
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("avx2,f16c"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("avx2,f16c")
+    #endif
+    namespace _avx2
+    {
+        //8 elements per step; the tails go through the scalar conversions
+        inline void _widenHalf(const float16* src, float* dst, size_t n) noexcept
+        {
+            size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+                _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+            _scalar::_widen(src + i, dst + i, n - i);
+        }
+
+        inline void _narrowHalf(const float* src, float16* dst, size_t n) noexcept
+        {
+            size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+            _scalar::_narrow(src + i, dst + i, n - i);
+        }
+
+        inline void _widenBfloat(const bfloat16* src, float* dst, size_t n) noexcept
+        {
+            size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+            {
+                const __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16)));
+            }
+            _scalar::_widen(src + i, dst + i, n - i);
+        }
+
+        //Rounds to nearest even by adding 0x7FFF plus the lowest kept bit;
+        //NaNs are truncated and made quiet instead
+        inline void _narrowBfloat(const float* src, bfloat16* dst, size_t n) noexcept
+        {
+            const __m256i bias = _mm256_set1_epi32(0x7FFF);
+            const __m256i one = _mm256_set1_epi32(1);
+            const __m256i quiet = _mm256_set1_epi32(0x40);
+            size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+            {
+                const __m256 v = _mm256_loadu_ps(src + i);
+                const __m256i bits = _mm256_castps_si256(v);
+                const __m256i high = _mm256_srli_epi32(bits, 16);
+                const __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(bits, bias), _mm256_and_si256(high, one)), 16);
+                const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+                const __m256i result = _mm256_blendv_epi8(rounded, _mm256_or_si256(high, quiet), nan);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                    _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1)));
+            }
+            _scalar::_narrow(src + i, dst + i, n - i);
+        }
+
+        //32 elements per step, rounded to nearest even by the conversion and
+        //narrowed with saturating packs
+        inline void _quantize(const float* src, std::int8_t* dst, size_t n, float scale, std::int32_t zeroPoint) noexcept
+        {
+            const float inverseScale = 1.0f/scale;
+            const __m256 inv = _mm256_set1_ps(inverseScale);
+            const __m256 zero = _mm256_set1_ps(static_cast<float>(zeroPoint));
+            const __m256 lo = _mm256_set1_ps(-128.0f);
+            const __m256 hi = _mm256_set1_ps(127.0f);
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            auto convert = [&](const float* p) noexcept
+            {
+                const __m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(p), inv), zero);
+                return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+            };
+            size_t i = 0;
+            for(; i + 32 <= n; i += 32)
+            {
+                const __m256i ab = _mm256_packs_epi32(convert(src + i), convert(src + i + 8));
+                const __m256i cd = _mm256_packs_epi32(convert(src + i + 16), convert(src + i + 24));
+                const __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(ab, cd), order);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), bytes);
+            }
+            for(; i < n; ++i)
+                dst[i] = _scalar::_quantizeOne(src[i], inverseScale, static_cast<float>(zeroPoint));
+        }
+
+        inline void _dequantize(const std::int8_t* src, float* dst, size_t n, float scale, std::int32_t zeroPoint) noexcept
+        {
+            const __m256 s = _mm256_set1_ps(scale);
+            const __m256i zero = _mm256_set1_epi32(zeroPoint);
+            size_t i = 0;
+            for(; i + 8 <= n; i += 8)
+            {
+                std::int64_t packed;
+                std::memcpy(&packed, src + i, sizeof(packed));
+                const __m256i wide = _mm256_sub_epi32(_mm256_cvtepi8_epi32(_mm_cvtsi64_si128(packed)), zero);
+                _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(wide), s));
+            }
+            _scalar::_dequantize(src + i, dst + i, n - i, scale, zeroPoint);
+        }
+
+        //Each step multiplies a broadcast pair of A by 8 pairs of the panel
+        //and adds both products into int32 lanes with one vpmaddwd. 32
+        //columns of a row of C stay in registers for the whole panel depth
+        inline void _quantizedProduct(size_t m, size_t n, size_t pairs, const std::int16_t* a, const std::int16_t* panel,
+            std::int32_t* c, size_t ldc) noexcept
+        {
+            for(size_t i = 0; i < m; ++i)
+            {
+                const std::int16_t* ai = a + i*2*pairs;
+                std::int32_t* ci = c + i*ldc;
+                auto pairOf = [ai](size_t q) noexcept
+                {
+                    std::int32_t pair;
+                    std::memcpy(&pair, ai + 2*q, sizeof(pair));
+                    return _mm256_set1_epi32(pair);
+                };
+                size_t j = 0;
+                for(; j + 32 <= n; j += 32)
+                {
+                    __m256i acc[4];
+                    for(size_t v = 0; v < 4; ++v)
+                        acc[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ci + j + 8*v));
+                    for(size_t q = 0; q < pairs; ++q)
+                    {
+                        const __m256i pair = pairOf(q);
+                        const std::int16_t* pq = panel + (q*n + j)*2;
+                        for(size_t v = 0; v < 4; ++v)
+                            acc[v] = _mm256_add_epi32(acc[v], _mm256_madd_epi16(pair,
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pq + 16*v))));
+                    }
+                    for(size_t v = 0; v < 4; ++v)
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(ci + j + 8*v), acc[v]);
+                }
+                for(; j + 8 <= n; j += 8)
+                {
+                    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ci + j));
+                    for(size_t q = 0; q < pairs; ++q)
+                        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairOf(q),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(panel + (q*n + j)*2))));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ci + j), acc);
+                }
+                for(; j < n; ++j)
+                    for(size_t q = 0; q < pairs; ++q)
+                        ci[j] += ai[2*q]*panel[(q*n + j)*2] + ai[2*q + 1]*panel[(q*n + j)*2 + 1];
+            }
+        }
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+    #endif // LIMNO_SIMD_X86
+
+    //F16C arrived alongside AVX2 on every x86 CPU that has both, but is a
+    //separate CPUID bit
+    inline bool _hasF16c() noexcept
+    {
+        #if LIMNO_SIMD_X86
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("f16c");
+        #else
+        return false;
+        #endif
+    }
+
+    //Conversion kernels for an instruction set; AVX-512 uses the AVX2 ones,
+    //as the conversions are bound by memory bandwidth
+    template<typename _FormatTp>
+    _ReducedKernels<_FormatTp> _reducedKernelsFor([[maybe_unused]] _SimdIsa isa) noexcept
+    {
+        #if LIMNO_SIMD_X86
+        if (isa >= _SimdIsa::avx2)
+        {
+            if constexpr(std::is_same_v<_FormatTp, _Bfloat16>)
+                return {&_avx2::_widenBfloat, &_avx2::_narrowBfloat};
+            else
+            {
+                if (_hasF16c())
+                    return {&_avx2::_widenHalf, &_avx2::_narrowHalf};
+            }
+        }
+        #endif
+        return {&_scalar::_widen<_FormatTp>, &_scalar::_narrow<_FormatTp>};
+    }
+
+    template<typename _FormatTp>
+    const _ReducedKernels<_FormatTp>& _reducedKernels() noexcept
+    {
+        static const _ReducedKernels<_FormatTp> kernels = _reducedKernelsFor<_FormatTp>(simdIsa());
+        return kernels;
+    }
+
+    inline _QuantizedKernels _quantizedKernelsFor([[maybe_unused]] _SimdIsa isa) noexcept
+    {
+        #if LIMNO_SIMD_X86
+        if (isa >= _SimdIsa::avx2)
+            return {&_avx2::_quantize, &_avx2::_dequantize, &_avx2::_quantizedProduct};
+        #endif
+        return {&_scalar::_quantize, &_scalar::_dequantize, &_scalar::_quantizedProduct};
+    }
+
+    inline const _QuantizedKernels& _quantizedKernels() noexcept
+    {
+        static const _QuantizedKernels kernels = _quantizedKernelsFor(simdIsa());
+        return kernels;
+    }
+
+    //Bulk conversions between float and the 16-bit float types
+    template<typename _FormatTp>
+    void convert(const _ReducedFloat<_FormatTp>* src, float* dst, size_t n) noexcept
+    {
+        _reducedKernels<_FormatTp>().widen(src, dst, n);
+    }
+
+    template<typename _FormatTp>
+    void convert(const float* src, _ReducedFloat<_FormatTp>* dst, size_t n) noexcept
+    {
+        _reducedKernels<_FormatTp>().narrow(src, dst, n);
+    }
+
+    //Calls f(r, c0, c1) on pieces of the rows of a rows x cols matrix, at most
+    //chunk elements long. Under Limno::par the elements are split into
+    //chunks on the thread pool and f must be safe to call concurrently; the
+    //results are added in order
+    template<typename _PolicyTp, typename _FuncTp>
+    auto _rowPieces(size_t rows, size_t cols, size_t chunk, _FuncTp f)
+    {
+        using result_type = decltype(f(size_t{}, size_t{}, size_t{}));
+        auto range = [&](size_t first, size_t last)
+        {
+            result_type total{};
+            while (first < last)
+            {
+                const size_t r = first/cols;
+                const size_t c = first % cols;
+                const size_t end = std::min({last, (r + 1)*cols, first + chunk});
+                total += f(r, c, c + (end - first));
+                first = end;
+            }
+            return total;
+        };
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+        {
+            const _Partition partition = _partition(rows*cols, chunk);
+            if (partition.count() > 1)
+            {
+                std::vector<result_type> partial(partition.count());
+                _threadPool().parallelFor(partition.count(), [&](size_t t) { partial[t] = range(partition.begin(t), partition.end(t)); });
+                return std::accumulate(partial.begin(), partial.end(), result_type{});
+            }
+        }
+        return range(0, rows*cols);
+    }
+
+    //Matrix of another element type with the shape and layout of m
+    template<typename _ToTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    auto _convertedShape(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        using result_type = LimnoMatrixBase<_ToTp, _Nrows, _Ncols, typename std::allocator_traits<_AllocTp>::template rebind_alloc<_ToTp>>;
+        if constexpr(runtimeDim<_Nrows, _Ncols>)
+            return result_type(Limno::uninitialized, m.numRows(), m.numCols());
+        else
+            return result_type();
+    }
+
+    //Zeroed float result of an m x n product
+    template<int _Nrows, int _Ncols>
+    LimnoMatrixBase<float, _Nrows, _Ncols> _floatProduct(size_t m, size_t n)
+    {
+        if constexpr(runtimeDim<_Nrows, _Ncols>)
+            return LimnoMatrixBase<float, _Nrows, _Ncols>(Limno::zeros, m, n);
+        else
+            return LimnoMatrixBase<float, _Nrows, _Ncols>(Limno::zeros);
+    }
+
+    //Runs f(src, dst, n) over runs of elements of src and dst, which have
+    //the same shape; both are treated as one run per row only if padded
+    template<typename _PolicyTp, typename _SrcTp, typename _DstTp, typename _FuncTp>
+    void _convertRuns(const _SrcTp& src, _DstTp& dst, _FuncTp f)
+    {
+        const bool flat = src.leadingDim() == src.numCols() && dst.leadingDim() == dst.numCols();
+        const size_t rows = flat ? 1 : src.numRows();
+        const size_t cols = flat ? src.size() : src.numCols();
+        _rowPieces<_PolicyTp>(rows, cols, LIMNO_PARALLEL_GRAIN, [&](size_t r, size_t c0, size_t c1)
+        {
+            f(src.data() + r*src.leadingDim() + c0, dst.data() + r*dst.leadingDim() + c0, c1 - c0);
+            return 0;
+        });
+    }
+
+    //Copy of m with each element converted to _ToTp, e.g. convert<float16>(m).
+    //float to and from float16 and bfloat16 use the bulk conversion kernels
+    #if __cplusplus > 201703L
+    template<typename _ToTp, typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _ToTp, typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto convert(_PolicyTp&&, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("convert", 0, m.size()*(sizeof(_Tp) + sizeof(_ToTp)));
+        auto result = _convertedShape<_ToTp>(m);
+        _convertRuns<_PolicyTp>(m, result, [](const _Tp* src, _ToTp* dst, size_t n)
+        {
+            if constexpr((_isReducedFloat<_Tp> && std::is_same_v<_ToTp, float>) || (std::is_same_v<_Tp, float> && _isReducedFloat<_ToTp>))
+                convert(src, dst, n);
+            else
+            {
+                for(size_t i = 0; i < n; ++i)
+                    dst[i] = static_cast<_ToTp>(src[i]);
+            }
+        });
+        return result;
+    }
+
+    template<typename _ToTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    auto convert(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        return convert<_ToTp>(Limno::seq, m);
+    }
+
+    //Reduces the elements of a float16 or bfloat16 matrix, widened to float
+    //_widenChunk at a time, with a float kernel; partial results are added
+    //in float
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows, int _Ncols, typename _AllocTp, typename _KernelTp>
+    float _widenedReduce(const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows, _Ncols, _AllocTp>& m, _KernelTp kernel)
+    {
+        const bool flat = m.leadingDim() == m.numCols();
+        return _rowPieces<_PolicyTp>(flat ? 1 : m.numRows(), flat ? m.size() : m.numCols(), _widenChunk,
+            [&](size_t r, size_t c0, size_t c1)
+            {
+                float buffer[_widenChunk];
+                convert(m.data() + r*m.leadingDim() + c0, buffer, c1 - c0);
+                return kernel(buffer, c1 - c0);
+            });
+    }
+
+    //Sum, dot product and norm of 16-bit float matrices, accumulated in float
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    float sum(_PolicyTp&&, const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("sum", m.size(), m.size()*sizeof(_ReducedFloat<_FormatTp>));
+        return _widenedReduce<_PolicyTp>(m, _simdKernels<float>().sum);
+    }
+
+    template<typename _FormatTp, int _Nrows, int _Ncols, typename _AllocTp>
+    float sum(const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        return sum(Limno::seq, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    float norm(_PolicyTp&&, const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("norm", 2*m.size(), m.size()*sizeof(_ReducedFloat<_FormatTp>));
+        return std::sqrt(_widenedReduce<_PolicyTp>(m, _simdKernels<float>().sumSquares));
+    }
+
+    template<typename _FormatTp, int _Nrows, int _Ncols, typename _AllocTp>
+    float norm(const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        return norm(Limno::seq, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2,
+        typename _AllocTp1, typename _AllocTp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2,
+        typename _AllocTp1, typename _AllocTp2, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    float dot(_PolicyTp&&, const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows1, _Ncols1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows2, _Ncols2, _AllocTp2>& rhs)
+    {
+        static_assert(compatibleDim<_Nrows1, _Nrows2> && compatibleDim<_Ncols1, _Ncols2>, "Matrix dimensions do not match!");
+        if (lhs.numRows() != rhs.numRows() || lhs.numCols() != rhs.numCols())
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        LIMNO_INSTRUMENT_OPERATION("dot", 2*lhs.size(), 2*lhs.size()*sizeof(_ReducedFloat<_FormatTp>));
+        const bool flat = lhs.leadingDim() == lhs.numCols() && rhs.leadingDim() == rhs.numCols();
+        const auto kernel = _simdKernels<float>().dot;
+        return _rowPieces<_PolicyTp>(flat ? 1 : lhs.numRows(), flat ? lhs.size() : lhs.numCols(), _widenChunk,
+            [&](size_t r, size_t c0, size_t c1)
+            {
+                float a[_widenChunk];
+                float b[_widenChunk];
+                convert(lhs.data() + r*lhs.leadingDim() + c0, a, c1 - c0);
+                convert(rhs.data() + r*rhs.leadingDim() + c0, b, c1 - c0);
+                return kernel(a, b, c1 - c0);
+            });
+    }
+
+    template<typename _FormatTp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2, typename _AllocTp1, typename _AllocTp2>
+    float dot(const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows1, _Ncols1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows2, _Ncols2, _AllocTp2>& rhs)
+    {
+        return dot(Limno::seq, lhs, rhs);
+    }
+
+    //Product of 16-bit float matrices as a float matrix. B is widened once
+    //and A a panel of rows at a time, so the float GEMM kernel does the work
+    //and the extra memory is bounded by the size of B
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows, int _K1, int _K2, int _Ncols,
+        typename _AllocTp1, typename _AllocTp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _FormatTp, int _Nrows, int _K1, int _K2, int _Ncols,
+        typename _AllocTp1, typename _AllocTp2, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<float, _Nrows, _Ncols> matmul(_PolicyTp&& policy, const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows, _K1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _K2, _Ncols, _AllocTp2>& rhs)
+    {
+        static_assert(compatibleDim<_K1, _K2>, "Inner matrix dimensions do not match!");
+        if (lhs.numCols() != rhs.numRows())
+            throw std::invalid_argument("Inner matrix dimensions do not match!");
+        const size_t m = lhs.numRows();
+        const size_t n = rhs.numCols();
+        const size_t k = lhs.numCols();
+        auto result = _floatProduct<_Nrows, _Ncols>(m, n);
+        if (m == 0 || n == 0)
+            return result;
+
+        LIMNO_INSTRUMENT_OPERATION("reducedGemm", _gemmFlops(m, n, k), (m*k + k*n)*sizeof(_ReducedFloat<_FormatTp>) + m*n*sizeof(float));
+        const auto b = convert<float>(policy, rhs);
+        const size_t panelRows = std::max<size_t>(64, (size_t{1} << 18)/std::max<size_t>(k, 1));
+        std::vector<float> a(std::min(m, panelRows)*k);
+        for(size_t r0 = 0; r0 < m; r0 += panelRows)
+        {
+            const size_t rows = std::min(panelRows, m - r0);
+            for(size_t r = 0; r < rows; ++r)
+                convert(lhs.data() + (r0 + r)*lhs.leadingDim(), a.data() + r*k, k);
+            _gemm(policy, rows, n, k, 1.0f, a.data(), static_cast<std::ptrdiff_t>(k), 1, b.data(), b.rowStride(), 1,
+                0.0f, result.data() + r0*result.leadingDim(), result.rowStride(), 1);
+        }
+        return result;
+    }
+
+    template<typename _FormatTp, int _Nrows, int _K1, int _K2, int _Ncols, typename _AllocTp1, typename _AllocTp2>
+    LimnoMatrixBase<float, _Nrows, _Ncols> matmul(const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _Nrows, _K1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_ReducedFloat<_FormatTp>, _K2, _Ncols, _AllocTp2>& rhs)
+    {
+        return matmul(Limno::seq, lhs, rhs);
+    }
+
+    //Quantization covering the range of m, widened to include zero so that
+    //zero is represented exactly
+    template<int _Nrows, int _Ncols, typename _AllocTp>
+    quantization chooseQuantization(const LimnoMatrixBase<float, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        if (m.empty())
+            return quantization{};
+        const float lo = std::min(0.0f, min(m));
+        const float hi = std::max(0.0f, max(m));
+        if (!(hi > lo))
+            return quantization{};
+        const float scale = (hi - lo)/255.0f;
+        const long zeroPoint = -128 - std::lrint(lo/scale);
+        return quantization{scale, static_cast<std::int32_t>(std::clamp(zeroPoint, -128L, 127L))};
+    }
+
+    //int8 copy of a float matrix, rounded to nearest and saturated
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto quantize(_PolicyTp&&, const LimnoMatrixBase<float, _Nrows, _Ncols, _AllocTp>& m, quantization q)
+    {
+        _checkQuantization(q);
+        LIMNO_INSTRUMENT_OPERATION("quantize", 2*m.size(), m.size()*(sizeof(float) + 1));
+        auto result = _convertedShape<std::int8_t>(m);
+        const auto kernel = _quantizedKernels().quantize;
+        _convertRuns<_PolicyTp>(m, result, [&](const float* src, std::int8_t* dst, size_t n) { kernel(src, dst, n, q.scale, q.zeroPoint); });
+        return result;
+    }
+
+    template<int _Nrows, int _Ncols, typename _AllocTp>
+    auto quantize(const LimnoMatrixBase<float, _Nrows, _Ncols, _AllocTp>& m, quantization q)
+    {
+        return quantize(Limno::seq, m, q);
+    }
+
+    //Float values of an int8 matrix
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    auto dequantize(_PolicyTp&&, const LimnoMatrixBase<std::int8_t, _Nrows, _Ncols, _AllocTp>& m, quantization q)
+    {
+        LIMNO_INSTRUMENT_OPERATION("dequantize", 2*m.size(), m.size()*(sizeof(float) + 1));
+        auto result = _convertedShape<float>(m);
+        const auto kernel = _quantizedKernels().dequantize;
+        _convertRuns<_PolicyTp>(m, result, [&](const std::int8_t* src, float* dst, size_t n) { kernel(src, dst, n, q.scale, q.zeroPoint); });
+        return result;
+    }
+
+    template<int _Nrows, int _Ncols, typename _AllocTp>
+    auto dequantize(const LimnoMatrixBase<std::int8_t, _Nrows, _Ncols, _AllocTp>& m, quantization q)
+    {
+        return dequantize(Limno::seq, m, q);
+    }
+
+    //Product of two quantized matrices as a float matrix. The products of
+    //the int8 values, less their zero points, are accumulated exactly in
+    //int32, moved to int64 before a longer depth could overflow, and scaled
+    //once at the end. B is widened to int16 a panel at a
+    //time, with pairs of rows interleaved for the multiply-add kernels; under
+    //Limno::par the rows of A are split over the thread pool
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, int _Nrows, int _K1, int _K2, int _Ncols, typename _AllocTp1, typename _AllocTp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, int _Nrows, int _K1, int _K2, int _Ncols, typename _AllocTp1, typename _AllocTp2,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<float, _Nrows, _Ncols> matmul(_PolicyTp&&, const LimnoMatrixBase<std::int8_t, _Nrows, _K1, _AllocTp1>& lhs, quantization lhsQ,
+        const LimnoMatrixBase<std::int8_t, _K2, _Ncols, _AllocTp2>& rhs, quantization rhsQ)
+    {
+        static_assert(compatibleDim<_K1, _K2>, "Inner matrix dimensions do not match!");
+        if (lhs.numCols() != rhs.numRows())
+            throw std::invalid_argument("Inner matrix dimensions do not match!");
+        _checkQuantization(lhsQ);
+        _checkQuantization(rhsQ);
+        const size_t m = lhs.numRows();
+        const size_t n = rhs.numCols();
+        const size_t k = lhs.numCols();
+        LIMNO_INSTRUMENT_OPERATION("quantizedGemm", _gemmFlops(m, n, k), m*k + k*n + m*n*sizeof(float));
+        LimnoMatrixBase<std::int32_t, DYNAMIC, DYNAMIC> acc(Limno::zeros, m, n);
+        const auto kernel = _quantizedKernels().product;
+        std::vector<std::int16_t> panel(_quantizedKc*_quantizedNc);
+        //Only needed for depths past _quantizedSafeDepth
+        std::vector<std::int64_t> wide;
+        for(size_t j0 = 0; j0 < n; j0 += _quantizedNc)
+        {
+            const size_t cols = std::min(_quantizedNc, n - j0);
+            size_t accumulated = 0;
+            for(size_t k0 = 0; k0 < k; k0 += _quantizedKc)
+            {
+                const size_t depth = std::min(_quantizedKc, k - k0);
+                if (accumulated + depth > _quantizedSafeDepth)
+                {
+                    wide.resize(m*n);
+                    for(size_t i = 0; i < m; ++i)
+                        for(size_t j = j0; j < j0 + cols; ++j)
+                        {
+                            wide[i*n + j] += acc(i, j);
+                            acc(i, j) = 0;
+                        }
+                    accumulated = 0;
+                }
+                accumulated += depth;
+                const size_t pairs = (depth + 1)/2;
+                for(size_t q = 0; q < pairs; ++q)
+                    for(size_t t = 0; t < 2; ++t)
+                    {
+                        const size_t kk = k0 + 2*q + t;
+                        for(size_t j = 0; j < cols; ++j)
+                            panel[(q*cols + j)*2 + t] = (2*q + t < depth) ?
+                                static_cast<std::int16_t>(rhs(kk, j0 + j) - rhsQ.zeroPoint) : std::int16_t{0};
+                    }
+
+                auto rowsOf = [&](size_t first, size_t last)
+                {
+                    std::vector<std::int16_t> a(2*pairs*(last - first));
+                    for(size_t i = first; i < last; ++i)
+                        for(size_t kk = 0; kk < 2*pairs; ++kk)
+                            a[(i - first)*2*pairs + kk] = (kk < depth) ?
+                                static_cast<std::int16_t>(lhs(i, k0 + kk) - lhsQ.zeroPoint) : std::int16_t{0};
+                    kernel(last - first, cols, pairs, a.data(), panel.data(), acc.data() + first*acc.leadingDim() + j0, acc.leadingDim());
+                };
+                if constexpr(_isParallelPolicy<_PolicyTp>)
+                    _parallelChunks(_partition(m, 1, 0, std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/(cols*pairs))), rowsOf);
+                else
+                    rowsOf(0, m);
+            }
+        }
+
+        auto result = _floatProduct<_Nrows, _Ncols>(m, n);
+        const float scale = lhsQ.scale*rhsQ.scale;
+        for(size_t i = 0; i < m; ++i)
+            for(size_t j = 0; j < n; ++j)
+                result(i, j) = static_cast<float>(wide.empty() ? acc(i, j) : wide[i*n + j] + acc(i, j))*scale;
+        return result;
+    }
+
+    template<int _Nrows, int _K1, int _K2, int _Ncols, typename _AllocTp1, typename _AllocTp2>
+    LimnoMatrixBase<float, _Nrows, _Ncols> matmul(const LimnoMatrixBase<std::int8_t, _Nrows, _K1, _AllocTp1>& lhs, quantization lhsQ,
+        const LimnoMatrixBase<std::int8_t, _K2, _Ncols, _AllocTp2>& rhs, quantization rhsQ)
+    {
+        return matmul(Limno::seq, lhs, lhsQ, rhs, rhsQ);
+    }
+}
+
+#endif
@@ -0,0 +1,1223 @@
+#ifndef REDUCTIONS_HH
+#define REDUCTIONS_HH 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+#include "Core/execution.hh"
+#include "Core/instrumentation.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+#include "Core/simd.hh"
+
+namespace LIB_NAMESPACE_BASE
+{
+    //Reduction options, passed after the matrix. rowwise reduces each row to
+    //one value, giving a column vector, and colwise reduces each column, 
+    //giving a row vector
+    struct rowwise_t
+    {
+
+    };
+
+    struct colwise_t
+    {
+
+    };
+
+    //Floating point sums use compensated summation over a reduction tree fixed
+    //by the shape alone, so results are bit-identical whatever the thread 
+    //count, execution policy or instruction set
+    struct deterministic_t
+    {
+
+    };
+
+    inline constexpr rowwise_t rowwise{};
+    inline constexpr colwise_t colwise{};
+    inline constexpr deterministic_t deterministic{};
+}
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Type returned by norm; integral matrices produce a double
+    template<typename _Tp>
+    using _norm_t = std::conditional_t<std::is_floating_point_v<_Tp>, _Tp, double>;
+
+    //Applies a kernel to every row of m and folds the partial results. 
+    //Unpadded matrices are handled by a single kernel call
+    template<typename _MatTp, typename _KernelTp, typename _FoldTp>
+    auto _reduceRows(const _MatTp& m, _KernelTp kernel, _FoldTp fold)
+    {
+        if constexpr(!_MatTp::isPadded)
+        {
+            return kernel(m.data(), m.size());
+        }
+        else 
+        {
+            auto result = kernel(m.data(), m.numCols());
+            for(size_t r = 1; r < m.numRows(); ++r)
+                result = fold(result, kernel(m.data() + r*m.leadingDim(), m.numCols()));
+            return result;
+        }
+    }
+
+    //Parallel version of _reduceRows. The matrix is split into chunks on the
+    //thread pool and the partial results are folded in chunk order
+    template<typename _MatTp, typename _KernelTp, typename _FoldTp>
+    auto _reduceRows(parallel_policy, const _MatTp& m, _KernelTp kernel, _FoldTp fold)
+    {
+        using result_type = decltype(kernel(m.data(), m.size()));
+        const size_t numCols = m.numCols();
+        const _Partition partition = _MatTp::isPadded ? 
+            _partition(m.numRows(), 1, 0, std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/numCols)) : 
+            _linePartition(m.data(), m.size());
+        if (partition.count() <= 1)
+            return _reduceRows(m, kernel, fold);
+
+        std::vector<result_type> partials(partition.count());
+        _threadPool().parallelFor(partition.count(), [&](size_t i) 
+        {
+            const size_t first = partition.begin(i);
+            const size_t last = partition.end(i);
+            if constexpr(!_MatTp::isPadded)
+            {
+                partials[i] = kernel(m.data() + first, last - first);
+            }
+            else 
+            {
+                result_type result = kernel(m.data() + first*m.leadingDim(), numCols);
+                for(size_t r = first + 1; r < last; ++r)
+                    result = fold(result, kernel(m.data() + r*m.leadingDim(), numCols));
+                partials[i] = result;
+            }
+        });
+
+        result_type result = partials[0];
+        for(size_t i = 1; i < partials.size(); ++i)
+            result = fold(result, partials[i]);
+        return result;
+    }
+
+    template<typename _MatTp, typename _KernelTp, typename _FoldTp>
+    auto _reduceRows(sequenced_policy, const _MatTp& m, _KernelTp kernel, _FoldTp fold)
+    {
+        return _reduceRows(m, kernel, fold);
+    }
+
+    //Applies a kernel to each unit-stride run of a non-empty view and folds the 
+    //partial results. Views with no unit stride are gathered one row at a time
+    template<typename _Tp, typename _KernelTp, typename _FoldTp>
+    auto _reduceView(const LimnoMatrixView<_Tp>& v, _KernelTp kernel, _FoldTp fold)
+    {
+        using value_type = std::remove_cv_t<_Tp>;
+        if (v.isContiguous())
+            return kernel(v.data(), v.size());
+
+        if (v.colStride() == 1 || v.rowStride() == 1)
+        {
+            //Reduce along whichever dimension is unit-stride
+            const bool byRow = v.colStride() == 1;
+            const size_t runs = byRow ? v.numRows() : v.numCols();
+            const size_t length = byRow ? v.numCols() : v.numRows();
+            const std::ptrdiff_t step = byRow ? v.rowStride() : v.colStride();
+            auto result = kernel(v.data(), length);
+            for(size_t i = 1; i < runs; ++i)
+                result = fold(result, kernel(v.data() + static_cast<std::ptrdiff_t>(i)*step, length));
+            return result;
+        }
+
+        std::vector<value_type> buffer(v.numCols());
+        auto gather = [&](size_t r) 
+        {
+            for(size_t c = 0; c < v.numCols(); ++c)
+                buffer[c] = v(r, c);
+            return kernel(buffer.data(), buffer.size());
+        };
+        auto result = gather(0);
+        for(size_t r = 1; r < v.numRows(); ++r)
+            result = fold(result, gather(r));
+        return result;
+    }
+
+    //Sum of all elements
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    _Tp sum(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m) noexcept
+    {
+        LIMNO_INSTRUMENT_OPERATION("sum", m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            return _Tp{};
+        return _reduceRows(m, _simdKernels<_Tp>().sum, std::plus<>{});
+    }
+
+    //Smallest element; throws if the matrix is empty
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    _Tp min(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("min", m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            throw std::invalid_argument("Matrix is empty!");
+        return _reduceRows(m, _simdKernels<_Tp>().min, [](_Tp a, _Tp b) { return (b < a) ? b : a; });
+    }
+
+    //Largest element; throws if the matrix is empty
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    _Tp max(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("max", m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            throw std::invalid_argument("Matrix is empty!");
+        return _reduceRows(m, _simdKernels<_Tp>().max, [](_Tp a, _Tp b) { return (b > a) ? b : a; });
+    }
+
+    //Sum of the element-wise product of two matrices with the same shape
+    template<typename _Tp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2, typename _AllocTp1, typename _AllocTp2>
+    _Tp dot(const LimnoMatrixBase<_Tp, _Nrows1, _Ncols1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_Tp, _Nrows2, _Ncols2, _AllocTp2>& rhs)
+    {
+        LIMNO_INSTRUMENT_OPERATION("dot", 2*lhs.size(), 2*lhs.size()*sizeof(_Tp));
+        static_assert(compatibleDim<_Nrows1, _Nrows2> && compatibleDim<_Ncols1, _Ncols2>, "Matrix dimensions do not match!");
+        if constexpr(runtimeDim<_Nrows1, _Ncols1> || runtimeDim<_Nrows2, _Ncols2>)
+        {
+            if (lhs.numRows() != rhs.numRows() || lhs.numCols() != rhs.numCols())
+                throw std::invalid_argument("Matrix dimensions do not match!");
+        }
+        const auto dotKernel = _simdKernels<_Tp>().dot;
+        if (lhs.leadingDim() == lhs.numCols() && rhs.leadingDim() == rhs.numCols())
+            return dotKernel(lhs.data(), rhs.data(), lhs.size());
+
+        _Tp result{};
+        for(size_t r = 0; r < lhs.numRows(); ++r)
+            result += dotKernel(lhs.data() + r*lhs.leadingDim(), rhs.data() + r*rhs.leadingDim(), lhs.numCols());
+        return result;
+    }
+
+    //Frobenius norm
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    _norm_t<_Tp> norm(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m) noexcept
+    {
+        LIMNO_INSTRUMENT_OPERATION("norm", 2*m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            return _norm_t<_Tp>{};
+        return std::sqrt(static_cast<_norm_t<_Tp>>(_reduceRows(m, _simdKernels<_Tp>().sumSquares, std::plus<>{})));
+    }
+
+    //Reductions taking an execution policy
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    _Tp sum(_PolicyTp&& policy, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("sum", m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            return _Tp{};
+        return _reduceRows(policy, m, _simdKernels<_Tp>().sum, std::plus<>{});
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    _Tp min(_PolicyTp&& policy, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("min", m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            throw std::invalid_argument("Matrix is empty!");
+        return _reduceRows(policy, m, _simdKernels<_Tp>().min, [](_Tp a, _Tp b) { return (b < a) ? b : a; });
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    _Tp max(_PolicyTp&& policy, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("max", m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            throw std::invalid_argument("Matrix is empty!");
+        return _reduceRows(policy, m, _simdKernels<_Tp>().max, [](_Tp a, _Tp b) { return (b > a) ? b : a; });
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    _norm_t<_Tp> norm(_PolicyTp&& policy, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        LIMNO_INSTRUMENT_OPERATION("norm", 2*m.size(), m.size()*sizeof(_Tp));
+        if (m.empty())
+            return _norm_t<_Tp>{};
+        return std::sqrt(static_cast<_norm_t<_Tp>>(_reduceRows(policy, m, _simdKernels<_Tp>().sumSquares, std::plus<>{})));
+    }
+
+    //Parallel dot splits both operands into the same blocks of rows
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2, 
+        typename _AllocTp1, typename _AllocTp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _Nrows1, int _Ncols1, int _Nrows2, int _Ncols2, 
+        typename _AllocTp1, typename _AllocTp2, std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    _Tp dot(_PolicyTp&&, const LimnoMatrixBase<_Tp, _Nrows1, _Ncols1, _AllocTp1>& lhs,
+        const LimnoMatrixBase<_Tp, _Nrows2, _Ncols2, _AllocTp2>& rhs)
+    {
+        if constexpr(!_isParallelPolicy<_PolicyTp>)
+        {
+            return dot(lhs, rhs);
+        }
+        else 
+        {
+            static_assert(compatibleDim<_Nrows1, _Nrows2> && compatibleDim<_Ncols1, _Ncols2>, "Matrix dimensions do not match!");
+            if (lhs.numRows() != rhs.numRows() || lhs.numCols() != rhs.numCols())
+                throw std::invalid_argument("Matrix dimensions do not match!");
+            if (lhs.empty())
+                return _Tp{};
+
+            LIMNO_INSTRUMENT_OPERATION("dot", 2*lhs.size(), 2*lhs.size()*sizeof(_Tp));
+            const size_t numCols = lhs.numCols();
+            const _Partition rows = _partition(lhs.numRows(), 1, 0, std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/numCols));
+            const auto dotKernel = _simdKernels<_Tp>().dot;
+            std::vector<_Tp> partials(rows.count());
+            _threadPool().parallelFor(rows.count(), [&](size_t i) 
+            {
+                _Tp result{};
+                for(size_t r = rows.begin(i); r < rows.end(i); ++r)
+                    result += dotKernel(lhs.data() + r*lhs.leadingDim(), rhs.data() + r*rhs.leadingDim(), numCols);
+                partials[i] = result;
+            });
+
+            _Tp result{};
+            for(const _Tp& partial : partials)
+                result += partial;
+            return result;
+        }
+    }
+
+    //Reductions over views
+    template<typename _Tp>
+    std::remove_cv_t<_Tp> sum(const LimnoMatrixView<_Tp>& v)
+    {
+        LIMNO_INSTRUMENT_OPERATION("sum", v.size(), v.size()*sizeof(_Tp));
+        using value_type = std::remove_cv_t<_Tp>;
+        if (v.empty())
+            return value_type{};
+        return _reduceView(v, _simdKernels<value_type>().sum, std::plus<>{});
+    }
+
+    template<typename _Tp>
+    std::remove_cv_t<_Tp> min(const LimnoMatrixView<_Tp>& v)
+    {
+        LIMNO_INSTRUMENT_OPERATION("min", v.size(), v.size()*sizeof(_Tp));
+        using value_type = std::remove_cv_t<_Tp>;
+        if (v.empty())
+            throw std::invalid_argument("Matrix is empty!");
+        return _reduceView(v, _simdKernels<value_type>().min, [](value_type a, value_type b) { return (b < a) ? b : a; });
+    }
+
+    template<typename _Tp>
+    std::remove_cv_t<_Tp> max(const LimnoMatrixView<_Tp>& v)
+    {
+        LIMNO_INSTRUMENT_OPERATION("max", v.size(), v.size()*sizeof(_Tp));
+        using value_type = std::remove_cv_t<_Tp>;
+        if (v.empty())
+            throw std::invalid_argument("Matrix is empty!");
+        return _reduceView(v, _simdKernels<value_type>().max, [](value_type a, value_type b) { return (b > a) ? b : a; });
+    }
+
+    template<typename _Tp1, typename _Tp2>
+    std::remove_cv_t<_Tp1> dot(const LimnoMatrixView<_Tp1>& lhs, const LimnoMatrixView<_Tp2>& rhs)
+    {
+        LIMNO_INSTRUMENT_OPERATION("dot", 2*lhs.size(), 2*lhs.size()*sizeof(_Tp1));
+        using value_type = std::remove_cv_t<_Tp1>;
+        static_assert(std::is_same_v<value_type, std::remove_cv_t<_Tp2>>, "Matrix types do not match!");
+        if (lhs.numRows() != rhs.numRows() || lhs.numCols() != rhs.numCols())
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        const auto dotKernel = _simdKernels<value_type>().dot;
+        if (lhs.isContiguous() && rhs.isContiguous())
+            return dotKernel(lhs.data(), rhs.data(), lhs.size());
+
+        value_type result{};
+        if (lhs.colStride() == 1 && rhs.colStride() == 1)
+        {
+            for(size_t r = 0; r < lhs.numRows(); ++r)
+                result += dotKernel(&lhs(r, 0), &rhs(r, 0), lhs.numCols());
+            return result;
+        }
+        for(size_t r = 0; r < lhs.numRows(); ++r)
+            for(size_t c = 0; c < lhs.numCols(); ++c)
+                result += lhs(r, c)*rhs(r, c);
+        return result;
+    }
+
+    template<typename _Tp>
+    _norm_t<std::remove_cv_t<_Tp>> norm(const LimnoMatrixView<_Tp>& v)
+    {
+        LIMNO_INSTRUMENT_OPERATION("norm", 2*v.size(), v.size()*sizeof(_Tp));
+        using value_type = std::remove_cv_t<_Tp>;
+        if (v.empty())
+            return _norm_t<value_type>{};
+        return std::sqrt(static_cast<_norm_t<value_type>>(_reduceView(v, _simdKernels<value_type>().sumSquares, std::plus<>{})));
+    }
+
+    //Axis and deterministic reductions. Every reduction takes the matrix or
+    //view, then optionally Limno::rowwise or Limno::colwise and 
+    //Limno::deterministic, and may be preceded by an execution policy:
+    //
+    //  sum(Limno::par, m, Limno::colwise, Limno::deterministic)
+    //
+    //min, max, argmin and argmax are exact, so deterministic changes nothing
+    enum class _ReduceOp
+    {
+        sum,
+        mean,
+        var,
+        norm,
+        min,
+        max,
+        argmin,
+        argmax
+    };
+
+    template<typename _Tp>
+    static constexpr bool _isReductionOption = std::is_same_v<std::decay_t<_Tp>, rowwise_t> ||
+        std::is_same_v<std::decay_t<_Tp>, colwise_t> || std::is_same_v<std::decay_t<_Tp>, deterministic_t>;
+
+    template<typename _MatTp, typename... _OptsTp>
+    static constexpr bool _isReductionCall = _OperandTraits<_MatTp>::isMatrix && !_isExpr<_MatTp> && 
+        (_isReductionOption<_OptsTp> && ...);
+
+    template<typename... _OptsTp>
+    struct _ReductionOptions
+    {
+        static constexpr int numRowwise = (0 + ... + static_cast<int>(std::is_same_v<std::decay_t<_OptsTp>, rowwise_t>));
+        static constexpr int numColwise = (0 + ... + static_cast<int>(std::is_same_v<std::decay_t<_OptsTp>, colwise_t>));
+        static constexpr int numDeterministic = (0 + ... + static_cast<int>(std::is_same_v<std::decay_t<_OptsTp>, deterministic_t>));
+        static constexpr bool rowwise = numRowwise != 0;
+        static constexpr bool colwise = numColwise != 0;
+        static constexpr bool deterministic = numDeterministic != 0;
+        static constexpr bool valid = numRowwise + numColwise <= 1 && numDeterministic <= 1;
+    };
+
+    //Element type of the result of a reduction; indices for argmin/argmax
+    template<_ReduceOp _Op, typename _Tp>
+    using _reduce_t = std::conditional_t<_Op == _ReduceOp::argmin || _Op == _ReduceOp::argmax, size_t,
+        std::conditional_t<_Op == _ReduceOp::mean || _Op == _ReduceOp::var || _Op == _ReduceOp::norm, _norm_t<_Tp>, _Tp>>;
+
+    //Result of a rowwise (column vector) or colwise (row vector) reduction,
+    //static when the reduced matrix is
+    template<typename _Rt, int _Nrows, int _Ncols, bool _Rowwise>
+    using _axis_result_t = std::conditional_t<runtimeDim<_Nrows, _Ncols>, LimnoMatrixBase<_Rt, DYNAMIC, DYNAMIC>,
+        LimnoMatrixBase<_Rt, (_Rowwise ? _Nrows : 1), (_Rowwise ? 1 : _Ncols)>>;
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    LimnoMatrixView<const _Tp> _reductionView(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m) noexcept
+    {
+        return m.view();
+    }
+
+    template<typename _Tp>
+    LimnoMatrixView<const std::remove_cv_t<_Tp>> _reductionView(const LimnoMatrixView<_Tp>& v) noexcept
+    {
+        return v;
+    }
+
+    //Elements [c0, c1) of row r, gathered into buffer unless already unit stride
+    template<typename _Tp>
+    const _Tp* _rowRun(const LimnoMatrixView<const _Tp>& v, size_t r, size_t c0, size_t c1, std::vector<_Tp>& buffer)
+    {
+        const _Tp* row = v.data() + static_cast<std::ptrdiff_t>(r)*v.rowStride();
+        if (v.colStride() == 1)
+            return row + c0;
+        buffer.resize(c1 - c0);
+        for(size_t c = c0; c < c1; ++c)
+            buffer[c - c0] = row[static_cast<std::ptrdiff_t>(c)*v.colStride()];
+        return buffer.data();
+    }
+
+    //Runs f(first, last) over blocks of rows, on the thread pool under Limno::par
+    template<typename _PolicyTp, typename _FuncTp>
+    void _forRowBlocks(const _PolicyTp&, size_t numRows, size_t numCols, _FuncTp f)
+    {
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+            _parallelChunks(_partition(numRows, 1, 0, std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/std::max<size_t>(numCols, 1))), f);
+        else
+            f(size_t{0}, numRows);
+    }
+
+    //Sum of (x - mean)^2 over a contiguous run
+    template<typename _Tp>
+    _norm_t<_Tp> _squaredDeviations(const _Tp* p, _norm_t<_Tp> mean, size_t n) noexcept
+    {
+        if constexpr(std::is_floating_point_v<_Tp>)
+            return _simdKernels<_Tp>().sumSquaredDeviations(p, mean, n);
+        else
+        {
+            _norm_t<_Tp> result{};
+            for(size_t i = 0; i < n; ++i)
+                result += (static_cast<_norm_t<_Tp>>(p[i]) - mean)*(static_cast<_norm_t<_Tp>>(p[i]) - mean);
+            return result;
+        }
+    }
+
+    //Position of the smallest or largest of n > 0 elements, the first if tied
+    template<bool _Max, typename _Tp>
+    size_t _extremeIndex(const _Tp* p, size_t n) noexcept
+    {
+        const auto& kernels = _simdKernels<_Tp>();
+        const _Tp extreme = _Max ? kernels.max(p, n) : kernels.min(p, n);
+        const _Tp* found = std::find(p, p + n, extreme);
+        //NaNs never compare equal
+        if (found == p + n)
+            found = _Max ? std::max_element(p, p + n) : std::min_element(p, p + n);
+        return static_cast<size_t>(found - p);
+    }
+
+    //Reduces one contiguous run of n elements
+    template<_ReduceOp _Op, typename _Tp>
+    _reduce_t<_Op, _Tp> _reduceRun(const _Tp* p, size_t n) noexcept
+    {
+        using result_type = _reduce_t<_Op, _Tp>;
+        const auto& kernels = _simdKernels<_Tp>();
+        if constexpr(_Op == _ReduceOp::sum)
+            return kernels.sum(p, n);
+        else if constexpr(_Op == _ReduceOp::mean)
+            return static_cast<result_type>(kernels.sum(p, n))/static_cast<result_type>(n);
+        else if constexpr(_Op == _ReduceOp::var)
+        {
+            const result_type mean = static_cast<result_type>(kernels.sum(p, n))/static_cast<result_type>(n);
+            return _squaredDeviations(p, mean, n)/static_cast<result_type>(n);
+        }
+        else if constexpr(_Op == _ReduceOp::norm)
+            return std::sqrt(static_cast<result_type>(kernels.sumSquares(p, n)));
+        else if constexpr(_Op == _ReduceOp::min)
+            return kernels.min(p, n);
+        else if constexpr(_Op == _ReduceOp::max)
+            return kernels.max(p, n);
+        else
+            return _extremeIndex<_Op == _ReduceOp::argmax>(p, n);
+    }
+
+    //Reduces columns [c0, c1) of v into out[0, c1 - c0) a whole row at a 
+    //time, so the inner loops run along unit-stride rows
+    template<_ReduceOp _Op, typename _Tp>
+    void _reduceColumns(const LimnoMatrixView<const _Tp>& v, size_t c0, size_t c1, _reduce_t<_Op, _Tp>* out)
+    {
+        using result_type = _reduce_t<_Op, _Tp>;
+        const auto& kernels = _simdKernels<_Tp>();
+        const auto add = kernels.binary[static_cast<int>(_SimdOp::add)];
+        const size_t n = c1 - c0;
+        const size_t numRows = v.numRows();
+        std::vector<_Tp> buffer;
+
+        if constexpr(_Op == _ReduceOp::sum || _Op == _ReduceOp::mean || _Op == _ReduceOp::var || _Op == _ReduceOp::norm)
+        {
+            std::fill(out, out + n, result_type{});
+            if constexpr(_Op != _ReduceOp::norm)
+            {
+                for(size_t r = 0; r < numRows; ++r)
+                {
+                    const _Tp* x = _rowRun(v, r, c0, c1, buffer);
+                    if constexpr(std::is_same_v<result_type, _Tp>)
+                        add(out, x, out, n);
+                    else
+                    {
+                        for(size_t c = 0; c < n; ++c)
+                            out[c] += static_cast<result_type>(x[c]);
+                    }
+                }
+                if constexpr(_Op != _ReduceOp::sum)
+                {
+                    for(size_t c = 0; c < n; ++c)
+                        out[c] /= static_cast<result_type>(numRows);
+                }
+            }
+
+            if constexpr(_Op == _ReduceOp::var || _Op == _ReduceOp::norm)
+            {
+                //Squares or squared deviations from the column means
+                const std::vector<result_type> means(out, out + n);
+                std::fill(out, out + n, result_type{});
+                std::vector<_Tp> squares(n);
+                for(size_t r = 0; r < numRows; ++r)
+                {
+                    const _Tp* x = _rowRun(v, r, c0, c1, buffer);
+                    if constexpr(std::is_same_v<result_type, _Tp>)
+                    {
+                        if constexpr(_Op == _ReduceOp::var)
+                        {
+                            kernels.binary[static_cast<int>(_SimdOp::sub)](x, means.data(), squares.data(), n);
+                            x = squares.data();
+                        }
+                        kernels.binary[static_cast<int>(_SimdOp::mul)](x, x, squares.data(), n);
+                        add(out, squares.data(), out, n);
+                    }
+                    else
+                    {
+                        for(size_t c = 0; c < n; ++c)
+                        {
+                            const result_type d = static_cast<result_type>(x[c]) - means[c];
+                            out[c] += d*d;
+                        }
+                    }
+                }
+                for(size_t c = 0; c < n; ++c)
+                {
+                    if constexpr(_Op == _ReduceOp::var)
+                        out[c] /= static_cast<result_type>(numRows);
+                    else
+                        out[c] = std::sqrt(out[c]);
+                }
+            }
+        }
+        else
+        {
+            //Requires at least one row
+            const _Tp* first = _rowRun(v, 0, c0, c1, buffer);
+            std::vector<_Tp> best(first, first + n);
+            if constexpr(_Op == _ReduceOp::argmin || _Op == _ReduceOp::argmax)
+                std::fill(out, out + n, size_t{0});
+            for(size_t r = 1; r < numRows; ++r)
+            {
+                const _Tp* x = _rowRun(v, r, c0, c1, buffer);
+                for(size_t c = 0; c < n; ++c)
+                {
+                    const bool better = (_Op == _ReduceOp::min || _Op == _ReduceOp::argmin) ? x[c] < best[c] : x[c] > best[c];
+                    if (better)
+                    {
+                        best[c] = x[c];
+                        if constexpr(_Op == _ReduceOp::argmin || _Op == _ReduceOp::argmax)
+                            out[c] = r;
+                    }
+                }
+            }
+            if constexpr(_Op == _ReduceOp::min || _Op == _ReduceOp::max)
+                std::copy(best.begin(), best.end(), out);
+        }
+    }
+
+    template<_ReduceOp _Op, typename _PolicyTp, typename _Tp>
+    void _reduceColwise(const _PolicyTp& policy, const LimnoMatrixView<const _Tp>& v, _reduce_t<_Op, _Tp>* out);
+
+    //One value per row. Column-major views are reduced down the columns of
+    //their transpose instead, which walks memory in order
+    template<_ReduceOp _Op, typename _PolicyTp, typename _Tp>
+    void _reduceRowwise(const _PolicyTp& policy, const LimnoMatrixView<const _Tp>& v, _reduce_t<_Op, _Tp>* out)
+    {
+        if (v.colStride() != 1 && v.rowStride() == 1 && v.numRows() > 1)
+            return _reduceColwise<_Op>(policy, v.transpose(), out);
+        _forRowBlocks(policy, v.numRows(), v.numCols(), [&](size_t first, size_t last)
+        {
+            std::vector<_Tp> buffer;
+            for(size_t r = first; r < last; ++r)
+                out[r] = _reduceRun<_Op>(_rowRun(v, r, 0, v.numCols(), buffer), v.numCols());
+        });
+    }
+
+    //One value per column. Under Limno::par the columns are split into 
+    //chunks of whole cache lines, each reduced over every row
+    template<_ReduceOp _Op, typename _PolicyTp, typename _Tp>
+    void _reduceColwise(const _PolicyTp& policy, const LimnoMatrixView<const _Tp>& v, _reduce_t<_Op, _Tp>* out)
+    {
+        if (v.colStride() != 1 && v.rowStride() == 1 && v.numCols() > 1)
+            return _reduceRowwise<_Op>(policy, v.transpose(), out);
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+        {
+            constexpr size_t perLine = std::max<size_t>(1, LIMNO_CACHE_LINE/sizeof(_Tp));
+            const size_t grain = std::max(perLine, LIMNO_PARALLEL_GRAIN/std::max<size_t>(v.numRows(), 1));
+            _parallelChunks(_partition(v.numCols(), perLine, 0, grain), [&](size_t first, size_t last)
+                { _reduceColumns<_Op>(v, first, last, out + first); });
+        }
+        else
+            _reduceColumns<_Op>(v, 0, v.numCols(), out);
+    }
+
+    //Fast reduction of a whole non-empty view. Under Limno::par contiguous 
+    //views are split into chunks of elements and others into blocks of rows,
+    //and the partial results are folded in order
+    template<typename _PolicyTp, typename _Tp, typename _KernelTp, typename _FoldTp>
+    auto _reduceAll(const _PolicyTp&, const LimnoMatrixView<const _Tp>& v, _KernelTp kernel, _FoldTp fold)
+    {
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+        {
+            using result_type = decltype(kernel(v.data(), v.size()));
+            const bool contiguous = v.isContiguous();
+            const _Partition partition = contiguous ? _linePartition(v.data(), v.size()) : 
+                _partition(v.numRows(), 1, 0, std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/v.numCols()));
+            if (partition.count() > 1)
+            {
+                std::vector<result_type> partials(partition.count());
+                _threadPool().parallelFor(partition.count(), [&](size_t i)
+                {
+                    const size_t first = partition.begin(i);
+                    const size_t last = partition.end(i);
+                    partials[i] = contiguous ? kernel(v.data() + first, last - first) :
+                        _reduceView(v.block(first, 0, last - first, v.numCols()), kernel, fold);
+                });
+                result_type result = partials[0];
+                for(size_t i = 1; i < partials.size(); ++i)
+                    result = fold(result, partials[i]);
+                return result;
+            }
+        }
+        return _reduceView(v, kernel, fold);
+    }
+
+    //Neumaier's improved Kahan summation: the rounding error of every
+    //addition is accumulated separately and added back at the end
+    template<typename _Tp>
+    struct _CompensatedSum
+    {
+        _Tp sum{};
+        _Tp error{};
+
+        void add(_Tp x) noexcept
+        {
+            const _Tp t = sum + x;
+            error += (std::abs(sum) >= std::abs(x)) ? (sum - t) + x : (x - t) + sum;
+            sum = t;
+        }
+
+        void add(const _CompensatedSum& other) noexcept
+        {
+            add(other.sum);
+            error += other.error;
+        }
+
+        _Tp value() const noexcept
+        {
+            return sum + error;
+        }
+    };
+
+    //Elements per leaf of the deterministic reduction tree
+    static constexpr size_t _compensatedBlock = 1024;
+
+    //Compensated sum of f(x) over elements [first, last) of v in row-major 
+    //order. Four interleaved lanes break the dependency chain and are folded
+    //in a fixed order
+    template<typename _Tp, typename _FuncTp>
+    _CompensatedSum<_Tp> _compensatedLeaf(const LimnoMatrixView<const _Tp>& v, size_t first, size_t last, _FuncTp f) noexcept
+    {
+        _CompensatedSum<_Tp> lanes[4];
+        const size_t numCols = v.numCols();
+        size_t r = first/numCols;
+        size_t c = first % numCols;
+        for(size_t i = first; i < last; ++r, c = 0)
+        {
+            const size_t run = std::min(numCols - c, last - i);
+            const _Tp* p = &v(r, c);
+            for(size_t j = 0; j < run; ++j, ++i)
+                lanes[i % 4].add(f(p[static_cast<std::ptrdiff_t>(j)*v.colStride()]));
+        }
+        lanes[0].add(lanes[1]);
+        lanes[2].add(lanes[3]);
+        lanes[0].add(lanes[2]);
+        return lanes[0];
+    }
+
+    //Folds leaves [first, last) pairwise, in a tree fixed by their number
+    template<typename _Tp, typename _LeafTp>
+    _CompensatedSum<_Tp> _compensatedTree(size_t first, size_t last, const _LeafTp& leaf)
+    {
+        if (last - first == 1)
+            return leaf(first);
+        const size_t mid = first + (last - first + 1)/2;
+        _CompensatedSum<_Tp> result = _compensatedTree<_Tp>(first, mid, leaf);
+        result.add(_compensatedTree<_Tp>(mid, last, leaf));
+        return result;
+    }
+
+    //Deterministic sum of f(x) over v. The leaves are fixed blocks of
+    //elements; under Limno::par they are summed on the thread pool and the
+    //tree is folded afterwards, giving the same bits as the sequential sum
+    template<typename _PolicyTp, typename _Tp, typename _FuncTp>
+    _Tp _compensatedSum(const _PolicyTp&, const LimnoMatrixView<const _Tp>& v, _FuncTp f)
+    {
+        const size_t n = v.size();
+        if (n == 0)
+            return _Tp{};
+        const size_t numLeaves = (n + _compensatedBlock - 1)/_compensatedBlock;
+        auto leaf = [&](size_t k) { return _compensatedLeaf(v, k*_compensatedBlock, std::min(n, (k + 1)*_compensatedBlock), f); };
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+        {
+            if (numLeaves > 1)
+            {
+                std::vector<_CompensatedSum<_Tp>> leaves(numLeaves);
+                _parallelChunks(_partition(numLeaves, 1, 0, std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/_compensatedBlock)),
+                    [&](size_t first, size_t last)
+                    {
+                        for(size_t k = first; k < last; ++k)
+                            leaves[k] = leaf(k);
+                    });
+                return _compensatedTree<_Tp>(0, numLeaves, [&](size_t k) { return leaves[k]; }).value();
+            }
+        }
+        return _compensatedTree<_Tp>(0, numLeaves, leaf).value();
+    }
+
+    //Deterministic sums of columns [c0, c1), each the same as 
+    //_compensatedSum over the column. Leaves are computed for neighbouring 
+    //columns in turn so the rows they read stay in cache
+    template<typename _Tp, typename _MakeFuncTp>
+    void _compensatedColumns(const LimnoMatrixView<const _Tp>& v, size_t c0, size_t c1, _MakeFuncTp makeFunc, _Tp* out)
+    {
+        const size_t numRows = v.numRows();
+        if (numRows == 0)
+        {
+            std::fill(out, out + (c1 - c0), _Tp{});
+            return;
+        }
+        const size_t numLeaves = (numRows + _compensatedBlock - 1)/_compensatedBlock;
+        std::vector<_CompensatedSum<_Tp>> leaves((c1 - c0)*numLeaves);
+        for(size_t k = 0; k < numLeaves; ++k)
+        {
+            const size_t last = std::min(numRows, (k + 1)*_compensatedBlock);
+            for(size_t c = c0; c < c1; ++c)
+                leaves[(c - c0)*numLeaves + k] = _compensatedLeaf(v.col(c), k*_compensatedBlock, last, makeFunc(c));
+        }
+        for(size_t c = c0; c < c1; ++c)
+        {
+            const _CompensatedSum<_Tp>* column = leaves.data() + (c - c0)*numLeaves;
+            out[c - c0] = _compensatedTree<_Tp>(0, numLeaves, [&](size_t k) { return column[k]; }).value();
+        }
+    }
+
+    //Deterministic sums along one axis: out[i] is the sum of makeFunc(i)(x)
+    //over row i, or column i
+    template<bool _Rowwise, typename _PolicyTp, typename _Tp, typename _MakeFuncTp>
+    void _compensatedAxis(const _PolicyTp& policy, const LimnoMatrixView<const _Tp>& v, _MakeFuncTp makeFunc, _Tp* out)
+    {
+        if constexpr(_Rowwise)
+        {
+            _forRowBlocks(policy, v.numRows(), v.numCols(), [&](size_t first, size_t last)
+            {
+                for(size_t r = first; r < last; ++r)
+                    out[r] = _compensatedSum(sequenced_policy{}, v.row(r), makeFunc(r));
+            });
+        }
+        else if constexpr(_isParallelPolicy<_PolicyTp>)
+        {
+            const size_t grain = std::max<size_t>(8, LIMNO_PARALLEL_GRAIN/std::max<size_t>(v.numRows(), 1));
+            _parallelChunks(_partition(v.numCols(), 8, 0, grain), [&](size_t first, size_t last)
+                { _compensatedColumns(v, first, last, makeFunc, out + first); });
+        }
+        else
+            _compensatedColumns(v, 0, v.numCols(), makeFunc, out);
+    }
+
+    //Deterministic sum, mean, var or norm along one axis
+    template<_ReduceOp _Op, bool _Rowwise, typename _PolicyTp, typename _Tp>
+    void _compensatedAxisOp(const _PolicyTp& policy, const LimnoMatrixView<const _Tp>& v, _Tp* out)
+    {
+        const size_t numResults = _Rowwise ? v.numRows() : v.numCols();
+        const _Tp length = static_cast<_Tp>(_Rowwise ? v.numCols() : v.numRows());
+        auto identity = [](size_t) { return [](_Tp x) { return x; }; };
+        if constexpr(_Op == _ReduceOp::norm)
+        {
+            _compensatedAxis<_Rowwise>(policy, v, [](size_t) { return [](_Tp x) { return x*x; }; }, out);
+            for(size_t i = 0; i < numResults; ++i)
+                out[i] = std::sqrt(out[i]);
+            return;
+        }
+        _compensatedAxis<_Rowwise>(policy, v, identity, out);
+        if constexpr(_Op != _ReduceOp::sum)
+        {
+            for(size_t i = 0; i < numResults; ++i)
+                out[i] /= length;
+        }
+        if constexpr(_Op == _ReduceOp::var)
+        {
+            const std::vector<_Tp> means(out, out + numResults);
+            _compensatedAxis<_Rowwise>(policy, v, [&](size_t i) 
+                { return [mean = means[i]](_Tp x) { return (x - mean)*(x - mean); }; }, out);
+            for(size_t i = 0; i < numResults; ++i)
+                out[i] /= length;
+        }
+    }
+
+    //Row and column of the first element equal to value, the smallest or 
+    //largest element of v. Only NaN extremes fall back to comparing
+    template<bool _Max, typename _Tp>
+    std::pair<size_t, size_t> _locate(const LimnoMatrixView<const _Tp>& v, _Tp value)
+    {
+        for(size_t r = 0; r < v.numRows(); ++r)
+            for(size_t c = 0; c < v.numCols(); ++c)
+            {
+                if (v(r, c) == value)
+                    return {r, c};
+            }
+        std::pair<size_t, size_t> best{0, 0};
+        for(size_t r = 0; r < v.numRows(); ++r)
+            for(size_t c = 0; c < v.numCols(); ++c)
+            {
+                if (_Max ? v(r, c) > v(best.first, best.second) : v(r, c) < v(best.first, best.second))
+                    best = {r, c};
+            }
+        return best;
+    }
+
+    //Reduces a whole view to one value
+    template<_ReduceOp _Op, bool _Deterministic, typename _PolicyTp, typename _Tp>
+    auto _reduceAllOp(const _PolicyTp& policy, const LimnoMatrixView<const _Tp>& v)
+    {
+        using result_type = _reduce_t<_Op, _Tp>;
+        constexpr bool isSum = _Op == _ReduceOp::sum || _Op == _ReduceOp::mean || _Op == _ReduceOp::var || _Op == _ReduceOp::norm;
+        if (v.empty())
+        {
+            if constexpr(_Op == _ReduceOp::sum || _Op == _ReduceOp::norm)
+                return result_type{};
+            else
+                throw std::invalid_argument("Matrix is empty!");
+        }
+
+        if constexpr(isSum && _Deterministic && std::is_floating_point_v<_Tp>)
+        {
+            const _Tp n = static_cast<_Tp>(v.size());
+            if constexpr(_Op == _ReduceOp::norm)
+                return std::sqrt(_compensatedSum(policy, v, [](_Tp x) { return x*x; }));
+            else
+            {
+                const _Tp sum = _compensatedSum(policy, v, [](_Tp x) { return x; });
+                if constexpr(_Op == _ReduceOp::sum)
+                    return sum;
+                else if constexpr(_Op == _ReduceOp::mean)
+                    return sum/n;
+                else
+                    return _compensatedSum(policy, v, [mean = sum/n](_Tp x) { return (x - mean)*(x - mean); })/n;
+            }
+        }
+        else
+        {
+            const auto& kernels = _simdKernels<_Tp>();
+            if constexpr(_Op == _ReduceOp::sum)
+                return _reduceAll(policy, v, kernels.sum, std::plus<>{});
+            else if constexpr(_Op == _ReduceOp::mean || _Op == _ReduceOp::var)
+            {
+                const result_type n = static_cast<result_type>(v.size());
+                const result_type mean = static_cast<result_type>(_reduceAll(policy, v, kernels.sum, std::plus<>{}))/n;
+                if constexpr(_Op == _ReduceOp::mean)
+                    return mean;
+                else
+                    return _reduceAll(policy, v, [mean](const _Tp* p, size_t count) 
+                        { return _squaredDeviations(p, mean, count); }, std::plus<>{})/n;
+            }
+            else if constexpr(_Op == _ReduceOp::norm)
+                return std::sqrt(static_cast<result_type>(_reduceAll(policy, v, kernels.sumSquares, std::plus<>{})));
+            else if constexpr(_Op == _ReduceOp::min || _Op == _ReduceOp::argmin)
+            {
+                const _Tp value = _reduceAll(policy, v, kernels.min, [](_Tp a, _Tp b) { return (b < a) ? b : a; });
+                if constexpr(_Op == _ReduceOp::min)
+                    return value;
+                else
+                    return _locate<false>(v, value);
+            }
+            else
+            {
+                const _Tp value = _reduceAll(policy, v, kernels.max, [](_Tp a, _Tp b) { return (b > a) ? b : a; });
+                if constexpr(_Op == _ReduceOp::max)
+                    return value;
+                else
+                    return _locate<true>(v, value);
+            }
+        }
+    }
+
+    //Reduces along one axis into out, one value per row when _Rowwise and per
+    //column otherwise
+    template<_ReduceOp _Op, bool _Deterministic, bool _Rowwise, typename _PolicyTp, typename _Tp>
+    void _reduceAxisOp(const _PolicyTp& policy, const LimnoMatrixView<const _Tp>& v, _reduce_t<_Op, _Tp>* out)
+    {
+        constexpr bool isSum = _Op == _ReduceOp::sum || _Op == _ReduceOp::mean || _Op == _ReduceOp::var || _Op == _ReduceOp::norm;
+        const size_t numResults = _Rowwise ? v.numRows() : v.numCols();
+        const size_t length = _Rowwise ? v.numCols() : v.numRows();
+        if (numResults == 0)
+            return;
+        if (length == 0 && _Op != _ReduceOp::sum && _Op != _ReduceOp::norm)
+            throw std::invalid_argument("Matrix is empty!");
+
+        if constexpr(isSum && _Deterministic && std::is_floating_point_v<_Tp>)
+            _compensatedAxisOp<_Op, _Rowwise>(policy, v, out);
+        else if constexpr(_Rowwise)
+            _reduceRowwise<_Op>(policy, v, out);
+        else
+            _reduceColwise<_Op>(policy, v, out);
+    }
+
+    //Name of a reduction for the instrumentation hooks
+    constexpr const char* _reduceOpName(_ReduceOp op) noexcept
+    {
+        switch(op)
+        {
+            case _ReduceOp::sum:
+                return "sum";
+            case _ReduceOp::mean:
+                return "mean";
+            case _ReduceOp::var:
+                return "var";
+            case _ReduceOp::norm:
+                return "norm";
+            case _ReduceOp::min:
+                return "min";
+            case _ReduceOp::max:
+                return "max";
+            case _ReduceOp::argmin:
+                return "argmin";
+            default:
+                return "argmax";
+        }
+    }
+
+    template<_ReduceOp _Op, typename... _OptsTp, typename _PolicyTp, typename _MatTp>
+    auto _reduction(const _PolicyTp& policy, const _MatTp& m)
+    {
+        using options = _ReductionOptions<_OptsTp...>;
+        static_assert(options::valid, "Reductions take at most one axis and one deterministic option!");
+        using value_type = _OperandValue_t<_MatTp>;
+        const LimnoMatrixView<const value_type> v = _reductionView(m);
+        LIMNO_INSTRUMENT_OPERATION(_reduceOpName(_Op), ((_Op == _ReduceOp::var || _Op == _ReduceOp::norm) ? 2 : 1)*v.size(),
+            v.size()*sizeof(value_type));
+        if constexpr(!options::rowwise && !options::colwise)
+            return _reduceAllOp<_Op, options::deterministic>(policy, v);
+        else
+        {
+            using result_type = _axis_result_t<_reduce_t<_Op, value_type>, _OperandTraits<_MatTp>::rows, 
+                _OperandTraits<_MatTp>::cols, options::rowwise>;
+            result_type result;
+            if constexpr(runtimeDim<_OperandTraits<_MatTp>::rows, _OperandTraits<_MatTp>::cols>)
+                result = result_type(Limno::uninitialized, options::rowwise ? v.numRows() : 1, options::rowwise ? 1 : v.numCols());
+            _reduceAxisOp<_Op, options::deterministic, options::rowwise>(policy, v, result.data());
+            return result;
+        }
+    }
+
+    //Public reductions. Each takes an optional execution policy, the matrix or
+    //view, then any of Limno::rowwise, Limno::colwise and Limno::deterministic.
+    //sum, norm, min and max without options are the overloads above, except
+    //for views under a policy, which only the overloads below take
+    template<typename _MatTp, typename... _OptsTp>
+    static constexpr bool _needsGenericReduction = sizeof...(_OptsTp) > 0 || _isView<_MatTp>;
+
+    //Sums
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto sum(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::sum, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0)
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0), int> = 0>
+    #endif
+    auto sum(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::sum, _OptsTp...>(Limno::seq, m);
+    }
+
+    //Means; integral matrices produce doubles
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto mean(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::mean, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto mean(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::mean, _OptsTp...>(Limno::seq, m);
+    }
+
+    //Population variances, the mean squared deviation from the mean
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto var(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::var, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto var(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::var, _OptsTp...>(Limno::seq, m);
+    }
+
+    //Euclidean norms, or the Frobenius norm of the whole matrix
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto norm(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::norm, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0)
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0), int> = 0>
+    #endif
+    auto norm(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::norm, _OptsTp...>(Limno::seq, m);
+    }
+
+    //Smallest elements
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto min(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::min, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0)
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0), int> = 0>
+    #endif
+    auto min(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::min, _OptsTp...>(Limno::seq, m);
+    }
+
+    //Largest elements
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...> && _needsGenericReduction<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto max(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::max, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0)
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...> && (sizeof...(_OptsTp) > 0), int> = 0>
+    #endif
+    auto max(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::max, _OptsTp...>(Limno::seq, m);
+    }
+
+    //Positions of the smallest elements, the first if tied. Without an axis
+    //the (row, column) of the smallest element is returned
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto argmin(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::argmin, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto argmin(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::argmin, _OptsTp...>(Limno::seq, m);
+    }
+
+    //Positions of the largest elements, the first if tied
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp>
+        requires _isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _PolicyTp, typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp> && _isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto argmax(_PolicyTp&& policy, const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::argmax, _OptsTp...>(policy, m);
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _MatTp, typename... _OptsTp>
+        requires _isReductionCall<_MatTp, _OptsTp...>
+    #else
+    template<typename _MatTp, typename... _OptsTp,
+        std::enable_if_t<_isReductionCall<_MatTp, _OptsTp...>, int> = 0>
+    #endif
+    auto argmax(const _MatTp& m, _OptsTp...)
+    {
+        return _reduction<_ReduceOp::argmax, _OptsTp...>(Limno::seq, m);
+    }
+}
+
+#endif
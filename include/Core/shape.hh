@@ -0,0 +1,50 @@
+#ifndef SHAPE_HH
+#define SHAPE_HH 1
+
+#include <cstddef>
+
+#include "config.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Indicate dimension isn't known at compile-time
+    static constexpr int DYNAMIC = -1;
+
+    //Convenience variable indicating if dimensions known at
+    //compile-time
+    template<int _Nrows, int _Ncols>
+    static constexpr bool runtimeDim = _Nrows == DYNAMIC || _Ncols == DYNAMIC;
+
+    //True if two extents can describe the same dimension; a dynamic
+    //extent is compatible with everything
+    template<int _N1, int _N2>
+    static constexpr bool compatibleDim = _N1 == DYNAMIC || _N2 == DYNAMIC || _N1 == _N2;
+
+    //Extent resulting from combining two compatible extents. A static
+    //extent wins over a dynamic one
+    template<int _N1, int _N2>
+    static constexpr int commonDim = (_N1 == DYNAMIC) ? _N2 : _N1;
+
+    //Extent of two extents laid end to end, as in a concatenation; dynamic
+    //if either is
+    template<int _N1, int _N2>
+    static constexpr int sumDim = (_N1 == DYNAMIC || _N2 == DYNAMIC) ? DYNAMIC : _N1 + _N2;
+
+    //True if both extents are static, in which case compatibleDim has
+    //already checked that they agree
+    template<int _N1, int _N2>
+    static constexpr bool staticDim = _N1 != DYNAMIC && _N2 != DYNAMIC;
+
+    //Runtime check that two extents agree. It compiles away when both are
+    //static, so kernels only test the extents a static_assert couldn't
+    template<int _N1, int _N2>
+    constexpr bool sameDim(size_t n1, size_t n2) noexcept
+    {
+        if constexpr(staticDim<_N1, _N2>)
+            return true;
+        else
+            return n1 == n2;
+    }
+}
+
+#endif
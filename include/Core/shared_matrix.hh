@@ -0,0 +1,261 @@
+#ifndef SHARED_MATRIX_HH
+#define SHARED_MATRIX_HH 1
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "config.hh"
+#include "Core/construction.hh"
+#include "Core/expression_templates.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Copy-on-write matrix. Copies, rows, columns, blocks, slices and
+    //transposes all share one reference-counted buffer, so passing a large
+    //matrix around or handing out pieces of it never copies. The first write
+    //through a non-const accessor (operator() or mutableView) copies the
+    //elements this matrix can see into a buffer of its own if any other
+    //shared_matrix still refers to the buffer.
+    //
+    //As with std::shared_ptr, different shared_matrix objects sharing a
+    //buffer may be used from different threads, but one object must not be
+    //read and written concurrently. References and views returned by the
+    //non-const accessors write straight into the buffer, so they must not be
+    //kept across copies of the matrix
+    template<typename _Tp, typename _AllocTp = std::allocator<_Tp>>
+    class shared_matrix
+    {
+        public:
+        using value_type = _Tp;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = _Tp&;
+        using const_reference = const _Tp&;
+        using buffer_type = LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC, _AllocTp>;
+        using view_type = LimnoMatrixView<_Tp>;
+        using const_view_type = LimnoMatrixView<const _Tp>;
+
+        shared_matrix() noexcept = default;
+
+        //Allocates but does not initialize, like LimnoMatrixBase
+        shared_matrix(size_type numRows, size_type numCols)
+            : shared_matrix(buffer_type(Limno::uninitialized, numRows, numCols))
+        {
+
+        }
+
+        shared_matrix(uninitialized_t, size_type numRows, size_type numCols)
+            : shared_matrix(buffer_type(Limno::uninitialized, numRows, numCols))
+        {
+
+        }
+
+        shared_matrix(zeros_t, size_type numRows, size_type numCols)
+            : shared_matrix(buffer_type(Limno::zeros, numRows, numCols))
+        {
+
+        }
+
+        //Takes over the storage of a matrix without copying it
+        explicit shared_matrix(buffer_type&& m)
+            : _buffer{std::make_shared<buffer_type>(std::move(m))}
+        {
+            _window = _buffer->view();
+        }
+
+        //Copies a matrix, view or expression once; later copies share it
+        #if __cplusplus > 201703L
+        template<typename _SrcTp>
+            requires (_OperandTraits<_SrcTp>::isMatrix && !std::is_same_v<_SrcTp, buffer_type> && !std::is_same_v<_SrcTp, shared_matrix>)
+        #else
+        template<typename _SrcTp,
+            std::enable_if_t<_OperandTraits<_SrcTp>::isMatrix && !std::is_same_v<_SrcTp, buffer_type> && 
+            !std::is_same_v<_SrcTp, shared_matrix>, int> = 0>
+        #endif
+        explicit shared_matrix(const _SrcTp& src)
+            : shared_matrix(buffer_type(src))
+        {
+
+        }
+
+        explicit shared_matrix(const buffer_type& m)
+            : shared_matrix(buffer_type(m))
+        {
+
+        }
+
+        //Replaces the contents with the value of an expression, evaluated into
+        //a new buffer so the expression may refer to this matrix
+        template<typename _Callable, typename... _ArgsTp>
+        shared_matrix& operator=(const _Expr<_Callable, _ArgsTp...>& expr)
+        {
+            return *this = shared_matrix(buffer_type(expr));
+        }
+
+        //Shape and layout
+        size_type numRows() const noexcept
+        {
+            return _window.numRows();
+        }
+
+        size_type numCols() const noexcept
+        {
+            return _window.numCols();
+        }
+
+        size_type size() const noexcept
+        {
+            return _window.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return _window.empty();
+        }
+
+        //Number of shared_matrix objects referring to the buffer, 0 if none
+        long useCount() const noexcept
+        {
+            return _buffer.use_count();
+        }
+
+        bool isShared() const noexcept
+        {
+            return _buffer.use_count() > 1;
+        }
+
+        //Read access never copies
+        const_reference operator()(size_type r, size_type c) const noexcept
+        {
+            return _window(r, c);
+        }
+
+        const_view_type view() const noexcept
+        {
+            return _window;
+        }
+
+        //Write access; copies the visible elements first if the buffer is shared
+        reference operator()(size_type r, size_type c)
+        {
+            _detach();
+            return _mutableWindow()(r, c);
+        }
+
+        view_type mutableView()
+        {
+            _detach();
+            return _mutableWindow();
+        }
+
+        //Pieces of the matrix sharing its buffer
+        shared_matrix row(size_type r) const
+        {
+            return shared_matrix{_buffer, _window.row(r)};
+        }
+
+        shared_matrix col(size_type c) const
+        {
+            return shared_matrix{_buffer, _window.col(c)};
+        }
+
+        shared_matrix block(size_type r0, size_type c0, size_type numRows, size_type numCols) const
+        {
+            return shared_matrix{_buffer, _window.block(r0, c0, numRows, numCols)};
+        }
+
+        shared_matrix slice(size_type rowBegin, size_type rowEnd, size_type rowStep,
+            size_type colBegin, size_type colEnd, size_type colStep) const
+        {
+            return shared_matrix{_buffer, _window.slice(rowBegin, rowEnd, rowStep, colBegin, colEnd, colStep)};
+        }
+
+        shared_matrix transpose() const noexcept
+        {
+            return shared_matrix{_buffer, _window.transpose()};
+        }
+
+        //Dense copy of the visible elements
+        buffer_type toMatrix() const
+        {
+            return buffer_type(_window);
+        }
+
+        //Dense matrix of the visible elements, without copying if this is the
+        //only reference to a buffer it covers exactly
+        buffer_type release() &&
+        {
+            if (_buffer.use_count() == 1 && _coversBuffer())
+            {
+                buffer_type result = std::move(*_buffer);
+                *this = shared_matrix{};
+                return result;
+            }
+            buffer_type result = toMatrix();
+            *this = shared_matrix{};
+            return result;
+        }
+        private:
+        shared_matrix(std::shared_ptr<buffer_type> buffer, const const_view_type& window) noexcept
+            : _buffer{std::move(buffer)}, _window{window}
+        {
+
+        }
+
+        bool _coversBuffer() const noexcept
+        {
+            const const_view_type whole = std::as_const(*_buffer).view();
+            return _window.data() == whole.data() && _window.numRows() == whole.numRows() && _window.numCols() == whole.numCols() &&
+                _window.rowStride() == whole.rowStride() && _window.colStride() == whole.colStride();
+        }
+
+        //Gives this matrix a buffer of its own holding just its elements. A
+        //sole owner keeps its buffer, even when it only sees part of it
+        void _detach()
+        {
+            if (_buffer.use_count() > 1)
+                *this = shared_matrix(toMatrix());
+        }
+
+        //Only valid once detached; the window is stored read-only so the const
+        //accessors can't write
+        view_type _mutableWindow() const noexcept
+        {
+            return view_type{const_cast<_Tp*>(_window.data()), _window.numRows(), _window.numCols(),
+                _window.rowStride(), _window.colStride()};
+        }
+
+        std::shared_ptr<buffer_type> _buffer;
+        const_view_type _window;
+    };
+
+    //Shared matrices take part in expressions like any other matrix
+    template<typename _Tp, typename _AllocTp>
+    struct _OperandTraits<shared_matrix<_Tp, _AllocTp>>
+    {
+        using matrix_type = shared_matrix<_Tp, _AllocTp>;
+        using value_type = _Tp;
+        static constexpr bool isMatrix = true;
+        static constexpr bool storedByValue = false;
+        static constexpr bool contiguous = false;
+        static constexpr int rows = DYNAMIC;
+        static constexpr int cols = DYNAMIC;
+
+        static const _Tp& at(const matrix_type& m, size_t i) noexcept
+        {
+            return m(i/m.numCols(), i % m.numCols());
+        }
+
+        static const _Tp& at(const matrix_type& m, size_t r, size_t c) noexcept
+        {
+            return m(r, c);
+        }
+    };
+}
+
+#endif
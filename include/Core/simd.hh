@@ -0,0 +1,490 @@
+#ifndef SIMD_HH
+#define SIMD_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+#include "config.hh"
+#include "Core/expression_templates.hh"
+
+//Explicit SIMD kernels are only built for x86 with GCC or Clang, everything
+//else uses the scalar kernels. Define LIMNO_DISABLE_SIMD to force that.
+#if !defined(LIMNO_DISABLE_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define LIMNO_SIMD_X86 1
+    #include <immintrin.h>
+#else
+    #define LIMNO_SIMD_X86 0
+#endif
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Instruction sets with a kernel implementation, in increasing order
+    enum class _SimdIsa
+    {
+        scalar,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    enum class _SimdOp
+    {
+        add,
+        sub,
+        mul,
+        div
+    };
+
+    enum class _SimdReduce
+    {
+        add,
+        min,
+        max
+    };
+
+    template<_SimdOp _Op, typename _Tp>
+    constexpr _Tp _applyScalarOp(_Tp a, _Tp b) noexcept
+    {
+        if constexpr(_Op == _SimdOp::add)
+            return a + b;
+        else if constexpr(_Op == _SimdOp::sub)
+            return a - b;
+        else if constexpr(_Op == _SimdOp::mul)
+            return a*b;
+        else
+            return a/b;
+    }
+
+    //Kernels over contiguous buffers for one element type and one instruction set
+    template<typename _Tp>
+    struct _SimdKernels
+    {
+        using binary_fn = void (*)(const _Tp*, const _Tp*, _Tp*, size_t);
+        using binary_scalar_rhs_fn = void (*)(const _Tp*, _Tp, _Tp*, size_t);
+        using binary_scalar_lhs_fn = void (*)(_Tp, const _Tp*, _Tp*, size_t);
+        using reduce_fn = _Tp (*)(const _Tp*, size_t);
+        using reduce2_fn = _Tp (*)(const _Tp*, const _Tp*, size_t);
+        using reduce_shift_fn = _Tp (*)(const _Tp*, _Tp, size_t);
+
+        binary_fn binary[4];
+        binary_scalar_rhs_fn binaryScalarRhs[4];
+        binary_scalar_lhs_fn binaryScalarLhs[4];
+        reduce_fn sum;
+        reduce2_fn dot;
+        reduce_fn sumSquares;
+        reduce_shift_fn sumSquaredDeviations;
+        reduce_fn min;
+        reduce_fn max;
+    };
+
+    namespace _scalar
+    {
+        //One element per "register"; used for non floating point types and as
+        //the fallback on other architectures
+        template<typename _Tp>
+        struct _Reg
+        {
+            using value_type = _Tp;
+            using reg = _Tp;
+            using mask = bool;
+            static constexpr size_t width = 1;
+
+            static reg load(const _Tp* p) noexcept { return *p; }
+            static void store(_Tp* p, reg r) noexcept { *p = r; }
+            static reg broadcast(_Tp s) noexcept { return s; }
+            static reg zero() noexcept { return _Tp{}; }
+            static reg add(reg a, reg b) noexcept { return a + b; }
+            static reg sub(reg a, reg b) noexcept { return a - b; }
+            static reg mul(reg a, reg b) noexcept { return a*b; }
+            static reg div(reg a, reg b) noexcept { return a/b; }
+            static reg min(reg a, reg b) noexcept { return (b < a) ? b : a; }
+            static reg max(reg a, reg b) noexcept { return (b > a) ? b : a; }
+            static reg abs(reg a) noexcept { return (a < _Tp{}) ? -a : a; }
+            static mask greater(reg a, reg b) noexcept { return a > b; }
+            static reg select(mask m, reg a, reg b) noexcept { return m ? a : b; }
+        };
+
+        #include "Core/simd_kernels.inl"
+    }
+
+    #if LIMNO_SIMD_X86
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("sse2")
+    #endif
+    namespace _sse2
+    {
+        template<typename _Tp>
+        struct _Reg;
+
+        template<>
+        struct _Reg<double>
+        {
+            using value_type = double;
+            using reg = __m128d;
+            using mask = __m128d;
+            static constexpr size_t width = 2;
+
+            static reg load(const double* p) noexcept { return _mm_loadu_pd(p); }
+            static void store(double* p, reg r) noexcept { _mm_storeu_pd(p, r); }
+            static reg broadcast(double s) noexcept { return _mm_set1_pd(s); }
+            static reg zero() noexcept { return _mm_setzero_pd(); }
+            static reg add(reg a, reg b) noexcept { return _mm_add_pd(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm_sub_pd(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm_mul_pd(a, b); }
+            static reg div(reg a, reg b) noexcept { return _mm_div_pd(a, b); }
+            static reg min(reg a, reg b) noexcept { return _mm_min_pd(a, b); }
+            static reg max(reg a, reg b) noexcept { return _mm_max_pd(a, b); }
+            static reg abs(reg a) noexcept { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+            static mask greater(reg a, reg b) noexcept { return _mm_cmpgt_pd(a, b); }
+            static reg select(mask m, reg a, reg b) noexcept { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+        };
+
+        template<>
+        struct _Reg<float>
+        {
+            using value_type = float;
+            using reg = __m128;
+            using mask = __m128;
+            static constexpr size_t width = 4;
+
+            static reg load(const float* p) noexcept { return _mm_loadu_ps(p); }
+            static void store(float* p, reg r) noexcept { _mm_storeu_ps(p, r); }
+            static reg broadcast(float s) noexcept { return _mm_set1_ps(s); }
+            static reg zero() noexcept { return _mm_setzero_ps(); }
+            static reg add(reg a, reg b) noexcept { return _mm_add_ps(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm_sub_ps(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm_mul_ps(a, b); }
+            static reg div(reg a, reg b) noexcept { return _mm_div_ps(a, b); }
+            static reg min(reg a, reg b) noexcept { return _mm_min_ps(a, b); }
+            static reg max(reg a, reg b) noexcept { return _mm_max_ps(a, b); }
+            static reg abs(reg a) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+            static mask greater(reg a, reg b) noexcept { return _mm_cmpgt_ps(a, b); }
+            static reg select(mask m, reg a, reg b) noexcept { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        };
+
+        #include "Core/simd_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("avx2")
+    #endif
+    namespace _avx2
+    {
+        template<typename _Tp>
+        struct _Reg;
+
+        template<>
+        struct _Reg<double>
+        {
+            using value_type = double;
+            using reg = __m256d;
+            using mask = __m256d;
+            static constexpr size_t width = 4;
+
+            static reg load(const double* p) noexcept { return _mm256_loadu_pd(p); }
+            static void store(double* p, reg r) noexcept { _mm256_storeu_pd(p, r); }
+            static reg broadcast(double s) noexcept { return _mm256_set1_pd(s); }
+            static reg zero() noexcept { return _mm256_setzero_pd(); }
+            static reg add(reg a, reg b) noexcept { return _mm256_add_pd(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm256_sub_pd(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm256_mul_pd(a, b); }
+            static reg div(reg a, reg b) noexcept { return _mm256_div_pd(a, b); }
+            static reg min(reg a, reg b) noexcept { return _mm256_min_pd(a, b); }
+            static reg max(reg a, reg b) noexcept { return _mm256_max_pd(a, b); }
+            static reg abs(reg a) noexcept { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+            static mask greater(reg a, reg b) noexcept { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+            static reg select(mask m, reg a, reg b) noexcept { return _mm256_blendv_pd(b, a, m); }
+        };
+
+        template<>
+        struct _Reg<float>
+        {
+            using value_type = float;
+            using reg = __m256;
+            using mask = __m256;
+            static constexpr size_t width = 8;
+
+            static reg load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+            static void store(float* p, reg r) noexcept { _mm256_storeu_ps(p, r); }
+            static reg broadcast(float s) noexcept { return _mm256_set1_ps(s); }
+            static reg zero() noexcept { return _mm256_setzero_ps(); }
+            static reg add(reg a, reg b) noexcept { return _mm256_add_ps(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm256_sub_ps(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm256_mul_ps(a, b); }
+            static reg div(reg a, reg b) noexcept { return _mm256_div_ps(a, b); }
+            static reg min(reg a, reg b) noexcept { return _mm256_min_ps(a, b); }
+            static reg max(reg a, reg b) noexcept { return _mm256_max_ps(a, b); }
+            static reg abs(reg a) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+            static mask greater(reg a, reg b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+            static reg select(mask m, reg a, reg b) noexcept { return _mm256_blendv_ps(b, a, m); }
+        };
+
+        #include "Core/simd_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("avx512f")
+    #endif
+    namespace _avx512
+    {
+        template<typename _Tp>
+        struct _Reg;
+
+        template<>
+        struct _Reg<double>
+        {
+            using value_type = double;
+            using reg = __m512d;
+            using mask = __mmask8;
+            static constexpr size_t width = 8;
+
+            static reg load(const double* p) noexcept { return _mm512_loadu_pd(p); }
+            static void store(double* p, reg r) noexcept { _mm512_storeu_pd(p, r); }
+            static reg broadcast(double s) noexcept { return _mm512_set1_pd(s); }
+            static reg zero() noexcept { return _mm512_setzero_pd(); }
+            static reg add(reg a, reg b) noexcept { return _mm512_add_pd(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm512_sub_pd(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm512_mul_pd(a, b); }
+            static reg div(reg a, reg b) noexcept { return _mm512_div_pd(a, b); }
+            //The unmasked forms trip -Wmaybe-uninitialized in GCC's headers at -O3
+            static reg min(reg a, reg b) noexcept { return _mm512_mask_min_pd(a, static_cast<__mmask8>(-1), a, b); }
+            static reg max(reg a, reg b) noexcept { return _mm512_mask_max_pd(a, static_cast<__mmask8>(-1), a, b); }
+            static reg abs(reg a) noexcept { return _mm512_abs_pd(a); }
+            static mask greater(reg a, reg b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+            static reg select(mask m, reg a, reg b) noexcept { return _mm512_mask_blend_pd(m, b, a); }
+        };
+
+        template<>
+        struct _Reg<float>
+        {
+            using value_type = float;
+            using reg = __m512;
+            using mask = __mmask16;
+            static constexpr size_t width = 16;
+
+            static reg load(const float* p) noexcept { return _mm512_loadu_ps(p); }
+            static void store(float* p, reg r) noexcept { _mm512_storeu_ps(p, r); }
+            static reg broadcast(float s) noexcept { return _mm512_set1_ps(s); }
+            static reg zero() noexcept { return _mm512_setzero_ps(); }
+            static reg add(reg a, reg b) noexcept { return _mm512_add_ps(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm512_sub_ps(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm512_mul_ps(a, b); }
+            static reg div(reg a, reg b) noexcept { return _mm512_div_ps(a, b); }
+            static reg min(reg a, reg b) noexcept { return _mm512_mask_min_ps(a, static_cast<__mmask16>(-1), a, b); }
+            static reg max(reg a, reg b) noexcept { return _mm512_mask_max_ps(a, static_cast<__mmask16>(-1), a, b); }
+            static reg abs(reg a) noexcept { return _mm512_abs_ps(a); }
+            static mask greater(reg a, reg b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+            static reg select(mask m, reg a, reg b) noexcept { return _mm512_mask_blend_ps(m, b, a); }
+        };
+
+        #include "Core/simd_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+    #endif // LIMNO_SIMD_X86
+
+    //Best instruction set supported by the CPU we are running on. The
+    //LIMNO_SIMD environment variable (scalar, sse2, avx2 or avx512) caps the
+    //selection, which is useful for testing the fallbacks on a single host.
+    inline _SimdIsa _detectSimdIsa() noexcept
+    {
+        _SimdIsa isa = _SimdIsa::scalar;
+        #if LIMNO_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            isa = _SimdIsa::avx512;
+        else if (__builtin_cpu_supports("avx2"))
+            isa = _SimdIsa::avx2;
+        else if (__builtin_cpu_supports("sse2"))
+            isa = _SimdIsa::sse2;
+        #endif
+
+        if (const char* cap = std::getenv("LIMNO_SIMD"))
+        {
+            _SimdIsa limit = isa;
+            if (std::strcmp(cap, "scalar") == 0)
+                limit = _SimdIsa::scalar;
+            else if (std::strcmp(cap, "sse2") == 0)
+                limit = _SimdIsa::sse2;
+            else if (std::strcmp(cap, "avx2") == 0)
+                limit = _SimdIsa::avx2;
+            isa = std::min(isa, limit);
+        }
+        return isa;
+    }
+
+    //Instruction set used by the dispatched kernels; detected once per process
+    inline _SimdIsa simdIsa() noexcept
+    {
+        static const _SimdIsa isa = _detectSimdIsa();
+        return isa;
+    }
+
+    //Kernel table for an instruction set. The caller must make sure the CPU
+    //supports it. Only float and double have vector kernels.
+    template<typename _Tp>
+    _SimdKernels<_Tp> _simdKernelsFor(_SimdIsa isa) noexcept
+    {
+        #if LIMNO_SIMD_X86
+        if constexpr(std::is_same_v<_Tp, float> || std::is_same_v<_Tp, double>)
+        {
+            switch(isa)
+            {
+                case _SimdIsa::avx512:
+                    return _avx512::_kernelTable<_avx512::_Reg<_Tp>>();
+                case _SimdIsa::avx2:
+                    return _avx2::_kernelTable<_avx2::_Reg<_Tp>>();
+                case _SimdIsa::sse2:
+                    return _sse2::_kernelTable<_sse2::_Reg<_Tp>>();
+                default:
+                    break;
+            }
+        }
+        #endif
+        (void)isa;
+        return _scalar::_kernelTable<_scalar::_Reg<_Tp>>();
+    }
+
+    //Kernels for the best instruction set of the running CPU
+    template<typename _Tp>
+    const _SimdKernels<_Tp>& _simdKernels() noexcept
+    {
+        static const _SimdKernels<_Tp> kernels = _simdKernelsFor<_Tp>(simdIsa());
+        return kernels;
+    }
+
+    //Maps the callables used by the element-wise operators onto kernels
+    template<typename _Callable>
+    struct _SimdBinaryOp
+    {
+        static constexpr bool supported = false;
+    };
+
+    template<>
+    struct _SimdBinaryOp<std::plus<>>
+    {
+        static constexpr bool supported = true;
+        static constexpr _SimdOp op = _SimdOp::add;
+    };
+
+    template<>
+    struct _SimdBinaryOp<std::minus<>>
+    {
+        static constexpr bool supported = true;
+        static constexpr _SimdOp op = _SimdOp::sub;
+    };
+
+    template<>
+    struct _SimdBinaryOp<std::multiplies<>>
+    {
+        static constexpr bool supported = true;
+        static constexpr _SimdOp op = _SimdOp::mul;
+    };
+
+    template<>
+    struct _SimdBinaryOp<std::divides<>>
+    {
+        static constexpr bool supported = true;
+        static constexpr _SimdOp op = _SimdOp::div;
+    };
+
+    //A matrix leaf whose elements are stored contiguously as _Tp
+    template<typename _Tp, typename _OperandTp>
+    static constexpr bool _isDenseLeaf = _OperandTraits<_OperandTp>::isMatrix && !_isExpr<_OperandTp> &&
+        _OperandTraits<_OperandTp>::contiguous && std::is_same_v<_OperandValue_t<_OperandTp>, _Tp>;
+
+    //A matrix or view of _Tp in any layout
+    template<typename _Tp, typename _OperandTp>
+    static constexpr bool _isMatrixLeaf = _OperandTraits<_OperandTp>::isMatrix && !_isExpr<_OperandTp> &&
+        std::is_same_v<_OperandValue_t<_OperandTp>, _Tp>;
+
+    template<typename _Tp, typename _ExprTp>
+    struct _SimdEvaluable
+    {
+        static constexpr bool value = false;
+    };
+
+    //Binary expressions over dense leaves or a dense leaf and a scalar can be
+    //evaluated by a single kernel call
+    template<typename _Tp, typename _Callable, typename _LTp, typename _RTp>
+    struct _SimdEvaluable<_Tp, _Expr<_Callable, _LTp, _RTp>>
+    {
+        static constexpr bool value = (std::is_same_v<_Tp, float> || std::is_same_v<_Tp, double>) &&
+            _SimdBinaryOp<_Callable>::supported &&
+            ((_isDenseLeaf<_Tp, _LTp> && _isDenseLeaf<_Tp, _RTp>) ||
+             (_isDenseLeaf<_Tp, _LTp> && std::is_arithmetic_v<_RTp>) ||
+             (std::is_arithmetic_v<_LTp> && _isDenseLeaf<_Tp, _RTp>));
+    };
+
+    //True if expr has the shape the kernels evaluate, with any layout of its
+    //matrix operand, and a scalar operand that is not a _Tp. The kernels
+    //round that scalar to _Tp before the operation
+    template<typename _Tp, typename _ExprTp>
+    static constexpr bool _simdConvertsScalar = false;
+
+    template<typename _Tp, typename _Callable, typename _LTp, typename _RTp>
+    constexpr bool _simdConvertsScalar<_Tp, _Expr<_Callable, _LTp, _RTp>> = 
+        (std::is_same_v<_Tp, float> || std::is_same_v<_Tp, double>) && _SimdBinaryOp<_Callable>::supported &&
+        ((std::is_arithmetic_v<_LTp> && !std::is_same_v<_LTp, _Tp> && _isMatrixLeaf<_Tp, _RTp>) || 
+         (std::is_arithmetic_v<_RTp> && !std::is_same_v<_RTp, _Tp> && _isMatrixLeaf<_Tp, _LTp>));
+
+    //The same expression with its scalar operand converted to _Tp, as the
+    //kernels see it, so layouts that can't use them round the same way
+    template<typename _Tp, typename _Callable, typename _LTp, typename _RTp>
+    auto _withScalarAs(const _Expr<_Callable, _LTp, _RTp>& expr)
+    {
+        const auto& lhs = std::get<0>(expr._operands());
+        const auto& rhs = std::get<1>(expr._operands());
+        if constexpr(std::is_arithmetic_v<_LTp>)
+            return _Expr<_Callable, _Tp, _RTp>(_Callable{}, static_cast<_Tp>(lhs), rhs);
+        else
+            return _Expr<_Callable, _LTp, _Tp>(_Callable{}, lhs, static_cast<_Tp>(rhs));
+    }
+
+    //Evaluates the elements [first, last) of expr into out with the dispatched
+    //kernels. Only valid if _SimdEvaluable<_Tp, _ExprTp> holds
+    template<typename _Tp, typename _Callable, typename _LTp, typename _RTp>
+    void _simdEvaluate(const _Expr<_Callable, _LTp, _RTp>& expr, _Tp* out, size_t first, size_t last)
+    {
+        constexpr int op = static_cast<int>(_SimdBinaryOp<_Callable>::op);
+        const _SimdKernels<_Tp>& kernels = _simdKernels<_Tp>();
+        const auto& lhs = std::get<0>(expr._operands());
+        const auto& rhs = std::get<1>(expr._operands());
+        const size_t n = last - first;
+        if constexpr(std::is_arithmetic_v<_LTp>)
+            kernels.binaryScalarLhs[op](static_cast<_Tp>(lhs), rhs.data() + first, out + first, n);
+        else if constexpr(std::is_arithmetic_v<_RTp>)
+            kernels.binaryScalarRhs[op](lhs.data() + first, static_cast<_Tp>(rhs), out + first, n);
+        else
+            kernels.binary[op](lhs.data() + first, rhs.data() + first, out + first, n);
+    }
+}
+
+#endif
@@ -0,0 +1,211 @@
+//Kernel bodies shared by every instruction set. This file intentionally has no
+//include guard: simd.hh includes it once per instruction set, inside a namespace
+//that has already defined the _Reg<float> and _Reg<double> register wrappers and
+//with the matching target enabled, so each copy is compiled for its own ISA.
+
+//Horizontal reduction through memory; only runs once per kernel call
+template<typename _V, _SimdReduce _Kind>
+typename _V::value_type _reduceLanes(typename _V::reg r) noexcept
+{
+    typename _V::value_type lanes[_V::width];
+    _V::store(lanes, r);
+    typename _V::value_type result = lanes[0];
+    for(size_t i = 1; i < _V::width; ++i)
+    {
+        if constexpr(_Kind == _SimdReduce::add)
+            result += lanes[i];
+        else if constexpr(_Kind == _SimdReduce::min)
+            result = (lanes[i] < result) ? lanes[i] : result;
+        else
+            result = (lanes[i] > result) ? lanes[i] : result;
+    }
+    return result;
+}
+
+template<typename _V, _SimdOp _Op>
+inline typename _V::reg _applyOp(typename _V::reg a, typename _V::reg b) noexcept
+{
+    if constexpr(_Op == _SimdOp::add)
+        return _V::add(a, b);
+    else if constexpr(_Op == _SimdOp::sub)
+        return _V::sub(a, b);
+    else if constexpr(_Op == _SimdOp::mul)
+        return _V::mul(a, b);
+    else
+        return _V::div(a, b);
+}
+
+//out[i] = a[i] op b[i]
+template<typename _V, _SimdOp _Op>
+void _binary(const typename _V::value_type* a, const typename _V::value_type* b,
+    typename _V::value_type* out, size_t n) noexcept
+{
+    size_t i = 0;
+    for(; i + _V::width <= n; i += _V::width)
+        _V::store(out + i, _applyOp<_V, _Op>(_V::load(a + i), _V::load(b + i)));
+    for(; i < n; ++i)
+        out[i] = _applyScalarOp<_Op>(a[i], b[i]);
+}
+
+//out[i] = a[i] op s
+template<typename _V, _SimdOp _Op>
+void _binaryScalarRhs(const typename _V::value_type* a, typename _V::value_type s,
+    typename _V::value_type* out, size_t n) noexcept
+{
+    const typename _V::reg sv = _V::broadcast(s);
+    size_t i = 0;
+    for(; i + _V::width <= n; i += _V::width)
+        _V::store(out + i, _applyOp<_V, _Op>(_V::load(a + i), sv));
+    for(; i < n; ++i)
+        out[i] = _applyScalarOp<_Op>(a[i], s);
+}
+
+//out[i] = s op a[i]
+template<typename _V, _SimdOp _Op>
+void _binaryScalarLhs(typename _V::value_type s, const typename _V::value_type* a,
+    typename _V::value_type* out, size_t n) noexcept
+{
+    const typename _V::reg sv = _V::broadcast(s);
+    size_t i = 0;
+    for(; i + _V::width <= n; i += _V::width)
+        _V::store(out + i, _applyOp<_V, _Op>(sv, _V::load(a + i)));
+    for(; i < n; ++i)
+        out[i] = _applyScalarOp<_Op>(s, a[i]);
+}
+
+//Four independent accumulators hide the latency of the vector adds
+template<typename _V>
+typename _V::value_type _sum(const typename _V::value_type* a, size_t n) noexcept
+{
+    constexpr size_t W = _V::width;
+    typename _V::reg acc0 = _V::zero(), acc1 = _V::zero(), acc2 = _V::zero(), acc3 = _V::zero();
+    size_t i = 0;
+    for(; i + 4*W <= n; i += 4*W)
+    {
+        acc0 = _V::add(acc0, _V::load(a + i));
+        acc1 = _V::add(acc1, _V::load(a + i + W));
+        acc2 = _V::add(acc2, _V::load(a + i + 2*W));
+        acc3 = _V::add(acc3, _V::load(a + i + 3*W));
+    }
+    for(; i + W <= n; i += W)
+        acc0 = _V::add(acc0, _V::load(a + i));
+
+    typename _V::value_type result = _reduceLanes<_V, _SimdReduce::add>(_V::add(_V::add(acc0, acc1), _V::add(acc2, acc3)));
+    for(; i < n; ++i)
+        result += a[i];
+    return result;
+}
+
+template<typename _V>
+typename _V::value_type _dot(const typename _V::value_type* a, const typename _V::value_type* b, size_t n) noexcept
+{
+    constexpr size_t W = _V::width;
+    typename _V::reg acc0 = _V::zero(), acc1 = _V::zero();
+    size_t i = 0;
+    for(; i + 2*W <= n; i += 2*W)
+    {
+        acc0 = _V::add(acc0, _V::mul(_V::load(a + i), _V::load(b + i)));
+        acc1 = _V::add(acc1, _V::mul(_V::load(a + i + W), _V::load(b + i + W)));
+    }
+    for(; i + W <= n; i += W)
+        acc0 = _V::add(acc0, _V::mul(_V::load(a + i), _V::load(b + i)));
+
+    typename _V::value_type result = _reduceLanes<_V, _SimdReduce::add>(_V::add(acc0, acc1));
+    for(; i < n; ++i)
+        result += a[i]*b[i];
+    return result;
+}
+
+template<typename _V>
+typename _V::value_type _sumSquares(const typename _V::value_type* a, size_t n) noexcept
+{
+    return _dot<_V>(a, a, n);
+}
+
+//Sum of (a[i] - mean)^2, the second pass of a variance
+template<typename _V>
+typename _V::value_type _sumSquaredDeviations(const typename _V::value_type* a, typename _V::value_type mean, size_t n) noexcept
+{
+    constexpr size_t W = _V::width;
+    const typename _V::reg m = _V::broadcast(mean);
+    typename _V::reg acc0 = _V::zero(), acc1 = _V::zero();
+    size_t i = 0;
+    for(; i + 2*W <= n; i += 2*W)
+    {
+        const typename _V::reg d0 = _V::sub(_V::load(a + i), m);
+        const typename _V::reg d1 = _V::sub(_V::load(a + i + W), m);
+        acc0 = _V::add(acc0, _V::mul(d0, d0));
+        acc1 = _V::add(acc1, _V::mul(d1, d1));
+    }
+    for(; i + W <= n; i += W)
+    {
+        const typename _V::reg d = _V::sub(_V::load(a + i), m);
+        acc0 = _V::add(acc0, _V::mul(d, d));
+    }
+
+    typename _V::value_type result = _reduceLanes<_V, _SimdReduce::add>(_V::add(acc0, acc1));
+    for(; i < n; ++i)
+        result += (a[i] - mean)*(a[i] - mean);
+    return result;
+}
+
+//Requires n > 0
+template<typename _V>
+typename _V::value_type _min(const typename _V::value_type* a, size_t n) noexcept
+{
+    typename _V::value_type result = a[0];
+    size_t i = 0;
+    if (n >= _V::width)
+    {
+        typename _V::reg acc = _V::load(a);
+        for(i = _V::width; i + _V::width <= n; i += _V::width)
+            acc = _V::min(acc, _V::load(a + i));
+        result = _reduceLanes<_V, _SimdReduce::min>(acc);
+    }
+    for(; i < n; ++i)
+        result = (a[i] < result) ? a[i] : result;
+    return result;
+}
+
+//Requires n > 0
+template<typename _V>
+typename _V::value_type _max(const typename _V::value_type* a, size_t n) noexcept
+{
+    typename _V::value_type result = a[0];
+    size_t i = 0;
+    if (n >= _V::width)
+    {
+        typename _V::reg acc = _V::load(a);
+        for(i = _V::width; i + _V::width <= n; i += _V::width)
+            acc = _V::max(acc, _V::load(a + i));
+        result = _reduceLanes<_V, _SimdReduce::max>(acc);
+    }
+    for(; i < n; ++i)
+        result = (a[i] > result) ? a[i] : result;
+    return result;
+}
+
+template<typename _V>
+_SimdKernels<typename _V::value_type> _kernelTable() noexcept
+{
+    _SimdKernels<typename _V::value_type> kernels{};
+    kernels.binary[static_cast<int>(_SimdOp::add)] = &_binary<_V, _SimdOp::add>;
+    kernels.binary[static_cast<int>(_SimdOp::sub)] = &_binary<_V, _SimdOp::sub>;
+    kernels.binary[static_cast<int>(_SimdOp::mul)] = &_binary<_V, _SimdOp::mul>;
+    kernels.binary[static_cast<int>(_SimdOp::div)] = &_binary<_V, _SimdOp::div>;
+    kernels.binaryScalarRhs[static_cast<int>(_SimdOp::add)] = &_binaryScalarRhs<_V, _SimdOp::add>;
+    kernels.binaryScalarRhs[static_cast<int>(_SimdOp::sub)] = &_binaryScalarRhs<_V, _SimdOp::sub>;
+    kernels.binaryScalarRhs[static_cast<int>(_SimdOp::mul)] = &_binaryScalarRhs<_V, _SimdOp::mul>;
+    kernels.binaryScalarRhs[static_cast<int>(_SimdOp::div)] = &_binaryScalarRhs<_V, _SimdOp::div>;
+    kernels.binaryScalarLhs[static_cast<int>(_SimdOp::add)] = &_binaryScalarLhs<_V, _SimdOp::add>;
+    kernels.binaryScalarLhs[static_cast<int>(_SimdOp::sub)] = &_binaryScalarLhs<_V, _SimdOp::sub>;
+    kernels.binaryScalarLhs[static_cast<int>(_SimdOp::mul)] = &_binaryScalarLhs<_V, _SimdOp::mul>;
+    kernels.binaryScalarLhs[static_cast<int>(_SimdOp::div)] = &_binaryScalarLhs<_V, _SimdOp::div>;
+    kernels.sum = &_sum<_V>;
+    kernels.dot = &_dot<_V>;
+    kernels.sumSquares = &_sumSquares<_V>;
+    kernels.sumSquaredDeviations = &_sumSquaredDeviations<_V>;
+    kernels.min = &_min<_V>;
+    kernels.max = &_max<_V>;
+    return kernels;
+}
@@ -0,0 +1,480 @@
+#ifndef SMALL_MATRIX_HH
+#define SMALL_MATRIX_HH 1
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "config.hh"
+#include "Core/matrix_base.hh"
+#include "Core/shape.hh"
+#include "Core/simd.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Largest extent handled by the fixed-size kernels
+    static constexpr int _smallDimMax = 8;
+
+    //True if both extents are static and small enough for the fully unrolled
+    //kernels, which never loop over a runtime bound or touch the heap
+    template<int _Nrows, int _Ncols>
+    static constexpr bool _smallDim = !runtimeDim<_Nrows, _Ncols> && _Nrows <= _smallDimMax && _Ncols <= _smallDimMax;
+
+    //float 4x4 matrices are mapped onto four SSE registers, one per row
+    template<typename _Tp, int _Nrows, int _Ncols>
+    static constexpr bool _simd4x4 = LIMNO_SIMD_X86 && std::is_same_v<_Tp, float> && _Nrows == 4 && _Ncols == 4;
+
+    template<typename _Tp>
+    constexpr _Tp _smallAbs(_Tp x) noexcept
+    {
+        return (x < _Tp{}) ? -x : x;
+    }
+
+    template<int _Nrows, int _Ncols, typename _Tp, size_t... _Is>
+    constexpr void _unrolledTranspose(const _Tp* a, _Tp* out, std::index_sequence<_Is...>) noexcept
+    {
+        ((out[_Is] = a[(_Is % _Nrows)*_Ncols + _Is/_Nrows]), ...);
+    }
+
+    //Forward elimination with partial pivoting of the _N x _W row-major block
+    //a, whose leading _N columns are square. One instantiation per pivot
+    //column, so every loop has a compile-time trip count. Returns the
+    //determinant of the square part, zero if it is singular
+    template<size_t _N, size_t _W, size_t _K = 0, typename _Tp>
+    constexpr _Tp _eliminate(_Tp* a, _Tp det = _Tp{1}) noexcept
+    {
+        if constexpr(_K == _N)
+            return det;
+        else
+        {
+            size_t pivot = _K;
+            for(size_t r = _K + 1; r < _N; ++r)
+            {
+                if (_smallAbs(a[r*_W + _K]) > _smallAbs(a[pivot*_W + _K]))
+                    pivot = r;
+            }
+            if (a[pivot*_W + _K] == _Tp{})
+                return _Tp{};
+            if (pivot != _K)
+            {
+                for(size_t c = _K; c < _W; ++c)
+                {
+                    const _Tp t = a[_K*_W + c];
+                    a[_K*_W + c] = a[pivot*_W + c];
+                    a[pivot*_W + c] = t;
+                }
+                det = -det;
+            }
+
+            const _Tp p = a[_K*_W + _K];
+            for(size_t r = _K + 1; r < _N; ++r)
+            {
+                const _Tp f = a[r*_W + _K]/p;
+                for(size_t c = _K; c < _W; ++c)
+                    a[r*_W + c] -= f*a[_K*_W + c];
+            }
+            return _eliminate<_N, _W, _K + 1>(a, det*p);
+        }
+    }
+
+    //Back substitution after _eliminate: leaves the solution for the columns
+    //[_N, _W) in place of the right-hand sides
+    template<size_t _N, size_t _W, size_t _K = _N, typename _Tp>
+    constexpr void _backSubstitute(_Tp* a) noexcept
+    {
+        if constexpr(_K != 0)
+        {
+            constexpr size_t k = _K - 1;
+            const _Tp p = a[k*_W + k];
+            for(size_t c = _N; c < _W; ++c)
+                a[k*_W + c] /= p;
+            for(size_t r = 0; r < k; ++r)
+            {
+                const _Tp f = a[r*_W + k];
+                for(size_t c = _N; c < _W; ++c)
+                    a[r*_W + c] -= f*a[k*_W + c];
+            }
+            _backSubstitute<_N, _W, k>(a);
+        }
+    }
+
+    template<size_t _N, typename _Tp>
+    constexpr _Tp _smallDeterminant(const _Tp* a) noexcept
+    {
+        if constexpr(_N == 1)
+            return a[0];
+        else if constexpr(_N == 2)
+            return a[0]*a[3] - a[1]*a[2];
+        else if constexpr(_N == 3)
+            return a[0]*(a[4]*a[8] - a[5]*a[7]) - a[1]*(a[3]*a[8] - a[5]*a[6]) + a[2]*(a[3]*a[7] - a[4]*a[6]);
+        else if constexpr(_N == 4)
+        {
+            //Laplace expansion over the 2x2 minors of the top and bottom halves
+            const _Tp s0 = a[0]*a[5] - a[4]*a[1];
+            const _Tp s1 = a[0]*a[6] - a[4]*a[2];
+            const _Tp s2 = a[0]*a[7] - a[4]*a[3];
+            const _Tp s3 = a[1]*a[6] - a[5]*a[2];
+            const _Tp s4 = a[1]*a[7] - a[5]*a[3];
+            const _Tp s5 = a[2]*a[7] - a[6]*a[3];
+            const _Tp c5 = a[10]*a[15] - a[14]*a[11];
+            const _Tp c4 = a[9]*a[15] - a[13]*a[11];
+            const _Tp c3 = a[9]*a[14] - a[13]*a[10];
+            const _Tp c2 = a[8]*a[15] - a[12]*a[11];
+            const _Tp c1 = a[8]*a[14] - a[12]*a[10];
+            const _Tp c0 = a[8]*a[13] - a[12]*a[9];
+            return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+        }
+        else
+        {
+            _Tp work[_N*_N]{};
+            for(size_t i = 0; i < _N*_N; ++i)
+                work[i] = a[i];
+            return _eliminate<_N, _N>(work);
+        }
+    }
+
+    //Writes the inverse of a to out and returns the determinant. out is left
+    //untouched if a is singular
+    template<size_t _N, typename _Tp>
+    constexpr _Tp _smallInverse(const _Tp* a, _Tp* out) noexcept
+    {
+        if constexpr(_N == 1)
+        {
+            if (a[0] != _Tp{})
+                out[0] = _Tp{1}/a[0];
+            return a[0];
+        }
+        else if constexpr(_N == 2)
+        {
+            const _Tp det = _smallDeterminant<2>(a);
+            if (det == _Tp{})
+                return det;
+            const _Tp inv = _Tp{1}/det;
+            out[0] = a[3]*inv;
+            out[1] = -a[1]*inv;
+            out[2] = -a[2]*inv;
+            out[3] = a[0]*inv;
+            return det;
+        }
+        else if constexpr(_N == 3)
+        {
+            //Adjugate from the cofactors
+            const _Tp c0 = a[4]*a[8] - a[5]*a[7];
+            const _Tp c3 = a[5]*a[6] - a[3]*a[8];
+            const _Tp c6 = a[3]*a[7] - a[4]*a[6];
+            const _Tp det = a[0]*c0 + a[1]*c3 + a[2]*c6;
+            if (det == _Tp{})
+                return det;
+            const _Tp inv = _Tp{1}/det;
+            out[0] = c0*inv;
+            out[1] = (a[2]*a[7] - a[1]*a[8])*inv;
+            out[2] = (a[1]*a[5] - a[2]*a[4])*inv;
+            out[3] = c3*inv;
+            out[4] = (a[0]*a[8] - a[2]*a[6])*inv;
+            out[5] = (a[2]*a[3] - a[0]*a[5])*inv;
+            out[6] = c6*inv;
+            out[7] = (a[1]*a[6] - a[0]*a[7])*inv;
+            out[8] = (a[0]*a[4] - a[1]*a[3])*inv;
+            return det;
+        }
+        else if constexpr(_N == 4)
+        {
+            //Adjugate from the same 2x2 minors as _smallDeterminant
+            const _Tp s0 = a[0]*a[5] - a[4]*a[1];
+            const _Tp s1 = a[0]*a[6] - a[4]*a[2];
+            const _Tp s2 = a[0]*a[7] - a[4]*a[3];
+            const _Tp s3 = a[1]*a[6] - a[5]*a[2];
+            const _Tp s4 = a[1]*a[7] - a[5]*a[3];
+            const _Tp s5 = a[2]*a[7] - a[6]*a[3];
+            const _Tp c5 = a[10]*a[15] - a[14]*a[11];
+            const _Tp c4 = a[9]*a[15] - a[13]*a[11];
+            const _Tp c3 = a[9]*a[14] - a[13]*a[10];
+            const _Tp c2 = a[8]*a[15] - a[12]*a[11];
+            const _Tp c1 = a[8]*a[14] - a[12]*a[10];
+            const _Tp c0 = a[8]*a[13] - a[12]*a[9];
+            const _Tp det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+            if (det == _Tp{})
+                return det;
+            const _Tp inv = _Tp{1}/det;
+            out[0] = (a[5]*c5 - a[6]*c4 + a[7]*c3)*inv;
+            out[1] = (-a[1]*c5 + a[2]*c4 - a[3]*c3)*inv;
+            out[2] = (a[13]*s5 - a[14]*s4 + a[15]*s3)*inv;
+            out[3] = (-a[9]*s5 + a[10]*s4 - a[11]*s3)*inv;
+            out[4] = (-a[4]*c5 + a[6]*c2 - a[7]*c1)*inv;
+            out[5] = (a[0]*c5 - a[2]*c2 + a[3]*c1)*inv;
+            out[6] = (-a[12]*s5 + a[14]*s2 - a[15]*s1)*inv;
+            out[7] = (a[8]*s5 - a[10]*s2 + a[11]*s1)*inv;
+            out[8] = (a[4]*c4 - a[5]*c2 + a[7]*c0)*inv;
+            out[9] = (-a[0]*c4 + a[1]*c2 - a[3]*c0)*inv;
+            out[10] = (a[12]*s4 - a[13]*s2 + a[15]*s0)*inv;
+            out[11] = (-a[8]*s4 + a[9]*s2 - a[11]*s0)*inv;
+            out[12] = (-a[4]*c3 + a[5]*c1 - a[6]*c0)*inv;
+            out[13] = (a[0]*c3 - a[1]*c1 + a[2]*c0)*inv;
+            out[14] = (-a[12]*s3 + a[13]*s1 - a[14]*s0)*inv;
+            out[15] = (a[8]*s3 - a[9]*s1 + a[10]*s0)*inv;
+            return det;
+        }
+        else
+        {
+            //Gauss-Jordan on [a | I]
+            constexpr size_t w = 2*_N;
+            _Tp work[_N*w]{};
+            for(size_t r = 0; r < _N; ++r)
+            {
+                for(size_t c = 0; c < _N; ++c)
+                    work[r*w + c] = a[r*_N + c];
+                work[r*w + _N + r] = _Tp{1};
+            }
+            const _Tp det = _eliminate<_N, w>(work);
+            if (det == _Tp{})
+                return det;
+            _backSubstitute<_N, w>(work);
+            for(size_t r = 0; r < _N; ++r)
+            {
+                for(size_t c = 0; c < _N; ++c)
+                    out[r*_N + c] = work[r*w + _N + c];
+            }
+            return det;
+        }
+    }
+
+    #if LIMNO_SIMD_X86
+    template<int _X, int _Y, int _Z, int _W>
+    inline __m128 _shuffle4(__m128 a, __m128 b) noexcept
+    {
+        return _mm_shuffle_ps(a, b, _X | (_Y << 2) | (_Z << 4) | (_W << 6));
+    }
+
+    template<int _X, int _Y, int _Z, int _W>
+    inline __m128 _swizzle4(__m128 v) noexcept
+    {
+        return _shuffle4<_X, _Y, _Z, _W>(v, v);
+    }
+
+    //Row i of C is the sum over k of a(i, k) broadcast against row k of B.
+    //Storage of static matrices is at least 16 byte aligned
+    inline void _simdProduct4x4(const float* a, const float* b, float* c) noexcept
+    {
+        const __m128 b0 = _mm_load_ps(b);
+        const __m128 b1 = _mm_load_ps(b + 4);
+        const __m128 b2 = _mm_load_ps(b + 8);
+        const __m128 b3 = _mm_load_ps(b + 12);
+        __m128 rows[4];
+        for(int i = 0; i < 4; ++i)
+        {
+            const __m128 ai = _mm_load_ps(a + 4*i);
+            __m128 row = _mm_mul_ps(_swizzle4<0, 0, 0, 0>(ai), b0);
+            row = _mm_add_ps(row, _mm_mul_ps(_swizzle4<1, 1, 1, 1>(ai), b1));
+            row = _mm_add_ps(row, _mm_mul_ps(_swizzle4<2, 2, 2, 2>(ai), b2));
+            rows[i] = _mm_add_ps(row, _mm_mul_ps(_swizzle4<3, 3, 3, 3>(ai), b3));
+        }
+        //Stored last so c may alias a or b
+        for(int i = 0; i < 4; ++i)
+            _mm_store_ps(c + 4*i, rows[i]);
+    }
+
+    inline void _simdTranspose4x4(const float* a, float* out) noexcept
+    {
+        __m128 r0 = _mm_load_ps(a);
+        __m128 r1 = _mm_load_ps(a + 4);
+        __m128 r2 = _mm_load_ps(a + 8);
+        __m128 r3 = _mm_load_ps(a + 12);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_store_ps(out, r0);
+        _mm_store_ps(out + 4, r1);
+        _mm_store_ps(out + 8, r2);
+        _mm_store_ps(out + 12, r3);
+    }
+
+    //2x2 blocks held row-major in one register: A*B, adj(A)*B and A*adj(B)
+    inline __m128 _mul2x2(__m128 a, __m128 b) noexcept
+    {
+        return _mm_add_ps(_mm_mul_ps(a, _swizzle4<0, 3, 0, 3>(b)),
+            _mm_mul_ps(_swizzle4<1, 0, 3, 2>(a), _swizzle4<2, 1, 2, 1>(b)));
+    }
+
+    inline __m128 _adjMul2x2(__m128 a, __m128 b) noexcept
+    {
+        return _mm_sub_ps(_mm_mul_ps(_swizzle4<3, 3, 0, 0>(a), b),
+            _mm_mul_ps(_swizzle4<1, 1, 2, 2>(a), _swizzle4<2, 3, 0, 1>(b)));
+    }
+
+    inline __m128 _mulAdj2x2(__m128 a, __m128 b) noexcept
+    {
+        return _mm_sub_ps(_mm_mul_ps(a, _swizzle4<3, 0, 3, 0>(b)),
+            _mm_mul_ps(_swizzle4<1, 0, 3, 2>(a), _swizzle4<2, 1, 2, 1>(b)));
+    }
+
+    //Block inverse: with M = [A B; C D] split into 2x2 blocks, every block
+    //of adj(M) is a short expression of 2x2 products and adjugates, all of
+    //which fit in single registers. Returns the determinant; out is left
+    //untouched if it is zero
+    inline float _simdInverse4x4(const float* m, float* out) noexcept
+    {
+        const __m128 r0 = _mm_load_ps(m);
+        const __m128 r1 = _mm_load_ps(m + 4);
+        const __m128 r2 = _mm_load_ps(m + 8);
+        const __m128 r3 = _mm_load_ps(m + 12);
+
+        const __m128 a = _mm_movelh_ps(r0, r1);
+        const __m128 b = _mm_movehl_ps(r1, r0);
+        const __m128 c = _mm_movelh_ps(r2, r3);
+        const __m128 d = _mm_movehl_ps(r3, r2);
+
+        //(|A|, |B|, |C|, |D|)
+        const __m128 detSub = _mm_sub_ps(
+            _mm_mul_ps(_shuffle4<0, 2, 0, 2>(r0, r2), _shuffle4<1, 3, 1, 3>(r1, r3)),
+            _mm_mul_ps(_shuffle4<1, 3, 1, 3>(r0, r2), _shuffle4<0, 2, 0, 2>(r1, r3)));
+        const __m128 detA = _swizzle4<0, 0, 0, 0>(detSub);
+        const __m128 detB = _swizzle4<1, 1, 1, 1>(detSub);
+        const __m128 detC = _swizzle4<2, 2, 2, 2>(detSub);
+        const __m128 detD = _swizzle4<3, 3, 3, 3>(detSub);
+
+        const __m128 dc = _adjMul2x2(d, c);
+        const __m128 ab = _adjMul2x2(a, b);
+        __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), _mul2x2(b, dc));
+        __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), _mul2x2(c, ab));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), _mulAdj2x2(d, ab));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), _mulAdj2x2(a, dc));
+
+        //|M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+        __m128 tr = _mm_mul_ps(ab, _swizzle4<0, 2, 1, 3>(dc));
+        tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+        tr = _mm_add_ps(tr, _swizzle4<1, 1, 1, 1>(tr));
+        tr = _swizzle4<0, 0, 0, 0>(tr);
+        const __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+        const float det = _mm_cvtss_f32(detM);
+        if (det == 0.0f)
+            return det;
+
+        const __m128 rDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+        x = _mm_mul_ps(x, rDet);
+        y = _mm_mul_ps(y, rDet);
+        z = _mm_mul_ps(z, rDet);
+        w = _mm_mul_ps(w, rDet);
+
+        //Taking the adjugate of each block is folded into the final shuffle
+        _mm_store_ps(out, _shuffle4<3, 1, 3, 1>(x, y));
+        _mm_store_ps(out + 4, _shuffle4<2, 0, 2, 0>(x, y));
+        _mm_store_ps(out + 8, _shuffle4<3, 1, 3, 1>(z, w));
+        _mm_store_ps(out + 12, _shuffle4<2, 0, 2, 0>(z, w));
+        return det;
+    }
+    #endif
+
+    //Transpose of a small static matrix
+    #if __cplusplus > 201703L
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _smallDim<_Nrows, _Ncols>
+    #else
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_smallDim<_Nrows, _Ncols>, int> = 0>
+    #endif
+    constexpr LimnoMatrixBase<_Tp, _Ncols, _Nrows, _AllocTp> transpose(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m) noexcept
+    {
+        LimnoMatrixBase<_Tp, _Ncols, _Nrows, _AllocTp> result(_Tp{});
+        #if LIMNO_SIMD_X86
+        if constexpr(_simd4x4<_Tp, _Nrows, _Ncols>)
+        {
+            if (!LIMNO_IS_CONSTANT_EVALUATED())
+            {
+                _simdTranspose4x4(m.data(), result.data());
+                return result;
+            }
+        }
+        #endif
+        _unrolledTranspose<_Nrows, _Ncols>(m.data(), result.data(), std::make_index_sequence<static_cast<size_t>(_Nrows*_Ncols)>{});
+        return result;
+    }
+
+    //Determinant of a small static square matrix. Up to 4x4 it is a closed
+    //form, larger sizes use elimination with partial pivoting
+    #if __cplusplus > 201703L
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _smallDim<_Nrows, _Ncols>
+    #else
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_smallDim<_Nrows, _Ncols>, int> = 0>
+    #endif
+    constexpr _Tp determinant(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m) noexcept
+    {
+        static_assert(_Nrows == _Ncols, "Determinant requires a square matrix!");
+        static_assert(_Nrows <= 4 || std::is_floating_point_v<_Tp>, "Determinant requires a floating point type!");
+        return _smallDeterminant<static_cast<size_t>(_Nrows)>(m.data());
+    }
+
+    //Inverse of a small static square matrix. Throws std::invalid_argument if
+    //the matrix is singular
+    #if __cplusplus > 201703L
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _smallDim<_Nrows, _Ncols>
+    #else
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_smallDim<_Nrows, _Ncols>, int> = 0>
+    #endif
+    constexpr LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> inverse(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        static_assert(_Nrows == _Ncols, "Inverse requires a square matrix!");
+        static_assert(std::is_floating_point_v<_Tp>, "Inverse requires a floating point type!");
+        LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> result(_Tp{});
+        #if LIMNO_SIMD_X86
+        if constexpr(_simd4x4<_Tp, _Nrows, _Ncols>)
+        {
+            if (!LIMNO_IS_CONSTANT_EVALUATED())
+            {
+                if (_simdInverse4x4(m.data(), result.data()) == 0.0f)
+                    throw std::invalid_argument("Matrix is singular!");
+                return result;
+            }
+        }
+        #endif
+        if (_smallInverse<static_cast<size_t>(_Nrows)>(m.data(), result.data()) == _Tp{})
+            throw std::invalid_argument("Matrix is singular!");
+        return result;
+    }
+
+    //Solves a*x = b for x, where b holds one right-hand side per column.
+    //Uses elimination with partial pivoting rather than the inverse. Throws
+    //std::invalid_argument if a is singular
+    #if __cplusplus > 201703L
+    template<typename _Tp, int _N1, int _N2, int _M, int _K, typename _AllocTp1, typename _AllocTp2>
+        requires _smallDim<_N1, _N2> && _smallDim<_M, _K>
+    #else
+    template<typename _Tp, int _N1, int _N2, int _M, int _K, typename _AllocTp1, typename _AllocTp2,
+        std::enable_if_t<_smallDim<_N1, _N2> && _smallDim<_M, _K>, int> = 0>
+    #endif
+    constexpr LimnoMatrixBase<_Tp, _M, _K, _AllocTp2> solve(const LimnoMatrixBase<_Tp, _N1, _N2, _AllocTp1>& a,
+        const LimnoMatrixBase<_Tp, _M, _K, _AllocTp2>& b)
+    {
+        static_assert(_N1 == _N2, "Solve requires a square matrix!");
+        static_assert(_N1 == _M, "Matrix dimensions do not match!");
+        static_assert(std::is_floating_point_v<_Tp>, "Solve requires a floating point type!");
+        constexpr size_t n = static_cast<size_t>(_N1);
+        constexpr size_t k = static_cast<size_t>(_K);
+        constexpr size_t w = n + k;
+
+        _Tp work[n*w]{};
+        for(size_t r = 0; r < n; ++r)
+        {
+            for(size_t c = 0; c < n; ++c)
+                work[r*w + c] = a.data()[r*n + c];
+            for(size_t c = 0; c < k; ++c)
+                work[r*w + n + c] = b.data()[r*k + c];
+        }
+        if (_eliminate<n, w>(work) == _Tp{})
+            throw std::invalid_argument("Matrix is singular!");
+        _backSubstitute<n, w>(work);
+
+        LimnoMatrixBase<_Tp, _M, _K, _AllocTp2> x(_Tp{});
+        for(size_t r = 0; r < n; ++r)
+        {
+            for(size_t c = 0; c < k; ++c)
+                x.data()[r*k + c] = work[r*w + n + c];
+        }
+        return x;
+    }
+}
+
+#endif
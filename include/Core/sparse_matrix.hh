@@ -0,0 +1,839 @@
+#ifndef SPARSE_MATRIX_HH
+#define SPARSE_MATRIX_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+#include "Core/construction.hh"
+#include "Core/execution.hh"
+#include "Core/instrumentation.hh"
+#include "Core/expression_templates.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //One stored element of a sparse matrix, as produced by its iterators.
+    //Binds well to structured bindings: for(auto [r, c, v] : m)
+    template<typename _Tp>
+    struct sparse_entry
+    {
+        size_t row;
+        size_t col;
+        _Tp& value;
+    };
+
+    //Throws if n can't be represented by the index type of a sparse matrix
+    template<typename _IndexTp>
+    void _checkSparseIndex(size_t n)
+    {
+        static_assert(std::is_integral_v<_IndexTp>, "Index type must be an integer!");
+        if (n > static_cast<std::make_unsigned_t<_IndexTp>>(std::numeric_limits<_IndexTp>::max()))
+            throw std::invalid_argument("Matrix is too large for the index type!");
+    }
+
+    //Walks the triplets of a coo_matrix in insertion order
+    template<typename _Tp, typename _IndexTp>
+    struct _CooIterator
+    {
+        using value_type = sparse_entry<_Tp>;
+        using reference = sparse_entry<_Tp>;
+        using pointer = void;
+        using difference_type = std::ptrdiff_t;
+        //Entries are proxies, so only an input iterator to older code
+        using iterator_category = std::input_iterator_tag;
+        #if __cplusplus > 201703L
+        using iterator_concept = std::forward_iterator_tag;
+        #endif
+
+        _CooIterator() noexcept
+            : _rows{}, _cols{}, _values{}
+        {
+
+        }
+
+        _CooIterator(const _IndexTp* rows, const _IndexTp* cols, _Tp* values) noexcept
+            : _rows{rows}, _cols{cols}, _values{values}
+        {
+
+        }
+
+        //Allows iterator -> const_iterator conversion
+        template<typename _UTp,
+            std::enable_if_t<std::is_same_v<const _UTp, _Tp> && !std::is_same_v<_UTp, _Tp>, int> = 0>
+        _CooIterator(const _CooIterator<_UTp, _IndexTp>& other) noexcept
+            : _rows{other._rows}, _cols{other._cols}, _values{other._values}
+        {
+
+        }
+
+        reference operator*() const noexcept
+        {
+            return reference{static_cast<size_t>(*_rows), static_cast<size_t>(*_cols), *_values};
+        }
+
+        _CooIterator& operator++() noexcept
+        {
+            ++_rows;
+            ++_cols;
+            ++_values;
+            return *this;
+        }
+
+        _CooIterator operator++(int) noexcept
+        {
+            _CooIterator temp{*this};
+            ++*this;
+            return temp;
+        }
+
+        friend bool operator==(const _CooIterator& lhs, const _CooIterator& rhs) noexcept
+        {
+            return lhs._values == rhs._values;
+        }
+
+        friend bool operator!=(const _CooIterator& lhs, const _CooIterator& rhs) noexcept
+        {
+            return lhs._values != rhs._values;
+        }
+
+        const _IndexTp* _rows;
+        const _IndexTp* _cols;
+        _Tp* _values;
+    };
+
+    //Walks the non-zeros of a CSR matrix row by row or of a CSC matrix column
+    //by column, skipping empty rows or columns
+    template<typename _Tp, bool _RowMajor, typename _IndexTp>
+    struct _CompressedIterator
+    {
+        using value_type = sparse_entry<_Tp>;
+        using reference = sparse_entry<_Tp>;
+        using pointer = void;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+        #if __cplusplus > 201703L
+        using iterator_concept = std::forward_iterator_tag;
+        #endif
+
+        _CompressedIterator() noexcept
+            : _offsets{}, _indices{}, _values{}, _major{0}, _numMajor{0}, _k{0}
+        {
+
+        }
+
+        _CompressedIterator(const _IndexTp* offsets, const _IndexTp* indices, _Tp* values,
+            size_t major, size_t numMajor, size_t k) noexcept
+            : _offsets{offsets}, _indices{indices}, _values{values}, _major{major}, _numMajor{numMajor}, _k{k}
+        {
+            _skipEmpty();
+        }
+
+        template<typename _UTp,
+            std::enable_if_t<std::is_same_v<const _UTp, _Tp> && !std::is_same_v<_UTp, _Tp>, int> = 0>
+        _CompressedIterator(const _CompressedIterator<_UTp, _RowMajor, _IndexTp>& other) noexcept
+            : _offsets{other._offsets}, _indices{other._indices}, _values{other._values},
+            _major{other._major}, _numMajor{other._numMajor}, _k{other._k}
+        {
+
+        }
+
+        reference operator*() const noexcept
+        {
+            const size_t minor = static_cast<size_t>(_indices[_k]);
+            if constexpr(_RowMajor)
+                return reference{_major, minor, _values[_k]};
+            else
+                return reference{minor, _major, _values[_k]};
+        }
+
+        _CompressedIterator& operator++() noexcept
+        {
+            ++_k;
+            _skipEmpty();
+            return *this;
+        }
+
+        _CompressedIterator operator++(int) noexcept
+        {
+            _CompressedIterator temp{*this};
+            ++*this;
+            return temp;
+        }
+
+        friend bool operator==(const _CompressedIterator& lhs, const _CompressedIterator& rhs) noexcept
+        {
+            return lhs._k == rhs._k;
+        }
+
+        friend bool operator!=(const _CompressedIterator& lhs, const _CompressedIterator& rhs) noexcept
+        {
+            return lhs._k != rhs._k;
+        }
+
+        void _skipEmpty() noexcept
+        {
+            while (_major < _numMajor && static_cast<size_t>(_offsets[_major + 1]) <= _k)
+                ++_major;
+        }
+
+        const _IndexTp* _offsets;
+        const _IndexTp* _indices;
+        _Tp* _values;
+        size_t _major;
+        size_t _numMajor;
+        size_t _k;
+    };
+
+    //Sparse matrix in coordinate format, for assembly. Entries are stored in
+    //the order they are inserted and repeated coordinates are summed when the
+    //matrix is converted, so contributions can be added without looking up
+    //what is already there. Convert to csr_matrix or csc_matrix to compute.
+    //Like the other sparse formats, size() and iteration cover the stored
+    //entries only
+    template<typename _Tp, typename _IndexTp = size_t>
+    class coo_matrix
+    {
+        public:
+        using value_type = _Tp;
+        using size_type = size_t;
+        using index_type = _IndexTp;
+        using iterator = _CooIterator<_Tp, _IndexTp>;
+        using const_iterator = _CooIterator<const _Tp, _IndexTp>;
+
+        coo_matrix() noexcept
+            : _numRows{0}, _numCols{0}
+        {
+
+        }
+
+        coo_matrix(size_type numRows, size_type numCols)
+            : _numRows{numRows}, _numCols{numCols}
+        {
+            _checkSparseIndex<_IndexTp>(std::max(numRows, numCols));
+        }
+
+        void reserve(size_type numEntries)
+        {
+            _rows.reserve(numEntries);
+            _cols.reserve(numEntries);
+            _values.reserve(numEntries);
+        }
+
+        //Adds value to element (r, c)
+        void insert(size_type r, size_type c, const _Tp& value)
+        {
+            if (r >= _numRows || c >= _numCols)
+                throw std::out_of_range("Index exceeds matrix dimensions!");
+            _rows.push_back(static_cast<_IndexTp>(r));
+            _cols.push_back(static_cast<_IndexTp>(c));
+            _values.push_back(value);
+        }
+
+        void clear() noexcept
+        {
+            _rows.clear();
+            _cols.clear();
+            _values.clear();
+        }
+
+        size_type numRows() const noexcept
+        {
+            return _numRows;
+        }
+
+        size_type numCols() const noexcept
+        {
+            return _numCols;
+        }
+
+        //Number of stored entries, counting repeats
+        size_type nonZeros() const noexcept
+        {
+            return _values.size();
+        }
+
+        size_type size() const noexcept
+        {
+            return _values.size();
+        }
+
+        iterator begin() noexcept
+        {
+            return iterator{_rows.data(), _cols.data(), _values.data()};
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator{_rows.data(), _cols.data(), _values.data()};
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        iterator end() noexcept
+        {
+            return iterator{_rows.data() + size(), _cols.data() + size(), _values.data() + size()};
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator{_rows.data() + size(), _cols.data() + size(), _values.data() + size()};
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        //Raw triplets
+        const std::vector<_IndexTp>& rowIndices() const noexcept
+        {
+            return _rows;
+        }
+
+        const std::vector<_IndexTp>& colIndices() const noexcept
+        {
+            return _cols;
+        }
+
+        const std::vector<_Tp>& values() const noexcept
+        {
+            return _values;
+        }
+
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> toDense() const
+        {
+            LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> result(Limno::zeros, _numRows, _numCols);
+            for(size_t k = 0; k < _values.size(); ++k)
+                result(static_cast<size_t>(_rows[k]), static_cast<size_t>(_cols[k])) += _values[k];
+            return result;
+        }
+        private:
+        size_type _numRows;
+        size_type _numCols;
+        std::vector<_IndexTp> _rows;
+        std::vector<_IndexTp> _cols;
+        std::vector<_Tp> _values;
+    };
+
+    //Compressed sparse matrix. With _RowMajor (CSR) the non-zeros of row i
+    //are values[offsets[i]:offsets[i + 1]] in columns indices[...], sorted by
+    //column; otherwise (CSC) the same holds for columns. Use the csr_matrix
+    //and csc_matrix aliases. Storage is nonZeros()*(sizeof(_Tp) + sizeof(_IndexTp))
+    //plus one offset per row or column, so a narrow _IndexTp such as
+    //std::uint32_t is worth choosing when the dimensions allow it
+    template<typename _Tp, bool _RowMajor, typename _IndexTp = size_t>
+    class _CompressedMatrix
+    {
+        public:
+        using value_type = _Tp;
+        using size_type = size_t;
+        using index_type = _IndexTp;
+        using iterator = _CompressedIterator<_Tp, _RowMajor, _IndexTp>;
+        using const_iterator = _CompressedIterator<const _Tp, _RowMajor, _IndexTp>;
+
+        static constexpr bool isRowMajor = _RowMajor;
+
+        _CompressedMatrix() noexcept
+            : _numRows{0}, _numCols{0}, _offsets(1)
+        {
+
+        }
+
+        //All-zero matrix
+        _CompressedMatrix(size_type numRows, size_type numCols)
+            : _numRows{numRows}, _numCols{numCols}, _offsets(_numMajor() + 1)
+        {
+            _checkSparseIndex<_IndexTp>(std::max(numRows, numCols));
+        }
+
+        //Adopts existing compressed arrays, e.g. from another library. Throws
+        //if they don't describe a valid matrix with sorted, unique indices
+        _CompressedMatrix(size_type numRows, size_type numCols, std::vector<_IndexTp> offsets,
+            std::vector<_IndexTp> indices, std::vector<_Tp> values)
+            : _numRows{numRows}, _numCols{numCols}, _offsets(std::move(offsets)),
+            _indices(std::move(indices)), _values(std::move(values))
+        {
+            _checkSparseIndex<_IndexTp>(std::max(numRows, numCols));
+            _validate();
+        }
+
+        //Sums repeated coordinates
+        explicit _CompressedMatrix(const coo_matrix<_Tp, _IndexTp>& coo)
+            : _CompressedMatrix(coo.numRows(), coo.numCols())
+        {
+            const std::vector<_IndexTp>& major = _RowMajor ? coo.rowIndices() : coo.colIndices();
+            const std::vector<_IndexTp>& minor = _RowMajor ? coo.colIndices() : coo.rowIndices();
+            _checkSparseIndex<_IndexTp>(coo.nonZeros());
+            _bucket(major.data(), minor.data(), coo.values().data(), coo.nonZeros());
+
+            //Sort each line by index, keeping insertion order among repeats so
+            //they are summed in a fixed order, then merge the repeats
+            std::vector<std::pair<_IndexTp, _Tp>> line;
+            size_t out = 0;
+            for(size_t i = 0; i < _numMajor(); ++i)
+            {
+                const size_t first = static_cast<size_t>(_offsets[i]);
+                const size_t last = static_cast<size_t>(_offsets[i + 1]);
+                if (!std::is_sorted(_indices.begin() + first, _indices.begin() + last))
+                {
+                    line.clear();
+                    for(size_t k = first; k < last; ++k)
+                        line.emplace_back(_indices[k], _values[k]);
+                    std::stable_sort(line.begin(), line.end(),
+                        [](const auto& a, const auto& b) { return a.first < b.first; });
+                    for(size_t k = first; k < last; ++k)
+                    {
+                        _indices[k] = line[k - first].first;
+                        _values[k] = line[k - first].second;
+                    }
+                }
+                _offsets[i] = static_cast<_IndexTp>(out);
+                for(size_t k = first; k < last; ++k)
+                {
+                    if (out > static_cast<size_t>(_offsets[i]) && _indices[out - 1] == _indices[k])
+                        _values[out - 1] += _values[k];
+                    else
+                    {
+                        _indices[out] = _indices[k];
+                        _values[out++] = _values[k];
+                    }
+                }
+            }
+            _offsets[_numMajor()] = static_cast<_IndexTp>(out);
+            _indices.resize(out);
+            _values.resize(out);
+        }
+
+        //Converts between CSR and CSC in O(nonZeros()) by bucketing on the
+        //other index. Lines are filled in order, so indices stay sorted
+        explicit _CompressedMatrix(const _CompressedMatrix<_Tp, !_RowMajor, _IndexTp>& other)
+            : _CompressedMatrix(other.numRows(), other.numCols())
+        {
+            std::vector<_IndexTp> major(other.nonZeros());
+            const std::vector<_IndexTp>& otherOffsets = other.offsets();
+            for(size_t i = 0; i + 1 < otherOffsets.size(); ++i)
+                std::fill(major.begin() + static_cast<std::ptrdiff_t>(otherOffsets[i]),
+                    major.begin() + static_cast<std::ptrdiff_t>(otherOffsets[i + 1]), static_cast<_IndexTp>(i));
+            _bucket(other.indices().data(), major.data(), other.values().data(), other.nonZeros());
+        }
+
+        //Keeps the non-zero elements of a dense matrix, view or expression
+        #if __cplusplus > 201703L
+        template<typename _SrcTp>
+            requires _OperandTraits<_SrcTp>::isMatrix
+        #else
+        template<typename _SrcTp, std::enable_if_t<_OperandTraits<_SrcTp>::isMatrix, int> = 0>
+        #endif
+        explicit _CompressedMatrix(const _SrcTp& src)
+            : _CompressedMatrix(src.numRows(), src.numCols())
+        {
+            static_assert(std::is_same_v<_OperandValue_t<_SrcTp>, _Tp>, "Matrix types do not match!");
+            for(size_t i = 0; i < _numMajor(); ++i)
+            {
+                for(size_t j = 0; j < _numMinor(); ++j)
+                {
+                    const _Tp value = _RowMajor ? _OperandTraits<_SrcTp>::at(src, i, j) : _OperandTraits<_SrcTp>::at(src, j, i);
+                    if (value != _Tp{})
+                    {
+                        _indices.push_back(static_cast<_IndexTp>(j));
+                        _values.push_back(value);
+                    }
+                }
+                _checkSparseIndex<_IndexTp>(_values.size());
+                _offsets[i + 1] = static_cast<_IndexTp>(_values.size());
+            }
+        }
+
+        size_type numRows() const noexcept
+        {
+            return _numRows;
+        }
+
+        size_type numCols() const noexcept
+        {
+            return _numCols;
+        }
+
+        size_type nonZeros() const noexcept
+        {
+            return _values.size();
+        }
+
+        size_type size() const noexcept
+        {
+            return _values.size();
+        }
+
+        //Element (r, c), found by binary search of its row or column
+        _Tp operator()(size_type r, size_type c) const noexcept
+        {
+            const size_t major = _RowMajor ? r : c;
+            const _IndexTp minor = static_cast<_IndexTp>(_RowMajor ? c : r);
+            const auto first = _indices.begin() + static_cast<std::ptrdiff_t>(_offsets[major]);
+            const auto last = _indices.begin() + static_cast<std::ptrdiff_t>(_offsets[major + 1]);
+            const auto it = std::lower_bound(first, last, minor);
+            if (it == last || *it != minor)
+                return _Tp{};
+            return _values[static_cast<size_t>(it - _indices.begin())];
+        }
+
+        iterator begin() noexcept
+        {
+            return iterator{_offsets.data(), _indices.data(), _values.data(), 0, _numMajor(), 0};
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator{_offsets.data(), _indices.data(), _values.data(), 0, _numMajor(), 0};
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        iterator end() noexcept
+        {
+            return iterator{_offsets.data(), _indices.data(), _values.data(), _numMajor(), _numMajor(), size()};
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator{_offsets.data(), _indices.data(), _values.data(), _numMajor(), _numMajor(), size()};
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        //Raw compressed arrays
+        const std::vector<_IndexTp>& offsets() const noexcept
+        {
+            return _offsets;
+        }
+
+        const std::vector<_IndexTp>& indices() const noexcept
+        {
+            return _indices;
+        }
+
+        const std::vector<_Tp>& values() const noexcept
+        {
+            return _values;
+        }
+
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> toDense() const
+        {
+            LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> result(Limno::zeros, _numRows, _numCols);
+            for(const auto [r, c, value] : *this)
+                result(r, c) = value;
+            return result;
+        }
+
+        //The CSR arrays of a matrix are the CSC arrays of its transpose, so
+        //transposing only swaps the format
+        _CompressedMatrix<_Tp, !_RowMajor, _IndexTp> transpose() const &
+        {
+            using transpose_type = _CompressedMatrix<_Tp, !_RowMajor, _IndexTp>;
+            return transpose_type(_numCols, _numRows, _offsets, _indices, _values, typename transpose_type::_trusted{});
+        }
+
+        _CompressedMatrix<_Tp, !_RowMajor, _IndexTp> transpose() &&
+        {
+            using transpose_type = _CompressedMatrix<_Tp, !_RowMajor, _IndexTp>;
+            transpose_type result(_numCols, _numRows, std::move(_offsets), std::move(_indices), std::move(_values),
+                typename transpose_type::_trusted{});
+            *this = _CompressedMatrix{};
+            return result;
+        }
+        private:
+        template<typename, bool, typename>
+        friend class _CompressedMatrix;
+
+        struct _trusted
+        {
+
+        };
+
+        _CompressedMatrix(size_type numRows, size_type numCols, std::vector<_IndexTp> offsets,
+            std::vector<_IndexTp> indices, std::vector<_Tp> values, _trusted) noexcept
+            : _numRows{numRows}, _numCols{numCols}, _offsets(std::move(offsets)),
+            _indices(std::move(indices)), _values(std::move(values))
+        {
+
+        }
+
+        size_type _numMajor() const noexcept
+        {
+            return _RowMajor ? _numRows : _numCols;
+        }
+
+        size_type _numMinor() const noexcept
+        {
+            return _RowMajor ? _numCols : _numRows;
+        }
+
+        //Counting sort of n entries by major index into the compressed arrays.
+        //Entries of a line keep their relative order
+        void _bucket(const _IndexTp* major, const _IndexTp* minor, const _Tp* values, size_t n)
+        {
+            std::fill(_offsets.begin(), _offsets.end(), _IndexTp{});
+            for(size_t k = 0; k < n; ++k)
+                ++_offsets[static_cast<size_t>(major[k]) + 1];
+            for(size_t i = 0; i < _numMajor(); ++i)
+                _offsets[i + 1] += _offsets[i];
+
+            std::vector<_IndexTp> next(_offsets.begin(), _offsets.end() - 1);
+            _indices.resize(n);
+            _values.resize(n);
+            for(size_t k = 0; k < n; ++k)
+            {
+                const size_t at = static_cast<size_t>(next[static_cast<size_t>(major[k])]++);
+                _indices[at] = minor[k];
+                _values[at] = values[k];
+            }
+        }
+
+        void _validate() const
+        {
+            if (_offsets.size() != _numMajor() + 1 || _offsets.front() != 0 ||
+                static_cast<size_t>(_offsets.back()) != _indices.size() || _indices.size() != _values.size())
+                throw std::invalid_argument("Invalid compressed sparse matrix!");
+            for(size_t i = 0; i < _numMajor(); ++i)
+            {
+                if (_offsets[i] > _offsets[i + 1])
+                    throw std::invalid_argument("Invalid compressed sparse matrix!");
+                for(size_t k = static_cast<size_t>(_offsets[i]); k < static_cast<size_t>(_offsets[i + 1]); ++k)
+                {
+                    //Negative indices wrap around to large ones
+                    if (static_cast<std::make_unsigned_t<_IndexTp>>(_indices[k]) >= _numMinor() ||
+                        (k > static_cast<size_t>(_offsets[i]) && _indices[k - 1] >= _indices[k]))
+                        throw std::invalid_argument("Invalid compressed sparse matrix!");
+                }
+            }
+        }
+
+        size_type _numRows;
+        size_type _numCols;
+        std::vector<_IndexTp> _offsets;
+        std::vector<_IndexTp> _indices;
+        std::vector<_Tp> _values;
+    };
+
+    template<typename _Tp, typename _IndexTp = size_t>
+    using csr_matrix = _CompressedMatrix<_Tp, true, _IndexTp>;
+
+    template<typename _Tp, typename _IndexTp = size_t>
+    using csc_matrix = _CompressedMatrix<_Tp, false, _IndexTp>;
+
+    //Rows [first, last) of C = A*B for CSR A. Each row of C is the sum of the
+    //rows of B picked out by the non-zeros of the row of A, so B is read
+    //along its rows and every row of C is written once
+    template<typename _Tp, typename _IndexTp>
+    void _csrProduct(size_t first, size_t last, size_t n, const _IndexTp* offsets, const _IndexTp* indices,
+        const _Tp* values, const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+        _Tp* c, std::ptrdiff_t rsc, std::ptrdiff_t csc) noexcept
+    {
+        using index = std::ptrdiff_t;
+        for(size_t i = first; i < last; ++i)
+        {
+            _Tp* cRow = c + static_cast<index>(i)*rsc;
+            const size_t k0 = static_cast<size_t>(offsets[i]);
+            const size_t k1 = static_cast<size_t>(offsets[i + 1]);
+            if (n == 1)
+            {
+                //SpMV: a sparse dot product
+                _Tp sum{};
+                for(size_t k = k0; k < k1; ++k)
+                    sum += values[k]*b[static_cast<index>(indices[k])*rsb];
+                *cRow = sum;
+            }
+            else if (csb == 1 && csc == 1)
+            {
+                std::fill(cRow, cRow + n, _Tp{});
+                for(size_t k = k0; k < k1; ++k)
+                {
+                    const _Tp a = values[k];
+                    const _Tp* bRow = b + static_cast<index>(indices[k])*rsb;
+                    for(size_t j = 0; j < n; ++j)
+                        cRow[j] += a*bRow[j];
+                }
+            }
+            else
+            {
+                for(size_t j = 0; j < n; ++j)
+                    cRow[static_cast<index>(j)*csc] = _Tp{};
+                for(size_t k = k0; k < k1; ++k)
+                {
+                    const _Tp a = values[k];
+                    const _Tp* bRow = b + static_cast<index>(indices[k])*rsb;
+                    for(size_t j = 0; j < n; ++j)
+                        cRow[static_cast<index>(j)*csc] += a*bRow[static_cast<index>(j)*csb];
+                }
+            }
+        }
+    }
+
+    //Columns [first, last) of C = A*B for CSC A. Column k of A is scaled by
+    //row k of B and scattered into C
+    template<typename _Tp, typename _IndexTp>
+    void _cscProduct(size_t first, size_t last, size_t m, size_t k, const _IndexTp* offsets, const _IndexTp* indices,
+        const _Tp* values, const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+        _Tp* c, std::ptrdiff_t rsc, std::ptrdiff_t csc) noexcept
+    {
+        using index = std::ptrdiff_t;
+        for(size_t i = 0; i < m; ++i)
+            for(size_t j = first; j < last; ++j)
+                c[static_cast<index>(i)*rsc + static_cast<index>(j)*csc] = _Tp{};
+        for(size_t p = 0; p < k; ++p)
+        {
+            const _Tp* bRow = b + static_cast<index>(p)*rsb;
+            for(size_t q = static_cast<size_t>(offsets[p]); q < static_cast<size_t>(offsets[p + 1]); ++q)
+            {
+                const _Tp a = values[q];
+                _Tp* cRow = c + static_cast<index>(indices[q])*rsc;
+                for(size_t j = first; j < last; ++j)
+                    cRow[static_cast<index>(j)*csc] += a*bRow[static_cast<index>(j)*csb];
+            }
+        }
+    }
+
+    template<typename _Tp, bool _RowMajor, typename _IndexTp>
+    void _sparseProduct(sequenced_policy, const _CompressedMatrix<_Tp, _RowMajor, _IndexTp>& a, size_t n,
+        const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb, _Tp* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+    {
+        if constexpr(_RowMajor)
+            _csrProduct(0, a.numRows(), n, a.offsets().data(), a.indices().data(), a.values().data(), b, rsb, csb, c, rsc, csc);
+        else
+            _cscProduct(0, n, a.numRows(), a.numCols(), a.offsets().data(), a.indices().data(), a.values().data(),
+                b, rsb, csb, c, rsc, csc);
+    }
+
+    //Parallel product. CSR splits the rows of C into chunks of equal work,
+    //counting one unit per non-zero and per row, so a few very dense rows
+    //(common in power-law graphs) don't leave one thread with most of it.
+    //CSC would race on the rows of C, so it splits the columns of C instead
+    //and runs SpMV sequentially
+    template<typename _Tp, bool _RowMajor, typename _IndexTp>
+    void _sparseProduct(parallel_policy, const _CompressedMatrix<_Tp, _RowMajor, _IndexTp>& a, size_t n,
+        const _Tp* b, std::ptrdiff_t rsb, std::ptrdiff_t csb, _Tp* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+    {
+        const size_t grain = std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/std::max<size_t>(n, 1));
+        const _IndexTp* offsets = a.offsets().data();
+        if constexpr(_RowMajor)
+        {
+            const size_t m = a.numRows();
+            const _Partition work = _partition(a.nonZeros() + m, 1, 0, grain);
+            if (work.count() <= 1)
+            {
+                _sparseProduct(Limno::seq, a, n, b, rsb, csb, c, rsc, csc);
+                return;
+            }
+            //First row whose work starts at or after w
+            const auto rowAt = [&](size_t w)
+            {
+                size_t lo = 0, hi = m;
+                while (lo < hi)
+                {
+                    const size_t mid = lo + (hi - lo)/2;
+                    if (static_cast<size_t>(offsets[mid]) + mid < w)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                return lo;
+            };
+            _parallelChunks(work, [&](size_t first, size_t last)
+            {
+                _csrProduct(rowAt(first), rowAt(last), n, offsets, a.indices().data(), a.values().data(), b, rsb, csb, c, rsc, csc);
+            });
+        }
+        else
+        {
+            const size_t quantum = std::max<size_t>(1, LIMNO_CACHE_LINE/sizeof(_Tp));
+            const _Partition columns = _partition(n, quantum, 0, std::max<size_t>(1, grain/std::max<size_t>(a.nonZeros(), 1)));
+            if (columns.count() <= 1)
+            {
+                _sparseProduct(Limno::seq, a, n, b, rsb, csb, c, rsc, csc);
+                return;
+            }
+            _parallelChunks(columns, [&](size_t first, size_t last)
+            {
+                _cscProduct(first, last, a.numRows(), a.numCols(), offsets, a.indices().data(), a.values().data(),
+                    b, rsb, csb, c, rsc, csc);
+            });
+        }
+    }
+
+    //Computes the product of a sparse matrix and a dense matrix or view into
+    //result, which may be a matrix or a mutable view and must already have
+    //the shape of the product. The kernels write C while still reading B, so
+    //result must not share storage with rhs. A dense column vector gives SpMV
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, bool _RowMajor, typename _IndexTp, typename _DenseTp, typename _ResultTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, bool _RowMajor, typename _IndexTp, typename _DenseTp, typename _ResultTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    void matmul(_PolicyTp&& policy, const _CompressedMatrix<_Tp, _RowMajor, _IndexTp>& lhs, const _DenseTp& rhs, _ResultTp&& result)
+    {
+        static_assert(_OperandTraits<_DenseTp>::isMatrix && !_isExpr<_DenseTp>, "Operands must be matrices or views!");
+        static_assert(std::is_same_v<_OperandValue_t<_DenseTp>, _Tp>, "Matrix types do not match!");
+        if (lhs.numCols() != rhs.numRows())
+            throw std::invalid_argument("Inner matrix dimensions do not match!");
+        if (result.numRows() != lhs.numRows() || result.numCols() != rhs.numCols())
+            throw std::invalid_argument("Result matrix has the wrong dimensions!");
+        if (_sharesStorage(result, rhs))
+            throw std::invalid_argument("Result matrix overlaps an operand!");
+        if (result.numRows() == 0 || result.numCols() == 0)
+            return;
+        //Each non-zero is read once and meets a row of B; C is read and written
+        LIMNO_INSTRUMENT_OPERATION(rhs.numCols() == 1 ? "spmv" : "spmm", 2.0*lhs.nonZeros()*rhs.numCols(),
+            lhs.nonZeros()*(sizeof(_Tp) + sizeof(_IndexTp)) + (rhs.size() + 2*result.numRows()*result.numCols())*sizeof(_Tp));
+        _sparseProduct(policy, lhs, rhs.numCols(), rhs.data(), rhs.rowStride(), rhs.colStride(),
+            result.data(), result.rowStride(), result.colStride());
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, bool _RowMajor, typename _IndexTp, typename _DenseTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, bool _RowMajor, typename _IndexTp, typename _DenseTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> matmul(_PolicyTp&& policy, const _CompressedMatrix<_Tp, _RowMajor, _IndexTp>& lhs,
+        const _DenseTp& rhs)
+    {
+        //Every element is written by the kernels
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> result(Limno::uninitialized, lhs.numRows(), rhs.numCols());
+        matmul(policy, lhs, rhs, result);
+        return result;
+    }
+
+    template<typename _Tp, bool _RowMajor, typename _IndexTp, typename _DenseTp, typename _ResultTp>
+    void matmul(const _CompressedMatrix<_Tp, _RowMajor, _IndexTp>& lhs, const _DenseTp& rhs, _ResultTp&& result)
+    {
+        matmul(Limno::seq, lhs, rhs, result);
+    }
+
+    template<typename _Tp, bool _RowMajor, typename _IndexTp, typename _DenseTp>
+    LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> matmul(const _CompressedMatrix<_Tp, _RowMajor, _IndexTp>& lhs, const _DenseTp& rhs)
+    {
+        return matmul(Limno::seq, lhs, rhs);
+    }
+}
+
+#endif
@@ -0,0 +1,285 @@
+#ifndef STRIDED_ITERATOR_HH
+#define STRIDED_ITERATOR_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
+
+#include "config.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Random access iterator over a two-dimensional strided walk. Elements are
+    //visited along the inner dimension first, then the walk moves one step 
+    //along the outer dimension. Used to skip row padding and to traverse 
+    //row-major storage in column-major order.
+    template<typename _Tp>
+    struct _StridedIterator
+    {
+        using value_type = std::remove_cv_t<_Tp>;
+        using reference = _Tp&;
+        using pointer = _Tp*;
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+
+        _StridedIterator() noexcept
+            : _base{}, _curr{}, _index{0}, _pos{0}, _inner{0}, _innerStride{0}, _outerStride{0}
+        {
+
+        }
+
+        //base points at the first element, inner is the number of elements 
+        //visited before moving along the outer dimension
+        _StridedIterator(pointer base, difference_type index, difference_type inner,
+            difference_type innerStride, difference_type outerStride) noexcept
+            : _base{base}, _curr{base}, _index{0}, _pos{0}, _inner{inner}, 
+            _innerStride{innerStride}, _outerStride{outerStride}
+        {
+            _seek(index);
+        }
+
+        //Allows iterator -> const_iterator conversion
+        template<typename _UTp, 
+            std::enable_if_t<std::is_same_v<const _UTp, _Tp> && !std::is_same_v<_UTp, _Tp>, int> = 0>
+        _StridedIterator(const _StridedIterator<_UTp>& other) noexcept
+            : _base{other._base}, _curr{other._curr}, _index{other._index}, _pos{other._pos},
+            _inner{other._inner}, _innerStride{other._innerStride}, _outerStride{other._outerStride}
+        {
+
+        }
+
+        reference operator*() const noexcept
+        {
+            return *_curr;
+        }
+
+        pointer operator->() const noexcept
+        {
+            return _curr;
+        }
+
+        reference operator[](difference_type n) const noexcept
+        {
+            return *(*this + n);
+        }
+
+        _StridedIterator& operator++() noexcept
+        {
+            ++_index;
+            if (++_pos == _inner)
+            {
+                _pos = 0;
+                _curr += _outerStride - (_inner - 1)*_innerStride;
+            }
+            else 
+            {
+                _curr += _innerStride;
+            }
+            return *this;
+        }
+
+        _StridedIterator operator++(int) noexcept
+        {
+            _StridedIterator temp{*this};
+            ++(*this);
+            return temp;
+        }
+
+        _StridedIterator& operator--() noexcept
+        {
+            --_index;
+            if (_pos == 0)
+            {
+                _pos = _inner - 1;
+                _curr -= _outerStride - (_inner - 1)*_innerStride;
+            }
+            else 
+            {
+                --_pos;
+                _curr -= _innerStride;
+            }
+            return *this;
+        }
+
+        _StridedIterator operator--(int) noexcept
+        {
+            _StridedIterator temp{*this};
+            --(*this);
+            return temp;
+        }
+
+        _StridedIterator& operator+=(difference_type n) noexcept
+        {
+            _seek(_index + n);
+            return *this;
+        }
+
+        _StridedIterator& operator-=(difference_type n) noexcept
+        {
+            _seek(_index - n);
+            return *this;
+        }
+
+        //Distance between consecutive elements along the inner dimension
+        difference_type innerStride() const noexcept
+        {
+            return _innerStride;
+        }
+
+        //Distance between consecutive positions along the outer dimension
+        difference_type outerStride() const noexcept
+        {
+            return _outerStride;
+        }
+
+        //Number of elements visited before moving along the outer dimension
+        difference_type innerExtent() const noexcept
+        {
+            return _inner;
+        }
+
+        //Position of the current element along the inner dimension
+        difference_type innerPosition() const noexcept
+        {
+            return _pos;
+        }
+
+        private:
+        void _seek(difference_type index) noexcept
+        {
+            _index = index;
+            if (_inner == 0)
+                return;
+            _pos = index % _inner;
+            _curr = _base + (index/_inner)*_outerStride + _pos*_innerStride;
+        }
+
+        friend _StridedIterator operator+(_StridedIterator it, difference_type n) noexcept
+        {
+            return it += n;
+        }
+
+        friend _StridedIterator operator+(difference_type n, _StridedIterator it) noexcept
+        {
+            return it += n;
+        }
+
+        friend _StridedIterator operator-(_StridedIterator it, difference_type n) noexcept
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const _StridedIterator& lhs, const _StridedIterator& rhs) noexcept
+        {
+            return lhs._index - rhs._index;
+        }
+
+        friend bool operator==(const _StridedIterator& lhs, const _StridedIterator& rhs) noexcept
+        {
+            return lhs._index == rhs._index && lhs._base == rhs._base;
+        }
+
+        friend bool operator!=(const _StridedIterator& lhs, const _StridedIterator& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(const _StridedIterator& lhs, const _StridedIterator& rhs) noexcept
+        {
+            return lhs._index < rhs._index;
+        }
+
+        friend bool operator>(const _StridedIterator& lhs, const _StridedIterator& rhs) noexcept
+        {
+            return lhs._index > rhs._index;
+        }
+
+        friend bool operator<=(const _StridedIterator& lhs, const _StridedIterator& rhs) noexcept
+        {
+            return lhs._index <= rhs._index;
+        }
+
+        friend bool operator>=(const _StridedIterator& lhs, const _StridedIterator& rhs) noexcept
+        {
+            return lhs._index >= rhs._index;
+        }
+
+        template<typename _UTp>
+        friend struct _StridedIterator;
+        private:
+        pointer _base;
+        pointer _curr;
+        difference_type _index;
+        //Position along the inner dimension
+        difference_type _pos;
+        difference_type _inner;
+        difference_type _innerStride;
+        difference_type _outerStride;
+    };
+
+    template<typename _IterTp>
+    static constexpr bool _isStridedIterator = false;
+
+    template<typename _Tp>
+    constexpr bool _isStridedIterator<_StridedIterator<_Tp>> = true;
+
+    //Calls f(offset, element) for every element of [first, last), where offset
+    //is the element's distance from first. If the walk strides further along
+    //the inner dimension than the outer one (e.g. a column-major walk over 
+    //row-major storage) whole inner runs are visited in tiles a cache line 
+    //wide, so every line that is loaded is fully used before moving on. f must
+    //not depend on the visiting order
+    template<typename _Tp, typename _FuncTp>
+    void _forEachTiled(_StridedIterator<_Tp> first, _StridedIterator<_Tp> last, _FuncTp f)
+    {
+        using difference_type = std::ptrdiff_t;
+        constexpr difference_type tile = std::max<difference_type>(1, LIMNO_CACHE_LINE/sizeof(_Tp));
+
+        const difference_type n = last - first;
+        const difference_type inner = first.innerExtent();
+        const difference_type innerStride = first.innerStride();
+        const difference_type outerStride = first.outerStride();
+        difference_type i = 0;
+        if (inner <= 1 || std::abs(innerStride) <= std::abs(outerStride))
+        {
+            for(; i < n; ++i, ++first)
+                f(i, *first);
+            return;
+        }
+
+        //Finish a partial run so the tiles start at the top of a run
+        for(; i < n && first.innerPosition() != 0; ++i, ++first)
+            f(i, *first);
+
+        const difference_type runs = (n - i)/inner;
+        _Tp* base = first.operator->();
+        for(difference_type r0 = 0; r0 < runs; r0 += tile)
+        {
+            const difference_type width = std::min(tile, runs - r0);
+            for(difference_type p = 0; p < inner; ++p)
+            {
+                _Tp* line = base + p*innerStride + r0*outerStride;
+                for(difference_type r = 0; r < width; ++r)
+                    f(i + (r0 + r)*inner + p, line[r*outerStride]);
+            }
+        }
+        i += runs*inner;
+        first += runs*inner;
+
+        for(; i < n; ++i, ++first)
+            f(i, *first);
+    }
+
+    //Copies [first, last) to the random access range starting at out, using
+    //the tiled traversal. Returns the end of the output range
+    template<typename _Tp, typename _OutTp>
+    _OutTp _stridedCopy(_StridedIterator<_Tp> first, _StridedIterator<_Tp> last, _OutTp out)
+    {
+        _forEachTiled(first, last, [&out](std::ptrdiff_t i, const _Tp& value) { out[i] = value; });
+        return out + (last - first);
+    }
+}
+
+#endif
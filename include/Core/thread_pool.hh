@@ -0,0 +1,261 @@
+#ifndef THREAD_POOL_HH
+#define THREAD_POOL_HH 1
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "config.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Pool of worker threads shared by every parallel kernel. Each worker owns a
+    //deque of tasks: it pops from the back of its own deque and, once that is
+    //empty, steals from the front of the others. A task covers a range of
+    //chunks and is split in half lazily, so idle threads steal large pieces
+    //and the owner keeps working on neighbouring (cache-warm) chunks. The
+    //thread calling parallelFor works on its own job while it waits, which
+    //also makes nested calls safe.
+    class _ThreadPool
+    {
+        public:
+        //numThreads counts the calling thread, so numThreads - 1 workers are
+        //started
+        explicit _ThreadPool(size_t numThreads)
+            : _queues(std::max<size_t>(numThreads, 1)), _pending{0}, _stopping{false}
+        {
+            for(auto& queue : _queues)
+                queue = std::make_unique<_Queue>();
+            for(size_t i = 1; i < _queues.size(); ++i)
+                _workers.emplace_back([this, i] { _workerLoop(i); });
+        }
+
+        _ThreadPool(const _ThreadPool&) = delete;
+        _ThreadPool& operator=(const _ThreadPool&) = delete;
+
+        ~_ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock{_sleepMutex};
+                _stopping = true;
+            }
+            _wake.notify_all();
+            for(auto& worker : _workers)
+                worker.join();
+        }
+
+        //Number of threads that execute tasks, including the caller
+        size_t size() const noexcept
+        {
+            return _queues.size();
+        }
+
+        //Calls f(i) for every i in [0, numTasks) and returns once all calls
+        //have finished. The first exception thrown by f is rethrown here
+        template<typename _FuncTp>
+        void parallelFor(size_t numTasks, _FuncTp&& f)
+        {
+            if (numTasks == 0)
+                return;
+            if (numTasks == 1 || size() == 1)
+            {
+                for(size_t i = 0; i < numTasks; ++i)
+                    f(i);
+                return;
+            }
+
+            _Job job;
+            job.context = &f;
+            job.invoke = [](void* context, size_t i) { (*static_cast<std::remove_reference_t<_FuncTp>*>(context))(i); };
+            job.remaining.store(numTasks, std::memory_order_relaxed);
+
+            //Hand every thread one contiguous share; the caller keeps the first
+            const size_t self = _selfIndex();
+            const size_t shares = std::min(numTasks, size());
+            for(size_t s = 0; s < shares; ++s)
+            {
+                const size_t first = numTasks*s/shares;
+                const size_t last = numTasks*(s + 1)/shares;
+                _push((self + s) % size(), _Task{&job, first, last});
+            }
+            _notify(true);
+
+            while (job.remaining.load(std::memory_order_acquire) != 0)
+            {
+                if (!_runOne(self))
+                    std::this_thread::yield();
+            }
+
+            if (job.error)
+                std::rethrow_exception(job.error);
+        }
+
+        private:
+        struct _Job
+        {
+            void* context;
+            void (*invoke)(void*, size_t);
+            std::atomic<size_t> remaining;
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        struct _Task
+        {
+            _Job* job;
+            size_t first;
+            size_t last;
+        };
+
+        //Own cache line per queue so workers don't contend on the lock words
+        struct alignas(LIMNO_CACHE_LINE) _Queue
+        {
+            std::mutex mutex;
+            std::deque<_Task> tasks;
+        };
+
+        //Index of the queue owned by the calling thread. Threads outside the
+        //pool share queue 0
+        static size_t& _workerIndex() noexcept
+        {
+            thread_local size_t index = 0;
+            return index;
+        }
+
+        size_t _selfIndex() const noexcept
+        {
+            return _workerIndex() % size();
+        }
+
+        void _push(size_t queue, _Task task)
+        {
+            //Counted before it becomes visible so _pending never underflows
+            _pending.fetch_add(1, std::memory_order_release);
+            std::lock_guard<std::mutex> lock{_queues[queue]->mutex};
+            _queues[queue]->tasks.push_back(task);
+        }
+
+        //Taking the sleep mutex orders the notification after a sleeping
+        //worker's last check of _pending, so the wake up can't be lost
+        void _notify(bool all)
+        {
+            {
+                std::lock_guard<std::mutex> lock{_sleepMutex};
+            }
+            if (all)
+                _wake.notify_all();
+            else 
+                _wake.notify_one();
+        }
+
+        bool _pop(size_t self, _Task& task)
+        {
+            {
+                _Queue& own = *_queues[self];
+                std::lock_guard<std::mutex> lock{own.mutex};
+                if (!own.tasks.empty())
+                {
+                    task = own.tasks.back();
+                    own.tasks.pop_back();
+                    _pending.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            for(size_t offset = 1; offset < size(); ++offset)
+            {
+                _Queue& victim = *_queues[(self + offset) % size()];
+                std::lock_guard<std::mutex> lock{victim.mutex};
+                if (!victim.tasks.empty())
+                {
+                    task = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    _pending.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //Runs one chunk of some task, leaving the rest of the task stealable
+        bool _runOne(size_t self)
+        {
+            _Task task;
+            if (!_pop(self, task))
+                return false;
+
+            while (task.last - task.first > 1)
+            {
+                const size_t mid = task.first + (task.last - task.first)/2;
+                _push(self, _Task{task.job, mid, task.last});
+                task.last = mid;
+                _notify(false);
+            }
+
+            _Job& job = *task.job;
+            try
+            {
+                job.invoke(job.context, task.first);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock{job.errorMutex};
+                if (!job.error)
+                    job.error = std::current_exception();
+            }
+            job.remaining.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+
+        void _workerLoop(size_t index)
+        {
+            _workerIndex() = index;
+            while (true)
+            {
+                if (_runOne(index))
+                    continue;
+                std::unique_lock<std::mutex> lock{_sleepMutex};
+                _wake.wait(lock, [this] { return _stopping || _pending.load(std::memory_order_acquire) != 0; });
+                if (_stopping)
+                    return;
+            }
+        }
+
+        std::vector<std::unique_ptr<_Queue>> _queues;
+        std::vector<std::thread> _workers;
+        std::atomic<size_t> _pending;
+        std::mutex _sleepMutex;
+        std::condition_variable _wake;
+        bool _stopping;
+    };
+
+    //Number of threads used by parallel kernels: LIMNO_NUM_THREADS if set,
+    //otherwise the hardware concurrency
+    inline size_t _defaultThreadCount() noexcept
+    {
+        if (const char* env = std::getenv("LIMNO_NUM_THREADS"))
+        {
+            const long count = std::strtol(env, nullptr, 10);
+            if (count > 0)
+                return static_cast<size_t>(count);
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    //The pool is started on first use and reused by every later call
+    inline _ThreadPool& _threadPool()
+    {
+        static _ThreadPool pool{_defaultThreadCount()};
+        return pool;
+    }
+}
+
+#endif
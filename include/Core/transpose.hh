@@ -0,0 +1,443 @@
+#ifndef TRANSPOSE_HH
+#define TRANSPOSE_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+#include "Core/construction.hh"
+#include "Core/execution.hh"
+#include "Core/instrumentation.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+#include "Core/simd.hh"
+#include "Core/small_matrix.hh"
+
+//Materializing transposes. A transpose view (view().transpose()) is free, but
+//reading one walks memory a column at a time, which for large matrices costs
+//a cache and TLB miss per element. The transposes here work in small square
+//tiles that fit in L1, and each tile is transposed in registers blocks at a
+//time
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Transposes the rows x cols block at src into dst, so that
+    //dst[j*dstLd + i] = src[i*srcLd + j]
+    template<typename _Tp>
+    using _transpose_tile_fn = void (*)(const _Tp*, std::ptrdiff_t, _Tp*, std::ptrdiff_t, size_t, size_t);
+
+    namespace _scalar
+    {
+        //Element by element blocks, small enough for the compiler to keep in
+        //registers
+        template<typename _Tp>
+        struct _TransposeBlock
+        {
+            static constexpr size_t width = 4;
+
+            static void apply(const _Tp* src, std::ptrdiff_t srcLd, _Tp* dst, std::ptrdiff_t dstLd) noexcept
+            {
+                for(size_t i = 0; i < width; ++i)
+                    for(size_t j = 0; j < width; ++j)
+                        dst[static_cast<std::ptrdiff_t>(j)*dstLd + i] = src[static_cast<std::ptrdiff_t>(i)*srcLd + j];
+            }
+        };
+
+        #include "Core/transpose_kernels.inl"
+    }
+
+    #if LIMNO_SIMD_X86
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("sse2")
+    #endif
+    namespace _sse2
+    {
+        template<typename _Tp>
+        struct _TransposeBlock;
+
+        template<>
+        struct _TransposeBlock<float>
+        {
+            static constexpr size_t width = 4;
+
+            static void apply(const float* src, std::ptrdiff_t srcLd, float* dst, std::ptrdiff_t dstLd) noexcept
+            {
+                __m128 r0 = _mm_loadu_ps(src);
+                __m128 r1 = _mm_loadu_ps(src + srcLd);
+                __m128 r2 = _mm_loadu_ps(src + 2*srcLd);
+                __m128 r3 = _mm_loadu_ps(src + 3*srcLd);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(dst, r0);
+                _mm_storeu_ps(dst + dstLd, r1);
+                _mm_storeu_ps(dst + 2*dstLd, r2);
+                _mm_storeu_ps(dst + 3*dstLd, r3);
+            }
+        };
+
+        template<>
+        struct _TransposeBlock<double>
+        {
+            static constexpr size_t width = 2;
+
+            static void apply(const double* src, std::ptrdiff_t srcLd, double* dst, std::ptrdiff_t dstLd) noexcept
+            {
+                const __m128d r0 = _mm_loadu_pd(src);
+                const __m128d r1 = _mm_loadu_pd(src + srcLd);
+                _mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+                _mm_storeu_pd(dst + dstLd, _mm_unpackhi_pd(r0, r1));
+            }
+        };
+
+        #include "Core/transpose_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+
+    #if defined(__clang__)
+        #pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+    #else
+        #pragma GCC push_options
+        #pragma GCC target("avx2")
+    #endif
+    namespace _avx2
+    {
+        template<typename _Tp>
+        struct _TransposeBlock;
+
+        //8x8 in three rounds of shuffles: interleave pairs of rows, then
+        //pairs of pairs, then swap 128 bit halves
+        template<>
+        struct _TransposeBlock<float>
+        {
+            static constexpr size_t width = 8;
+
+            static void apply(const float* src, std::ptrdiff_t srcLd, float* dst, std::ptrdiff_t dstLd) noexcept
+            {
+                __m256 r[8];
+                for(int i = 0; i < 8; ++i)
+                    r[i] = _mm256_loadu_ps(src + i*srcLd);
+                __m256 t[8];
+                for(int i = 0; i < 8; i += 2)
+                {
+                    t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+                    t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+                }
+                for(int i = 0; i < 8; i += 4)
+                {
+                    r[i] = _mm256_shuffle_ps(t[i], t[i + 2], 0x44);
+                    r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], 0xEE);
+                    r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+                    r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+                }
+                for(int i = 0; i < 4; ++i)
+                {
+                    _mm256_storeu_ps(dst + i*dstLd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+                    _mm256_storeu_ps(dst + (i + 4)*dstLd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+                }
+            }
+        };
+
+        template<>
+        struct _TransposeBlock<double>
+        {
+            static constexpr size_t width = 4;
+
+            static void apply(const double* src, std::ptrdiff_t srcLd, double* dst, std::ptrdiff_t dstLd) noexcept
+            {
+                const __m256d r0 = _mm256_loadu_pd(src);
+                const __m256d r1 = _mm256_loadu_pd(src + srcLd);
+                const __m256d r2 = _mm256_loadu_pd(src + 2*srcLd);
+                const __m256d r3 = _mm256_loadu_pd(src + 3*srcLd);
+                const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+                const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+                const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+                const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+                _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+                _mm256_storeu_pd(dst + dstLd, _mm256_permute2f128_pd(t1, t3, 0x20));
+                _mm256_storeu_pd(dst + 2*dstLd, _mm256_permute2f128_pd(t0, t2, 0x31));
+                _mm256_storeu_pd(dst + 3*dstLd, _mm256_permute2f128_pd(t1, t3, 0x31));
+            }
+        };
+
+        #include "Core/transpose_kernels.inl"
+    }
+    #if defined(__clang__)
+        #pragma clang attribute pop
+    #else
+        #pragma GCC pop_options
+    #endif
+    #endif // LIMNO_SIMD_X86
+
+    //Tile kernel for an instruction set; AVX-512 uses the AVX2 blocks, which
+    //already move a cache line per row
+    template<typename _Tp>
+    _transpose_tile_fn<_Tp> _transposeTileFor([[maybe_unused]] _SimdIsa isa) noexcept
+    {
+        #if LIMNO_SIMD_X86
+        if constexpr(std::is_same_v<_Tp, float> || std::is_same_v<_Tp, double>)
+        {
+            if (isa >= _SimdIsa::avx2)
+                return &_avx2::_transposeTile<_Tp>;
+            if (isa == _SimdIsa::sse2)
+                return &_sse2::_transposeTile<_Tp>;
+        }
+        #endif
+        return &_scalar::_transposeTile<_Tp>;
+    }
+
+    //Tile kernel for the instruction set detected at startup
+    template<typename _Tp>
+    _transpose_tile_fn<_Tp> _transposeTile() noexcept
+    {
+        static const _transpose_tile_fn<_Tp> kernel = _transposeTileFor<_Tp>(simdIsa());
+        return kernel;
+    }
+
+    //Side of the square tiles handed to the tile kernels
+    static constexpr size_t _transposeTileSide = 16;
+
+    //Transposes a rows x cols row-major block a band of output rows at a
+    //time. Each band is written in full before moving on, so only a few
+    //pages of the destination are live at once; a recursive (cache
+    //oblivious) split measured slower, as it revisits far more pages and
+    //thrashes the TLB on large matrices
+    template<typename _Tp>
+    void _transposeBlocked(_transpose_tile_fn<_Tp> kernel, const _Tp* src, std::ptrdiff_t srcLd, _Tp* dst,
+        std::ptrdiff_t dstLd, size_t rows, size_t cols) noexcept
+    {
+        constexpr size_t tile = _transposeTileSide;
+        for(size_t c0 = 0; c0 < cols; c0 += tile)
+            for(size_t r0 = 0; r0 < rows; r0 += tile)
+                kernel(src + static_cast<std::ptrdiff_t>(r0)*srcLd + c0, srcLd, dst + static_cast<std::ptrdiff_t>(c0)*dstLd + r0,
+                    dstLd, std::min(tile, rows - r0), std::min(tile, cols - c0));
+    }
+
+    //Writes the transpose of src into dst, which must have the transposed
+    //shape and not overlap src. Under Limno::par the columns of src, i.e. the
+    //rows of dst, are split into chunks on the thread pool
+    template<typename _PolicyTp, typename _Tp>
+    void _transposeInto(const _PolicyTp&, const LimnoMatrixView<const _Tp>& src, const LimnoMatrixView<_Tp>& dst)
+    {
+        const size_t rows = src.numRows();
+        const size_t cols = src.numCols();
+        LIMNO_INSTRUMENT_OPERATION("transpose", 0, 2.0*rows*cols*sizeof(_Tp));
+        if (rows == 0 || cols == 0)
+            return;
+
+        auto run = [cols, rows](auto chunk)
+        {
+            if constexpr(_isParallelPolicy<_PolicyTp>)
+                _parallelChunks(_partition(cols, _transposeTileSide, 0, std::max(_transposeTileSide, LIMNO_PARALLEL_GRAIN/rows)), chunk);
+            else
+                chunk(size_t{0}, cols);
+        };
+
+        if (src.colStride() == 1 && dst.colStride() == 1)
+        {
+            const _transpose_tile_fn<_Tp> kernel = _transposeTile<_Tp>();
+            run([&src, &dst, kernel, rows](size_t first, size_t last)
+            {
+                _transposeBlocked(kernel, src.data() + first, src.rowStride(),
+                    dst.data() + static_cast<std::ptrdiff_t>(first)*dst.rowStride(), dst.rowStride(), rows, last - first);
+            });
+        }
+        else if (src.rowStride() == 1 && dst.colStride() == 1)
+        {
+            //Columns of src are contiguous and become rows of dst
+            run([&src, &dst, rows](size_t first, size_t last)
+            {
+                for(size_t c = first; c < last; ++c)
+                    std::copy(&src(0, c), &src(0, c) + rows, &dst(c, 0));
+            });
+        }
+        else
+        {
+            //Any strides; tiled so both sides are walked a few lines at a time
+            constexpr size_t tile = 32;
+            run([&src, &dst, rows](size_t first, size_t last)
+            {
+                for(size_t r0 = 0; r0 < rows; r0 += tile)
+                    for(size_t c0 = first; c0 < last; c0 += tile)
+                        for(size_t r = r0; r < std::min(rows, r0 + tile); ++r)
+                            for(size_t c = c0; c < std::min(last, c0 + tile); ++c)
+                                dst(c, r) = src(r, c);
+            });
+        }
+    }
+
+    //In place transpose of an n x n row-major block with leading dimension
+    //ld. Tiles above the diagonal are swapped with their mirror images
+    //through one tile-sized buffer; under Limno::par tile rows are paired
+    //from both ends so every task does the same amount of work
+    template<typename _PolicyTp, typename _Tp>
+    void _transposeSquareInPlace(const _PolicyTp&, _Tp* data, std::ptrdiff_t ld, size_t n)
+    {
+        LIMNO_INSTRUMENT_OPERATION("transposeInPlace", 0, 2.0*n*n*sizeof(_Tp));
+        constexpr size_t tile = 32;
+        const size_t numTiles = (n + tile - 1)/tile;
+        const _transpose_tile_fn<_Tp> kernel = _transposeTile<_Tp>();
+        auto tileRow = [=](size_t i, std::vector<_Tp>& buffer)
+        {
+            const size_t r0 = i*tile;
+            const size_t rows = std::min(tile, n - r0);
+            for(size_t j = i; j < numTiles; ++j)
+            {
+                const size_t c0 = j*tile;
+                const size_t cols = std::min(tile, n - c0);
+                _Tp* upper = data + static_cast<std::ptrdiff_t>(r0)*ld + c0;
+                _Tp* lower = data + static_cast<std::ptrdiff_t>(c0)*ld + r0;
+                const std::ptrdiff_t bufferLd = static_cast<std::ptrdiff_t>(rows);
+                kernel(upper, ld, buffer.data(), bufferLd, rows, cols);
+                if (i != j)
+                    kernel(lower, ld, upper, ld, cols, rows);
+                for(size_t c = 0; c < cols; ++c)
+                    std::copy(buffer.data() + c*rows, buffer.data() + (c + 1)*rows, lower + static_cast<std::ptrdiff_t>(c)*ld);
+            }
+        };
+
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+        {
+            if (n*n >= LIMNO_PARALLEL_GRAIN)
+            {
+                _threadPool().parallelFor((numTiles + 1)/2, [&](size_t t)
+                {
+                    std::vector<_Tp> buffer(tile*tile);
+                    tileRow(t, buffer);
+                    if (numTiles - 1 - t != t)
+                        tileRow(numTiles - 1 - t, buffer);
+                });
+                return;
+            }
+        }
+        std::vector<_Tp> buffer(tile*tile);
+        for(size_t i = 0; i < numTiles; ++i)
+            tileRow(i, buffer);
+    }
+
+    //Writes the transpose of src into dst without allocating. dst must have
+    //the transposed shape and must not overlap src
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp1, typename _Tp2>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp1, typename _Tp2,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    void transposeInto(_PolicyTp&& policy, const LimnoMatrixView<_Tp1>& src, const LimnoMatrixView<_Tp2>& dst)
+    {
+        static_assert(std::is_same_v<std::remove_cv_t<_Tp1>, _Tp2>, "Matrix types do not match!");
+        if (src.numRows() != dst.numCols() || src.numCols() != dst.numRows())
+            throw std::invalid_argument("Matrix dimensions do not match!");
+        _transposeInto(policy, LimnoMatrixView<const _Tp2>{src}, dst);
+    }
+
+    template<typename _Tp1, typename _Tp2>
+    void transposeInto(const LimnoMatrixView<_Tp1>& src, const LimnoMatrixView<_Tp2>& dst)
+    {
+        transposeInto(Limno::seq, src, dst);
+    }
+
+    //Transposed copy of a matrix. Small static matrices use the unrolled
+    //transpose in small_matrix.hh
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<_Tp, _Ncols, _Nrows, _AllocTp> transpose(_PolicyTp&& policy, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        if constexpr(_smallDim<_Nrows, _Ncols>)
+            return transpose(m);
+        else
+        {
+            using result_type = LimnoMatrixBase<_Tp, _Ncols, _Nrows, _AllocTp>;
+            result_type result;
+            if constexpr(runtimeDim<_Nrows, _Ncols>)
+                result = result_type(Limno::uninitialized, m.numCols(), m.numRows());
+            _transposeInto(policy, m.view(), result.view());
+            return result;
+        }
+    }
+
+    #if __cplusplus > 201703L
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires (!_smallDim<_Nrows, _Ncols>)
+    #else
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<!_smallDim<_Nrows, _Ncols>, int> = 0>
+    #endif
+    LimnoMatrixBase<_Tp, _Ncols, _Nrows, _AllocTp> transpose(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        return transpose(Limno::seq, m);
+    }
+
+    //Transposed copy of a view
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<std::remove_cv_t<_Tp>, DYNAMIC, DYNAMIC> transpose(_PolicyTp&& policy, const LimnoMatrixView<_Tp>& v)
+    {
+        LimnoMatrixBase<std::remove_cv_t<_Tp>, DYNAMIC, DYNAMIC> result(Limno::uninitialized, v.numCols(), v.numRows());
+        _transposeInto(policy, LimnoMatrixView<const std::remove_cv_t<_Tp>>{v}, result.view());
+        return result;
+    }
+
+    template<typename _Tp>
+    LimnoMatrixBase<std::remove_cv_t<_Tp>, DYNAMIC, DYNAMIC> transpose(const LimnoMatrixView<_Tp>& v)
+    {
+        return transpose(Limno::seq, v);
+    }
+
+    //Transposes a matrix in place. Square matrices are transposed tile by
+    //tile without allocating a second matrix; dynamic matrices of any other
+    //shape are transposed into new storage and take on the transposed shape
+    #if __cplusplus > 201703L
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _PolicyTp, typename _Tp, int _Nrows, int _Ncols, typename _AllocTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    void transposeInPlace(_PolicyTp&& policy, LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        static_assert(compatibleDim<_Nrows, _Ncols>, "Matrix must be square!");
+        if constexpr(_Nrows != DYNAMIC && _Ncols != DYNAMIC)
+            _transposeSquareInPlace(policy, m.data(), static_cast<std::ptrdiff_t>(m.leadingDim()), m.numRows());
+        else
+        {
+            if (m.numRows() == m.numCols())
+                _transposeSquareInPlace(policy, m.data(), static_cast<std::ptrdiff_t>(m.leadingDim()), m.numRows());
+            else if constexpr(_Nrows == DYNAMIC && _Ncols == DYNAMIC)
+            {
+                LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> result(Limno::uninitialized, m.numCols(), m.numRows());
+                _transposeInto(policy, std::as_const(m).view(), result.view());
+                m = std::move(result);
+            }
+            else
+                throw std::invalid_argument("Matrix must be square!");
+        }
+    }
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    void transposeInPlace(LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        transposeInPlace(Limno::seq, m);
+    }
+}
+
+#endif
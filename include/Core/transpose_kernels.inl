@@ -0,0 +1,27 @@
+//Tile transpose shared by every instruction set. Like simd_kernels.inl this file
+//has no include guard: transpose.hh includes it once per instruction set, inside
+//a namespace that has already defined the _TransposeBlock register transposes
+//and with the matching target enabled, so the blocks inline into the loop.
+
+//Transposes the rows x cols tile at src into dst in _TransposeBlock<_Tp>::width
+//square blocks, with the ragged edges done element by element
+template<typename _Tp>
+void _transposeTile(const _Tp* src, std::ptrdiff_t srcLd, _Tp* dst, std::ptrdiff_t dstLd, size_t rows, size_t cols) noexcept
+{
+    using block = _TransposeBlock<_Tp>;
+    constexpr size_t width = block::width;
+    const size_t fullRows = rows - rows % width;
+    const size_t fullCols = cols - cols % width;
+    for(size_t i = 0; i < fullRows; i += width)
+    {
+        const _Tp* in = src + static_cast<std::ptrdiff_t>(i)*srcLd;
+        for(size_t j = 0; j < fullCols; j += width)
+            block::apply(in + j, srcLd, dst + static_cast<std::ptrdiff_t>(j)*dstLd + i, dstLd);
+        for(size_t j = fullCols; j < cols; ++j)
+            for(size_t k = 0; k < width; ++k)
+                dst[static_cast<std::ptrdiff_t>(j)*dstLd + i + k] = in[static_cast<std::ptrdiff_t>(k)*srcLd + j];
+    }
+    for(size_t i = fullRows; i < rows; ++i)
+        for(size_t j = 0; j < cols; ++j)
+            dst[static_cast<std::ptrdiff_t>(j)*dstLd + i] = src[static_cast<std::ptrdiff_t>(i)*srcLd + j];
+}
@@ -0,0 +1,469 @@
+#ifndef BINARY_FORMAT_HH
+#define BINARY_FORMAT_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+#include "IO/dtype.hh"
+#include "IO/mapped_file.hh"
+#include "IO/mapped_matrix.hh"
+
+//Binary matrix format. A fixed 64 byte header, always little-endian:
+//
+//  offset  size  field
+//       0     8  magic "LIMNOMAT"
+//       8     2  version
+//      10     1  dtype
+//      11     1  byte order of the data, 0 little-endian, 1 big-endian
+//      12     4  offset of the data from the start of the file
+//      16     8  rows
+//      24     8  columns
+//      32     8  row stride in elements
+//      40     8  column stride in elements
+//      48     4  alignment of the data offset
+//      52    12  reserved, zero
+//
+//followed by the elements at the data offset, element (r, c) at
+//r*rowStride + c*colStride. Writers produce dense row-major data aligned to a
+//cache line, so a mapped file can be used in place.
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    static constexpr size_t _binaryHeaderSize = 64;
+    static constexpr std::uint16_t _binaryVersion = 1;
+    static constexpr char _binaryMagic[8] = {'L', 'I', 'M', 'N', 'O', 'M', 'A', 'T'};
+
+    //Decoded header of a binary matrix file
+    struct binary_header
+    {
+        dtype type;
+        bool littleEndian;
+        size_t numRows;
+        size_t numCols;
+        std::ptrdiff_t rowStride;
+        std::ptrdiff_t colStride;
+        size_t dataOffset;
+        size_t alignment;
+
+        //Elements between the first and last element, inclusive
+        size_t span() const noexcept
+        {
+            if (numRows == 0 || numCols == 0)
+                return 0;
+            return (numRows - 1)*static_cast<size_t>(rowStride) + (numCols - 1)*static_cast<size_t>(colStride) + 1;
+        }
+
+        //True if every element lies within the first available elements.
+        //Checked term by term, so crafted extents and strides can't wrap
+        bool fitsIn(size_t available) const noexcept
+        {
+            if (numRows == 0 || numCols == 0)
+                return true;
+            if (available == 0)
+                return false;
+            const size_t rowStep = static_cast<size_t>(rowStride);
+            const size_t colStep = static_cast<size_t>(colStride);
+            if (rowStep != 0 && numRows - 1 > (available - 1)/rowStep)
+                return false;
+            const size_t lastRow = (numRows - 1)*rowStep;
+            return colStep == 0 || numCols - 1 <= (available - 1 - lastRow)/colStep;
+        }
+
+        bool isDenseRowMajor() const noexcept
+        {
+            return colStride == 1 && (numRows <= 1 || rowStride == static_cast<std::ptrdiff_t>(numCols));
+        }
+    };
+
+    template<typename _UTp>
+    void _storeLittle(std::byte* p, _UTp value) noexcept
+    {
+        for(size_t i = 0; i < sizeof(_UTp); ++i)
+            p[i] = static_cast<std::byte>((static_cast<std::uint64_t>(value) >> (8*i)) & 0xFF);
+    }
+
+    template<typename _UTp>
+    _UTp _loadLittle(const std::byte* p) noexcept
+    {
+        std::uint64_t value = 0;
+        for(size_t i = 0; i < sizeof(_UTp); ++i)
+            value |= static_cast<std::uint64_t>(p[i]) << (8*i);
+        return static_cast<_UTp>(value);
+    }
+
+    inline void _encodeBinaryHeader(const binary_header& header, std::byte* p) noexcept
+    {
+        std::memset(p, 0, _binaryHeaderSize);
+        std::memcpy(p, _binaryMagic, sizeof(_binaryMagic));
+        _storeLittle<std::uint16_t>(p + 8, _binaryVersion);
+        p[10] = static_cast<std::byte>(header.type);
+        p[11] = static_cast<std::byte>(header.littleEndian ? 0 : 1);
+        _storeLittle<std::uint32_t>(p + 12, static_cast<std::uint32_t>(header.dataOffset));
+        _storeLittle<std::uint64_t>(p + 16, header.numRows);
+        _storeLittle<std::uint64_t>(p + 24, header.numCols);
+        _storeLittle<std::int64_t>(p + 32, header.rowStride);
+        _storeLittle<std::int64_t>(p + 40, header.colStride);
+        _storeLittle<std::uint32_t>(p + 48, static_cast<std::uint32_t>(header.alignment));
+    }
+
+    //Throws std::invalid_argument if the bytes aren't a valid header or
+    //fileSize is too small for the data it describes
+    inline binary_header _decodeBinaryHeader(const std::byte* p, size_t fileSize)
+    {
+        if (fileSize < _binaryHeaderSize || std::memcmp(p, _binaryMagic, sizeof(_binaryMagic)) != 0)
+            throw std::invalid_argument("Not a Limno binary matrix!");
+        if (_loadLittle<std::uint16_t>(p + 8) != _binaryVersion)
+            throw std::invalid_argument("Unsupported binary matrix version!");
+
+        binary_header header;
+        header.type = static_cast<dtype>(p[10]);
+        header.littleEndian = p[11] == std::byte{0};
+        header.dataOffset = _loadLittle<std::uint32_t>(p + 12);
+        header.numRows = _loadLittle<std::uint64_t>(p + 16);
+        header.numCols = _loadLittle<std::uint64_t>(p + 24);
+        header.rowStride = _loadLittle<std::int64_t>(p + 32);
+        header.colStride = _loadLittle<std::int64_t>(p + 40);
+        header.alignment = _loadLittle<std::uint32_t>(p + 48);
+
+        const size_t elementSize = dtypeSize(header.type);
+        if (elementSize == 0 || p[11] > std::byte{1})
+            throw std::invalid_argument("Unknown element type!");
+        if (header.dataOffset < _binaryHeaderSize || header.rowStride < 0 || header.colStride < 0)
+            throw std::invalid_argument("Corrupt binary matrix header!");
+        //Element offsets, and the element count of a loaded copy, must be
+        //addressable whether or not the size of the file is known
+        const size_t addressable = static_cast<size_t>(std::numeric_limits<std::ptrdiff_t>::max())/elementSize;
+        if (!header.fitsIn(addressable) || (header.numCols != 0 && header.numRows > addressable/header.numCols))
+            throw std::invalid_argument("Corrupt binary matrix header!");
+        if (fileSize != static_cast<size_t>(-1) &&
+            (fileSize < header.dataOffset || !header.fitsIn((fileSize - header.dataOffset)/elementSize)))
+            throw std::invalid_argument("Binary matrix file is truncated!");
+        return header;
+    }
+
+    //Header describing numRows x numCols dense row-major elements of type _Tp
+    template<typename _Tp>
+    binary_header _denseBinaryHeader(size_t numRows, size_t numCols, size_t alignment)
+    {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+            throw std::invalid_argument("Alignment must be a power of two!");
+        binary_header header;
+        header.type = _dtypeOf<_Tp>();
+        header.littleEndian = _nativeLittleEndian();
+        header.numRows = numRows;
+        header.numCols = numCols;
+        header.rowStride = static_cast<std::ptrdiff_t>(numCols);
+        header.colStride = 1;
+        header.alignment = alignment;
+        header.dataOffset = (_binaryHeaderSize + alignment - 1)/alignment*alignment;
+        return header;
+    }
+
+    //Writes the header and the padding up to the data offset
+    inline void _writeBinaryHeader(std::ostream& os, const binary_header& header)
+    {
+        std::vector<std::byte> bytes(header.dataOffset, std::byte{0});
+        _encodeBinaryHeader(header, bytes.data());
+        os.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    //Passes the rows of a view to sink as dense row-major bytes, gathering
+    //strided rows into buffer. sink is called as sink(const char*, size_t)
+    template<typename _Tp, typename _SinkTp>
+    void _forEachDenseChunk(const LimnoMatrixView<_Tp>& view, std::vector<std::remove_cv_t<_Tp>>& buffer, _SinkTp&& sink)
+    {
+        using value_type = std::remove_cv_t<_Tp>;
+        const size_t rowBytes = view.numCols()*sizeof(value_type);
+        if (view.isContiguous())
+        {
+            sink(reinterpret_cast<const char*>(view.data()), view.numRows()*rowBytes);
+            return;
+        }
+        buffer.resize(view.numCols());
+        for(size_t r = 0; r < view.numRows(); ++r)
+        {
+            const value_type* row = view.data() + static_cast<std::ptrdiff_t>(r)*view.rowStride();
+            if (view.colStride() != 1)
+            {
+                for(size_t c = 0; c < view.numCols(); ++c)
+                    buffer[c] = view(r, c);
+                row = buffer.data();
+            }
+            sink(reinterpret_cast<const char*>(row), rowBytes);
+        }
+    }
+
+    template<typename _Tp>
+    void _writeBinaryRows(std::ostream& os, const LimnoMatrixView<_Tp>& view, std::vector<std::remove_cv_t<_Tp>>& buffer)
+    {
+        _forEachDenseChunk(view, buffer, [&](const char* bytes, size_t n) { os.write(bytes, static_cast<std::streamsize>(n)); });
+    }
+
+    //Saves a matrix or view as a dense row-major binary matrix
+    template<typename _Tp>
+    void saveBinary(const std::string& path, const LimnoMatrixView<_Tp>& view, size_t alignment = LIMNO_CACHE_LINE)
+    {
+        using value_type = std::remove_cv_t<_Tp>;
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        if (!os)
+            throw std::runtime_error("Could not open " + path + "!");
+        _writeBinaryHeader(os, _denseBinaryHeader<value_type>(view.numRows(), view.numCols(), alignment));
+        std::vector<value_type> buffer;
+        _writeBinaryRows(os, view, buffer);
+        if (!os.flush())
+            throw std::runtime_error("Could not write " + path + "!");
+    }
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    void saveBinary(const std::string& path, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m, size_t alignment = LIMNO_CACHE_LINE)
+    {
+        saveBinary(path, m.view(), alignment);
+    }
+
+    //Reads the header of a binary matrix file without reading its data
+    inline binary_header readBinaryHeader(const std::string& path)
+    {
+        std::ifstream is{path, std::ios::binary};
+        std::byte bytes[_binaryHeaderSize];
+        if (!is || !is.read(reinterpret_cast<char*>(bytes), _binaryHeaderSize))
+            throw std::runtime_error("Could not read " + path + "!");
+        return _decodeBinaryHeader(bytes, static_cast<size_t>(-1));
+    }
+
+    template<typename _Tp>
+    using mapped_binary = mapped_matrix<_Tp, binary_header>;
+
+    //Maps a binary matrix file without reading it. Throws
+    //std::invalid_argument if the file would need converting, i.e. its dtype
+    //or byte order differ from _Tp on this machine
+    template<typename _Tp>
+    mapped_binary<_Tp> mapBinary(const std::string& path)
+    {
+        auto file = std::make_shared<const mapped_file>(path);
+        const binary_header header = _decodeBinaryHeader(file->data(), file->size());
+        if (header.type != _dtypeOf<_Tp>() || header.littleEndian != _nativeLittleEndian())
+            throw std::invalid_argument("File can not be mapped without conversion, use loadBinary!");
+        const _Tp* data = _mappedElements<_Tp>(file->data() + header.dataOffset);
+        const LimnoMatrixView<const _Tp> view{data, header.numRows, header.numCols, header.rowStride, header.colStride};
+        return mapped_binary<_Tp>{std::move(file), header, view};
+    }
+
+    //Loads a binary matrix into memory, converting the element type and byte
+    //order if they differ
+    template<typename _Tp>
+    LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> loadBinary(const std::string& path)
+    {
+        const mapped_file file{path};
+        const binary_header header = _decodeBinaryHeader(file.data(), file.size());
+        const size_t elementSize = dtypeSize(header.type);
+        const std::byte* data = file.data() + header.dataOffset;
+
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> result(Limno::uninitialized, header.numRows, header.numCols);
+        if (header.isDenseRowMajor() && !decltype(result)::isPadded)
+        {
+            _readElements(data, header.type, header.littleEndian, result.data(), result.size());
+            return result;
+        }
+        for(size_t r = 0; r < header.numRows; ++r)
+        {
+            const std::byte* row = data + r*static_cast<size_t>(header.rowStride)*elementSize;
+            if (header.colStride == 1)
+                _readElements(row, header.type, header.littleEndian, &result(r, 0), header.numCols);
+            else
+            {
+                for(size_t c = 0; c < header.numCols; ++c)
+                    _readElements(row + c*static_cast<size_t>(header.colStride)*elementSize, header.type,
+                        header.littleEndian, &result(r, c), 1);
+            }
+        }
+        return result;
+    }
+
+    //Appends rows to a binary matrix file one chunk at a time, so matrices
+    //larger than memory can be written. The row count is filled in by close()
+    template<typename _Tp>
+    class binary_writer
+    {
+        public:
+        using size_type = size_t;
+
+        binary_writer(const std::string& path, size_type numCols, size_t alignment = LIMNO_CACHE_LINE)
+            : _os{path, std::ios::binary | std::ios::trunc}, _path{path}, _header{_denseBinaryHeader<_Tp>(0, numCols, alignment)}
+        {
+            if (!_os)
+                throw std::runtime_error("Could not open " + path + "!");
+            _writeBinaryHeader(_os, _header);
+        }
+
+        binary_writer(const binary_writer&) = delete;
+        binary_writer& operator=(const binary_writer&) = delete;
+
+        //Closes the file if close() wasn't called; errors are lost
+        ~binary_writer()
+        {
+            try
+            {
+                close();
+            }
+            catch(...)
+            {
+
+            }
+        }
+
+        //Appends the rows of a matrix or view with numCols() columns
+        template<typename _UTp>
+        void write(const LimnoMatrixView<_UTp>& rows)
+        {
+            static_assert(std::is_same_v<std::remove_cv_t<_UTp>, _Tp>, "Element types do not match!");
+            if (!_os.is_open())
+                throw std::logic_error("Writer is closed!");
+            if (rows.numCols() != _header.numCols)
+                throw std::invalid_argument("Matrix dimensions do not match!");
+            _writeBinaryRows(_os, rows, _buffer);
+            if (!_os)
+                throw std::runtime_error("Could not write " + _path + "!");
+            _header.numRows += rows.numRows();
+        }
+
+        template<int _Nrows, int _Ncols, typename _AllocTp>
+        void write(const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& rows)
+        {
+            write(rows.view());
+        }
+
+        size_type rowsWritten() const noexcept
+        {
+            return _header.numRows;
+        }
+
+        size_type numCols() const noexcept
+        {
+            return _header.numCols;
+        }
+
+        //Writes the final row count and closes the file
+        void close()
+        {
+            if (!_os.is_open())
+                return;
+            std::byte rows[8];
+            _storeLittle<std::uint64_t>(rows, _header.numRows);
+            _os.seekp(16);
+            _os.write(reinterpret_cast<const char*>(rows), sizeof(rows));
+            const bool ok = static_cast<bool>(_os.flush());
+            _os.close();
+            if (!ok)
+                throw std::runtime_error("Could not write " + _path + "!");
+        }
+        private:
+        std::ofstream _os;
+        std::string _path;
+        binary_header _header;
+        std::vector<_Tp> _buffer;
+    };
+
+    //Reads a dense row-major binary matrix a chunk of rows at a time,
+    //converting the element type and byte order if needed
+    template<typename _Tp>
+    class binary_reader
+    {
+        public:
+        using size_type = size_t;
+
+        explicit binary_reader(const std::string& path)
+            : _is{path, std::ios::binary}, _path{path}, _header{}, _rowsRead{0}
+        {
+            std::byte bytes[_binaryHeaderSize];
+            if (!_is || !_is.read(reinterpret_cast<char*>(bytes), _binaryHeaderSize))
+                throw std::runtime_error("Could not read " + path + "!");
+            _header = _decodeBinaryHeader(bytes, static_cast<size_t>(-1));
+            if (!_header.isDenseRowMajor())
+                throw std::invalid_argument("Streaming requires a dense row-major file, use loadBinary!");
+            _is.seekg(static_cast<std::streamoff>(_header.dataOffset));
+        }
+
+        const binary_header& header() const noexcept
+        {
+            return _header;
+        }
+
+        size_type numRows() const noexcept
+        {
+            return _header.numRows;
+        }
+
+        size_type numCols() const noexcept
+        {
+            return _header.numCols;
+        }
+
+        size_type rowsRemaining() const noexcept
+        {
+            return _header.numRows - _rowsRead;
+        }
+
+        //Reads the next rows into out, at most out.numRows() of them, and
+        //returns how many were read
+        size_type read(const LimnoMatrixView<_Tp>& out)
+        {
+            if (out.numCols() != _header.numCols)
+                throw std::invalid_argument("Matrix dimensions do not match!");
+            const size_type count = std::min(out.numRows(), rowsRemaining());
+            const size_t rowBytes = _header.numCols*dtypeSize(_header.type);
+            const bool direct = _header.type == _dtypeOf<_Tp>() && _header.littleEndian == _nativeLittleEndian();
+
+            if (direct && out.isContiguous())
+                _readBytes(reinterpret_cast<char*>(out.data()), count*rowBytes);
+            else
+            {
+                _bytes.resize(count*rowBytes);
+                _readBytes(reinterpret_cast<char*>(_bytes.data()), _bytes.size());
+                for(size_type r = 0; r < count; ++r)
+                {
+                    const std::byte* row = _bytes.data() + r*rowBytes;
+                    if (out.colStride() == 1)
+                        _readElements(row, _header.type, _header.littleEndian, &out(r, 0), _header.numCols);
+                    else
+                    {
+                        for(size_type c = 0; c < _header.numCols; ++c)
+                            _readElements(row + c*dtypeSize(_header.type), _header.type, _header.littleEndian, &out(r, c), 1);
+                    }
+                }
+            }
+            _rowsRead += count;
+            return count;
+        }
+
+        template<int _Nrows, int _Ncols, typename _AllocTp>
+        size_type read(LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& out)
+        {
+            return read(out.view());
+        }
+        private:
+        void _readBytes(char* out, size_t bytes)
+        {
+            if (!_is.read(out, static_cast<std::streamsize>(bytes)))
+                throw std::runtime_error("Could not read " + _path + "!");
+        }
+
+        std::ifstream _is;
+        std::string _path;
+        binary_header _header;
+        size_type _rowsRead;
+        std::vector<std::byte> _bytes;
+    };
+}
+
+#endif
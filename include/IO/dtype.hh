@@ -0,0 +1,130 @@
+#ifndef DTYPE_HH
+#define DTYPE_HH 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "config.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Element types that can be stored in matrix files. The values are part
+    //of the binary format and must not change
+    enum class dtype : std::uint8_t
+    {
+        int8 = 1,
+        uint8 = 2,
+        int16 = 3,
+        uint16 = 4,
+        int32 = 5,
+        uint32 = 6,
+        int64 = 7,
+        uint64 = 8,
+        float32 = 9,
+        float64 = 10
+    };
+
+    //dtype of a C++ type; types without one can't be read or written
+    template<typename _Tp>
+    constexpr dtype _dtypeOf() noexcept
+    {
+        static_assert(std::is_arithmetic_v<_Tp> && !std::is_same_v<_Tp, bool> && !std::is_same_v<_Tp, long double>,
+            "Type has no file representation!");
+        if constexpr(std::is_floating_point_v<_Tp>)
+            return (sizeof(_Tp) == 4) ? dtype::float32 : dtype::float64;
+        else if constexpr(sizeof(_Tp) == 1)
+            return std::is_signed_v<_Tp> ? dtype::int8 : dtype::uint8;
+        else if constexpr(sizeof(_Tp) == 2)
+            return std::is_signed_v<_Tp> ? dtype::int16 : dtype::uint16;
+        else if constexpr(sizeof(_Tp) == 4)
+            return std::is_signed_v<_Tp> ? dtype::int32 : dtype::uint32;
+        else
+            return std::is_signed_v<_Tp> ? dtype::int64 : dtype::uint64;
+    }
+
+    //Size in bytes of one element, 0 if type isn't a valid dtype
+    constexpr size_t dtypeSize(dtype type) noexcept
+    {
+        switch(type)
+        {
+            case dtype::int8:
+            case dtype::uint8:
+                return 1;
+            case dtype::int16:
+            case dtype::uint16:
+                return 2;
+            case dtype::int32:
+            case dtype::uint32:
+            case dtype::float32:
+                return 4;
+            case dtype::int64:
+            case dtype::uint64:
+            case dtype::float64:
+                return 8;
+        }
+        return 0;
+    }
+
+    constexpr bool _nativeLittleEndian() noexcept
+    {
+        #if defined(__BYTE_ORDER__)
+        return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+        #else
+        return true;
+        #endif
+    }
+
+    inline void _byteSwap(std::byte* p, size_t size) noexcept
+    {
+        std::reverse(p, p + size);
+    }
+
+    //Reads n packed elements of type _SrcTp and converts them to _Tp
+    template<typename _SrcTp, typename _Tp>
+    void _convertElements(const std::byte* src, bool swap, _Tp* out, size_t n) noexcept
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            std::byte bytes[sizeof(_SrcTp)];
+            std::memcpy(bytes, src + i*sizeof(_SrcTp), sizeof(_SrcTp));
+            if (swap)
+                _byteSwap(bytes, sizeof(_SrcTp));
+            _SrcTp value;
+            std::memcpy(&value, bytes, sizeof(_SrcTp));
+            out[i] = static_cast<_Tp>(value);
+        }
+    }
+
+    //Converts n packed elements of the given dtype and byte order into _Tp.
+    //Matching types are copied in bulk
+    template<typename _Tp>
+    void _readElements(const std::byte* src, dtype type, bool littleEndian, _Tp* out, size_t n)
+    {
+        const bool swap = littleEndian != _nativeLittleEndian();
+        if (type == _dtypeOf<_Tp>() && !swap)
+        {
+            std::memcpy(out, src, n*sizeof(_Tp));
+            return;
+        }
+        switch(type)
+        {
+            case dtype::int8: _convertElements<std::int8_t>(src, swap, out, n); break;
+            case dtype::uint8: _convertElements<std::uint8_t>(src, swap, out, n); break;
+            case dtype::int16: _convertElements<std::int16_t>(src, swap, out, n); break;
+            case dtype::uint16: _convertElements<std::uint16_t>(src, swap, out, n); break;
+            case dtype::int32: _convertElements<std::int32_t>(src, swap, out, n); break;
+            case dtype::uint32: _convertElements<std::uint32_t>(src, swap, out, n); break;
+            case dtype::int64: _convertElements<std::int64_t>(src, swap, out, n); break;
+            case dtype::uint64: _convertElements<std::uint64_t>(src, swap, out, n); break;
+            case dtype::float32: _convertElements<float>(src, swap, out, n); break;
+            case dtype::float64: _convertElements<double>(src, swap, out, n); break;
+            default: throw std::invalid_argument("Unknown element type!");
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef MAPPED_FILE_HH
+#define MAPPED_FILE_HH 1
+
+#include <cstddef>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "config.hh"
+
+//Files are mapped with mmap on POSIX systems. Everywhere else they are read
+//into an aligned buffer, which keeps the interface but not the zero-copy
+#if defined(__unix__) || defined(__APPLE__)
+    #define LIMNO_HAS_MMAP 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #define LIMNO_HAS_MMAP 0
+#endif
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Read-only view of a whole file. The pages are mapped lazily, so opening
+    //even a very large file is cheap and only the parts that are touched are
+    //ever read from disk. Move-only; the mapping is released on destruction
+    class mapped_file
+    {
+        public:
+        mapped_file() noexcept
+            : _data{nullptr}, _size{0}
+        {
+
+        }
+
+        explicit mapped_file(const std::string& path)
+            : mapped_file()
+        {
+            #if LIMNO_HAS_MMAP
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("Could not open " + path + "!");
+            struct stat info;
+            if (::fstat(fd, &info) != 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("Could not read the size of " + path + "!");
+            }
+            _size = static_cast<size_t>(info.st_size);
+            if (_size != 0)
+            {
+                void* data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED)
+                {
+                    ::close(fd);
+                    throw std::runtime_error("Could not map " + path + "!");
+                }
+                _data = static_cast<const std::byte*>(data);
+            }
+            //The mapping keeps the file alive
+            ::close(fd);
+            #else
+            std::ifstream is{path, std::ios::binary | std::ios::ate};
+            if (!is)
+                throw std::runtime_error("Could not open " + path + "!");
+            _size = static_cast<size_t>(is.tellg());
+            if (_size != 0)
+            {
+                std::byte* data = static_cast<std::byte*>(::operator new(_size, std::align_val_t{LIMNO_CACHE_LINE}));
+                is.seekg(0);
+                if (!is.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(_size)))
+                {
+                    ::operator delete(data, std::align_val_t{LIMNO_CACHE_LINE});
+                    throw std::runtime_error("Could not read " + path + "!");
+                }
+                _data = data;
+            }
+            #endif
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept
+            : _data{std::exchange(other._data, nullptr)}, _size{std::exchange(other._size, 0)}
+        {
+
+        }
+
+        mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            if (this != &other)
+            {
+                _release();
+                _data = std::exchange(other._data, nullptr);
+                _size = std::exchange(other._size, 0);
+            }
+            return *this;
+        }
+
+        ~mapped_file()
+        {
+            _release();
+        }
+
+        //Start of the file; page aligned when mapped
+        const std::byte* data() const noexcept
+        {
+            return _data;
+        }
+
+        size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+        private:
+        void _release() noexcept
+        {
+            if (_data == nullptr)
+                return;
+            #if LIMNO_HAS_MMAP
+            ::munmap(const_cast<std::byte*>(_data), _size);
+            #else
+            ::operator delete(const_cast<std::byte*>(_data), std::align_val_t{LIMNO_CACHE_LINE});
+            #endif
+            _data = nullptr;
+        }
+
+        const std::byte* _data;
+        size_t _size;
+    };
+}
+
+#endif
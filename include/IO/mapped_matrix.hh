@@ -0,0 +1,77 @@
+#ifndef MAPPED_MATRIX_HH
+#define MAPPED_MATRIX_HH 1
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "config.hh"
+#include "Core/matrix_view.hh"
+#include "IO/mapped_file.hh"
+
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    //Matrix stored in a mapped file. view() points straight at the mapped
+    //pages, so opening costs the same regardless of the matrix size and rows
+    //are only read from disk once they are touched. Several matrices can share
+    //one mapping, e.g. the arrays of an archive
+    template<typename _Tp, typename _HeaderTp>
+    class mapped_matrix
+    {
+        public:
+        using value_type = _Tp;
+        using size_type = size_t;
+        using header_type = _HeaderTp;
+        using view_type = LimnoMatrixView<const _Tp>;
+
+        mapped_matrix() noexcept = default;
+
+        mapped_matrix(std::shared_ptr<const mapped_file> file, const header_type& header, const view_type& view) noexcept
+            : _file{std::move(file)}, _header{header}, _view{view}
+        {
+
+        }
+
+        const view_type& view() const noexcept
+        {
+            return _view;
+        }
+
+        const header_type& header() const noexcept
+        {
+            return _header;
+        }
+
+        size_type numRows() const noexcept
+        {
+            return _view.numRows();
+        }
+
+        size_type numCols() const noexcept
+        {
+            return _view.numCols();
+        }
+
+        const _Tp& operator()(size_type r, size_type c) const noexcept
+        {
+            return _view(r, c);
+        }
+        private:
+        std::shared_ptr<const mapped_file> _file;
+        header_type _header;
+        view_type _view;
+    };
+
+    //Checks elements of _Tp can be read in place at data
+    template<typename _Tp>
+    const _Tp* _mappedElements(const std::byte* data)
+    {
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(_Tp) != 0)
+            throw std::invalid_argument("Mapped data is misaligned!");
+        return reinterpret_cast<const _Tp*>(data);
+    }
+}
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef NPY_HH
+#define NPY_HH 1
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "config.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+#include "IO/binary_format.hh"
+#include "IO/dtype.hh"
+#include "IO/mapped_file.hh"
+#include "IO/mapped_matrix.hh"
+
+//NumPy .npy files: the magic "\x93NUMPY", a version, the length of the
+//header and the header itself, a Python dict literal such as
+//
+//  {'descr': '<f8', 'fortran_order': False, 'shape': (3, 4), }
+//
+//padded with spaces so the data starts on a 64 byte boundary. 0-d arrays load
+//as 1x1 matrices and 1-d arrays as column vectors
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    static constexpr char _npyMagic[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+    static constexpr size_t _npyAlignment = 64;
+
+    //Decoded header of a .npy file
+    struct npy_header
+    {
+        dtype type;
+        bool littleEndian;
+        bool fortranOrder;
+        size_t numRows;
+        size_t numCols;
+        size_t dataOffset;
+
+        size_t dataSize() const noexcept
+        {
+            return numRows*numCols*dtypeSize(type);
+        }
+    };
+
+    //Value of key in a header dict, up to the end of the header
+    inline std::string_view _npyValue(std::string_view dict, std::string_view key)
+    {
+        for(const char quote : {'\'', '"'})
+        {
+            const std::string quoted = quote + std::string{key} + quote;
+            const size_t at = dict.find(quoted);
+            if (at == std::string_view::npos)
+                continue;
+            size_t pos = dict.find(':', at + quoted.size());
+            if (pos == std::string_view::npos)
+                break;
+            pos = dict.find_first_not_of(" \t", pos + 1);
+            if (pos == std::string_view::npos)
+                break;
+            return dict.substr(pos);
+        }
+        throw std::invalid_argument("Missing " + std::string{key} + " in .npy header!");
+    }
+
+    inline dtype _npyParseDescr(std::string_view value, bool& littleEndian)
+    {
+        if (value.size() < 4 || (value[0] != '\'' && value[0] != '"'))
+            throw std::invalid_argument("Invalid descr in .npy header!");
+        const char order = value[1];
+        const char kind = value[2];
+        const size_t end = value.find(value[0], 1);
+        if (end == std::string_view::npos)
+            throw std::invalid_argument("Invalid descr in .npy header!");
+        const std::string_view bits = value.substr(3, end - 3);
+        if (order != '<' && order != '>' && order != '|' && order != '=')
+            throw std::invalid_argument("Invalid descr in .npy header!");
+        littleEndian = (order == '<') || (order != '>' && _nativeLittleEndian());
+
+        const size_t size = (bits.size() == 1) ? static_cast<size_t>(bits[0] - '0') : 0;
+        if (kind == 'f' && size == 4)
+            return dtype::float32;
+        if (kind == 'f' && size == 8)
+            return dtype::float64;
+        if (kind == 'i' || kind == 'u')
+        {
+            const bool isSigned = kind == 'i';
+            switch(size)
+            {
+                case 1: return isSigned ? dtype::int8 : dtype::uint8;
+                case 2: return isSigned ? dtype::int16 : dtype::uint16;
+                case 4: return isSigned ? dtype::int32 : dtype::uint32;
+                case 8: return isSigned ? dtype::int64 : dtype::uint64;
+            }
+        }
+        throw std::invalid_argument("Unsupported .npy element type " + std::string{value.substr(0, end + 1)} + "!");
+    }
+
+    inline void _npyParseShape(std::string_view value, size_t& numRows, size_t& numCols)
+    {
+        if (value.empty() || value[0] != '(')
+            throw std::invalid_argument("Invalid shape in .npy header!");
+        std::vector<size_t> dims;
+        size_t pos = 1;
+        while(true)
+        {
+            pos = value.find_first_not_of(" ,", pos);
+            if (pos == std::string_view::npos)
+                throw std::invalid_argument("Invalid shape in .npy header!");
+            if (value[pos] == ')')
+                break;
+            if (value[pos] < '0' || value[pos] > '9')
+                throw std::invalid_argument("Invalid shape in .npy header!");
+            size_t dim = 0;
+            for(; pos < value.size() && value[pos] >= '0' && value[pos] <= '9'; ++pos)
+            {
+                const size_t digit = static_cast<size_t>(value[pos] - '0');
+                if (dim > (std::numeric_limits<size_t>::max() - digit)/10)
+                    throw std::invalid_argument("Invalid shape in .npy header!");
+                dim = dim*10 + digit;
+            }
+            dims.push_back(dim);
+        }
+        if (dims.size() > 2)
+            throw std::invalid_argument("Only 1 and 2 dimensional arrays can be loaded as matrices!");
+        numRows = dims.empty() ? 1 : dims[0];
+        numCols = (dims.size() == 2) ? dims[1] : 1;
+    }
+
+    //Throws std::invalid_argument if the bytes aren't a supported .npy file
+    //or size is too small for the data it describes
+    inline npy_header _decodeNpyHeader(const std::byte* p, size_t size)
+    {
+        if (size < 10 || std::memcmp(p, _npyMagic, sizeof(_npyMagic)) != 0)
+            throw std::invalid_argument("Not a .npy file!");
+        const auto major = static_cast<unsigned>(p[6]);
+        size_t dictOffset, dictSize;
+        if (major == 1)
+        {
+            dictOffset = 10;
+            dictSize = _loadLittle<std::uint16_t>(p + 8);
+        }
+        else if ((major == 2 || major == 3) && size >= 12)
+        {
+            dictOffset = 12;
+            dictSize = _loadLittle<std::uint32_t>(p + 8);
+        }
+        else
+            throw std::invalid_argument("Unsupported .npy version!");
+        if (size - dictOffset < dictSize)
+            throw std::invalid_argument(".npy file is truncated!");
+
+        const std::string_view dict{reinterpret_cast<const char*>(p + dictOffset), dictSize};
+        npy_header header;
+        header.type = _npyParseDescr(_npyValue(dict, "descr"), header.littleEndian);
+        const std::string_view fortran = _npyValue(dict, "fortran_order");
+        if (fortran.substr(0, 4) == "True")
+            header.fortranOrder = true;
+        else if (fortran.substr(0, 5) == "False")
+            header.fortranOrder = false;
+        else
+            throw std::invalid_argument("Invalid fortran_order in .npy header!");
+        _npyParseShape(_npyValue(dict, "shape"), header.numRows, header.numCols);
+        header.dataOffset = dictOffset + dictSize;
+        //Checked by division so a crafted shape can't wrap around
+        const size_t available = (size - header.dataOffset)/dtypeSize(header.type);
+        if (header.numCols != 0 && header.numRows > available/header.numCols)
+            throw std::invalid_argument(".npy file is truncated!");
+        return header;
+    }
+
+    //Preamble and header of a .npy file for numRows x numCols elements of _Tp
+    template<typename _Tp>
+    std::string _encodeNpyHeader(size_t numRows, size_t numCols, bool fortranOrder)
+    {
+        static constexpr char kinds[] = {'i', 'u', 'i', 'u', 'i', 'u', 'i', 'u', 'f', 'f'};
+        const dtype type = _dtypeOf<_Tp>();
+        const char order = (sizeof(_Tp) == 1) ? '|' : (_nativeLittleEndian() ? '<' : '>');
+        std::string dict = std::string{"{'descr': '"} + order + kinds[static_cast<size_t>(type) - 1] + std::to_string(sizeof(_Tp)) +
+            "', 'fortran_order': " + (fortranOrder ? "True" : "False") +
+            ", 'shape': (" + std::to_string(numRows) + ", " + std::to_string(numCols) + "), }";
+
+        //Version 1 stores the header length in 16 bits, version 2 in 32
+        const bool wide = dict.size() + 11 + _npyAlignment > 0xFFFF;
+        const size_t preamble = wide ? 12 : 10;
+        const size_t total = (preamble + dict.size() + 1 + _npyAlignment - 1)/_npyAlignment*_npyAlignment;
+        dict.append(total - preamble - dict.size() - 1, ' ');
+        dict.push_back('\n');
+
+        std::string bytes(preamble, '\0');
+        std::memcpy(bytes.data(), _npyMagic, sizeof(_npyMagic));
+        bytes[6] = wide ? 2 : 1;
+        if (wide)
+            _storeLittle<std::uint32_t>(reinterpret_cast<std::byte*>(bytes.data() + 8), static_cast<std::uint32_t>(dict.size()));
+        else
+            _storeLittle<std::uint16_t>(reinterpret_cast<std::byte*>(bytes.data() + 8), static_cast<std::uint16_t>(dict.size()));
+        return bytes + dict;
+    }
+
+    //Column-major views are written in Fortran order as they are, everything
+    //else is written row by row in C order. Returns the view to write out
+    template<typename _Tp>
+    LimnoMatrixView<_Tp> _npyLayout(const LimnoMatrixView<_Tp>& view, bool& fortranOrder) noexcept
+    {
+        fortranOrder = !view.isContiguous() && view.transpose().isContiguous();
+        return fortranOrder ? view.transpose() : view;
+    }
+
+    template<typename _Tp>
+    LimnoMatrixView<const _Tp> _npyView(const npy_header& header, const _Tp* data) noexcept
+    {
+        if (header.fortranOrder)
+            return LimnoMatrixView<const _Tp>{data, header.numRows, header.numCols, 1, static_cast<std::ptrdiff_t>(header.numRows)};
+        return LimnoMatrixView<const _Tp>{data, header.numRows, header.numCols};
+    }
+
+    //Copies the elements of a .npy file into a matrix, converting the
+    //element type and byte order if they differ
+    template<typename _Tp>
+    LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> _loadNpy(const npy_header& header, const std::byte* data)
+    {
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> result(Limno::uninitialized, header.numRows, header.numCols);
+        if (!header.fortranOrder && !decltype(result)::isPadded)
+        {
+            _readElements(data, header.type, header.littleEndian, result.data(), result.size());
+            return result;
+        }
+        if (!header.fortranOrder)
+        {
+            for(size_t r = 0; r < header.numRows; ++r)
+                _readElements(data + r*header.numCols*dtypeSize(header.type), header.type, header.littleEndian, &result(r, 0), header.numCols);
+            return result;
+        }
+        //Fortran order, convert a column at a time and scatter it
+        std::vector<_Tp> column(header.numRows);
+        for(size_t c = 0; c < header.numCols; ++c)
+        {
+            _readElements(data + c*header.numRows*dtypeSize(header.type), header.type, header.littleEndian, column.data(), header.numRows);
+            for(size_t r = 0; r < header.numRows; ++r)
+                result(r, c) = column[r];
+        }
+        return result;
+    }
+
+    template<typename _Tp>
+    using mapped_npy = mapped_matrix<_Tp, npy_header>;
+
+    //Maps the array of a .npy file at data inside file without copying it
+    template<typename _Tp>
+    mapped_npy<_Tp> _mapNpy(std::shared_ptr<const mapped_file> file, const npy_header& header, const std::byte* data)
+    {
+        if (header.type != _dtypeOf<_Tp>() || (sizeof(_Tp) > 1 && header.littleEndian != _nativeLittleEndian()))
+            throw std::invalid_argument("File can not be mapped without conversion, use loadNpy!");
+        const LimnoMatrixView<const _Tp> view = _npyView(header, _mappedElements<_Tp>(data));
+        return mapped_npy<_Tp>{std::move(file), header, view};
+    }
+
+    //Saves a matrix or view as a .npy file
+    template<typename _Tp>
+    void saveNpy(const std::string& path, const LimnoMatrixView<_Tp>& view)
+    {
+        using value_type = std::remove_cv_t<_Tp>;
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        if (!os)
+            throw std::runtime_error("Could not open " + path + "!");
+        bool fortranOrder;
+        const LimnoMatrixView<_Tp> rows = _npyLayout(view, fortranOrder);
+        const std::string header = _encodeNpyHeader<value_type>(view.numRows(), view.numCols(), fortranOrder);
+        os.write(header.data(), static_cast<std::streamsize>(header.size()));
+        std::vector<value_type> buffer;
+        _writeBinaryRows(os, rows, buffer);
+        if (!os.flush())
+            throw std::runtime_error("Could not write " + path + "!");
+    }
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    void saveNpy(const std::string& path, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+    {
+        saveNpy(path, m.view());
+    }
+
+    template<typename _Tp>
+    LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> loadNpy(const std::string& path)
+    {
+        const mapped_file file{path};
+        const npy_header header = _decodeNpyHeader(file.data(), file.size());
+        return _loadNpy<_Tp>(header, file.data() + header.dataOffset);
+    }
+
+    //Maps a .npy file without reading it. C order arrays map to row-major
+    //views and Fortran order arrays to column-major views. Throws
+    //std::invalid_argument if the dtype or byte order differ from _Tp
+    template<typename _Tp>
+    mapped_npy<_Tp> mapNpy(const std::string& path)
+    {
+        auto file = std::make_shared<const mapped_file>(path);
+        const npy_header header = _decodeNpyHeader(file->data(), file->size());
+        const std::byte* data = file->data() + header.dataOffset;
+        return _mapNpy<_Tp>(std::move(file), header, data);
+    }
+}
+
+#endif
@@ -0,0 +1,416 @@
+#ifndef NPZ_HH
+#define NPZ_HH 1
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "config.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+#include "IO/mapped_file.hh"
+#include "IO/npy.hh"
+
+//NumPy .npz archives: a zip file with one .npy file per array. Only stored
+//(uncompressed) entries are supported, which is what numpy.savez writes, so
+//arrays can be read and mapped in place
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    static constexpr std::uint32_t _zipLocalSignature = 0x04034b50;
+    static constexpr std::uint32_t _zipCentralSignature = 0x02014b50;
+    static constexpr std::uint32_t _zipEndSignature = 0x06054b50;
+    static constexpr std::uint32_t _zip64EndSignature = 0x06064b50;
+    static constexpr std::uint32_t _zip64LocatorSignature = 0x07064b50;
+    static constexpr std::uint32_t _zipMax32 = 0xFFFFFFFF;
+    //DOS date of 1980-01-01, the earliest a zip file can hold
+    static constexpr std::uint16_t _zipDate = 0x21;
+
+    constexpr std::array<std::uint32_t, 256> _crc32Table() noexcept
+    {
+        std::array<std::uint32_t, 256> table{};
+        for(std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t crc = i;
+            for(int k = 0; k < 8; ++k)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    //Continues the CRC-32 crc over n more bytes; start from 0
+    inline std::uint32_t _crc32(std::uint32_t crc, const char* p, size_t n) noexcept
+    {
+        static constexpr std::array<std::uint32_t, 256> table = _crc32Table();
+        crc = ~crc;
+        for(size_t i = 0; i < n; ++i)
+            crc = table[(crc ^ static_cast<std::uint8_t>(p[i])) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    //Archive entry, name has the .npy extension removed
+    struct _NpzEntry
+    {
+        std::string name;
+        std::uint16_t method;
+        size_t offset;
+        size_t size;
+    };
+
+    //Read-only .npz archive. The file is mapped once and arrays mapped from
+    //it share the mapping
+    class npz_archive
+    {
+        public:
+        explicit npz_archive(const std::string& path)
+            : _file{std::make_shared<const mapped_file>(path)}, _entries{}
+        {
+            _readDirectory();
+        }
+
+        std::vector<std::string> names() const
+        {
+            std::vector<std::string> result;
+            result.reserve(_entries.size());
+            for(const _NpzEntry& entry : _entries)
+                result.push_back(entry.name);
+            return result;
+        }
+
+        size_t size() const noexcept
+        {
+            return _entries.size();
+        }
+
+        bool contains(const std::string& name) const noexcept
+        {
+            for(const _NpzEntry& entry : _entries)
+            {
+                if (entry.name == name)
+                    return true;
+            }
+            return false;
+        }
+
+        npy_header header(const std::string& name) const
+        {
+            return _decodeNpyHeader(_entryData(name), _entry(name).size);
+        }
+
+        //Copies an array, converting its element type and byte order if needed
+        template<typename _Tp>
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> load(const std::string& name) const
+        {
+            const std::byte* data = _entryData(name);
+            const npy_header header = _decodeNpyHeader(data, _entry(name).size);
+            return _loadNpy<_Tp>(header, data + header.dataOffset);
+        }
+
+        //Maps an array in place. Throws std::invalid_argument if it needs
+        //converting or is misaligned in the archive
+        template<typename _Tp>
+        mapped_npy<_Tp> map(const std::string& name) const
+        {
+            const std::byte* data = _entryData(name);
+            const npy_header header = _decodeNpyHeader(data, _entry(name).size);
+            return _mapNpy<_Tp>(_file, header, data + header.dataOffset);
+        }
+        private:
+        const std::byte* _at(size_t offset, size_t size) const
+        {
+            if (offset > _file->size() || _file->size() - offset < size)
+                throw std::invalid_argument("Corrupt .npz archive!");
+            return _file->data() + offset;
+        }
+
+        const _NpzEntry& _entry(const std::string& name) const
+        {
+            for(const _NpzEntry& entry : _entries)
+            {
+                if (entry.name == name)
+                    return entry;
+            }
+            throw std::out_of_range("No array named " + name + " in archive!");
+        }
+
+        const std::byte* _entryData(const std::string& name) const
+        {
+            const _NpzEntry& entry = _entry(name);
+            if (entry.method != 0)
+                throw std::invalid_argument("Compressed .npz archives are not supported!");
+            return _at(entry.offset, entry.size);
+        }
+
+        void _readDirectory()
+        {
+            //The end record is last, followed only by a comment of up to 64k
+            const size_t size = _file->size();
+            if (size < 22)
+                throw std::invalid_argument("Not a .npz archive!");
+            size_t end = size - 22;
+            const size_t stop = (end > 0xFFFF) ? end - 0xFFFF : 0;
+            while(_loadLittle<std::uint32_t>(_file->data() + end) != _zipEndSignature)
+            {
+                if (end == stop)
+                    throw std::invalid_argument("Not a .npz archive!");
+                --end;
+            }
+            const std::byte* record = _file->data() + end;
+            size_t count = _loadLittle<std::uint16_t>(record + 10);
+            size_t offset = _loadLittle<std::uint32_t>(record + 16);
+            if ((offset == _zipMax32 || count == 0xFFFF) && end >= 20 && _loadLittle<std::uint32_t>(record - 20) == _zip64LocatorSignature)
+            {
+                const std::byte* zip64 = _at(_loadLittle<std::uint64_t>(record - 12), 56);
+                if (_loadLittle<std::uint32_t>(zip64) != _zip64EndSignature)
+                    throw std::invalid_argument("Corrupt .npz archive!");
+                count = _loadLittle<std::uint64_t>(zip64 + 32);
+                offset = _loadLittle<std::uint64_t>(zip64 + 48);
+            }
+
+            _entries.reserve(count);
+            for(size_t i = 0; i < count; ++i)
+            {
+                const std::byte* p = _at(offset, 46);
+                if (_loadLittle<std::uint32_t>(p) != _zipCentralSignature)
+                    throw std::invalid_argument("Corrupt .npz archive!");
+                const size_t nameSize = _loadLittle<std::uint16_t>(p + 28);
+                const size_t extraSize = _loadLittle<std::uint16_t>(p + 30);
+                const size_t commentSize = _loadLittle<std::uint16_t>(p + 32);
+                _at(offset + 46, nameSize + extraSize);
+
+                _NpzEntry entry;
+                entry.method = _loadLittle<std::uint16_t>(p + 10);
+                entry.size = _loadLittle<std::uint32_t>(p + 20);
+                size_t local = _loadLittle<std::uint32_t>(p + 42);
+                _readZip64Extra(p + 46 + nameSize, extraSize, p, entry.size, local);
+
+                entry.name.assign(reinterpret_cast<const char*>(p + 46), nameSize);
+                if (entry.name.size() > 4 && entry.name.compare(entry.name.size() - 4, 4, ".npy") == 0)
+                    entry.name.resize(entry.name.size() - 4);
+
+                //The local header repeats the name and has its own extra field
+                const std::byte* header = _at(local, 30);
+                if (_loadLittle<std::uint32_t>(header) != _zipLocalSignature)
+                    throw std::invalid_argument("Corrupt .npz archive!");
+                entry.offset = local + 30 + _loadLittle<std::uint16_t>(header + 26) + _loadLittle<std::uint16_t>(header + 28);
+                _entries.push_back(std::move(entry));
+                offset += 46 + nameSize + extraSize + commentSize;
+            }
+        }
+
+        //Sizes and offsets that don't fit in 32 bits are in the zip64 extra
+        //field, in order, but only those that overflowed
+        static void _readZip64Extra(const std::byte* extra, size_t extraSize, const std::byte* central, size_t& size, size_t& local)
+        {
+            for(size_t pos = 0; pos + 4 <= extraSize;)
+            {
+                const std::uint16_t id = _loadLittle<std::uint16_t>(extra + pos);
+                const size_t fieldSize = _loadLittle<std::uint16_t>(extra + pos + 2);
+                if (id == 1)
+                {
+                    size_t field = pos + 4;
+                    const size_t fieldEnd = std::min(field + fieldSize, extraSize);
+                    auto next = [&](size_t& value)
+                    {
+                        if (value == _zipMax32 && field + 8 <= fieldEnd)
+                        {
+                            value = _loadLittle<std::uint64_t>(extra + field);
+                            field += 8;
+                        }
+                    };
+                    size_t uncompressed = _loadLittle<std::uint32_t>(central + 24);
+                    next(uncompressed);
+                    next(size);
+                    next(local);
+                    return;
+                }
+                pos += 4 + fieldSize;
+            }
+        }
+
+        std::shared_ptr<const mapped_file> _file;
+        std::vector<_NpzEntry> _entries;
+    };
+
+    //Writes an uncompressed .npz archive one array at a time. Arrays are
+    //padded to start on a cache line so they can be mapped once read back.
+    //The directory is written by close()
+    class npz_writer
+    {
+        public:
+        explicit npz_writer(const std::string& path)
+            : _os{path, std::ios::binary | std::ios::trunc}, _path{path}, _central{}, _count{0}
+        {
+            if (!_os)
+                throw std::runtime_error("Could not open " + path + "!");
+        }
+
+        npz_writer(const npz_writer&) = delete;
+        npz_writer& operator=(const npz_writer&) = delete;
+
+        //Closes the archive if close() wasn't called; errors are lost
+        ~npz_writer()
+        {
+            try
+            {
+                close();
+            }
+            catch(...)
+            {
+
+            }
+        }
+
+        //Adds an array; name is given the .npy extension numpy expects
+        template<typename _Tp>
+        void add(const std::string& name, const LimnoMatrixView<_Tp>& view)
+        {
+            using value_type = std::remove_cv_t<_Tp>;
+            if (!_os.is_open())
+                throw std::logic_error("Writer is closed!");
+            bool fortranOrder;
+            const LimnoMatrixView<_Tp> rows = _npyLayout(view, fortranOrder);
+            const std::string npyHeader = _encodeNpyHeader<value_type>(view.numRows(), view.numCols(), fortranOrder);
+            const size_t size = npyHeader.size() + view.numRows()*view.numCols()*sizeof(value_type);
+            const std::string fileName = name + ".npy";
+            const size_t local = static_cast<size_t>(_os.tellp());
+            if (size >= _zipMax32 || local >= _zipMax32 || fileName.size() > 0xFFFF)
+                throw std::invalid_argument("Array is too large for a .npz archive!");
+
+            //Padding the extra field aligns the data and, as the .npy header
+            //is a multiple of 64 bytes, the array after it
+            const size_t unpadded = local + 30 + fileName.size();
+            const size_t extraSize = (unpadded + 4 + LIMNO_CACHE_LINE - 1)/LIMNO_CACHE_LINE*LIMNO_CACHE_LINE - unpadded;
+            std::string header(30, '\0');
+            _storeLittle<std::uint32_t>(_bytes(header.data()), _zipLocalSignature);
+            _fillZipFields(header.data() + 4, 0, size, fileName.size());
+            _storeLittle<std::uint16_t>(_bytes(header.data() + 28), static_cast<std::uint16_t>(extraSize));
+            std::string extra(extraSize, '\0');
+            _storeLittle<std::uint16_t>(_bytes(extra.data()), 0xA11E);
+            _storeLittle<std::uint16_t>(_bytes(extra.data() + 2), static_cast<std::uint16_t>(extraSize - 4));
+            _os << header << fileName << extra;
+
+            std::uint32_t crc = _crc32(0, npyHeader.data(), npyHeader.size());
+            _os.write(npyHeader.data(), static_cast<std::streamsize>(npyHeader.size()));
+            std::vector<value_type> buffer;
+            _forEachDenseChunk(rows, buffer, [&](const char* bytes, size_t n)
+                {
+                    crc = _crc32(crc, bytes, n);
+                    _os.write(bytes, static_cast<std::streamsize>(n));
+                });
+            const auto end = _os.tellp();
+            _os.seekp(static_cast<std::streamoff>(local + 14));
+            char crcBytes[4];
+            _storeLittle<std::uint32_t>(_bytes(crcBytes), crc);
+            _os.write(crcBytes, sizeof(crcBytes));
+            _os.seekp(end);
+            if (!_os)
+                throw std::runtime_error("Could not write " + _path + "!");
+
+            std::string central(46, '\0');
+            _storeLittle<std::uint32_t>(_bytes(central.data()), _zipCentralSignature);
+            _storeLittle<std::uint16_t>(_bytes(central.data() + 4), 20);
+            _fillZipFields(central.data() + 6, crc, size, fileName.size());
+            _storeLittle<std::uint32_t>(_bytes(central.data() + 42), static_cast<std::uint32_t>(local));
+            _central += central + fileName;
+            ++_count;
+        }
+
+        template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+        void add(const std::string& name, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m)
+        {
+            add(name, m.view());
+        }
+
+        //Writes the directory and closes the file
+        void close()
+        {
+            if (!_os.is_open())
+                return;
+            const size_t offset = static_cast<size_t>(_os.tellp());
+            //Counts and offsets that don't fit the end record are saturated
+            //there and given in full by a zip64 end record and its locator
+            std::string zip64;
+            if (_count >= 0xFFFF || offset >= _zipMax32 || _central.size() >= _zipMax32)
+            {
+                zip64.assign(76, '\0');
+                _storeLittle<std::uint32_t>(_bytes(zip64.data()), _zip64EndSignature);
+                _storeLittle<std::uint64_t>(_bytes(zip64.data() + 4), 44);
+                _storeLittle<std::uint16_t>(_bytes(zip64.data() + 12), 45);
+                _storeLittle<std::uint16_t>(_bytes(zip64.data() + 14), 45);
+                _storeLittle<std::uint64_t>(_bytes(zip64.data() + 24), _count);
+                _storeLittle<std::uint64_t>(_bytes(zip64.data() + 32), _count);
+                _storeLittle<std::uint64_t>(_bytes(zip64.data() + 40), _central.size());
+                _storeLittle<std::uint64_t>(_bytes(zip64.data() + 48), offset);
+                _storeLittle<std::uint32_t>(_bytes(zip64.data() + 56), _zip64LocatorSignature);
+                _storeLittle<std::uint64_t>(_bytes(zip64.data() + 64), offset + _central.size());
+                _storeLittle<std::uint32_t>(_bytes(zip64.data() + 72), 1);
+            }
+            std::string end(22, '\0');
+            _storeLittle<std::uint32_t>(_bytes(end.data()), _zipEndSignature);
+            _storeLittle<std::uint16_t>(_bytes(end.data() + 8), static_cast<std::uint16_t>(std::min<size_t>(_count, 0xFFFF)));
+            _storeLittle<std::uint16_t>(_bytes(end.data() + 10), static_cast<std::uint16_t>(std::min<size_t>(_count, 0xFFFF)));
+            _storeLittle<std::uint32_t>(_bytes(end.data() + 12), static_cast<std::uint32_t>(std::min<size_t>(_central.size(), _zipMax32)));
+            _storeLittle<std::uint32_t>(_bytes(end.data() + 16), static_cast<std::uint32_t>(std::min<size_t>(offset, _zipMax32)));
+            _os << _central << zip64 << end;
+            const bool ok = static_cast<bool>(_os.flush());
+            _os.close();
+            if (!ok)
+                throw std::runtime_error("Could not write " + _path + "!");
+        }
+        private:
+        static std::byte* _bytes(char* p) noexcept
+        {
+            return reinterpret_cast<std::byte*>(p);
+        }
+
+        //Fields shared by the local and central headers, from the version
+        //needed to extract up to the name length. Method and flags are 0
+        static void _fillZipFields(char* p, std::uint32_t crc, size_t size, size_t nameSize) noexcept
+        {
+            _storeLittle<std::uint16_t>(_bytes(p), 20);
+            _storeLittle<std::uint16_t>(_bytes(p + 8), _zipDate);
+            _storeLittle<std::uint32_t>(_bytes(p + 10), crc);
+            _storeLittle<std::uint32_t>(_bytes(p + 14), static_cast<std::uint32_t>(size));
+            _storeLittle<std::uint32_t>(_bytes(p + 18), static_cast<std::uint32_t>(size));
+            _storeLittle<std::uint16_t>(_bytes(p + 22), static_cast<std::uint16_t>(nameSize));
+        }
+
+        std::ofstream _os;
+        std::string _path;
+        std::string _central;
+        size_t _count;
+    };
+
+    inline void _addNpz(npz_writer&)
+    {
+
+    }
+
+    template<typename _MatrixTp, typename... _ArgsTp>
+    void _addNpz(npz_writer& writer, const std::string& name, const _MatrixTp& m, const _ArgsTp&... args)
+    {
+        writer.add(name, m);
+        _addNpz(writer, args...);
+    }
+
+    //Saves matrices or views as a .npz archive, e.g.
+    //saveNpz("data.npz", "a", a, "b", b.view())
+    template<typename... _ArgsTp>
+    void saveNpz(const std::string& path, const _ArgsTp&... args)
+    {
+        static_assert(sizeof...(_ArgsTp) % 2 == 0, "Arrays must be given as name, matrix pairs!");
+        npz_writer writer{path};
+        _addNpz(writer, args...);
+        writer.close();
+    }
+}
+
+#endif
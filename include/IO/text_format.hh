@@ -0,0 +1,321 @@
+#ifndef TEXT_FORMAT_HH
+#define TEXT_FORMAT_HH 1
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "config.hh"
+#include "Core/construction.hh"
+#include "Core/execution.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_view.hh"
+
+//Text formatting and parsing of matrices with std::to_chars/std::from_chars.
+//Numbers are written in their shortest form that reads back exactly, so text
+//round trips lose no precision. Nothing here allocates except parseMatrix,
+//which allocates the matrix it returns
+namespace LIB_NAMESPACE_BASE::_detail
+{
+    enum class text_format
+    {
+        //{1, 2},\n{3, 4} as written by operator<<
+        braces,
+        //1,2\n3,4\n
+        csv
+    };
+
+    //Most characters to_chars writes for one value of _Tp
+    template<typename _Tp>
+    constexpr size_t _maxChars() noexcept
+    {
+        static_assert(std::is_arithmetic_v<_Tp> && !std::is_same_v<_Tp, bool>, "Type can not be formatted!");
+        if constexpr(std::is_floating_point_v<_Tp>)
+            //Sign, digits, point, e, exponent sign and up to 4 exponent digits
+            return std::numeric_limits<_Tp>::max_digits10 + 8;
+        else
+            return std::numeric_limits<_Tp>::digits10 + 2;
+    }
+
+    //Upper bound on the characters toChars writes for a numRows x numCols
+    //matrix of _Tp, for sizing the output buffer
+    template<typename _Tp>
+    constexpr size_t formattedSize(size_t numRows, size_t numCols, text_format format = text_format::braces) noexcept
+    {
+        const size_t separator = (format == text_format::braces) ? 2 : 1;
+        const size_t rowExtra = (format == text_format::braces) ? 4 : 1;
+        return numRows*(numCols*(_maxChars<std::remove_cv_t<_Tp>>() + separator) + rowExtra);
+    }
+
+    inline bool _putChars(char*& first, char* last, std::string_view s) noexcept
+    {
+        if (static_cast<size_t>(last - first) < s.size())
+            return false;
+        std::memcpy(first, s.data(), s.size());
+        first += s.size();
+        return true;
+    }
+
+    //Formats a matrix or view into [first, last). Like std::to_chars, returns
+    //the end of the output, or last and std::errc::value_too_large if the
+    //buffer is too small; formattedSize gives a size that always fits
+    template<typename _Tp>
+    std::to_chars_result toChars(char* first, char* last, const LimnoMatrixView<_Tp>& view,
+        text_format format = text_format::braces) noexcept
+    {
+        const bool braces = format == text_format::braces;
+        const std::string_view separator = braces ? ", " : ",";
+        for(size_t r = 0; r < view.numRows(); ++r)
+        {
+            if (braces && !_putChars(first, last, "{"))
+                return {last, std::errc::value_too_large};
+            for(size_t c = 0; c < view.numCols(); ++c)
+            {
+                if (c != 0 && !_putChars(first, last, separator))
+                    return {last, std::errc::value_too_large};
+                const std::to_chars_result result = std::to_chars(first, last, view(r, c));
+                if (result.ec != std::errc{})
+                    return {last, result.ec};
+                first = result.ptr;
+            }
+            const std::string_view end = braces ? ((r + 1 < view.numRows()) ? "},\n" : "}") : "\n";
+            if (!_putChars(first, last, end))
+                return {last, std::errc::value_too_large};
+        }
+        return {first, std::errc{}};
+    }
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    std::to_chars_result toChars(char* first, char* last, const LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& m,
+        text_format format = text_format::braces) noexcept
+    {
+        return toChars(first, last, m.view(), format);
+    }
+
+    //Formats a matrix or view into a new string
+    template<typename _MatrixTp>
+    std::string toString(const _MatrixTp& m, text_format format = text_format::braces)
+    {
+        using value_type = std::remove_cv_t<std::remove_reference_t<decltype(m(0, 0))>>;
+        std::string result(formattedSize<value_type>(m.numRows(), m.numCols(), format), '\0');
+        const std::to_chars_result end = toChars(result.data(), result.data() + result.size(), m, format);
+        result.resize(static_cast<size_t>(end.ptr - result.data()));
+        return result;
+    }
+
+    //Whitespace inside a row; rows of CSV are ended by newlines
+    inline const char* _skipBlank(const char* p, const char* last, text_format format) noexcept
+    {
+        for(; p != last; ++p)
+        {
+            const char c = *p;
+            if (c != ' ' && c != '\t' && c != '\r' && (c != '\n' || format == text_format::csv))
+                break;
+        }
+        return p;
+    }
+
+    inline const char* _skipSpace(const char* p, const char* last) noexcept
+    {
+        return _skipBlank(p, last, text_format::braces);
+    }
+
+    //Parses one row of numCols values into out[0], out[stride], ... Blank
+    //lines before a CSV row and the comma after a braces row are skipped.
+    //Returns the end of the row, or where parsing failed and why
+    template<typename _Tp>
+    std::from_chars_result _parseRow(const char* p, const char* last, _Tp* out, std::ptrdiff_t stride,
+        size_t numCols, text_format format) noexcept
+    {
+        const bool braces = format == text_format::braces;
+        if (braces)
+        {
+            p = _skipSpace(p, last);
+            if (p == last || *p != '{')
+                return {p, std::errc::invalid_argument};
+            ++p;
+        }
+        else
+        {
+            for(const char* q = _skipBlank(p, last, format); q != last && *q == '\n'; q = _skipBlank(p, last, format))
+                p = q + 1;
+        }
+
+        for(size_t c = 0; c < numCols; ++c)
+        {
+            p = _skipBlank(p, last, format);
+            if (c != 0)
+            {
+                if (p == last || *p != ',')
+                    return {p, std::errc::invalid_argument};
+                p = _skipBlank(p + 1, last, format);
+            }
+            //from_chars doesn't take a leading plus
+            if (p != last && *p == '+' && p + 1 != last && *(p + 1) != '-')
+                ++p;
+            const std::from_chars_result result = std::from_chars(p, last, out[static_cast<std::ptrdiff_t>(c)*stride]);
+            if (result.ec != std::errc{})
+                return result;
+            p = result.ptr;
+        }
+
+        p = _skipBlank(p, last, format);
+        if (braces)
+        {
+            if (p == last || *p != '}')
+                return {p, std::errc::invalid_argument};
+            p = _skipSpace(p + 1, last);
+            if (p != last && *p == ',')
+                ++p;
+        }
+        else if (p != last)
+        {
+            if (*p != '\n')
+                return {p, std::errc::invalid_argument};
+            ++p;
+        }
+        return {p, std::errc{}};
+    }
+
+    //Parses exactly out.numRows() rows of out.numCols() values into a matrix
+    //or view of the expected shape. Like std::from_chars, returns the end of
+    //the parsed text, or where parsing failed and why
+    template<typename _Tp>
+    std::from_chars_result fromChars(const char* first, const char* last, const LimnoMatrixView<_Tp>& out,
+        text_format format = text_format::braces) noexcept
+    {
+        for(size_t r = 0; r < out.numRows(); ++r)
+        {
+            const std::from_chars_result result = _parseRow(first, last, &out(r, 0), out.colStride(), out.numCols(), format);
+            if (result.ec != std::errc{})
+                return result;
+            first = result.ptr;
+        }
+        return {first, std::errc{}};
+    }
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    std::from_chars_result fromChars(const char* first, const char* last, LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>& out,
+        text_format format = text_format::braces) noexcept
+    {
+        return fromChars(first, last, out.view(), format);
+    }
+
+    //Start of every row: each '{', or each line that isn't blank
+    inline std::vector<const char*> _rowStarts(std::string_view text, text_format format)
+    {
+        std::vector<const char*> starts;
+        const char* p = text.data();
+        const char* last = p + text.size();
+        const char delimiter = (format == text_format::braces) ? '{' : '\n';
+        while(p != last)
+        {
+            const char* next = static_cast<const char*>(std::memchr(p, delimiter, static_cast<size_t>(last - p)));
+            if (format == text_format::braces)
+            {
+                if (next == nullptr)
+                    break;
+                starts.push_back(next);
+                p = next + 1;
+            }
+            else
+            {
+                const char* end = (next == nullptr) ? last : next;
+                if (_skipBlank(p, end, format) != end)
+                    starts.push_back(p);
+                p = (next == nullptr) ? last : next + 1;
+            }
+        }
+        return starts;
+    }
+
+    //Number of values in the row starting at row
+    inline size_t _countColumns(const char* row, const char* last, text_format format)
+    {
+        if (format == text_format::braces)
+            ++row;
+        const char close = (format == text_format::braces) ? '}' : '\n';
+        const char* end = std::find(row, last, close);
+        if (_skipBlank(row, end, format) == end)
+            return 0;
+        return static_cast<size_t>(std::count(row, end, ',')) + 1;
+    }
+
+    [[noreturn]] inline void _throwParseError(std::string_view text, const char* at)
+    {
+        throw std::invalid_argument("Malformed matrix text at offset " + std::to_string(at - text.data()) + "!");
+    }
+
+    //Parses rows [first, last) of text into result, given where every row starts
+    template<typename _Tp>
+    void _parseRows(std::string_view text, const std::vector<const char*>& starts, size_t first, size_t last,
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC>& result, text_format format)
+    {
+        const char* end = text.data() + text.size();
+        for(size_t r = first; r < last; ++r)
+        {
+            const char* rowEnd = (r + 1 < starts.size()) ? starts[r + 1] : end;
+            const std::from_chars_result row = _parseRow(starts[r], rowEnd, &result(r, 0), 1, result.numCols(), format);
+            if (row.ec != std::errc{})
+                _throwParseError(text, row.ptr);
+            const char* rest = _skipSpace(row.ptr, rowEnd);
+            if (rest != rowEnd)
+                _throwParseError(text, rest);
+        }
+    }
+
+    //Parses a whole matrix, working out its shape from the text. Under
+    //Limno::par the rows are split into chunks parsed on the thread pool.
+    //Throws std::invalid_argument if the text is malformed or the rows have
+    //different lengths
+    #if __cplusplus > 201703L
+    template<typename _Tp, typename _PolicyTp>
+        requires _isExecutionPolicy<_PolicyTp>
+    #else
+    template<typename _Tp, typename _PolicyTp,
+        std::enable_if_t<_isExecutionPolicy<_PolicyTp>, int> = 0>
+    #endif
+    LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> parseMatrix(_PolicyTp, std::string_view text, text_format format = text_format::braces)
+    {
+        const std::vector<const char*> starts = _rowStarts(text, format);
+        const char* end = text.data() + text.size();
+        if (starts.empty())
+        {
+            const char* rest = _skipSpace(text.data(), end);
+            if (rest != end)
+                _throwParseError(text, rest);
+            return LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC>{};
+        }
+        const char* leading = _skipSpace(text.data(), starts.front());
+        if (leading != starts.front())
+            _throwParseError(text, leading);
+
+        const size_t numCols = _countColumns(starts.front(), end, format);
+        LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> result(Limno::uninitialized, starts.size(), numCols);
+        if constexpr(_isParallelPolicy<_PolicyTp>)
+        {
+            const size_t grain = std::max<size_t>(1, LIMNO_PARALLEL_GRAIN/std::max<size_t>(numCols, 1));
+            _parallelChunks(_partition(starts.size(), 1, 0, grain), [&](size_t first, size_t last)
+                { _parseRows(text, starts, first, last, result, format); });
+        }
+        else
+            _parseRows(text, starts, 0, starts.size(), result, format);
+        return result;
+    }
+
+    template<typename _Tp>
+    LimnoMatrixBase<_Tp, DYNAMIC, DYNAMIC> parseMatrix(std::string_view text, text_format format = text_format::braces)
+    {
+        return parseMatrix<_Tp>(Limno::seq, text, format);
+    }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define CONCEPTS_HH
 
 #include "config.hh"
+#include "Core/reduced_float.hh"
 
 #include <concepts>
 #include <iterator>
@@ -28,10 +29,12 @@ namespace LIB_NAMESPACE_BASE
         };
 
         /*
-            Concept to represent a number. A number is an integer (signed or unsigned) or a floating point number
+            Concept to represent a number. A number is an integer (signed or unsigned), a floating point number
+            or one of the 16-bit float storage types (float16 and bfloat16)
         */
         template<typename _Tp>
-        concept Number = (std::floating_point<_Tp> || std::integral<_Tp>) && !std::same_as<_Tp, char>;
+        concept Number = ((std::floating_point<_Tp> || std::integral<_Tp>) && !std::same_as<_Tp, char>) || 
+            _detail::_isReducedFloat<_Tp>;
 
         /*
             Concept to represent a callable for a set of arguments. 
@@ -1,5 +1,5 @@
 #ifndef CONFIG_HH
-#define CONFIH_HH
+#define CONFIG_HH
 
 //Namespace 
 #define LIB_NAMESPACE_BASE Limno
@@ -16,6 +16,16 @@ static_assert(__cplusplus >= 201703L, "C++17 Required");
     #define CONSTINIT constexpr
 #endif
 
+//True while the enclosing constexpr function is being evaluated at
+//compile-time, so it can fall back from intrinsics to plain code
+#if __cplusplus > 201703L
+    #define LIMNO_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) || defined(__clang__)
+    #define LIMNO_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+    #define LIMNO_IS_CONSTANT_EVALUATED() true
+#endif
+
 #if __cplusplus >= 201703L
     #define CONSTEXPR17 constexpr
     #define NOEXCEPT17 noexcept
@@ -26,6 +36,44 @@ static_assert(__cplusplus >= 201703L, "C++17 Required");
     #define NOEXCEPT17_cond(o  
 #endif
 
+//Size of a cache line in bytes; used for aligned storage and padding
+#ifndef LIMNO_CACHE_LINE
+    #define LIMNO_CACHE_LINE 64
+#endif
+
+//Fewest elements a parallel kernel hands to another thread
+#ifndef LIMNO_PARALLEL_GRAIN
+    #define LIMNO_PARALLEL_GRAIN 16384
+#endif
+
+//Size in bytes of the blocks a memory_arena takes from the heap
+#ifndef LIMNO_ARENA_BLOCK_SIZE
+    #define LIMNO_ARENA_BLOCK_SIZE (1 << 20)
+#endif
+
+//Set to 1 to record the calls, time, FLOPs and bytes of every kernel with
+//operation_profiler (Core/instrumentation.hh). When 0 the hooks compile to
+//nothing
+#ifndef LIMNO_INSTRUMENT
+    #define LIMNO_INSTRUMENT 0
+#endif
+
+//Set to 1 along with LIMNO_INSTRUMENT to also mark each kernel as a VTune
+//task through the ITT API; needs ittnotify.h and libittnotify
+#ifndef LIMNO_INSTRUMENT_ITT
+    #define LIMNO_INSTRUMENT_ITT 0
+#endif
+
+//Operations moving at most this many bytes are reported as small, at most
+//LIMNO_INSTRUMENT_LARGE_BYTES as medium and anything more as large
+#ifndef LIMNO_INSTRUMENT_SMALL_BYTES
+    #define LIMNO_INSTRUMENT_SMALL_BYTES (32 << 10)
+#endif
+
+#ifndef LIMNO_INSTRUMENT_LARGE_BYTES
+    #define LIMNO_INSTRUMENT_LARGE_BYTES (8 << 20)
+#endif
+
 #define TYPE_CHECK(a, b, message) static_assert(std::is_convertible_v<a, b>, #message)
 
 #endif
\ No newline at end of file
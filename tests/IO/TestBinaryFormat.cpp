@@ -0,0 +1,187 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "IO/binary_format.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::iota;
+using LimnoTest::tempPath;
+
+TEST(TestBinaryFormat, RoundTrip)
+{
+    const std::string path = tempPath("roundtrip.lmat");
+    const auto m = iota(5, 7);
+    saveBinary(path, m);
+
+    const binary_header header = readBinaryHeader(path);
+    EXPECT_EQ(header.type, dtype::float64);
+    EXPECT_EQ(header.numRows, 5);
+    EXPECT_EQ(header.numCols, 7);
+    EXPECT_EQ(header.dataOffset % LIMNO_CACHE_LINE, 0);
+    EXPECT_TRUE(header.isDenseRowMajor());
+
+    const auto loaded = loadBinary<double>(path);
+    ASSERT_EQ(loaded.numRows(), 5);
+    ASSERT_EQ(loaded.numCols(), 7);
+    for(size_t i = 0; i < 5; ++i)
+        for(size_t j = 0; j < 7; ++j)
+            EXPECT_EQ(loaded(i, j), m(i, j));
+
+    //Other element types are converted on load
+    const auto asInt = loadBinary<int>(path);
+    EXPECT_EQ(asInt(4, 6), 34);
+    std::filesystem::remove(path);
+}
+
+TEST(TestBinaryFormat, Map)
+{
+    const std::string path = tempPath("map.lmat");
+    const auto m = iota(16, 9);
+    saveBinary(path, m);
+    {
+        const auto mapped = mapBinary<double>(path);
+        ASSERT_EQ(mapped.numRows(), 16);
+        ASSERT_EQ(mapped.numCols(), 9);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mapped.view().data()) % LIMNO_CACHE_LINE, 0);
+        for(size_t i = 0; i < 16; ++i)
+            for(size_t j = 0; j < 9; ++j)
+                EXPECT_EQ(mapped(i, j), m(i, j));
+        EXPECT_EQ(mapped.view().transpose()(8, 15), m(15, 8));
+
+        EXPECT_THROW(mapBinary<float>(path), std::invalid_argument);
+    }
+    std::filesystem::remove(path);
+    EXPECT_THROW(mapBinary<double>(path), std::runtime_error);
+}
+
+TEST(TestBinaryFormat, StridedView)
+{
+    const std::string path = tempPath("strided.lmat");
+    const auto m = iota(4, 6);
+    saveBinary(path, m.view().transpose());
+    auto loaded = loadBinary<double>(path);
+    ASSERT_EQ(loaded.numRows(), 6);
+    ASSERT_EQ(loaded.numCols(), 4);
+    for(size_t i = 0; i < 6; ++i)
+        for(size_t j = 0; j < 4; ++j)
+            EXPECT_EQ(loaded(i, j), m(j, i));
+
+    saveBinary(path, m.view().block(1, 2, 2, 3));
+    loaded = loadBinary<double>(path);
+    ASSERT_EQ(loaded.numRows(), 2);
+    EXPECT_EQ(loaded(1, 2), m(2, 4));
+    std::filesystem::remove(path);
+}
+
+TEST(TestBinaryFormat, ByteOrder)
+{
+    const std::string path = tempPath("byteorder.lmat");
+    LimnoMatrixBase<std::int32_t, DYNAMIC, DYNAMIC> m(2, 3);
+    for(size_t i = 0; i < m.size(); ++i)
+        m(i/3, i%3) = static_cast<std::int32_t>(0x01020304 + i);
+    saveBinary(path, m);
+
+    //Rewrite the file as if it came from a machine of the other byte order
+    std::vector<char> bytes;
+    {
+        std::ifstream is{path, std::ios::binary};
+        bytes.assign(std::istreambuf_iterator<char>{is}, std::istreambuf_iterator<char>{});
+    }
+    const binary_header header = readBinaryHeader(path);
+    bytes[11] = _nativeLittleEndian() ? 1 : 0;
+    for(size_t i = 0; i < m.size(); ++i)
+        std::reverse(bytes.data() + header.dataOffset + 4*i, bytes.data() + header.dataOffset + 4*(i + 1));
+    {
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    const auto loaded = loadBinary<std::int32_t>(path);
+    for(size_t i = 0; i < m.size(); ++i)
+        EXPECT_EQ(loaded(i/3, i%3), m(i/3, i%3));
+    EXPECT_THROW(mapBinary<std::int32_t>(path), std::invalid_argument);
+
+    binary_reader<std::int64_t> reader{path};
+    LimnoMatrixBase<std::int64_t, DYNAMIC, DYNAMIC> out(2, 3);
+    EXPECT_EQ(reader.read(out), 2);
+    EXPECT_EQ(out(1, 2), m(1, 2));
+    std::filesystem::remove(path);
+}
+
+TEST(TestBinaryFormat, Corrupt)
+{
+    const std::string path = tempPath("corrupt.lmat");
+    saveBinary(path, iota(8, 8));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_THROW(loadBinary<double>(path), std::invalid_argument);
+
+    //Extents and strides whose span wraps around to fit the file
+    saveBinary(path, iota(8, 8));
+    {
+        std::fstream fs{path, std::ios::binary | std::ios::in | std::ios::out};
+        std::byte fields[32];
+        _storeLittle<std::uint64_t>(fields, (std::uint64_t{1} << 62) + 1);
+        _storeLittle<std::uint64_t>(fields + 8, 1);
+        _storeLittle<std::int64_t>(fields + 16, 4);
+        _storeLittle<std::int64_t>(fields + 24, 1);
+        fs.seekp(16);
+        fs.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+    }
+    EXPECT_THROW(mapBinary<double>(path), std::invalid_argument);
+    EXPECT_THROW(loadBinary<double>(path), std::invalid_argument);
+    EXPECT_THROW(readBinaryHeader(path), std::invalid_argument);
+
+    {
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        os << "not a matrix";
+    }
+    EXPECT_THROW(loadBinary<double>(path), std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+TEST(TestBinaryFormat, Streaming)
+{
+    const std::string path = tempPath("stream.lmat");
+    const auto m = iota(10, 3);
+    {
+        binary_writer<double> writer{path, 3};
+        writer.write(m.view().block(0, 0, 4, 3));
+        writer.write(m.view().block(4, 0, 6, 3));
+        EXPECT_EQ(writer.rowsWritten(), 10);
+        EXPECT_THROW(writer.write(iota(2, 2)), std::invalid_argument);
+    }
+    EXPECT_EQ(readBinaryHeader(path).numRows, 10);
+
+    binary_reader<double> reader{path};
+    EXPECT_EQ(reader.numRows(), 10);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> chunk(4, 3);
+    size_t row = 0;
+    while(reader.rowsRemaining() != 0)
+    {
+        const size_t count = reader.read(chunk);
+        for(size_t i = 0; i < count; ++i, ++row)
+            for(size_t j = 0; j < 3; ++j)
+                EXPECT_EQ(chunk(i, j), m(row, j));
+    }
+    EXPECT_EQ(row, 10);
+    EXPECT_EQ(reader.read(chunk), 0);
+
+    //Reading into a strided destination
+    binary_reader<double> transposed{path};
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> t(3, 10);
+    EXPECT_EQ(transposed.read(t.view().transpose()), 10);
+    EXPECT_EQ(t(2, 9), m(9, 2));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,185 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "IO/npy.hh"
+#include "IO/npz.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::iota;
+using LimnoTest::tempPath;
+
+namespace
+{
+    void writeFile(const std::string& path, const std::string& bytes)
+    {
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    //A version 1 .npy file with the given header dict and data
+    std::string npyFile(const std::string& dict, const std::string& data)
+    {
+        std::string bytes = std::string{"\x93NUMPY\x01\x00", 8};
+        bytes.push_back(static_cast<char>((dict.size() + 1) & 0xFF));
+        bytes.push_back(static_cast<char>((dict.size() + 1) >> 8));
+        return bytes + dict + "\n" + data;
+    }
+}
+
+TEST(TestNpy, RoundTrip)
+{
+    const std::string path = tempPath("roundtrip.npy");
+    const auto m = iota(3, 5, 0.25);
+    saveNpy(path, m);
+
+    std::ifstream is{path, std::ios::binary};
+    std::string bytes{std::istreambuf_iterator<char>{is}, std::istreambuf_iterator<char>{}};
+    EXPECT_EQ(bytes.find("{'descr': '<f8', 'fortran_order': False, 'shape': (3, 5), }"), 10);
+    EXPECT_EQ(bytes.size(), 128 + 15*sizeof(double));
+
+    const auto loaded = loadNpy<double>(path);
+    ASSERT_EQ(loaded.numRows(), 3);
+    ASSERT_EQ(loaded.numCols(), 5);
+    for(size_t i = 0; i < 3; ++i)
+        for(size_t j = 0; j < 5; ++j)
+            EXPECT_EQ(loaded(i, j), m(i, j));
+
+    const auto mapped = mapNpy<double>(path);
+    EXPECT_FALSE(mapped.header().fortranOrder);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mapped.view().data()) % 64, 0);
+    EXPECT_EQ(mapped(2, 4), m(2, 4));
+    EXPECT_THROW(mapNpy<float>(path), std::invalid_argument);
+    EXPECT_EQ(loadNpy<float>(path)(1, 1), 6.25f);
+    std::filesystem::remove(path);
+}
+
+TEST(TestNpy, FortranOrder)
+{
+    const std::string path = tempPath("fortran.npy");
+    const auto m = iota(4, 3, 0.25);
+    //A transposed view is column-major and written without reordering
+    saveNpy(path, m.view().transpose());
+
+    const auto mapped = mapNpy<double>(path);
+    EXPECT_TRUE(mapped.header().fortranOrder);
+    ASSERT_EQ(mapped.numRows(), 3);
+    ASSERT_EQ(mapped.numCols(), 4);
+    EXPECT_EQ(mapped.view().rowStride(), 1);
+    EXPECT_EQ(mapped.view().colStride(), 3);
+    const auto loaded = loadNpy<double>(path);
+    for(size_t i = 0; i < 3; ++i)
+        for(size_t j = 0; j < 4; ++j)
+        {
+            EXPECT_EQ(mapped(i, j), m(j, i));
+            EXPECT_EQ(loaded(i, j), m(j, i));
+        }
+    std::filesystem::remove(path);
+}
+
+TEST(TestNpy, Headers)
+{
+    const std::string path = tempPath("headers.npy");
+    //Big-endian 1-d array, as written on another machine
+    writeFile(path, npyFile("{'descr': '>i4', 'fortran_order': False, 'shape': (3,), }",
+        std::string{"\x00\x00\x00\x01\x00\x00\x01\x00\xFF\xFF\xFF\xFE", 12}));
+    auto loaded = loadNpy<std::int64_t>(path);
+    ASSERT_EQ(loaded.numRows(), 3);
+    ASSERT_EQ(loaded.numCols(), 1);
+    EXPECT_EQ(loaded(0, 0), 1);
+    EXPECT_EQ(loaded(1, 0), 256);
+    EXPECT_EQ(loaded(2, 0), -2);
+
+    //0-d array with double quoted keys
+    writeFile(path, npyFile("{\"shape\": (), \"fortran_order\": True, \"descr\": \"|u1\"}", "\x07"));
+    const auto scalar = loadNpy<int>(path);
+    ASSERT_EQ(scalar.size(), 1);
+    EXPECT_EQ(scalar(0, 0), 7);
+
+    writeFile(path, npyFile("{'descr': '<f8', 'fortran_order': False, 'shape': (2, 2, 2), }", std::string(64, '\0')));
+    EXPECT_THROW(loadNpy<double>(path), std::invalid_argument);
+    writeFile(path, npyFile("{'descr': '<c16', 'fortran_order': False, 'shape': (1,), }", std::string(16, '\0')));
+    EXPECT_THROW(loadNpy<double>(path), std::invalid_argument);
+    writeFile(path, npyFile("{'descr': '<f8', 'fortran_order': False, 'shape': (4,), }", std::string(16, '\0')));
+    EXPECT_THROW(loadNpy<double>(path), std::invalid_argument);
+    //Shapes whose digits or element count overflow
+    writeFile(path, npyFile("{'descr': '<f8', 'fortran_order': False, 'shape': (99999999999999999999,), }", std::string(16, '\0')));
+    EXPECT_THROW(loadNpy<double>(path), std::invalid_argument);
+    writeFile(path, npyFile("{'descr': '<f8', 'fortran_order': False, 'shape': (9223372036854775808, 2), }", std::string(16, '\0')));
+    EXPECT_THROW(loadNpy<double>(path), std::invalid_argument);
+    EXPECT_THROW(mapNpy<double>(path), std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+TEST(TestNpy, Npz)
+{
+    const std::string path = tempPath("arrays.npz");
+    const auto a = iota(5, 4, 0.25);
+    LimnoMatrixBase<std::int32_t, DYNAMIC, DYNAMIC> b(2, 7);
+    for(size_t i = 0; i < b.size(); ++i)
+        b(i/7, i%7) = static_cast<std::int32_t>(i*i);
+    saveNpz(path, "a", a, "bt", b.view().transpose());
+
+    const npz_archive archive{path};
+    EXPECT_EQ(archive.size(), 2);
+    EXPECT_EQ(archive.names(), (std::vector<std::string>{"a", "bt"}));
+    EXPECT_TRUE(archive.contains("a"));
+    EXPECT_FALSE(archive.contains("c"));
+    EXPECT_THROW(archive.load<double>("c"), std::out_of_range);
+    EXPECT_TRUE(archive.header("bt").fortranOrder);
+
+    const auto loadedA = archive.load<double>("a");
+    const auto mappedA = archive.map<double>("a");
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mappedA.view().data()) % LIMNO_CACHE_LINE, 0);
+    for(size_t i = 0; i < 5; ++i)
+        for(size_t j = 0; j < 4; ++j)
+        {
+            EXPECT_EQ(loadedA(i, j), a(i, j));
+            EXPECT_EQ(mappedA(i, j), a(i, j));
+        }
+
+    const auto mappedB = archive.map<std::int32_t>("bt");
+    ASSERT_EQ(mappedB.numRows(), 7);
+    for(size_t i = 0; i < 7; ++i)
+        for(size_t j = 0; j < 2; ++j)
+            EXPECT_EQ(mappedB(i, j), b(j, i));
+    EXPECT_THROW(archive.map<double>("bt"), std::invalid_argument);
+    std::filesystem::remove(path);
+    //The mapping outlives the file name
+    EXPECT_EQ(mappedB(6, 1), b(1, 6));
+}
+
+TEST(TestNpy, ManyEntries)
+{
+    //More entries than the end record can count need a zip64 end record
+    const std::string path = tempPath("many.npz");
+    {
+        npz_writer writer{path};
+        LimnoMatrixBase<std::int32_t, DYNAMIC, DYNAMIC> m(1, 1);
+        for(std::int32_t i = 0; i < 0x10001; ++i)
+        {
+            m(0, 0) = i;
+            writer.add("a" + std::to_string(i), m);
+        }
+    }
+    const npz_archive archive{path};
+    EXPECT_EQ(archive.size(), 0x10001);
+    EXPECT_EQ(archive.load<std::int32_t>("a65536")(0, 0), 0x10000);
+    std::filesystem::remove(path);
+}
+
+TEST(TestNpy, Crc32)
+{
+    EXPECT_EQ(_crc32(0, "123456789", 9), 0xCBF43926u);
+    EXPECT_EQ(_crc32(_crc32(0, "1234", 4), "56789", 5), 0xCBF43926u);
+}
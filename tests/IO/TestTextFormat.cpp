@@ -0,0 +1,140 @@
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "IO/text_format.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+TEST(TestTextFormat, Format)
+{
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m(2, 3);
+    m(0, 0) = 1;
+    m(0, 1) = -2.5;
+    m(0, 2) = 0.1;
+    m(1, 0) = 1e300;
+    m(1, 1) = 1.0/3.0;
+    m(1, 2) = std::numeric_limits<double>::lowest();
+
+    EXPECT_EQ(toString(m), "{1, -2.5, 0.1},\n{1e+300, 0.3333333333333333, -1.7976931348623157e+308}");
+    EXPECT_EQ(toString(m, text_format::csv), "1,-2.5,0.1\n1e+300,0.3333333333333333,-1.7976931348623157e+308\n");
+    EXPECT_EQ(toString(m.view().transpose().block(0, 0, 2, 2), text_format::csv), "1,1e+300\n-2.5,0.3333333333333333\n");
+
+    //operator<< keeps to the stream's formatting
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3) << m;
+    EXPECT_EQ(os.str().substr(0, 24), "{1.000, -2.500, 0.100},\n");
+
+    //Too small a buffer is reported, not overrun
+    char buffer[16];
+    const std::to_chars_result result = toChars(buffer, buffer + sizeof(buffer), m);
+    EXPECT_EQ(result.ec, std::errc::value_too_large);
+    EXPECT_EQ(result.ptr, buffer + sizeof(buffer));
+
+    LimnoMatrixBase<long long, 1, 2> extremes;
+    extremes(0, 0) = std::numeric_limits<long long>::min();
+    extremes(0, 1) = std::numeric_limits<long long>::max();
+    std::vector<char> exact(formattedSize<long long>(1, 2));
+    EXPECT_EQ(toChars(exact.data(), exact.data() + exact.size(), extremes).ec, std::errc{});
+}
+
+TEST(TestTextFormat, Ostream)
+{
+    //Integers look the same either way
+    LimnoMatrixBase<int, DYNAMIC, DYNAMIC> m(300, 40);
+    for(size_t i = 0; i < 300; ++i)
+        for(size_t j = 0; j < 40; ++j)
+            m(i, j) = -static_cast<int>(i*40 + j);
+    std::ostringstream os;
+    os << m;
+    EXPECT_EQ(os.str(), toString(m));
+
+    LimnoMatrixBase<double, 1, 1> value(0.1 + 0.2);
+    std::ostringstream fixed;
+    fixed << std::setprecision(3) << std::fixed << value;
+    EXPECT_EQ(fixed.str(), "{0.300}");
+    EXPECT_EQ(toString(value), "{0.30000000000000004}");
+
+    LimnoMatrixBase<int, DYNAMIC, DYNAMIC> empty(5000, 0);
+    std::ostringstream emptyRows;
+    emptyRows << empty;
+    EXPECT_EQ(emptyRows.str().size(), 5000*4 - 2);
+}
+
+TEST(TestTextFormat, Parse)
+{
+    const auto m = parseMatrix<double>("{1, -2.5, 0.1},\n{ +1e300 ,0.3333333333333333,\t-7}");
+    ASSERT_EQ(m.numRows(), 2);
+    ASSERT_EQ(m.numCols(), 3);
+    EXPECT_EQ(m(0, 1), -2.5);
+    EXPECT_EQ(m(0, 2), 0.1);
+    EXPECT_EQ(m(1, 0), 1e300);
+    EXPECT_EQ(m(1, 1), 1.0/3.0);
+    EXPECT_EQ(m(1, 2), -7);
+
+    const auto csv = parseMatrix<int>("\n1,2\r\n 3 , 4\r\n\n5,6", text_format::csv);
+    ASSERT_EQ(csv.numRows(), 3);
+    ASSERT_EQ(csv.numCols(), 2);
+    EXPECT_EQ(csv(1, 0), 3);
+    EXPECT_EQ(csv(2, 1), 6);
+
+    EXPECT_TRUE(parseMatrix<int>("  \n").empty());
+    EXPECT_THROW(parseMatrix<int>("{1, 2},\n{3}"), std::invalid_argument);
+    EXPECT_THROW(parseMatrix<int>("{1, 2},\n{3, 4, 5}"), std::invalid_argument);
+    EXPECT_THROW(parseMatrix<int>("1,2\n3,x\n", text_format::csv), std::invalid_argument);
+    EXPECT_THROW(parseMatrix<unsigned>("1,-2\n", text_format::csv), std::invalid_argument);
+    EXPECT_THROW(parseMatrix<int>("x{1, 2}"), std::invalid_argument);
+    EXPECT_THROW(parseMatrix<signed char>("1,1000\n", text_format::csv), std::invalid_argument);
+}
+
+TEST(TestTextFormat, FromChars)
+{
+    const std::string text = "1,2,3\n4,5,6\ntrailing";
+    LimnoMatrixBase<float, 3, 2> t;
+    //Parsing into a transposed view fills the matrix column by column
+    const std::from_chars_result result = fromChars(text.data(), text.data() + text.size(), t.view().transpose(), text_format::csv);
+    EXPECT_EQ(result.ec, std::errc{});
+    EXPECT_EQ(std::string{result.ptr}, "trailing");
+    EXPECT_EQ(t(2, 0), 3.0f);
+    EXPECT_EQ(t(0, 1), 4.0f);
+
+    LimnoMatrixBase<float, 2, 4> wide;
+    const std::from_chars_result bad = fromChars(text.data(), text.data() + text.size(), wide, text_format::csv);
+    EXPECT_EQ(bad.ec, std::errc::invalid_argument);
+    EXPECT_EQ(bad.ptr, text.data() + 5);
+}
+
+TEST(TestTextFormat, RoundTrip)
+{
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m(257, 33);
+    for(size_t i = 0; i < m.numRows(); ++i)
+        for(size_t j = 0; j < m.numCols(); ++j)
+            m(i, j) = static_cast<double>(i*33 + j)/7.0 - 100.0;
+
+    for(const text_format format : {text_format::braces, text_format::csv})
+    {
+        const std::string text = toString(m, format);
+        const auto sequential = parseMatrix<double>(text, format);
+        const auto parallel = parseMatrix<double>(Limno::par, text, format);
+        ASSERT_EQ(parallel.numRows(), m.numRows());
+        ASSERT_EQ(parallel.numCols(), m.numCols());
+        for(size_t i = 0; i < m.numRows(); ++i)
+            for(size_t j = 0; j < m.numCols(); ++j)
+            {
+                EXPECT_EQ(sequential(i, j), m(i, j));
+                EXPECT_EQ(parallel(i, j), m(i, j));
+            }
+    }
+
+    std::string broken = toString(m, text_format::csv);
+    broken[broken.size()/2] = ';';
+    EXPECT_THROW(parseMatrix<double>(Limno::par, broken, text_format::csv), std::invalid_argument);
+}
@@ -0,0 +1,99 @@
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/aligned_allocator.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/reductions.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    bool isAligned(const void* p, size_t alignment)
+    {
+        return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+    }
+}
+
+TEST(AlignedStorage, Allocator)
+{
+    std::vector<float, aligned_allocator<float>> v(17);
+    EXPECT_TRUE(isAligned(v.data(), 64));
+
+    std::vector<double, aligned_allocator<double, 128>> w(3);
+    EXPECT_TRUE(isAligned(w.data(), 128));
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC, aligned_allocator<double>> m(1.0, 3, 5);
+    EXPECT_TRUE(isAligned(m.data(), 64));
+    EXPECT_EQ(m.leadingDim(), 5);
+    EXPECT_EQ(m(2, 4), 1.0);
+}
+
+TEST(AlignedStorage, StaticAlignment)
+{
+    //By default storage is only aligned as far as it costs no space
+    LimnoMatrixBase<float, 4, 4> a;
+    LimnoMatrixBase<double, 2, 2> b;
+    EXPECT_TRUE(isAligned(a.data(), 16));
+    EXPECT_TRUE(isAligned(b.data(), 16));
+    static_assert(sizeof(LimnoMatrixBase<float, 4, 4>) == 2*sizeof(size_t) + 16*sizeof(float));
+    static_assert(sizeof(LimnoMatrixBase<double, 3, 3>) == 2*sizeof(size_t) + 9*sizeof(double));
+
+    //Cache line alignment is opted in to through the allocator
+    LimnoMatrixBase<double, 3, 3, aligned_allocator<double>> c;
+    LimnoMatrixBase<float, 4, 4, aligned_allocator<float, 32>> d;
+    EXPECT_TRUE(isAligned(c.data(), 64));
+    EXPECT_TRUE(isAligned(d.data(), 32));
+}
+
+TEST(AlignedStorage, PaddedRows)
+{
+    using padded_type = LimnoMatrixBase<double, DYNAMIC, DYNAMIC, padded_allocator<double>>;
+    static_assert(padded_type::isPadded, "Expected padded rows");
+
+    std::vector<double> values(3*5);
+    std::iota(values.begin(), values.end(), 0.0);
+    padded_type m(values.begin(), values.end(), 3, 5);
+
+    EXPECT_EQ(m.numRows(), 3);
+    EXPECT_EQ(m.numCols(), 5);
+    EXPECT_EQ(m.size(), 15);
+    EXPECT_EQ(m.leadingDim(), 8);
+    for(size_t r = 0; r < m.numRows(); ++r)
+        EXPECT_TRUE(isAligned(&m(r, 0), 64));
+    EXPECT_EQ(m(1, 0), 5);
+    EXPECT_EQ(m(2, 4), 14);
+
+    //Iteration skips the padding
+    std::vector<double> visited(m.begin(), m.end());
+    EXPECT_EQ(visited, values);
+    auto it = m.begin();
+    it += 7;
+    EXPECT_EQ(*it, 7);
+    EXPECT_EQ(m.end() - m.begin(), 15);
+
+    //Kernels respect the leading dimension
+    padded_type doubled = m + m;
+    EXPECT_EQ(doubled(2, 4), 28);
+    EXPECT_EQ(sum(m), 105);
+    EXPECT_EQ(max(m), 14);
+    EXPECT_EQ(dot(m, m), 1015);
+
+    std::vector<std::vector<double>> identity = {
+        {1, 0, 0, 0, 0},
+        {0, 1, 0, 0, 0},
+        {0, 0, 1, 0, 0},
+        {0, 0, 0, 1, 0},
+        {0, 0, 0, 0, 1}
+    };
+    padded_type eye(identity);
+    padded_type product = matmul(m, eye);
+    for(size_t r = 0; r < m.numRows(); ++r)
+        for(size_t c = 0; c < m.numCols(); ++c)
+            EXPECT_EQ(product(r, c), m(r, c));
+}
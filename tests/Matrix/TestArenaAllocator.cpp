@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/arena_allocator.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    bool isAligned(const void* p, size_t alignment)
+    {
+        return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+    }
+}
+
+TEST(ArenaAllocator, Arena)
+{
+    memory_arena arena{1024};
+    void* a = arena.allocate(100, 64);
+    void* b = arena.allocate(10, 8);
+    EXPECT_TRUE(isAligned(a, 64));
+    EXPECT_EQ(static_cast<std::byte*>(b), static_cast<std::byte*>(a) + 104);
+    EXPECT_EQ(arena.stats().heapAllocations, 1);
+
+    //Only the most recent allocation is reclaimed
+    arena.deallocate(b, 10);
+    EXPECT_EQ(arena.used(), 104);
+    EXPECT_EQ(arena.allocate(10, 8), b);
+
+    //Spilling into a second block, then reset merges the blocks
+    auto mark = arena.mark();
+    arena.allocate(2000, 64);
+    EXPECT_EQ(arena.stats().heapAllocations, 2);
+    arena.release(mark);
+    EXPECT_EQ(arena.allocate(10, 8), static_cast<std::byte*>(b) + 16);
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0);
+    EXPECT_EQ(arena.stats().heapAllocations, 3);
+    EXPECT_GE(arena.capacity(), 1024 + 2000);
+    arena.allocate(2500, 64);
+    EXPECT_EQ(arena.stats().heapAllocations, 3);
+    EXPECT_EQ(arena.stats().resets, 1);
+}
+
+TEST(ArenaAllocator, Matrices)
+{
+    using arena_matrix = LimnoMatrixBase<double, DYNAMIC, DYNAMIC, arena_allocator<double>>;
+    memory_arena& arena = threadArena();
+    arena.reset();
+
+    const auto run = [](size_t iteration) 
+    {
+        arena_scope scope;
+        arena_matrix a(1.0, 16, 16);
+        arena_matrix b(2.0, 16, 16);
+        EXPECT_TRUE(isAligned(a.data(), 64));
+        arena_matrix c = a + b*static_cast<double>(iteration);
+        arena_matrix d = matmul(a, c);
+        EXPECT_EQ(d(3, 4), 16*(1 + 2*static_cast<double>(iteration)));
+    };
+
+    //Warm up, then the loop should not touch the heap
+    run(0);
+    const size_t used = arena.used();
+    const size_t heapAllocations = arena.stats().heapAllocations;
+    const size_t allocations = arena.stats().allocations;
+    for(size_t i = 1; i < 100; ++i)
+        run(i);
+    EXPECT_EQ(arena.stats().heapAllocations, heapAllocations);
+    EXPECT_EQ(arena.stats().allocations, allocations + 99*4);
+    EXPECT_EQ(arena.used(), used);
+
+    //Allocators on different arenas compare unequal
+    memory_arena other;
+    EXPECT_TRUE(arena_allocator<double>{} == arena_allocator<float>{});
+    EXPECT_TRUE(arena_allocator<double>{other} != arena_allocator<double>{});
+
+    std::vector<int, arena_allocator<int>> v{arena_allocator<int>{other}};
+    v.assign(100, 7);
+    EXPECT_EQ(other.stats().allocations, 1);
+    EXPECT_EQ(v[99], 7);
+}
@@ -0,0 +1,171 @@
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/array_base.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+TEST(TestArray, Extents)
+{
+    using extents = _Extents<DYNAMIC, 3, DYNAMIC, 4>;
+    static_assert(extents::rank == 4);
+    static_assert(extents::rankDynamic == 2);
+    static_assert(!extents::isStatic);
+    static_assert(extents::hasStaticStride(3) && extents::hasStaticStride(2));
+    static_assert(!extents::hasStaticStride(1) && !extents::hasStaticStride(0));
+    static_assert(extents::staticStride(2) == 4);
+
+    constexpr extents e{2, 5};
+    static_assert(e.extent(0) == 2 && e.extent(1) == 3 && e.extent(2) == 5 && e.extent(3) == 4);
+    static_assert(e.size() == 120);
+
+    EXPECT_EQ(extents(std::array<size_t, 4>{2, 3, 5, 4}), e);
+    EXPECT_THROW(extents(std::array<size_t, 4>{2, 2, 5, 4}), std::invalid_argument);
+
+    static_assert(_Extents<2, 3, 4>::isStatic);
+    static_assert(_Extents<2, 3, 4>{}.size() == 24);
+}
+
+TEST(TestArray, StaticArray)
+{
+    LimnoArray<int, 2, 3, 4> a(7);
+    static_assert(decltype(a)::rank == 3);
+    EXPECT_EQ(a.size(), 24);
+    EXPECT_EQ(a.stride(0), 12);
+    EXPECT_EQ(a.stride(1), 4);
+    EXPECT_EQ(a.stride(2), 1);
+    for(int x : a)
+        EXPECT_EQ(x, 7);
+
+    std::iota(a.begin(), a.end(), 0);
+    for(size_t i = 0; i < 2; ++i)
+    {
+        for(size_t j = 0; j < 3; ++j)
+        {
+            for(size_t k = 0; k < 4; ++k)
+                EXPECT_EQ(a(i, j, k), static_cast<int>(12*i + 4*j + k));
+        }
+    }
+    a(1, 2, 3) = -1;
+    EXPECT_EQ(a.data()[23], -1);
+}
+
+TEST(TestArray, DynamicArray)
+{
+    //Batch x channel x height x width with a static channel count
+    LimnoArray<double, DYNAMIC, 3, DYNAMIC, DYNAMIC> a(2, 4, 5);
+    EXPECT_EQ(a.extent(0), 2);
+    EXPECT_EQ(a.extent(1), 3);
+    EXPECT_EQ(a.extent(2), 4);
+    EXPECT_EQ(a.extent(3), 5);
+    EXPECT_EQ(a.size(), 120);
+    EXPECT_EQ(a.stride(0), 60);
+    EXPECT_EQ(a.stride(1), 20);
+    EXPECT_EQ(a.stride(2), 5);
+    EXPECT_EQ(a.stride(3), 1);
+    for(double x : a)
+        EXPECT_EQ(x, 0.0);
+
+    std::iota(a.begin(), a.end(), 0.0);
+    EXPECT_EQ(a(1, 2, 3, 4), 119.0);
+    EXPECT_EQ(a(1, 0, 2, 1), 71.0);
+
+    using array_type = LimnoArray<double, DYNAMIC, DYNAMIC>;
+    std::vector<double> values{1, 2, 3, 4, 5, 6};
+    array_type b(array_type::extents_type{2, 3}, values.begin(), values.end());
+    EXPECT_EQ(b(1, 0), 4.0);
+    array_type c(array_type::extents_type{2, 3}, 1.5);
+    EXPECT_EQ(c(1, 2), 1.5);
+}
+
+TEST(TestArray, Views)
+{
+    LimnoArray<int, DYNAMIC, 3, 4> a(2);
+    std::iota(a.begin(), a.end(), 0);
+
+    //One sample of the batch
+    auto sample = a[1];
+    static_assert(decltype(sample)::rank == 2);
+    EXPECT_EQ(sample.extent(0), 3);
+    EXPECT_EQ(sample.extent(1), 4);
+    EXPECT_EQ(sample(2, 1), a(1, 2, 1));
+    EXPECT_THROW(a[2], std::out_of_range);
+
+    //Every second column of the last dimension
+    auto sliced = a.view().slice(2, 1, 4, 2);
+    EXPECT_EQ(sliced.extent(2), 2);
+    EXPECT_EQ(sliced(1, 2, 1), a(1, 2, 3));
+    EXPECT_FALSE(sliced.isContiguous());
+    EXPECT_THROW(a.view().slice(1, 0, 4), std::out_of_range);
+    EXPECT_THROW(a.view().slice(1, 0, 2, 0), std::invalid_argument);
+
+    //Channels last
+    auto permuted = a.view().permute({0, 2, 1});
+    EXPECT_EQ(permuted.extent(1), 4);
+    EXPECT_EQ(permuted.extent(2), 3);
+    EXPECT_EQ(permuted(1, 3, 2), a(1, 2, 3));
+    EXPECT_THROW(a.view().permute({0, 0, 1}), std::invalid_argument);
+
+    //Writing through a view
+    a[0].fill(-1);
+    EXPECT_EQ(a(0, 2, 3), -1);
+    EXPECT_EQ(a(1, 0, 0), 12);
+
+    //Materializing a permuted view gives a dense copy
+    LimnoArray<int, DYNAMIC, 4, 3> b(permuted);
+    EXPECT_TRUE(b.view().isContiguous());
+    for(size_t i = 0; i < 2; ++i)
+    {
+        for(size_t j = 0; j < 4; ++j)
+        {
+            for(size_t k = 0; k < 3; ++k)
+                EXPECT_EQ(b(i, j, k), a(i, k, j));
+        }
+    }
+    EXPECT_THROW((LimnoArray<int, DYNAMIC, 3, 4>(permuted)), std::invalid_argument);
+
+    int count = 0;
+    sliced.forEach([&](int) { ++count; });
+    EXPECT_EQ(count, 12);
+}
+
+TEST(TestArray, AsMatrix)
+{
+    LimnoArray<double, DYNAMIC, 2, 3> a(4);
+    std::iota(a.begin(), a.end(), 0.0);
+
+    //Batch and channels as rows, features as columns
+    auto m = a.asMatrix(2);
+    EXPECT_EQ(m.numRows(), 8);
+    EXPECT_EQ(m.numCols(), 3);
+    EXPECT_EQ(m(5, 2), a(2, 1, 2));
+
+    auto flat = a.asMatrix(0);
+    EXPECT_EQ(flat.numRows(), 1);
+    EXPECT_EQ(flat.numCols(), 24);
+    EXPECT_EQ(flat(0, 23), 23.0);
+
+    //Runs the matrix kernels without flattening by hand
+    LimnoMatrixBase<double, 3, 1> ones(1.0);
+    auto rowSums = matmul(m, ones.view());
+    for(size_t r = 0; r < 8; ++r)
+        EXPECT_EQ(rowSums(r, 0), 9.0*r + 3.0);
+
+    //A permuted view whose row group isn't nested can't be merged
+    auto permuted = a.view().permute({1, 0, 2});
+    EXPECT_THROW(permuted.asMatrix(2), std::invalid_argument);
+    EXPECT_THROW(permuted.asMatrix(1), std::invalid_argument);
+
+    //Slicing the batch keeps the rest nested
+    auto middle = a.view().slice(0, 1, 3).asMatrix(2);
+    EXPECT_EQ(middle.numRows(), 4);
+    EXPECT_EQ(middle(0, 0), 6.0);
+    EXPECT_THROW(a.asMatrix(4), std::out_of_range);
+}
@@ -0,0 +1,209 @@
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "Core/reductions.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::pattern;
+
+namespace
+{
+    bool sameBits(double a, double b)
+    {
+        return std::memcmp(&a, &b, sizeof(double)) == 0;
+    }
+}
+
+TEST(TestAxisReductions, Rowwise)
+{
+    const auto m = pattern<double>(37, 1029);
+    for(const auto& result : {sum(m, Limno::rowwise), sum(Limno::par, m, Limno::rowwise)})
+    {
+        ASSERT_EQ(result.numRows(), 37);
+        ASSERT_EQ(result.numCols(), 1);
+        for(size_t i = 0; i < 37; ++i)
+            EXPECT_EQ(result(i, 0), sum(m.view().row(i)));
+    }
+
+    const auto means = mean(m, Limno::rowwise);
+    const auto vars = var(Limno::par, m, Limno::rowwise);
+    const auto norms = norm(m, Limno::rowwise);
+    const auto largest = argmax(m, Limno::rowwise);
+    for(size_t i = 0; i < 37; ++i)
+    {
+        double s = 0, ss = 0, d = 0;
+        size_t best = 0;
+        for(size_t j = 0; j < 1029; ++j)
+        {
+            s += m(i, j);
+            ss += m(i, j)*m(i, j);
+            best = (m(i, j) > m(i, best)) ? j : best;
+        }
+        for(size_t j = 0; j < 1029; ++j)
+            d += (m(i, j) - s/1029)*(m(i, j) - s/1029);
+        EXPECT_DOUBLE_EQ(means(i, 0), s/1029);
+        EXPECT_NEAR(vars(i, 0), d/1029, 1e-9);
+        EXPECT_DOUBLE_EQ(norms(i, 0), std::sqrt(ss));
+        EXPECT_EQ(largest(i, 0), best);
+    }
+}
+
+TEST(TestAxisReductions, Colwise)
+{
+    const auto m = pattern<int>(515, 43);
+    const auto sums = sum(Limno::par, m, Limno::colwise);
+    const auto mins = min(m, Limno::colwise);
+    const auto maxs = max(Limno::par, m, Limno::colwise);
+    const auto first = argmin(Limno::par, m, Limno::colwise);
+    const auto means = mean(m, Limno::colwise);
+    static_assert(std::is_same_v<std::decay_t<decltype(means(0, 0))>, double>);
+    ASSERT_EQ(sums.numRows(), 1);
+    ASSERT_EQ(sums.numCols(), 43);
+    for(size_t j = 0; j < 43; ++j)
+    {
+        int s = 0, lo = m(0, j), hi = m(0, j);
+        size_t at = 0;
+        for(size_t i = 0; i < 515; ++i)
+        {
+            s += m(i, j);
+            hi = std::max(hi, m(i, j));
+            if (m(i, j) < lo)
+            {
+                lo = m(i, j);
+                at = i;
+            }
+        }
+        EXPECT_EQ(sums(0, j), s);
+        EXPECT_EQ(mins(0, j), lo);
+        EXPECT_EQ(maxs(0, j), hi);
+        EXPECT_EQ(first(0, j), at);
+        EXPECT_DOUBLE_EQ(means(0, j), static_cast<double>(s)/515);
+    }
+}
+
+TEST(TestAxisReductions, StaticShapes)
+{
+    LimnoMatrixBase<float, 3, 4> m;
+    for(size_t i = 0; i < 3; ++i)
+        for(size_t j = 0; j < 4; ++j)
+            m(i, j) = static_cast<float>(i*4 + j);
+
+    const auto rows = sum(m, Limno::rowwise);
+    const auto cols = max(m, Limno::colwise, Limno::deterministic);
+    static_assert(std::is_same_v<decltype(rows), const LimnoMatrixBase<float, 3, 1>>);
+    static_assert(std::is_same_v<decltype(cols), const LimnoMatrixBase<float, 1, 4>>);
+    EXPECT_EQ(rows(2, 0), 8 + 9 + 10 + 11);
+    EXPECT_EQ(cols(0, 1), 9);
+
+    EXPECT_EQ(argmax(m), (std::pair<size_t, size_t>{2, 3}));
+    EXPECT_EQ(argmin(m.view().transpose()), (std::pair<size_t, size_t>{0, 0}));
+    EXPECT_DOUBLE_EQ(mean(m), 5.5);
+    EXPECT_FLOAT_EQ(var(m, Limno::deterministic), 143.0f/12);
+}
+
+TEST(TestAxisReductions, Views)
+{
+    const auto m = pattern<double>(64, 48);
+    const auto block = m.view().block(3, 5, 40, 30);
+    const auto transposed = m.view().transpose();
+
+    const auto blockRows = sum(Limno::par, block, Limno::rowwise);
+    const auto blockCols = norm(block, Limno::colwise);
+    for(size_t i = 0; i < 40; ++i)
+        EXPECT_DOUBLE_EQ(blockRows(i, 0), sum(block.row(i)));
+    for(size_t j = 0; j < 30; ++j)
+        EXPECT_DOUBLE_EQ(blockCols(0, j), norm(block.col(j)));
+
+    //Rows of a transpose are columns of the matrix
+    const auto rows = sum(transposed, Limno::rowwise);
+    const auto cols = sum(m, Limno::colwise);
+    const auto strided = argmax(Limno::par, transposed, Limno::colwise);
+    const auto direct = argmax(m, Limno::rowwise);
+    ASSERT_EQ(rows.numRows(), 48);
+    for(size_t j = 0; j < 48; ++j)
+        EXPECT_EQ(rows(j, 0), cols(0, j));
+    for(size_t i = 0; i < 64; ++i)
+        EXPECT_EQ(strided(0, i), direct(i, 0));
+
+    //Every reduction takes a policy with a view and no options
+    EXPECT_EQ(sum(Limno::par, block), sum(block));
+    EXPECT_EQ(sum(Limno::seq, transposed), sum(m));
+    EXPECT_DOUBLE_EQ(norm(Limno::par, block), norm(block));
+    EXPECT_DOUBLE_EQ(norm(Limno::seq, transposed), norm(m));
+    EXPECT_EQ(min(Limno::par, block), min(block));
+    EXPECT_EQ(min(Limno::seq, transposed), min(m));
+    EXPECT_EQ(max(Limno::par, block), max(block));
+    EXPECT_EQ(max(Limno::seq, transposed), max(m));
+    EXPECT_DOUBLE_EQ(mean(Limno::par, block), mean(block));
+    EXPECT_DOUBLE_EQ(var(Limno::seq, transposed), var(m));
+    EXPECT_EQ(argmin(Limno::par, block), argmin(block));
+    EXPECT_EQ(argmax(Limno::seq, block), argmax(block));
+}
+
+TEST(TestAxisReductions, Deterministic)
+{
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m(301, 997);
+    for(size_t i = 0; i < m.numRows(); ++i)
+        for(size_t j = 0; j < m.numCols(); ++j)
+            m(i, j) = std::sin(static_cast<double>(i*997 + j))*std::pow(10.0, static_cast<double>((i + j) % 13) - 6);
+
+    EXPECT_TRUE(sameBits(sum(m, Limno::deterministic), sum(Limno::par, m, Limno::deterministic)));
+    EXPECT_TRUE(sameBits(var(m, Limno::deterministic), var(Limno::par, m, Limno::deterministic)));
+    EXPECT_NEAR(sum(m.view().transpose(), Limno::deterministic), sum(m, Limno::deterministic), 1e-9);
+
+    const auto rows = sum(m, Limno::rowwise, Limno::deterministic);
+    const auto parallelRows = sum(Limno::par, m, Limno::deterministic, Limno::rowwise);
+    for(size_t i = 0; i < m.numRows(); ++i)
+        EXPECT_TRUE(sameBits(rows(i, 0), parallelRows(i, 0)));
+
+    const auto cols = norm(m, Limno::colwise, Limno::deterministic);
+    const auto parallelCols = norm(Limno::par, m, Limno::colwise, Limno::deterministic);
+    for(size_t j = 0; j < m.numCols(); ++j)
+    {
+        EXPECT_TRUE(sameBits(cols(0, j), parallelCols(0, j)));
+        EXPECT_TRUE(sameBits(cols(0, j), norm(m.view().col(j), Limno::deterministic)));
+    }
+}
+
+TEST(TestAxisReductions, Compensated)
+{
+    //Naive summation loses every 1 added to 1e16
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m(1, 4097);
+    m(0, 0) = 1e16;
+    for(size_t j = 1; j < m.numCols(); ++j)
+        m(0, j) = 1.0;
+    EXPECT_EQ(sum(m, Limno::deterministic), 1e16 + 4096);
+    EXPECT_EQ(sum(Limno::par, m.view().transpose(), Limno::colwise, Limno::deterministic)(0, 0), 1e16 + 4096);
+
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> f(1000, 10);
+    for(size_t i = 0; i < f.size(); ++i)
+        f(i/10, i % 10) = 0.1f;
+    EXPECT_NEAR(sum(f, Limno::deterministic), 1000.0, 1e-4);
+    EXPECT_FLOAT_EQ(mean(f, Limno::deterministic), 0.1f);
+}
+
+TEST(TestAxisReductions, Empty)
+{
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m(4, 0);
+    const auto sums = sum(m, Limno::rowwise, Limno::deterministic);
+    ASSERT_EQ(sums.numRows(), 4);
+    EXPECT_EQ(sums(3, 0), 0.0);
+    EXPECT_EQ(norm(Limno::par, m, Limno::rowwise)(0, 0), 0.0);
+    EXPECT_EQ(sum(m, Limno::colwise).numCols(), 0);
+    EXPECT_EQ(mean(m, Limno::colwise).numCols(), 0);
+    EXPECT_THROW(mean(m, Limno::rowwise), std::invalid_argument);
+    EXPECT_THROW(argmax(m, Limno::rowwise), std::invalid_argument);
+    EXPECT_THROW(argmin(m), std::invalid_argument);
+    EXPECT_THROW(var(m, Limno::deterministic), std::invalid_argument);
+    EXPECT_EQ(sum(m, Limno::deterministic), 0.0);
+}
@@ -0,0 +1,93 @@
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include "Core/blocks.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/shape.hh"
+#include "Core/transpose.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::grid;
+
+namespace
+{
+    template<typename _MatTp>
+    static constexpr bool storedInArray = !runtimeDim<_OperandTraits<_MatTp>::rows, _OperandTraits<_MatTp>::cols>;
+}
+
+TEST(TestBlocks, ShapeAlgebra)
+{
+    static_assert(sumDim<2, 3> == 5 && sumDim<2, DYNAMIC> == DYNAMIC);
+    static_assert(commonDim<DYNAMIC, 4> == 4 && commonDim<4, DYNAMIC> == 4);
+    static_assert(staticDim<1, 2> && !staticDim<1, DYNAMIC>);
+    static_assert(sameDim<3, 3>(1, 2));
+    EXPECT_FALSE((sameDim<3, DYNAMIC>(3, 2)));
+    EXPECT_TRUE((sameDim<DYNAMIC, DYNAMIC>(2, 2)));
+
+    //Products and transposes carry static extents through
+    using product_type = decltype(matmul(grid<int, 2, 7>(), grid<int, 7, 3>()));
+    static_assert(std::is_same_v<product_type, LimnoMatrixBase<int, 2, 3>>);
+    using transpose_type = decltype(transpose(grid<int, 20, 30>()));
+    static_assert(std::is_same_v<transpose_type, LimnoMatrixBase<int, 30, 20>>);
+}
+
+TEST(TestBlocks, Blocks)
+{
+    const auto m = grid<int, 6, 5>();
+    const auto b = block<2, 3>(m, 3, 1);
+    static_assert(std::is_same_v<decltype(b), const LimnoMatrixBase<int, 2, 3>>);
+    for(size_t r = 0; r < 2; ++r)
+        for(size_t c = 0; c < 3; ++c)
+            EXPECT_EQ(b(r, c), m(3 + r, 1 + c));
+    EXPECT_THROW((block<2, 3>(m, 5, 0)), std::out_of_range);
+    EXPECT_THROW((block<2, 2>(m, std::numeric_limits<size_t>::max(), 0)), std::out_of_range);
+    EXPECT_THROW((block<2, 2>(m, 0, std::numeric_limits<size_t>::max())), std::out_of_range);
+
+    const auto s = block<4, 2, 2, 3>(m);
+    EXPECT_EQ(s(1, 2), 54);
+
+    //Static blocks of dynamic matrices are checked at runtime
+    const auto d = grid<int, DYNAMIC, DYNAMIC>(4, 40);
+    const auto db = block<3, 3>(d, 1, 37);
+    static_assert(storedInArray<std::decay_t<decltype(db)>>);
+    EXPECT_EQ(db(2, 2), 69);
+    EXPECT_THROW((block<3, 3>(d, 1, 38)), std::out_of_range);
+    EXPECT_THROW((block<0, 0, 5, 1>(d)), std::out_of_range);
+}
+
+TEST(TestBlocks, Concatenation)
+{
+    const auto a = grid<int, 2, 3>();
+    const auto b = grid<int, 2, 4>();
+    const auto h = hconcat(a, b);
+    static_assert(std::is_same_v<decltype(h), const LimnoMatrixBase<int, 2, 7>>);
+    EXPECT_EQ(h(1, 2), 12);
+    EXPECT_EQ(h(1, 3), 10);
+    EXPECT_EQ(h(1, 6), 13);
+
+    const auto v = vconcat(a, grid<int, 4, 3>());
+    static_assert(std::is_same_v<decltype(v), const LimnoMatrixBase<int, 6, 3>>);
+    EXPECT_EQ(v(1, 2), 12);
+    EXPECT_EQ(v(5, 2), 32);
+
+    //A static extent on either side makes the shared extent static; the
+    //concatenated extent is dynamic if either side is
+    const auto mixed = hconcat(grid<int, DYNAMIC, 3>(2, 3), grid<int, 2, DYNAMIC>(2, 1));
+    static_assert(std::is_same_v<decltype(mixed), const LimnoMatrixBase<int, 2, DYNAMIC>>);
+    EXPECT_EQ(mixed.numCols(), 4);
+    EXPECT_EQ(mixed(1, 3), 10);
+    EXPECT_THROW(hconcat(grid<int, DYNAMIC, DYNAMIC>(3, 2), a), std::invalid_argument);
+    EXPECT_THROW(vconcat(grid<int, DYNAMIC, DYNAMIC>(3, 2), a), std::invalid_argument);
+
+    const auto d = vconcat(grid<int, DYNAMIC, DYNAMIC>(3, 2), grid<int, DYNAMIC, DYNAMIC>(1, 2));
+    EXPECT_EQ(d.numRows(), 4);
+    EXPECT_EQ(d(3, 1), 1);
+}
@@ -0,0 +1,91 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/debug_allocator.hh"
+#include "Core/matrix_base.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+TEST(DebugAllocator, Labels)
+{
+    allocation_profiler& profiler = allocation_profiler::instance();
+    {
+        std::vector<double, debug_allocator<double>> v{debug_allocator<double>{"TestLabels.vector"}};
+        v.resize(10);
+        auto stats = profiler.stats("TestLabels.vector");
+        EXPECT_EQ(stats.allocations, 1);
+        EXPECT_EQ(stats.bytesAllocated, 80);
+        EXPECT_EQ(stats.liveBytes, 80);
+        //80 bytes fall in [64, 128)
+        EXPECT_EQ(stats.histogram[7], 1);
+    }
+    auto stats = profiler.stats("TestLabels.vector");
+    EXPECT_EQ(stats.deallocations, 1);
+    EXPECT_EQ(stats.bytesFreed, 80);
+    EXPECT_EQ(stats.liveBytes, 0);
+    EXPECT_EQ(stats.peakLiveBytes, 80);
+
+    //Unlabelled allocators use the innermost scope
+    using debug_matrix = LimnoMatrixBase<double, DYNAMIC, DYNAMIC, debug_allocator<double>>;
+    {
+        allocation_label outer{"TestLabels.outer"};
+        debug_matrix a(1.0, 4, 4);
+        {
+            allocation_label inner{"TestLabels.inner"};
+            debug_matrix b(1.0, 2, 2);
+            debug_matrix c = a + a;
+        }
+        debug_matrix d(1.0, 8, 8);
+    }
+    EXPECT_EQ(profiler.stats("TestLabels.outer").allocations, 2);
+    EXPECT_EQ(profiler.stats("TestLabels.outer").peakLiveBytes, 16*8 + 64*8);
+    EXPECT_EQ(profiler.stats("TestLabels.inner").allocations, 2);
+    EXPECT_EQ(profiler.stats("TestLabels.inner").liveBytes, 0);
+
+    std::ostringstream report;
+    profiler.report(report);
+    EXPECT_NE(report.str().find("TestLabels.inner"), std::string::npos);
+    EXPECT_NE(report.str().find("[64, 128): 1"), std::string::npos);
+
+    std::string site = LIMNO_ALLOCATION_SITE;
+    EXPECT_NE(site.find("TestDebugAllocator.cpp:"), std::string::npos);
+}
+
+TEST(DebugAllocator, Threads)
+{
+    allocation_profiler& profiler = allocation_profiler::instance();
+    std::vector<std::thread> threads;
+    //Memory allocated on one thread and freed on another is credited back
+    std::vector<std::vector<int, debug_allocator<int>>> handoff(4);
+    for(size_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&handoff, t] 
+        {
+            for(size_t i = 0; i < 100; ++i)
+            {
+                std::vector<int, debug_allocator<int>> v{debug_allocator<int>{"TestThreads"}};
+                v.resize(i + 1);
+            }
+            handoff[t] = std::vector<int, debug_allocator<int>>(16, 0, debug_allocator<int>{"TestThreads.handoff"});
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+
+    auto stats = profiler.stats("TestThreads");
+    EXPECT_EQ(stats.allocations, 400);
+    EXPECT_EQ(stats.deallocations, 400);
+    EXPECT_EQ(stats.liveBytes, 0);
+    EXPECT_EQ(stats.bytesAllocated, 4*sizeof(int)*100*101/2);
+
+    handoff.clear();
+    auto handoffStats = profiler.stats("TestThreads.handoff");
+    EXPECT_EQ(handoffStats.allocations, 4);
+    EXPECT_EQ(handoffStats.deallocations, 4);
+    EXPECT_EQ(handoffStats.liveBytes, 0);
+}
@@ -0,0 +1,108 @@
+#include <stdexcept>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+TEST(ExpressionTemplates, ElementWiseOperators)
+{
+    double arr1[] = {1, 2, 3, 4};
+    double arr2[] = {5, 6, 7, 8};
+    LimnoMatrixBase<double, 2, 2> a(arr1);
+    LimnoMatrixBase<double, 2, 2> b(arr2);
+
+    LimnoMatrixBase<double, 2, 2> sum = a + b;
+    EXPECT_EQ(sum(0, 0), 6);
+    EXPECT_EQ(sum(1, 1), 12);
+
+    LimnoMatrixBase<double, 2, 2> diff = b - a;
+    EXPECT_EQ(diff(0, 1), 4);
+
+    LimnoMatrixBase<double, 2, 2> prod = a * b;
+    EXPECT_EQ(prod(1, 0), 21);
+
+    LimnoMatrixBase<double, 2, 2> quot = b / a;
+    EXPECT_EQ(quot(0, 0), 5);
+    EXPECT_EQ(quot(1, 1), 2);
+
+    LimnoMatrixBase<double, 2, 2> neg = -a;
+    EXPECT_EQ(neg(1, 1), -4);
+}
+
+TEST(ExpressionTemplates, ChainedExpressions)
+{
+    double arr[] = {1, 2, 3, 4, 5, 6};
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> a(arr, 2, 3);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(arr, 2, 3);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> c(arr, 2, 3);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> d(arr, 2, 3);
+
+    //Nothing is evaluated until assignment
+    auto expr = a + b * c - d;
+    static_assert(!std::is_same_v<decltype(expr), LimnoMatrixBase<double, DYNAMIC, DYNAMIC>>, "Expected lazy expression");
+    EXPECT_EQ(expr.numRows(), 2);
+    EXPECT_EQ(expr.numCols(), 3);
+    EXPECT_EQ(expr(1, 2), 36);
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> result = expr;
+    EXPECT_EQ(result.numRows(), 2);
+    EXPECT_EQ(result.numCols(), 3);
+    EXPECT_EQ(result.size(), 6);
+    for(size_t i = 0; i < result.size(); ++i)
+        EXPECT_EQ(result.data()[i], arr[i]*arr[i]);
+}
+
+TEST(ExpressionTemplates, Scalars)
+{
+    int arr[] = {1, 2, 3, 4};
+    LimnoMatrixBase<int, 2, 2> a(arr);
+
+    LimnoMatrixBase<int, 2, 2> b = 2*a + 1;
+    EXPECT_EQ(b(0, 0), 3);
+    EXPECT_EQ(b(1, 1), 9);
+
+    LimnoMatrixBase<double, 2, 2> c = a/2.0;
+    EXPECT_EQ(c(0, 0), 0.5);
+
+    a += 1;
+    EXPECT_EQ(a(0, 0), 2);
+    a *= a;
+    EXPECT_EQ(a(1, 1), 25);
+    a -= b;
+    EXPECT_EQ(a(1, 1), 16);
+}
+
+TEST(ExpressionTemplates, MixedStaticDynamic)
+{
+    double arr[] = {1, 2, 3, 4};
+    LimnoMatrixBase<double, 2, 2> a(arr);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(arr, 2, 2);
+
+    auto expr = a + b;
+    static_assert(decltype(expr)::rows == 2 && decltype(expr)::cols == 2, "Expected static extents");
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> c = expr;
+    EXPECT_EQ(c(1, 0), 6);
+
+    LimnoMatrixBase<double, 2, 2> d;
+    d = b - a;
+    EXPECT_EQ(d(1, 1), 0);
+}
+
+TEST(ExpressionTemplates, ShapeMismatch)
+{
+    double arr[] = {1, 2, 3, 4, 5, 6};
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> a(arr, 2, 3);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(arr, 3, 2);
+    LimnoMatrixBase<double, 2, 2> c(arr);
+
+    EXPECT_THROW(a + b, std::invalid_argument);
+    EXPECT_THROW(a * c, std::invalid_argument);
+
+    LimnoMatrixBase<double, 2, 2> d;
+    EXPECT_THROW(d = a*2.0, std::invalid_argument);
+}
@@ -0,0 +1,204 @@
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/factorizations.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    using matrix = LimnoMatrixBase<double, DYNAMIC, DYNAMIC>;
+
+    matrix random(size_t r, size_t c, std::uint64_t seed = 1)
+    {
+        matrix m(r, c);
+        std::uint64_t state = seed*2654435761u + 88172645463325252ull;
+        for(size_t i = 0; i < r; ++i)
+            for(size_t j = 0; j < c; ++j)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                m(i, j) = static_cast<double>(state % 2001)/1000.0 - 1.0;
+            }
+        return m;
+    }
+
+    //b*b^T + n*I
+    matrix spd(size_t n)
+    {
+        const matrix b = random(n, n, 7);
+        matrix a = matmul(b, matrix(b.view().transpose()));
+        for(size_t i = 0; i < n; ++i)
+            a(i, i) += static_cast<double>(n);
+        return a;
+    }
+
+    template<typename _MatTp1, typename _MatTp2>
+    void expectNear(const _MatTp1& a, const _MatTp2& b, double tolerance)
+    {
+        ASSERT_EQ(a.numRows(), b.numRows());
+        ASSERT_EQ(a.numCols(), b.numCols());
+        for(size_t i = 0; i < a.numRows(); ++i)
+            for(size_t j = 0; j < a.numCols(); ++j)
+                ASSERT_NEAR(a(i, j), b(i, j), tolerance) << i << ", " << j;
+    }
+
+    //P^T*L*U from packed factors
+    matrix luProduct(const matrix& factors, const std::vector<size_t>& pivots)
+    {
+        const size_t n = factors.numRows();
+        matrix l(Limno::zeros, n, n), u(Limno::zeros, n, n);
+        for(size_t i = 0; i < n; ++i)
+        {
+            l(i, i) = 1.0;
+            for(size_t j = 0; j < n; ++j)
+                (j < i ? l(i, j) : u(i, j)) = factors(i, j);
+        }
+        matrix a = matmul(l, u);
+        for(size_t i = n; i-- > 0;)
+            for(size_t c = 0; c < n; ++c)
+                std::swap(a(i, c), a(pivots[i], c));
+        return a;
+    }
+}
+
+TEST(TestFactorizations, LU)
+{
+    for(size_t n : {1, 5, 63, 64, 65, 200})
+    {
+        const matrix a = random(n, n, n);
+        const auto [factors, pivots] = lu(a);
+        expectNear(luProduct(factors, pivots), a, 1e-10*n);
+
+        matrix parallel = a;
+        const std::vector<size_t> parallelPivots = luInPlace(Limno::par, parallel);
+        expectNear(luProduct(parallel, parallelPivots), a, 1e-10*n);
+
+        const matrix b = random(n, 3, 99);
+        matrix x = b;
+        luSolveInPlace(Limno::par, factors, pivots, x);
+        expectNear(matmul(a, x), b, 1e-9*n);
+        expectNear(solve(a, b), x, 1e-9*n);
+    }
+
+    matrix singular = random(70, 70);
+    for(size_t i = 0; i < 70; ++i)
+        singular(i, 69) = 0.0;
+    EXPECT_THROW(luInPlace(singular), std::invalid_argument);
+    matrix wide(3, 4);
+    EXPECT_THROW(luInPlace(wide), std::invalid_argument);
+}
+
+TEST(TestFactorizations, Cholesky)
+{
+    for(size_t n : {1, 2, 64, 65, 150})
+    {
+        const matrix a = spd(n);
+        const matrix l = cholesky(a);
+        for(size_t i = 0; i < n; ++i)
+            for(size_t j = i + 1; j < n; ++j)
+                ASSERT_EQ(l(i, j), 0.0);
+        expectNear(matmul(l, matrix(l.view().transpose())), a, 1e-9*n);
+
+        //Only the lower triangle is read
+        matrix lowerOnly = a;
+        for(size_t i = 0; i < n; ++i)
+            for(size_t j = i + 1; j < n; ++j)
+                lowerOnly(i, j) = -1e300;
+        choleskyInPlace(Limno::par, lowerOnly);
+        expectNear(lowerOnly, l, 1e-12*n);
+
+        const matrix b = random(n, 2, 5);
+        matrix x = b;
+        choleskySolveInPlace(Limno::par, l, x);
+        expectNear(matmul(a, x), b, 1e-9*n);
+    }
+
+    matrix indefinite = spd(80);
+    indefinite(70, 70) = -1.0;
+    EXPECT_THROW(choleskyInPlace(indefinite), std::invalid_argument);
+}
+
+TEST(TestFactorizations, QR)
+{
+    for(const auto& shape : {std::pair<size_t, size_t>{1, 1}, {70, 70}, {150, 100}, {40, 90}, {300, 65}})
+    {
+        const matrix a = random(shape.first, shape.second, shape.first);
+        const auto [factors, tau] = qr(Limno::par, a);
+        ASSERT_EQ(tau.size(), std::min(shape.first, shape.second));
+
+        //A = QR with Q orthogonal, so A^T A = R^T R
+        matrix r(Limno::zeros, tau.size(), shape.second);
+        for(size_t i = 0; i < r.numRows(); ++i)
+            for(size_t j = i; j < r.numCols(); ++j)
+                r(i, j) = factors(i, j);
+        expectNear(matmul(matrix(r.view().transpose()), r), matmul(matrix(a.view().transpose()), a), 1e-9*shape.first);
+
+        matrix sequential = a;
+        const std::vector<double> sequentialTau = qrInPlace(sequential);
+        for(size_t i = 0; i < tau.size(); ++i)
+            EXPECT_NEAR(sequentialTau[i], tau[i], 1e-12);
+        expectNear(sequential, factors, 1e-10);
+    }
+
+    //Least squares: the residual is orthogonal to the columns of A
+    const matrix a = random(200, 90, 3);
+    const matrix b = random(200, 2, 4);
+    const auto [factors, tau] = qr(a);
+    const matrix x = qrSolve(Limno::par, factors, tau, b);
+    ASSERT_EQ(x.numRows(), 90);
+    const matrix residual = matmul(a, x) - b;
+    expectNear(matmul(matrix(a.view().transpose()), residual), matrix(Limno::zeros, 90, 2), 1e-9);
+
+    matrix deficient = a;
+    for(size_t i = 0; i < 200; ++i)
+        deficient(i, 10) = 0.0;
+    const auto [deficientFactors, deficientTau] = qr(deficient);
+    EXPECT_THROW(qrSolve(deficientFactors, deficientTau, b), std::invalid_argument);
+}
+
+TEST(TestFactorizations, ViewsAndStaticShapes)
+{
+    //Factoring a block leaves the rest of the matrix alone
+    matrix big = random(120, 130, 11);
+    const matrix original = big;
+    const matrix block(big.view().block(10, 20, 100, 100));
+    const auto [factors, pivots] = lu(block);
+    EXPECT_EQ(luInPlace(big.view().block(10, 20, 100, 100)), pivots);
+    expectNear(big.view().block(10, 20, 100, 100), factors, 1e-12);
+    EXPECT_EQ(big(5, 5), original(5, 5));
+    EXPECT_EQ(big(115, 125), original(115, 125));
+
+    //Transposed and padded storage
+    const matrix a = spd(90);
+    matrix t = a;
+    choleskyInPlace(t.view().transpose());
+    expectNear(t.view().transpose(), cholesky(a), 1e-12);
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC, padded_allocator<double>> padded(a.view());
+    choleskyInPlace(Limno::par, padded);
+    expectNear(padded, cholesky(a), 1e-12);
+
+    LimnoMatrixBase<float, 12, 12> f;
+    LimnoMatrixBase<float, 12, 1> g;
+    for(size_t i = 0; i < 12; ++i)
+    {
+        for(size_t j = 0; j < 12; ++j)
+            f(i, j) = (i == j) ? 4.0f : 1.0f/static_cast<float>(i + j + 1);
+        g(i, 0) = static_cast<float>(i);
+    }
+    const auto y = solve(f, g);
+    static_assert(std::is_same_v<std::decay_t<decltype(y)>, LimnoMatrixBase<float, 12, 1>>);
+    const auto check = matmul(f, y);
+    for(size_t i = 0; i < 12; ++i)
+        EXPECT_NEAR(check(i, 0), g(i, 0), 1e-4f);
+}
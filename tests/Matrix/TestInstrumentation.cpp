@@ -0,0 +1,159 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/factorizations.hh"
+#include "Core/instrumentation.hh"
+#include "Core/matrix_batch.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/reductions.hh"
+#include "Core/transpose.hh"
+#include "config.hh"
+
+//Built as its own executable with LIMNO_INSTRUMENT set, so the kernels
+//instantiated here are not mixed with uninstrumented ones
+static_assert(LIMNO_INSTRUMENT, "Instrumentation tests need LIMNO_INSTRUMENT!");
+
+using namespace Limno::_detail;
+
+namespace
+{
+    std::vector<std::string> markerLog;
+
+    void logBegin(const char* operation)
+    {
+        markerLog.push_back(std::string{"begin "} + operation);
+    }
+
+    void logEnd(const char* operation)
+    {
+        markerLog.push_back(std::string{"end "} + operation);
+    }
+}
+
+TEST(TestInstrumentation, ShapeClasses)
+{
+    EXPECT_EQ(_shapeClass(0), shape_class::small);
+    EXPECT_EQ(_shapeClass(LIMNO_INSTRUMENT_SMALL_BYTES), shape_class::small);
+    EXPECT_EQ(_shapeClass(LIMNO_INSTRUMENT_SMALL_BYTES + 1), shape_class::medium);
+    EXPECT_EQ(_shapeClass(LIMNO_INSTRUMENT_LARGE_BYTES + 1), shape_class::large);
+}
+
+TEST(TestInstrumentation, Scopes)
+{
+    operation_profiler& profiler = operation_profiler::instance();
+    for(int i = 0; i < 3; ++i)
+        LIMNO_INSTRUMENT_OPERATION("TestScopes.op", 100, 64);
+    {
+        LIMNO_INSTRUMENT_OPERATION("TestScopes.op", 1e9, 1e9);
+    }
+    const auto stats = profiler.stats("TestScopes.op");
+    EXPECT_EQ(stats.calls, 4);
+    EXPECT_EQ(stats.flops, 300 + 1e9);
+    EXPECT_EQ(stats.bytes, 192 + 1e9);
+
+    const auto all = profiler.snapshot();
+    EXPECT_EQ((all.at({"TestScopes.op", shape_class::small}).calls), 3);
+    EXPECT_EQ((all.at({"TestScopes.op", shape_class::large}).calls), 1);
+    EXPECT_EQ((all.count({"TestScopes.op", shape_class::medium})), 0);
+
+    profiler.reset();
+    EXPECT_EQ(profiler.stats("TestScopes.op").calls, 0);
+}
+
+TEST(TestInstrumentation, Kernels)
+{
+    operation_profiler& profiler = operation_profiler::instance();
+    profiler.reset();
+    const LimnoMatrixBase<double, DYNAMIC, DYNAMIC> a(1.0, 64, 32);
+    const LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(2.0, 32, 16);
+    const auto c = matmul(a, b);
+    EXPECT_EQ(c(0, 0), 64.0);
+    EXPECT_DOUBLE_EQ(sum(c), 64.0*64*16);
+    const auto t = transpose(a);
+    EXPECT_EQ(t.numRows(), 32);
+
+    const auto gemm = profiler.stats("gemm");
+    EXPECT_EQ(gemm.calls, 1);
+    EXPECT_EQ(gemm.flops, 2.0*64*32*16);
+    EXPECT_EQ(gemm.bytes, (64*32 + 32*16 + 64*16)*sizeof(double));
+    EXPECT_DOUBLE_EQ(gemm.intensity(), gemm.flops/gemm.bytes);
+    EXPECT_EQ(profiler.stats("sum").calls, 1);
+    EXPECT_EQ(profiler.stats("transpose").calls, 1);
+
+    //Products of views go through the same hooks, and the hooks never throw
+    const auto v = matmul(a.view(), b.view());
+    EXPECT_EQ(v(0, 0), 64.0);
+    EXPECT_EQ(profiler.stats("gemm").calls, 2);
+    static_assert(noexcept(operation_scope{"TestKernels.op", 0, 0}));
+
+    //Nested operations are recorded as well, e.g. the GEMMs of a blocked
+    //factorization
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> spd(1.0, 200, 200);
+    for(size_t i = 0; i < 200; ++i)
+        spd(i, i) = 400.0;
+    choleskyInPlace(spd);
+    EXPECT_EQ(profiler.stats("cholesky").calls, 1);
+    EXPECT_GT(profiler.stats("gemm").calls, 1);
+
+    //Element-wise expressions are recorded where they are evaluated, with one
+    //FLOP per operation and element
+    profiler.reset();
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> e = a*2.0 + a;
+    e.assign(Limno::par, e - a);
+    EXPECT_EQ(e(0, 0), 2.0);
+    const auto elementwise = profiler.stats("elementwise");
+    EXPECT_EQ(elementwise.calls, 2);
+    EXPECT_EQ(elementwise.flops, 3.0*64*32);
+    EXPECT_EQ(elementwise.bytes, 6.0*64*32*sizeof(double));
+
+    matrix_batch<float, 2, 2> batch(Limno::zeros, 10);
+    batch += batch;
+    batch *= 2.0f;
+    EXPECT_EQ(profiler.stats("batchElementwise").calls, 2);
+}
+
+TEST(TestInstrumentation, Reports)
+{
+    operation_profiler& profiler = operation_profiler::instance();
+    profiler.reset();
+    {
+        LIMNO_INSTRUMENT_OPERATION("TestReports.op", 2048, 1024);
+    }
+    std::ostringstream table;
+    profiler.report(table);
+    EXPECT_NE(table.str().find("GFLOP/s"), std::string::npos);
+    EXPECT_NE(table.str().find("TestReports.op"), std::string::npos);
+
+    std::ostringstream json;
+    profiler.reportJson(json);
+    EXPECT_EQ(json.str().front(), '[');
+    EXPECT_NE(json.str().find("{\"operation\": \"TestReports.op\", \"shape\": \"small\", \"calls\": 1"),
+        std::string::npos);
+    EXPECT_NE(json.str().find("\"flops\": 2048, \"bytes\": 1024}"), std::string::npos);
+    //Operations with no calls since the last reset are left out
+    EXPECT_EQ(json.str().find("gemm"), std::string::npos);
+}
+
+TEST(TestInstrumentation, Markers)
+{
+    operation_profiler& profiler = operation_profiler::instance();
+    markerLog.clear();
+    profiler.setMarkers({logBegin, logEnd});
+    {
+        LIMNO_INSTRUMENT_OPERATION("TestMarkers.outer", 0, 0);
+        {
+            LIMNO_INSTRUMENT_OPERATION("TestMarkers.inner", 0, 0);
+        }
+    }
+    profiler.setMarkers({});
+    {
+        LIMNO_INSTRUMENT_OPERATION("TestMarkers.outer", 0, 0);
+    }
+    const std::vector<std::string> expected{"begin TestMarkers.outer", "begin TestMarkers.inner",
+        "end TestMarkers.inner", "end TestMarkers.outer"};
+    EXPECT_EQ(markerLog, expected);
+}
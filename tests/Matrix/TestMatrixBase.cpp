@@ -1,8 +1,12 @@
+#include <algorithm>
 #include <iterator>
+#include <numeric>
 #include <sstream>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "Core/aligned_allocator.hh"
 #include "Core/matrix_base.hh"
 #include "config.hh"
 
@@ -36,10 +40,13 @@ TEST(MatrixBase, Constructors)
     EXPECT_EQ(m4.size(), 0);
     EXPECT_TRUE(m4.empty());
 
+    //Storage is allocated but left uninitialized
     LimnoMatrixBase<double, DYNAMIC, DYNAMIC> n1(2, 3);
     EXPECT_EQ(n1.numRows(), 2);
     EXPECT_EQ(n1.numCols(), 3);
-    EXPECT_EQ(n1.size(), 0);
+    EXPECT_EQ(n1.size(), 6);
+    n1(1, 2) = 4.0;
+    EXPECT_EQ(n1(1, 2), 4.0);
 
     //Create non-empty matrix 
     //Fill with single value
@@ -127,6 +134,63 @@ TEST(MatrixBase, Constructors)
     EXPECT_EQ(q3(2, 4), 0);
 }
 
+TEST(MatrixBase, ConstructionModes)
+{
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> u(Limno::uninitialized, 3, 4);
+    EXPECT_EQ(u.numRows(), 3);
+    EXPECT_EQ(u.numCols(), 4);
+    EXPECT_EQ(u.size(), 12);
+    std::iota(u.begin(), u.end(), 0.0);
+    EXPECT_EQ(u(2, 3), 11.0);
+
+    LimnoMatrixBase<double, DYNAMIC, 4> z(Limno::zeros, 3, 4);
+    EXPECT_EQ(z.size(), 12);
+    for(double x : z)
+        EXPECT_EQ(x, 0.0);
+
+    LimnoMatrixBase<int, 2, 3> zs(Limno::zeros);
+    for(int x : zs)
+        EXPECT_EQ(x, 0);
+    LimnoMatrixBase<int, 2, 3> us(Limno::uninitialized);
+    EXPECT_EQ(us.size(), 6);
+
+    //Padded rows: only the elements are exposed and the padding stays zero
+    using padded_matrix = LimnoMatrixBase<float, DYNAMIC, DYNAMIC, padded_allocator<float>>;
+    padded_matrix pz(Limno::zeros, 3, 5);
+    EXPECT_EQ(pz.size(), 15);
+    for(float x : pz)
+        EXPECT_EQ(x, 0.0f);
+    for(size_t r = 0; r < 3; ++r)
+    {
+        for(size_t c = 5; c < pz.leadingDim(); ++c)
+            EXPECT_EQ(pz.data()[r*pz.leadingDim() + c], 0.0f);
+    }
+
+    //Bulk copies from random access ranges, including a short one
+    std::vector<float> values(13);
+    std::iota(values.begin(), values.end(), 1.0f);
+    padded_matrix pv(values.begin(), values.end(), 3, 5);
+    EXPECT_EQ(pv(1, 0), 6.0f);
+    EXPECT_EQ(pv(2, 2), 13.0f);
+    EXPECT_EQ(pv(2, 3), 0.0f);
+    EXPECT_EQ(pv(2, 4), 0.0f);
+
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> v(values.begin(), values.end(), 2, 5);
+    EXPECT_EQ(v(1, 4), 10.0f);
+
+    //Input iterators still work element by element
+    std::istringstream stream("1 2 3");
+    LimnoMatrixBase<int, DYNAMIC, DYNAMIC> s(std::istream_iterator<int>(stream), std::istream_iterator<int>(), 2, 2);
+    EXPECT_EQ(s(0, 0), 1);
+    EXPECT_EQ(s(1, 0), 3);
+    EXPECT_EQ(s(1, 1), 0);
+
+    //Empty outer container
+    std::vector<std::vector<int>> none;
+    LimnoMatrixBase<int, DYNAMIC, DYNAMIC> e(none);
+    EXPECT_TRUE(e.empty());
+}
+
 TEST(MatrixBase, Indexing)
 {
     std::vector<std::vector<double>> v = {
@@ -220,4 +284,71 @@ TEST(MatrixBase, RowIterators)
     auto it5 = m2.begin();
     *it5 = 5;
     EXPECT_EQ(m2(0, 0), 5);
-}
\ No newline at end of file
+}
+
+TEST(MatrixBase, ConstIterators)
+{
+    std::vector<std::vector<int>> c = {
+        {1, 2, 3}, 
+        {4, 5, 6}
+    };
+
+    const LimnoMatrixBase<int, 2, 3> m1(c);
+    #if __cplusplus > 201703L
+    static_assert(std::contiguous_iterator<decltype(m1.cbegin())>, "Expected contiguous iterator");
+    #endif
+    std::vector<int> visited(m1.begin(), m1.end());
+    EXPECT_EQ(visited, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(m1.cend() - m1.cbegin(), 6);
+    EXPECT_EQ(m1.cbegin()[4], 5);
+
+    LimnoMatrixBase<int, 2, 3> m2(c);
+    LimnoMatrixBase<int, 2, 3>::const_iterator it = m2.begin();
+    EXPECT_TRUE(it + 6 == m2.cend());
+    EXPECT_TRUE(it < m2.cend());
+    auto it2 = it++;
+    EXPECT_EQ(*it2, 1);
+    EXPECT_EQ(*it, 2);
+}
+
+TEST(MatrixBase, ColumnIterators)
+{
+    std::vector<std::vector<int>> c = {
+        {1, 2, 3}, 
+        {4, 5, 6}
+    };
+
+    LimnoMatrixBase<int, 2, 3> m1(c);
+    std::vector<int> visited(m1.columnBegin(), m1.columnEnd());
+    EXPECT_EQ(visited, (std::vector<int>{1, 4, 2, 5, 3, 6}));
+
+    auto it = m1.columnBegin();
+    EXPECT_EQ(it.innerStride(), 3);
+    EXPECT_EQ(it.outerStride(), 1);
+    it += 3;
+    EXPECT_EQ(*it, 5);
+    --it;
+    EXPECT_EQ(*it, 2);
+    EXPECT_EQ(it[3], 6);
+    EXPECT_EQ(m1.columnEnd() - m1.columnBegin(), 6);
+    *it = 10;
+    EXPECT_EQ(m1(0, 1), 10);
+
+    const auto& m2 = m1;
+    EXPECT_EQ(*(m2.ccolumnEnd() - 1), 6);
+    EXPECT_TRUE(std::is_sorted(m2.ccolumnBegin(), m2.ccolumnBegin() + 2));
+
+    //Copying a column walk is a tiled transpose
+    std::vector<double> values(37*53);
+    std::iota(values.begin(), values.end(), 0.0);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m3(values.begin(), values.end(), 37, 53);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> t(m3.columnBegin(), m3.columnEnd(), 53, 37);
+    for(size_t r = 0; r < 53; ++r)
+        for(size_t col = 0; col < 37; ++col)
+            EXPECT_EQ(t(r, col), m3(col, r));
+
+    //Partial walks starting mid-column
+    std::vector<double> partial(40);
+    _stridedCopy(m3.columnBegin() + 5, m3.columnBegin() + 45, partial.begin());
+    EXPECT_TRUE(std::equal(partial.begin(), partial.end(), m3.columnBegin() + 5));
+}
@@ -0,0 +1,175 @@
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "Core/matrix_batch.hh"
+#include "Core/matrix_product.hh"
+#include "Core/small_matrix.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    //Well conditioned matrices that differ from one batch entry to the next
+    template<typename _Tp, int _Nrows, int _Ncols>
+    matrix_batch<_Tp, _Nrows, _Ncols> pattern(size_t count, size_t seed = 0)
+    {
+        matrix_batch<_Tp, _Nrows, _Ncols> batch(count);
+        for(size_t b = 0; b < count; ++b)
+            for(size_t r = 0; r < _Nrows; ++r)
+                for(size_t c = 0; c < _Ncols; ++c)
+                    batch(b, r, c) = static_cast<_Tp>(((b + seed)*7 + r*13 + c*5) % 11) - _Tp(5) + (r == c ? _Tp(12) : _Tp(0));
+        return batch;
+    }
+
+    template<typename _Tp, int _Nrows, int _Ncols, typename _AllocTp>
+    void expectNear(const matrix_batch<_Tp, _Nrows, _Ncols, _AllocTp>& batch, size_t b,
+        const LimnoMatrixBase<_Tp, _Nrows, _Ncols>& expected, _Tp tolerance)
+    {
+        for(size_t r = 0; r < _Nrows; ++r)
+            for(size_t c = 0; c < _Ncols; ++c)
+                ASSERT_NEAR(batch(b, r, c), expected(r, c), tolerance) << b << ": " << r << ", " << c;
+    }
+
+    //Every kernel the host supports against one matrix at a time, on batch
+    //sizes that leave the last pack partly filled
+    template<typename _Tp, int _N, int _K>
+    void checkKernels(_Tp tolerance)
+    {
+        constexpr size_t lanes = _batchLanes<_Tp>;
+        for(int isa = 0; isa <= static_cast<int>(simdIsa()); ++isa)
+        {
+            const auto product = _batchProductFor<_Tp, _N, _N, _K>(static_cast<_SimdIsa>(isa));
+            const auto solver = _batchSolveFor<_Tp, _N, _K>(static_cast<_SimdIsa>(isa));
+            const auto inverter = _batchInverseFor<_Tp, _N>(static_cast<_SimdIsa>(isa));
+            for(size_t count : {size_t{1}, lanes, 2*lanes + 3})
+            {
+                const auto a = pattern<_Tp, _N, _N>(count);
+                const auto b = pattern<_Tp, _N, _K>(count, 3);
+                matrix_batch<_Tp, _N, _K> c(count);
+                product(a.data(), b.data(), c.data(), a.packs());
+                matrix_batch<_Tp, _N, _K> x(count);
+                ASSERT_TRUE(solver(a.data(), b.data(), x.data(), a.packs(), count));
+                matrix_batch<_Tp, _N, _N> inv(count);
+                ASSERT_TRUE(inverter(a.data(), inv.data(), a.packs(), count));
+                for(size_t i = 0; i < count; ++i)
+                {
+                    expectNear(c, i, LimnoMatrixBase<_Tp, _N, _K>(matmul(a.get(i), b.get(i))), tolerance);
+                    expectNear(x, i, solve(a.get(i), b.get(i)), tolerance);
+                    expectNear(inv, i, inverse(a.get(i)), tolerance);
+                }
+            }
+        }
+    }
+}
+
+TEST(TestMatrixBatch, Layout)
+{
+    matrix_batch<double, 2, 3> batch(Limno::zeros, 11);
+    EXPECT_EQ(batch.size(), 11);
+    EXPECT_EQ(batch.packs(), 2);
+    batch(9, 1, 2) = 4.0;
+    EXPECT_EQ(batch.data()[batch.packSize + 5*batch.lanes + 1], 4.0);
+
+    LimnoMatrixBase<double, 2, 3> m;
+    for(size_t i = 0; i < 6; ++i)
+        m(i/3, i % 3) = static_cast<double>(i);
+    batch.set(3, m);
+    expectNear(batch, 3, m, 0.0);
+
+    std::vector<LimnoMatrixBase<double, 2, 3>> matrices(5, m);
+    matrix_batch<double, 2, 3> copies(matrices.begin(), matrices.end());
+    EXPECT_EQ(copies.size(), 5);
+    expectNear(copies, 4, m, 0.0);
+    for(size_t i = 0; i < 8; ++i)
+        copies.push_back(m*2.0);
+    EXPECT_EQ(copies.size(), 13);
+    EXPECT_EQ(copies.packs(), 2);
+    EXPECT_EQ(copies(12, 1, 2), 10.0);
+}
+
+TEST(TestMatrixBatch, ElementWise)
+{
+    const auto a = pattern<float, 3, 3>(37);
+    const auto b = pattern<float, 3, 3>(37, 5);
+    const auto sum = a + b;
+    const auto difference = a - b;
+    const auto scaled = 2.0f*a/4.0f;
+    for(size_t i = 0; i < a.size(); ++i)
+    {
+        using matrix_type = LimnoMatrixBase<float, 3, 3>;
+        expectNear(sum, i, matrix_type(a.get(i) + b.get(i)), 0.0f);
+        expectNear(difference, i, matrix_type(a.get(i) - b.get(i)), 0.0f);
+        expectNear(scaled, i, matrix_type(a.get(i)*0.5f), 0.0f);
+    }
+    EXPECT_THROW(a + (pattern<float, 3, 3>(36)), std::invalid_argument);
+}
+
+TEST(TestMatrixBatch, Kernels)
+{
+    checkKernels<double, 2, 1>(1e-12);
+    checkKernels<double, 3, 3>(1e-12);
+    checkKernels<double, 6, 1>(1e-12);
+    checkKernels<float, 4, 2>(1e-4f);
+    checkKernels<float, 8, 8>(1e-4f);
+}
+
+TEST(TestMatrixBatch, Products)
+{
+    const auto a = pattern<double, 3, 4>(100);
+    const auto b = pattern<double, 4, 2>(100, 1);
+    const auto c = matmul(a, b);
+    const auto parallel = matmul(Limno::par, a, b);
+    for(size_t i = 0; i < a.size(); ++i)
+    {
+        expectNear(c, i, LimnoMatrixBase<double, 3, 2>(matmul(a.get(i), b.get(i))), 1e-12);
+        expectNear(parallel, i, c.get(i), 0.0);
+    }
+    EXPECT_THROW(matmul(a, pattern<double, 4, 2>(99)), std::invalid_argument);
+
+    const auto integers = pattern<int, 2, 2>(21);
+    const auto squares = matmul(Limno::par, integers, integers);
+    for(size_t i = 0; i < integers.size(); ++i)
+        expectNear(squares, i, LimnoMatrixBase<int, 2, 2>(matmul(integers.get(i), integers.get(i))), 0);
+}
+
+TEST(TestMatrixBatch, InverseAndSolve)
+{
+    const auto a = pattern<double, 6, 6>(1000);
+    const auto b = pattern<double, 6, 1>(1000, 2);
+    const auto inv = inverse(a);
+    const auto x = solve(Limno::par, a, b);
+    const auto parallelInv = inverse(Limno::par, a);
+    for(size_t i = 0; i < a.size(); ++i)
+    {
+        expectNear(inv, i, inverse(a.get(i)), 1e-12);
+        expectNear(x, i, solve(a.get(i), b.get(i)), 1e-12);
+        expectNear(parallelInv, i, inv.get(i), 0.0);
+    }
+
+    //Pivoting is done per matrix
+    matrix_batch<float, 2, 2> swapped(Limno::zeros, 3);
+    for(size_t i = 0; i < 3; ++i)
+    {
+        swapped(i, 0, 1) = 1.0f;
+        swapped(i, 1, 0) = static_cast<float>(i + 1);
+    }
+    swapped(1, 0, 0) = 3.0f;
+    const auto swappedInv = inverse(swapped);
+    for(size_t i = 0; i < 3; ++i)
+        expectNear(swappedInv, i, inverse(swapped.get(i)), 1e-6f);
+
+    //One singular matrix fails the whole batch; zero padding lanes don't
+    auto singular = pattern<double, 3, 3>(5);
+    for(size_t c = 0; c < 3; ++c)
+        singular(4, 2, c) = 0.0;
+    EXPECT_THROW(inverse(singular), std::invalid_argument);
+    EXPECT_NO_THROW(inverse(pattern<double, 3, 3>(5)));
+    EXPECT_THROW(solve(a, pattern<double, 6, 1>(3)), std::invalid_argument);
+    EXPECT_TRUE(inverse(matrix_batch<double, 3, 3>()).empty());
+}
@@ -0,0 +1,136 @@
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/aligned_allocator.hh"
+#include "Core/matrix_product.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    //Reference triple loop
+    template<typename _MatTp1, typename _MatTp2>
+    std::vector<double> naiveProduct(const _MatTp1& a, const _MatTp2& b)
+    {
+        std::vector<double> c(a.numRows()*b.numCols(), 0.0);
+        for(size_t i = 0; i < a.numRows(); ++i)
+            for(size_t j = 0; j < b.numCols(); ++j)
+                for(size_t k = 0; k < a.numCols(); ++k)
+                    c[i*b.numCols() + j] += a(i, k)*b(k, j);
+        return c;
+    }
+
+    template<typename _MatTp>
+    void fillPattern(_MatTp& m)
+    {
+        for(size_t i = 0; i < m.size(); ++i)
+            m.data()[i] = static_cast<double>((i*7) % 13) - 6.0;
+    }
+}
+
+TEST(MatrixProduct, StaticShapes)
+{
+    double arr1[] = {1, 2, 3, 4, 5, 6};
+    double arr2[] = {7, 8, 9, 10, 11, 12};
+    LimnoMatrixBase<double, 2, 3> a(arr1);
+    LimnoMatrixBase<double, 3, 2> b(arr2);
+
+    LimnoMatrixBase<double, 2, 2> c = matmul(a, b);
+    EXPECT_EQ(c(0, 0), 58);
+    EXPECT_EQ(c(0, 1), 64);
+    EXPECT_EQ(c(1, 0), 139);
+    EXPECT_EQ(c(1, 1), 154);
+
+    float identity[] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    float values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    LimnoMatrixBase<float, 4, 4> i4(identity);
+    LimnoMatrixBase<float, 4, 4> m4(values);
+    LimnoMatrixBase<float, 4, 4> r4 = matmul(i4, m4);
+    for(size_t i = 0; i < r4.size(); ++i)
+        EXPECT_EQ(r4.data()[i], values[i]);
+}
+
+TEST(MatrixProduct, DynamicShapes)
+{
+    //Crosses the MC and KC block boundaries and leaves partial register tiles
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> a(0.0, 70, 300);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(0.0, 300, 45);
+    fillPattern(a);
+    fillPattern(b);
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> c = matmul(a, b);
+    EXPECT_EQ(c.numRows(), 70);
+    EXPECT_EQ(c.numCols(), 45);
+
+    std::vector<double> expected = naiveProduct(a, b);
+    for(size_t i = 0; i < expected.size(); ++i)
+        EXPECT_DOUBLE_EQ(c.data()[i], expected[i]);
+
+    //Small dynamic product
+    double arr[] = {1, 2, 3, 4};
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> d(arr, 2, 2);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> e = matmul(d, d);
+    EXPECT_EQ(e(0, 0), 7);
+    EXPECT_EQ(e(1, 1), 22);
+}
+
+TEST(MatrixProduct, MixedShapes)
+{
+    double arr[] = {1, 2, 3, 4, 5, 6};
+    LimnoMatrixBase<double, 2, 3> a(arr);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(arr, 3, 2);
+
+    LimnoMatrixBase<double, 2, DYNAMIC> c = matmul(a, b);
+    EXPECT_EQ(c.numRows(), 2);
+    EXPECT_EQ(c.numCols(), 2);
+    EXPECT_EQ(c(1, 1), 64);
+}
+
+TEST(MatrixProduct, ShapeMismatch)
+{
+    double arr[] = {1, 2, 3, 4, 5, 6};
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> a(arr, 2, 3);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(arr, 2, 3);
+    EXPECT_THROW(matmul(a, b), std::invalid_argument);
+}
+
+TEST(MatrixProduct, StaticTimesDynamic)
+{
+    //A static lhs with a dynamic inner extent on rhs is checked at runtime
+    double arr[] = {1, 0, 0, 0, 1, 0};
+    LimnoMatrixBase<double, 2, 3> a(arr);
+    LimnoMatrixBase<double, DYNAMIC, 3> shortRhs(1.0, 1, 3);
+    EXPECT_THROW(matmul(a, shortRhs), std::invalid_argument);
+
+    //and padded operands go through their leading dimension
+    std::vector<double> ones(9, 1.0);
+    LimnoMatrixBase<double, DYNAMIC, 3, padded_allocator<double>> padded(ones.begin(), ones.end(), 3, 3);
+    static_assert(decltype(padded)::isPadded);
+    const auto c = matmul(a, padded);
+    for(size_t r = 0; r < 2; ++r)
+        for(size_t col = 0; col < 3; ++col)
+            EXPECT_EQ(c(r, col), 1.0);
+}
+
+TEST(MatrixProduct, Aliasing)
+{
+    //The result is overwritten while the operands are still read, so it may
+    //not share their storage
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> a(1.0, 3, 3);
+    const LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(2.0, 3, 3);
+    EXPECT_THROW(matmul(a, b, a), std::invalid_argument);
+    EXPECT_THROW(matmul(Limno::par, b, a, a), std::invalid_argument);
+    EXPECT_THROW(matmul(b.view(), a.view().transpose(), a.view()), std::invalid_argument);
+    LimnoMatrixBase<double, 2, 2> s(1.0);
+    EXPECT_THROW(matmul(s, s, s), std::invalid_argument);
+    EXPECT_EQ(a(0, 0), 1.0);
+
+    //Disjoint blocks of one matrix are fine
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m(1.0, 4, 2);
+    matmul(m.view().block(0, 0, 2, 2), b.view().block(0, 0, 2, 2), m.view().block(2, 0, 2, 2));
+    EXPECT_EQ(m(3, 1), 4.0);
+    EXPECT_EQ(m(0, 0), 1.0);
+}
@@ -0,0 +1,176 @@
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/matrix_view.hh"
+#include "Core/reductions.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::iota;
+
+TEST(MatrixView, Slicing)
+{
+    auto m = iota(4, 5);
+
+    auto r = m.row(2);
+    EXPECT_EQ(r.numRows(), 1);
+    EXPECT_EQ(r.numCols(), 5);
+    EXPECT_EQ(r(0, 3), 13);
+    EXPECT_EQ(r.data(), &m(2, 0));
+
+    auto c = m.col(1);
+    EXPECT_EQ(c.numRows(), 4);
+    EXPECT_EQ(c.numCols(), 1);
+    EXPECT_EQ(c.rowStride(), 5);
+    EXPECT_EQ(c(3, 0), 16);
+
+    auto b = m.block(1, 2, 2, 3);
+    EXPECT_EQ(b(0, 0), 7);
+    EXPECT_EQ(b(1, 2), 14);
+    EXPECT_FALSE(b.isContiguous());
+
+    auto s = m.slice(0, 4, 2, 0, 5, 2);
+    EXPECT_EQ(s.numRows(), 2);
+    EXPECT_EQ(s.numCols(), 3);
+    EXPECT_EQ(s(1, 2), 14);
+
+    auto t = m.view().transpose();
+    EXPECT_EQ(t.numRows(), 5);
+    EXPECT_EQ(t.numCols(), 4);
+    EXPECT_EQ(t(4, 3), m(3, 4));
+    EXPECT_EQ(t.transpose()(1, 2), m(1, 2));
+
+    std::vector<double> visited(b.begin(), b.end());
+    EXPECT_EQ(visited, (std::vector<double>{7, 8, 9, 12, 13, 14}));
+    std::vector<double> columnOrder(b.columnBegin(), b.columnEnd());
+    EXPECT_EQ(columnOrder, (std::vector<double>{7, 12, 8, 13, 9, 14}));
+
+    EXPECT_THROW(m.block(3, 0, 2, 1), std::out_of_range);
+    //Offsets large enough to wrap around are still out of range
+    constexpr size_t huge = std::numeric_limits<size_t>::max();
+    EXPECT_THROW(m.block(huge, 0, 2, 1), std::out_of_range);
+    EXPECT_THROW(m.block(0, 1, 1, huge), std::out_of_range);
+    EXPECT_THROW(m.slice(0, 6, 1, 0, 5, 1), std::out_of_range);
+    EXPECT_THROW(m.slice(0, 4, 0, 0, 5, 1), std::invalid_argument);
+}
+
+TEST(MatrixView, WriteThrough)
+{
+    auto m = iota(3, 4);
+    m.col(0).fill(-1);
+    EXPECT_EQ(m(2, 0), -1);
+
+    auto b = m.block(0, 1, 2, 2);
+    b += 100;
+    EXPECT_EQ(m(0, 1), 101);
+    EXPECT_EQ(m(1, 2), 106);
+    EXPECT_EQ(m(2, 2), 10);
+
+    b = b*2;
+    EXPECT_EQ(m(0, 1), 202);
+
+    m.row(2).assign(m.row(0));
+    EXPECT_EQ(m(2, 1), 202);
+    EXPECT_THROW(m.row(0).assign(m.col(0)), std::invalid_argument);
+
+    //Copying out of a view
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> copy(m.block(1, 1, 2, 3));
+    EXPECT_EQ(copy.numRows(), 2);
+    EXPECT_EQ(copy.numCols(), 3);
+    EXPECT_EQ(copy(0, 0), m(1, 1));
+    copy(0, 0) = 0;
+    EXPECT_NE(m(1, 1), 0);
+
+    //Assigning a view of the matrix's own storage
+    auto square = iota(3, 3);
+    square = square.view().transpose();
+    EXPECT_EQ(square(0, 1), 3);
+    EXPECT_EQ(square(1, 0), 1);
+
+    const auto& constRef = square;
+    LimnoMatrixView<const double> readOnly = constRef.row(1);
+    EXPECT_EQ(readOnly(0, 0), 1);
+}
+
+TEST(MatrixView, Expressions)
+{
+    auto m = iota(4, 4);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> sym = m.view() + m.view().transpose();
+    for(size_t r = 0; r < 4; ++r)
+        for(size_t c = 0; c < 4; ++c)
+            EXPECT_EQ(sym(r, c), m(r, c) + m(c, r));
+
+    LimnoMatrixBase<double, 2, 2> fixed = m.block(2, 2, 2, 2) - 10;
+    EXPECT_EQ(fixed(1, 1), 5);
+
+    //Expressions reading the destination through a view in another layout
+    auto a = iota(3, 3);
+    a = a + a.view().transpose();
+    for(size_t r = 0; r < 3; ++r)
+        for(size_t c = 0; c < 3; ++c)
+            EXPECT_EQ(a(r, c), 4.0*(r + c));
+    auto b = iota(3, 3);
+    b += b.view().transpose();
+    b.assign(Limno::par, b - b.view().transpose()*0.5);
+    for(size_t r = 0; r < 3; ++r)
+        for(size_t c = 0; c < 3; ++c)
+            EXPECT_EQ(b(r, c), 2.0*(r + c));
+    auto s = iota<double, 2, 2>();
+    s -= s.view().transpose();
+    EXPECT_EQ(s(0, 1), -1);
+    EXPECT_EQ(s(1, 0), 1);
+}
+
+TEST(MatrixView, Product)
+{
+    auto a = iota(60, 70);
+    auto b = iota(60, 50);
+
+    //a^T*b without materializing the transpose
+    auto product = matmul(a.view().transpose(), b.view());
+    ASSERT_EQ(product.numRows(), 70);
+    ASSERT_EQ(product.numCols(), 50);
+    for(size_t i = 0; i < 70; i += 7)
+    {
+        for(size_t j = 0; j < 50; j += 3)
+        {
+            double expected = 0;
+            for(size_t k = 0; k < 60; ++k)
+                expected += a(k, i)*b(k, j);
+            EXPECT_DOUBLE_EQ(product(i, j), expected);
+        }
+    }
+
+    //Writing into a block of a larger matrix
+    auto small = iota(2, 3);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> out(0.0, 4, 4);
+    matmul(small.view(), small.view().transpose(), out.block(1, 1, 2, 2));
+    EXPECT_EQ(out(0, 0), 0);
+    EXPECT_EQ(out(1, 1), 5);
+    EXPECT_EQ(out(1, 2), 14);
+    EXPECT_EQ(out(2, 2), 50);
+    EXPECT_THROW(matmul(small.view(), small.view(), out.view()), std::invalid_argument);
+}
+
+TEST(MatrixView, Reductions)
+{
+    auto m = iota(5, 6);
+    EXPECT_EQ(sum(m.view()), sum(m));
+    EXPECT_EQ(sum(m.row(1)), 6 + 7 + 8 + 9 + 10 + 11);
+    EXPECT_EQ(sum(m.col(2)), 2 + 8 + 14 + 20 + 26);
+    EXPECT_EQ(sum(m.slice(0, 5, 2, 0, 6, 3)), 0 + 3 + 12 + 15 + 24 + 27);
+    EXPECT_EQ(max(m.block(1, 1, 2, 2)), 14);
+    EXPECT_EQ(min(m.view().transpose()), 0);
+    EXPECT_EQ(dot(m.row(0), m.row(1)), dot(m.row(1), m.row(0)));
+    EXPECT_EQ(dot(m.col(0), m.col(0)), 0 + 36 + 144 + 324 + 576);
+    EXPECT_DOUBLE_EQ(norm(m.view()), norm(m));
+    EXPECT_THROW(max(m.block(0, 0, 0, 0)), std::invalid_argument);
+}
@@ -0,0 +1,126 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/aligned_allocator.hh"
+#include "Core/execution.hh"
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/reductions.hh"
+#include "Core/thread_pool.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::pattern;
+
+TEST(Parallel, ThreadPool)
+{
+    _ThreadPool pool{4};
+    EXPECT_EQ(pool.size(), 4);
+
+    std::vector<std::atomic<int>> visits(1000);
+    pool.parallelFor(visits.size(), [&](size_t i) { ++visits[i]; });
+    for(const auto& count : visits)
+        EXPECT_EQ(count.load(), 1);
+
+    //Nested calls run on the same pool without deadlocking
+    std::atomic<int> total{0};
+    pool.parallelFor(8, [&](size_t) 
+    {
+        pool.parallelFor(8, [&](size_t) { ++total; });
+    });
+    EXPECT_EQ(total.load(), 64);
+
+    EXPECT_THROW(pool.parallelFor(16, [](size_t i) 
+    { 
+        if (i == 7) 
+            throw std::runtime_error("task failed"); 
+    }), std::runtime_error);
+
+    //The pool is still usable after a failed job
+    std::atomic<int> after{0};
+    pool.parallelFor(16, [&](size_t) { ++after; });
+    EXPECT_EQ(after.load(), 16);
+}
+
+TEST(Parallel, Partition)
+{
+    const _Partition p = _partition(1000, 16, 5, 100);
+    size_t expected = 0;
+    for(size_t i = 0; i < p.count(); ++i)
+    {
+        EXPECT_EQ(p.begin(i), expected);
+        if (i > 0 && p.end(i) != 1000)
+        {
+            EXPECT_EQ((p.end(i) - 5) % 16, 0);
+        }
+        expected = p.end(i);
+    }
+    EXPECT_EQ(expected, 1000);
+    EXPECT_EQ(_partition(0, 16).count(), 0);
+}
+
+TEST(Parallel, ElementWise)
+{
+    auto a = pattern(301, 257);
+    auto b = pattern(301, 257, 1);
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> expected = a*b + 1.0;
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> actual;
+    actual.assign(Limno::par, a*b + 1.0);
+    ASSERT_EQ(actual.numRows(), 301);
+    for(size_t r = 0; r < a.numRows(); ++r)
+        for(size_t c = 0; c < a.numCols(); ++c)
+            EXPECT_EQ(actual(r, c), expected(r, c));
+
+    //SIMD fast path and padded storage
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> sum;
+    sum.assign(Limno::par, a + b);
+    EXPECT_EQ(sum(300, 256), a(300, 256) + b(300, 256));
+
+    auto padded = pattern<double, DYNAMIC, DYNAMIC, padded_allocator<double>>(301, 257);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC, padded_allocator<double>> doubled;
+    doubled.assign(Limno::par, padded + padded);
+    EXPECT_EQ(doubled(300, 256), 2*padded(300, 256));
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> sequential;
+    sequential.assign(Limno::seq, a - b);
+    EXPECT_EQ(sequential(5, 5), a(5, 5) - b(5, 5));
+}
+
+TEST(Parallel, Reductions)
+{
+    auto a = pattern(513, 129);
+    auto padded = pattern<double, DYNAMIC, DYNAMIC, padded_allocator<double>>(513, 129);
+    EXPECT_DOUBLE_EQ(sum(Limno::par, a), sum(a));
+    EXPECT_DOUBLE_EQ(sum(Limno::par, padded), sum(a));
+    EXPECT_EQ(max(Limno::par, a), 11);
+    EXPECT_EQ(min(Limno::par, padded), -11);
+    EXPECT_DOUBLE_EQ(norm(Limno::par, a), norm(a));
+    EXPECT_DOUBLE_EQ(dot(Limno::par, a, padded), dot(a, a));
+    EXPECT_DOUBLE_EQ(sum(Limno::seq, a), sum(a));
+}
+
+TEST(Parallel, Product)
+{
+    auto a = pattern(257, 190);
+    auto b = pattern(190, 131, 2);
+    auto expected = matmul(a, b);
+    auto actual = matmul(Limno::par, a, b);
+    ASSERT_EQ(actual.numRows(), 257);
+    ASSERT_EQ(actual.numCols(), 131);
+    for(size_t r = 0; r < actual.numRows(); ++r)
+        for(size_t c = 0; c < actual.numCols(); ++c)
+            EXPECT_DOUBLE_EQ(actual(r, c), expected(r, c));
+
+    auto transposed = matmul(Limno::par, b.view().transpose(), a.view().transpose());
+    EXPECT_DOUBLE_EQ(transposed(130, 256), expected(256, 130));
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> wrong(0.0, 3, 3);
+    EXPECT_THROW(matmul(Limno::par, a, b, wrong), std::invalid_argument);
+}
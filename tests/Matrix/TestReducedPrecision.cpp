@@ -0,0 +1,306 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "Core/matrix_product.hh"
+#include "Core/reduced_precision.hh"
+#include "Core/reductions.hh"
+#include "config.hh"
+#include "concepts.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::pattern;
+
+namespace
+{
+    //Every conversion kernel the host supports against the scalar one, on
+    //lengths with and without a tail
+    template<typename _FormatTp>
+    void checkConversionKernels()
+    {
+        std::vector<float> values;
+        for(size_t i = 0; i < 1003; ++i)
+            values.push_back(std::ldexp(static_cast<float>(i % 97) - 48.5f, static_cast<int>(i % 41) - 20));
+        values.push_back(std::numeric_limits<float>::infinity());
+        values.push_back(std::numeric_limits<float>::quiet_NaN());
+        values.push_back(1e-7f);
+        values.push_back(-1e30f);
+        for(int isa = 0; isa <= static_cast<int>(simdIsa()); ++isa)
+        {
+            const auto kernels = _reducedKernelsFor<_FormatTp>(static_cast<_SimdIsa>(isa));
+            std::vector<_ReducedFloat<_FormatTp>> narrow(values.size());
+            kernels.narrow(values.data(), narrow.data(), values.size());
+            std::vector<float> wide(values.size());
+            kernels.widen(narrow.data(), wide.data(), values.size());
+            for(size_t i = 0; i < values.size(); ++i)
+            {
+                const _ReducedFloat<_FormatTp> expected = values[i];
+                ASSERT_EQ(narrow[i].bits(), expected.bits()) << isa << ": " << values[i];
+                if (std::isnan(values[i]))
+                {
+                    ASSERT_TRUE(std::isnan(wide[i]));
+                }
+                else
+                {
+                    ASSERT_EQ(wide[i], static_cast<float>(expected)) << isa << ": " << values[i];
+                }
+            }
+        }
+    }
+}
+
+TEST(TestReducedPrecision, Float16Conversions)
+{
+    EXPECT_EQ(float16(1.0f).bits(), 0x3C00);
+    EXPECT_EQ(float16(-2.0f).bits(), 0xC000);
+    EXPECT_EQ(float16(65504.0f).bits(), 0x7BFF);
+    EXPECT_EQ(float16(65520.0f).bits(), 0x7C00);
+    EXPECT_EQ(float16(1e10f).bits(), 0x7C00);
+    EXPECT_EQ(float16(-std::numeric_limits<float>::infinity()).bits(), 0xFC00);
+    EXPECT_TRUE(std::isnan(static_cast<float>(float16(std::numeric_limits<float>::quiet_NaN()))));
+    EXPECT_EQ(static_cast<float>(float16::fromBits(0x0001)), std::ldexp(1.0f, -24));
+    EXPECT_EQ(float16(std::ldexp(1.0f, -24)).bits(), 0x0001);
+    EXPECT_EQ(float16(std::ldexp(1.0f, -26)).bits(), 0x0000);
+    //Ties round to even
+    EXPECT_EQ(float16(1.0f + std::ldexp(1.0f, -11)).bits(), 0x3C00);
+    EXPECT_EQ(float16(1.0f + 3*std::ldexp(1.0f, -11)).bits(), 0x3C02);
+
+    //Every half converts to float and back unchanged
+    for(std::uint32_t bits = 0; bits < 0x10000; ++bits)
+    {
+        const float16 h = float16::fromBits(static_cast<std::uint16_t>(bits));
+        if (!std::isnan(static_cast<float>(h)))
+        {
+            ASSERT_EQ(float16(static_cast<float>(h)).bits(), bits);
+        }
+    }
+}
+
+TEST(TestReducedPrecision, Bfloat16Conversions)
+{
+    EXPECT_EQ(bfloat16(1.0f).bits(), 0x3F80);
+    EXPECT_EQ(bfloat16(-0.0f).bits(), 0x8000);
+    EXPECT_EQ(bfloat16(std::numeric_limits<float>::infinity()).bits(), 0x7F80);
+    EXPECT_TRUE(std::isnan(static_cast<float>(bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+    EXPECT_EQ(bfloat16(1.0f + std::ldexp(1.0f, -8)).bits(), 0x3F80);
+    EXPECT_EQ(bfloat16(1.0f + 3*std::ldexp(1.0f, -8)).bits(), 0x3F82);
+
+    bfloat16 x = 1.5f;
+    x += 0.5f;
+    x *= 3.0f;
+    EXPECT_EQ(static_cast<float>(x), 6.0f);
+}
+
+TEST(TestReducedPrecision, ConversionKernels)
+{
+    checkConversionKernels<_Binary16>();
+    checkConversionKernels<_Bfloat16>();
+}
+
+#if __cplusplus > 201703L
+TEST(TestReducedPrecision, NumberConcept)
+{
+    EXPECT_TRUE(Limno::Number<float16>);
+    EXPECT_TRUE(Limno::Number<bfloat16>);
+    EXPECT_TRUE(Limno::Number<std::int8_t>);
+    EXPECT_FALSE(Limno::Number<char>);
+}
+#endif
+
+TEST(TestReducedPrecision, Matrices)
+{
+    const auto a = pattern<float>(33, 70);
+    const auto h = convert<float16>(a);
+    const auto b = convert<bfloat16>(Limno::par, a);
+    ASSERT_EQ(h.numRows(), 33);
+    ASSERT_EQ(h.numCols(), 70);
+    const auto back = convert<float>(h);
+    for(size_t r = 0; r < a.numRows(); ++r)
+        for(size_t c = 0; c < a.numCols(); ++c)
+        {
+            //Small integers are exact in both formats
+            ASSERT_EQ(back(r, c), a(r, c));
+            ASSERT_EQ(static_cast<float>(b(r, c)), a(r, c));
+        }
+
+    //Expressions compute in float and round on assignment
+    LimnoMatrixBase<float16, 2, 2> s;
+    s(0, 0) = 1.0f;
+    s(0, 1) = 2.0f;
+    s(1, 0) = 3.0f;
+    s(1, 1) = 4.0f;
+    LimnoMatrixBase<float16, 2, 2> t = s + s;
+    EXPECT_EQ(static_cast<float>(t(1, 1)), 8.0f);
+    EXPECT_EQ(convert<double>(t)(0, 1), 4.0);
+}
+
+TEST(TestReducedPrecision, WidenedReductions)
+{
+    //Larger than one widening chunk, with padded and unpadded rows
+    const auto a = pattern<float>(61, 97);
+    const auto b = pattern<float>(61, 97, 3);
+    const auto ha = convert<bfloat16>(a);
+    const auto hb = convert<bfloat16>(b);
+    EXPECT_NEAR(sum(ha), sum(a), 1e-3f);
+    EXPECT_NEAR(sum(Limno::par, ha), sum(a), 1e-3f);
+    EXPECT_NEAR(dot(ha, hb), dot(a, b), 1e-5f*std::abs(dot(a, b)));
+    EXPECT_NEAR(dot(Limno::par, ha, hb), dot(a, b), 1e-5f*std::abs(dot(a, b)));
+    EXPECT_NEAR(norm(ha), norm(a), 1e-5f*norm(a));
+    EXPECT_NEAR(norm(Limno::par, ha), norm(a), 1e-5f*norm(a));
+    EXPECT_THROW(dot(ha, convert<bfloat16>(pattern<float>(61, 96))), std::invalid_argument);
+
+    //A float16 accumulator would stop growing at 2048
+    LimnoMatrixBase<float16, DYNAMIC, DYNAMIC> ones(float16(1.0f), 100, 100);
+    EXPECT_EQ(sum(ones), 10000.0f);
+}
+
+TEST(TestReducedPrecision, ReducedFloatProducts)
+{
+    const auto a = pattern<float>(70, 45);
+    const auto b = pattern<float>(45, 83, 1);
+    const auto expected = matmul(a, b);
+    const auto c = matmul(convert<float16>(a), convert<float16>(b));
+    const auto parallel = matmul(Limno::par, convert<float16>(a), convert<float16>(b));
+    ASSERT_EQ(c.numRows(), 70);
+    ASSERT_EQ(c.numCols(), 83);
+    for(size_t r = 0; r < c.numRows(); ++r)
+        for(size_t col = 0; col < c.numCols(); ++col)
+        {
+            ASSERT_NEAR(c(r, col), expected(r, col), 1e-3f);
+            ASSERT_EQ(parallel(r, col), c(r, col));
+        }
+    EXPECT_THROW(matmul(convert<float16>(a), convert<float16>(a)), std::invalid_argument);
+
+    const auto small = matmul(convert<bfloat16>(pattern<float, 3, 4>()), convert<bfloat16>(pattern<float, 4, 2>()));
+    const auto smallExpected = matmul(pattern<float, 3, 4>(), pattern<float, 4, 2>());
+    for(size_t r = 0; r < 3; ++r)
+        for(size_t col = 0; col < 2; ++col)
+            EXPECT_NEAR(small(r, col), smallExpected(r, col), 1e-3f);
+}
+
+TEST(TestReducedPrecision, Quantization)
+{
+    auto a = pattern<float>(19, 53);
+    a(0, 0) = -12.0f;
+    a(0, 1) = 30.0f;
+    const quantization q = chooseQuantization(a);
+    EXPECT_NEAR(q.scale, 42.0f/255.0f, 1e-6f);
+    const auto quantized = quantize(a, q);
+    const auto parallel = quantize(Limno::par, a, q);
+    const auto restored = dequantize(quantized, q);
+    for(size_t r = 0; r < a.numRows(); ++r)
+        for(size_t c = 0; c < a.numCols(); ++c)
+        {
+            ASSERT_LE(std::abs(restored(r, c) - a(r, c)), 0.5f*q.scale + 1e-6f);
+            ASSERT_EQ(parallel(r, c), quantized(r, c));
+        }
+
+    //Zero is exact and values outside the range saturate
+    const auto zero = quantize(LimnoMatrixBase<float, 1, 1>(0.0f), q);
+    EXPECT_EQ(dequantize(zero, q)(0, 0), 0.0f);
+    LimnoMatrixBase<float, 1, 3> extremes;
+    extremes(0, 0) = 1e9f;
+    extremes(0, 1) = -1e9f;
+    extremes(0, 2) = std::numeric_limits<float>::quiet_NaN();
+    const auto saturated = quantize(extremes, q);
+    EXPECT_EQ(saturated(0, 0), 127);
+    EXPECT_EQ(saturated(0, 1), -128);
+    EXPECT_EQ(saturated(0, 2), -128);
+    EXPECT_THROW(quantize(a, quantization{0.0f, 0}), std::invalid_argument);
+    EXPECT_EQ(chooseQuantization(LimnoMatrixBase<float, 2, 2>(0.0f)).scale, 1.0f);
+}
+
+TEST(TestReducedPrecision, QuantizationKernels)
+{
+    std::vector<float> values;
+    for(size_t i = 0; i < 203; ++i)
+        values.push_back(static_cast<float>(i % 67)*0.37f - 12.0f);
+    values.push_back(std::numeric_limits<float>::quiet_NaN());
+    values.push_back(1e20f);
+    const auto reference = _quantizedKernelsFor(_SimdIsa::scalar);
+    std::vector<std::int8_t> expected(values.size());
+    reference.quantize(values.data(), expected.data(), values.size(), 0.1f, 7);
+    std::vector<float> expectedBack(values.size());
+    reference.dequantize(expected.data(), expectedBack.data(), values.size(), 0.1f, 7);
+    for(int isa = 0; isa <= static_cast<int>(simdIsa()); ++isa)
+    {
+        const auto kernels = _quantizedKernelsFor(static_cast<_SimdIsa>(isa));
+        std::vector<std::int8_t> q(values.size());
+        kernels.quantize(values.data(), q.data(), values.size(), 0.1f, 7);
+        std::vector<float> back(values.size());
+        kernels.dequantize(q.data(), back.data(), values.size(), 0.1f, 7);
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            ASSERT_EQ(q[i], expected[i]) << isa << ": " << values[i];
+            ASSERT_EQ(back[i], expectedBack[i]) << isa;
+        }
+    }
+}
+
+TEST(TestReducedPrecision, QuantizedProducts)
+{
+    //Deeper and wider than one panel, with odd depths left in the last one
+    for(size_t k : {size_t{1}, size_t{7}, size_t{300}})
+    {
+        const auto a = pattern<float>(37, k);
+        const auto b = pattern<float>(k, 301, 2);
+        const quantization qa = chooseQuantization(a);
+        const quantization qb{0.05f, -3};
+        const auto a8 = quantize(a, qa);
+        const auto b8 = quantize(b, qb);
+        const auto c = matmul(a8, qa, b8, qb);
+        const auto parallel = matmul(Limno::par, a8, qa, b8, qb);
+        for(size_t r = 0; r < c.numRows(); ++r)
+            for(size_t col = 0; col < c.numCols(); ++col)
+            {
+                //The integer sums are exact; only the final scaling rounds
+                std::int64_t exact = 0;
+                for(size_t i = 0; i < k; ++i)
+                    exact += (a8(r, i) - qa.zeroPoint)*(b8(i, col) - qb.zeroPoint);
+                ASSERT_EQ(c(r, col), static_cast<float>(exact)*(qa.scale*qb.scale)) << k << ": " << r << ", " << col;
+                ASSERT_EQ(parallel(r, col), c(r, col));
+            }
+    }
+    const auto a8 = quantize(pattern<float>(4, 5), quantization{});
+    EXPECT_THROW(matmul(a8, quantization{}, a8, quantization{}), std::invalid_argument);
+    const auto square8 = quantize(pattern<float>(4, 4), quantization{});
+    EXPECT_THROW(matmul(square8, quantization{1.0f, 200}, square8, quantization{}), std::invalid_argument);
+    EXPECT_THROW(matmul(square8, quantization{}, square8, quantization{0.0f, 0}), std::invalid_argument);
+
+    //Depths whose sums overflow int32
+    constexpr size_t deep = 3*_quantizedSafeDepth;
+    const LimnoMatrixBase<std::int8_t, DYNAMIC, DYNAMIC> lhs(std::int8_t{127}, 2, deep);
+    const LimnoMatrixBase<std::int8_t, DYNAMIC, DYNAMIC> rhs(std::int8_t{-1}, deep, 3);
+    const quantization q{1.0f, -128};
+    const float expected = static_cast<float>(std::int64_t{255}*127*static_cast<std::int64_t>(deep));
+    EXPECT_EQ(matmul(lhs, q, rhs, q)(1, 2), expected);
+    EXPECT_EQ(matmul(Limno::par, lhs, q, rhs, q)(0, 1), expected);
+}
+
+TEST(TestReducedPrecision, QuantizedProductKernels)
+{
+    constexpr size_t m = 3, n = 45, pairs = 9;
+    std::vector<std::int16_t> a(m*2*pairs), panel(pairs*2*n);
+    for(size_t i = 0; i < a.size(); ++i)
+        a[i] = static_cast<std::int16_t>(static_cast<int>(i*31 % 511) - 255);
+    for(size_t i = 0; i < panel.size(); ++i)
+        panel[i] = static_cast<std::int16_t>(static_cast<int>(i*17 % 511) - 255);
+    std::vector<std::int32_t> expected(m*n, 1);
+    _quantizedKernelsFor(_SimdIsa::scalar).product(m, n, pairs, a.data(), panel.data(), expected.data(), n);
+    for(int isa = 0; isa <= static_cast<int>(simdIsa()); ++isa)
+    {
+        std::vector<std::int32_t> c(m*n, 1);
+        _quantizedKernelsFor(static_cast<_SimdIsa>(isa)).product(m, n, pairs, a.data(), panel.data(), c.data(), n);
+        for(size_t i = 0; i < c.size(); ++i)
+            ASSERT_EQ(c[i], expected[i]) << isa << ": " << i;
+    }
+}
@@ -0,0 +1,110 @@
+#include <type_traits>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "Core/reductions.hh"
+#include "Core/shared_matrix.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::grid;
+
+TEST(TestSharedMatrix, CopiesShare)
+{
+    auto m = grid(4, 5);
+    const double* storage = m.data();
+    shared_matrix<double> a{std::move(m)};
+    //Taking over a matrix doesn't copy it
+    EXPECT_EQ(a.view().data(), storage);
+    EXPECT_FALSE(a.isShared());
+
+    const shared_matrix<double> b = a;
+    const shared_matrix<double> c = b;
+    EXPECT_EQ(a.useCount(), 3);
+    EXPECT_EQ(b.view().data(), storage);
+    EXPECT_EQ(c(3, 4), 34.0);
+}
+
+TEST(TestSharedMatrix, WriteCopies)
+{
+    shared_matrix<double> a{grid(4, 5)};
+    shared_matrix<double> b = a;
+    const double* storage = std::as_const(a).view().data();
+
+    b(1, 2) = -1.0;
+    EXPECT_EQ(b(1, 2), -1.0);
+    EXPECT_EQ(std::as_const(a)(1, 2), 12.0);
+    EXPECT_NE(b.view().data(), storage);
+    EXPECT_FALSE(a.isShared());
+    EXPECT_FALSE(b.isShared());
+
+    //A sole owner writes in place
+    a(0, 0) = 5.0;
+    EXPECT_EQ(a.view().data(), storage);
+    a.mutableView().row(3).fill(7.0);
+    EXPECT_EQ(std::as_const(a)(3, 4), 7.0);
+    EXPECT_EQ(std::as_const(b)(3, 4), 34.0);
+}
+
+TEST(TestSharedMatrix, Slices)
+{
+    const shared_matrix<double> a{grid(6, 8)};
+    shared_matrix<double> block = a.block(1, 2, 3, 4);
+    const shared_matrix<double> row = a.row(5);
+    const shared_matrix<double> t = a.transpose();
+    EXPECT_EQ(a.useCount(), 4);
+    EXPECT_EQ(&std::as_const(block)(0, 0), &a(1, 2));
+    EXPECT_EQ(row(0, 7), 57.0);
+    EXPECT_EQ(t(7, 5), 57.0);
+    EXPECT_EQ(a.slice(0, 6, 2, 1, 8, 3)(2, 2), 47.0);
+
+    //Writing to a slice copies only the slice
+    block(0, 0) = 0.5;
+    ASSERT_EQ(block.numRows(), 3);
+    ASSERT_EQ(block.numCols(), 4);
+    EXPECT_TRUE(block.view().isContiguous());
+    EXPECT_EQ(std::as_const(block)(2, 3), 35.0);
+    EXPECT_EQ(a(1, 2), 12.0);
+    EXPECT_EQ(a.useCount(), 3);
+
+    EXPECT_EQ(sum(t.view()), sum(a.view()));
+}
+
+TEST(TestSharedMatrix, Expressions)
+{
+    const shared_matrix<double> a{grid(3, 3)};
+    const shared_matrix<double> b = a;
+    const LimnoMatrixBase<double, DYNAMIC, DYNAMIC> c = a + b*2.0;
+    EXPECT_EQ(c(2, 1), 63.0);
+
+    shared_matrix<double> d = a;
+    d = d + 1.0;
+    EXPECT_EQ(std::as_const(d)(0, 0), 1.0);
+    EXPECT_EQ(a(0, 0), 0.0);
+
+    const shared_matrix<double> e{a.transpose() - a};
+    EXPECT_EQ(e(0, 1), 9.0);
+}
+
+TEST(TestSharedMatrix, Release)
+{
+    auto m = grid(2, 3);
+    const double* storage = m.data();
+    shared_matrix<double> a{std::move(m)};
+    shared_matrix<double> b = a;
+    const auto copy = std::move(b).release();
+    EXPECT_NE(copy.data(), storage);
+    EXPECT_EQ(copy(1, 2), 12.0);
+
+    const auto whole = std::move(a).release();
+    EXPECT_EQ(whole.data(), storage);
+    EXPECT_TRUE(a.empty());
+
+    const shared_matrix<double> zeros(Limno::zeros, 2, 2);
+    EXPECT_EQ(zeros(1, 1), 0.0);
+}
@@ -0,0 +1,136 @@
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/aligned_allocator.hh"
+#include "Core/matrix_base.hh"
+#include "Core/reductions.hh"
+#include "Core/simd.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    //Runs the kernels of every instruction set the host supports against
+    //plain loops. Sizes cover empty tails and partially filled registers.
+    template<typename _Tp>
+    void checkKernels()
+    {
+        for(int isa = 0; isa <= static_cast<int>(simdIsa()); ++isa)
+        {
+            _SimdKernels<_Tp> kernels = _simdKernelsFor<_Tp>(static_cast<_SimdIsa>(isa));
+            for(size_t n : {1, 3, 8, 17, 64, 131})
+            {
+                std::vector<_Tp> a(n), b(n), out(n);
+                for(size_t i = 0; i < n; ++i)
+                {
+                    a[i] = static_cast<_Tp>((i*5) % 11) - 4;
+                    b[i] = static_cast<_Tp>((i*3) % 7) + 1;
+                }
+
+                kernels.binary[static_cast<int>(_SimdOp::add)](a.data(), b.data(), out.data(), n);
+                for(size_t i = 0; i < n; ++i)
+                    EXPECT_EQ(out[i], a[i] + b[i]);
+
+                kernels.binary[static_cast<int>(_SimdOp::div)](a.data(), b.data(), out.data(), n);
+                for(size_t i = 0; i < n; ++i)
+                    EXPECT_EQ(out[i], a[i]/b[i]);
+
+                kernels.binaryScalarRhs[static_cast<int>(_SimdOp::sub)](a.data(), _Tp{2}, out.data(), n);
+                for(size_t i = 0; i < n; ++i)
+                    EXPECT_EQ(out[i], a[i] - 2);
+
+                kernels.binaryScalarLhs[static_cast<int>(_SimdOp::sub)](_Tp{2}, a.data(), out.data(), n);
+                for(size_t i = 0; i < n; ++i)
+                    EXPECT_EQ(out[i], 2 - a[i]);
+
+                _Tp sum = 0, dot = 0, deviations = 0, min = a[0], max = a[0];
+                for(size_t i = 0; i < n; ++i)
+                {
+                    sum += a[i];
+                    dot += a[i]*b[i];
+                    deviations += (a[i] - 1)*(a[i] - 1);
+                    min = std::min(min, a[i]);
+                    max = std::max(max, a[i]);
+                }
+                EXPECT_EQ(kernels.sum(a.data(), n), sum);
+                EXPECT_EQ(kernels.dot(a.data(), b.data(), n), dot);
+                EXPECT_EQ(kernels.min(a.data(), n), min);
+                EXPECT_EQ(kernels.max(a.data(), n), max);
+                EXPECT_EQ(kernels.sumSquaredDeviations(a.data(), _Tp{1}, n), deviations);
+            }
+        }
+    }
+}
+
+TEST(Simd, KernelsMatchScalar)
+{
+    checkKernels<float>();
+    checkKernels<double>();
+    checkKernels<int>();
+}
+
+TEST(Simd, Reductions)
+{
+    double arr[] = {3, -1, 4, 1, -5, 9, 2, 6, 5};
+    LimnoMatrixBase<double, 3, 3> a(arr);
+    EXPECT_EQ(sum(a), 24);
+    EXPECT_EQ(min(a), -5);
+    EXPECT_EQ(max(a), 9);
+    EXPECT_EQ(dot(a, a), 198);
+    EXPECT_DOUBLE_EQ(norm(a), std::sqrt(198.0));
+
+    int iarr[] = {3, 4};
+    LimnoMatrixBase<int, DYNAMIC, DYNAMIC> b(iarr, 1, 2);
+    EXPECT_EQ(sum(b), 7);
+    EXPECT_DOUBLE_EQ(norm(b), 5.0);
+
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> empty;
+    EXPECT_EQ(sum(empty), 0);
+    EXPECT_THROW(min(empty), std::invalid_argument);
+}
+
+TEST(Simd, ExpressionFastPath)
+{
+    float arr[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> a(arr, 1, 19);
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> b(arr, 1, 19);
+
+    static_assert(_SimdEvaluable<float, decltype(a + b)>::value, "Expected kernel evaluation");
+    static_assert(_SimdEvaluable<float, decltype(2.0f*a)>::value, "Expected kernel evaluation");
+    static_assert(!_SimdEvaluable<float, decltype(a + b*b)>::value, "Nested expressions use the generic loop");
+
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> c = a*b;
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> d = 1.0f/a;
+    for(size_t i = 0; i < 19; ++i)
+    {
+        EXPECT_EQ(c(0, i), arr[i]*arr[i]);
+        EXPECT_EQ(d(0, i), 1.0f/arr[i]);
+    }
+}
+
+TEST(Simd, ScalarRounding)
+{
+    //A double scalar is rounded to float before the operation whether the
+    //rows are dense and use the kernels or are padded and don't
+    std::vector<float> values;
+    for(size_t i = 0; i < 3*37; ++i)
+        values.push_back(static_cast<float>(i)*1.37f - 20.0f);
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> dense(values.begin(), values.end(), 3, 37);
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC, padded_allocator<float>> padded(values.begin(), values.end(), 3, 37);
+    static_assert(decltype(padded)::isPadded);
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> a = dense*0.1;
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC, padded_allocator<float>> b = padded*0.1;
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC, padded_allocator<float>> c = 0.1/padded;
+    LimnoMatrixBase<float, DYNAMIC, DYNAMIC> d = 0.1/dense;
+    for(size_t r = 0; r < 3; ++r)
+        for(size_t col = 0; col < 37; ++col)
+        {
+            EXPECT_EQ(a(r, col), dense(r, col)*0.1f);
+            EXPECT_EQ(b(r, col), a(r, col));
+            EXPECT_EQ(c(r, col), d(r, col));
+        }
+}
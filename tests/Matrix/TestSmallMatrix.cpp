@@ -0,0 +1,157 @@
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_product.hh"
+#include "Core/small_matrix.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    constexpr double arr2[] = {4, 7, 2, 6};
+    constexpr double arr3[] = {2, -1, 0, -1, 2, -1, 0, -1, 2};
+    constexpr double arr23[] = {1, 2, 3, 4, 5, 6};
+
+    //Diagonally dominant so every size is well conditioned
+    template<typename _Tp, int _N>
+    LimnoMatrixBase<_Tp, _N, _N> randomMatrix(std::mt19937& gen)
+    {
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        LimnoMatrixBase<_Tp, _N, _N> m(_Tp{});
+        for(size_t r = 0; r < _N; ++r)
+        {
+            for(size_t c = 0; c < _N; ++c)
+                m(r, c) = static_cast<_Tp>(dist(gen) + ((r == c) ? 2.0*_N : 0.0));
+        }
+        return m;
+    }
+
+    template<typename _Tp, int _N>
+    void expectInverse(const LimnoMatrixBase<_Tp, _N, _N>& m, const LimnoMatrixBase<_Tp, _N, _N>& inv, double tol)
+    {
+        const auto product = matmul(m, inv);
+        for(size_t r = 0; r < _N; ++r)
+        {
+            for(size_t c = 0; c < _N; ++c)
+                EXPECT_NEAR(product(r, c), (r == c) ? 1.0 : 0.0, tol);
+        }
+    }
+
+    template<int _N>
+    void checkSize(std::mt19937& gen)
+    {
+        const auto m = randomMatrix<double, _N>(gen);
+        const auto inv = inverse(m);
+        expectInverse(m, inv, 1e-12);
+        EXPECT_NEAR(determinant(m)*determinant(inv), 1.0, 1e-12);
+
+        LimnoMatrixBase<double, _N, 2> b(1.0);
+        const auto x = solve(m, b);
+        const auto check = matmul(m, x);
+        for(size_t i = 0; i < check.size(); ++i)
+            EXPECT_NEAR(check.data()[i], 1.0, 1e-12);
+    }
+
+    template<int... _Ns>
+    void checkSizes(std::mt19937& gen, std::integer_sequence<int, _Ns...>)
+    {
+        (checkSize<_Ns + 1>(gen), ...);
+    }
+}
+
+TEST(SmallMatrix, Constexpr)
+{
+    constexpr LimnoMatrixBase<double, 2, 2> m2(arr2);
+    static_assert(determinant(m2) == 10.0);
+    constexpr auto inv2 = inverse(m2);
+    static_assert(_smallAbs(inv2(0, 0) - 0.6) < 1e-15 && _smallAbs(inv2(0, 1) + 0.7) < 1e-15);
+    static_assert(_smallAbs(inv2(1, 0) + 0.2) < 1e-15 && _smallAbs(inv2(1, 1) - 0.4) < 1e-15);
+
+    constexpr LimnoMatrixBase<double, 3, 3> m3(arr3);
+    static_assert(determinant(m3) == 4.0);
+    constexpr auto inv3 = inverse(m3);
+    static_assert(inv3(0, 0) == 0.75 && inv3(1, 1) == 1.0 && inv3(2, 0) == 0.25);
+
+    constexpr LimnoMatrixBase<double, 2, 3> m23(arr23);
+    constexpr auto t = transpose(m23);
+    static_assert(t.numRows() == 3 && t.numCols() == 2);
+    static_assert(t(0, 1) == 4.0 && t(2, 0) == 3.0);
+
+    constexpr auto p = matmul(m23, t);
+    static_assert(p(0, 0) == 14.0 && p(0, 1) == 32.0 && p(1, 1) == 77.0);
+
+    constexpr double rhs[] = {1, 0, 1};
+    constexpr LimnoMatrixBase<double, 3, 1> b(rhs);
+    constexpr auto x = solve(m3, b);
+    static_assert(_smallAbs(x(0, 0) - 1.0) < 1e-15 && _smallAbs(x(1, 0) - 1.0) < 1e-15 && _smallAbs(x(2, 0) - 1.0) < 1e-15);
+}
+
+TEST(SmallMatrix, AllSizes)
+{
+    std::mt19937 gen(7);
+    checkSizes(gen, std::make_integer_sequence<int, 8>{});
+
+    //Permutation matrices need pivoting and flip the sign of the determinant
+    double swap[] = {0, 1, 0, 0, 0,
+                     1, 0, 0, 0, 0,
+                     0, 0, 1, 0, 0,
+                     0, 0, 0, 1, 0,
+                     0, 0, 0, 0, 1};
+    LimnoMatrixBase<double, 5, 5> p(swap);
+    EXPECT_EQ(determinant(p), -1.0);
+    expectInverse(p, inverse(p), 0.0);
+
+    double ints[] = {1, 2, 3, 4, 5, 6, 7, 8, 10};
+    EXPECT_EQ(determinant(LimnoMatrixBase<int, 3, 3>(ints)), -3);
+}
+
+TEST(SmallMatrix, Singular)
+{
+    double rank1[] = {1, 2, 2, 4};
+    EXPECT_THROW(inverse(LimnoMatrixBase<double, 2, 2>(rank1)), std::invalid_argument);
+    EXPECT_THROW(inverse(LimnoMatrixBase<double, 6, 6>(0.0)), std::invalid_argument);
+    EXPECT_THROW(inverse(LimnoMatrixBase<float, 4, 4>(1.0f)), std::invalid_argument);
+    EXPECT_THROW(solve(LimnoMatrixBase<double, 3, 3>(1.0), LimnoMatrixBase<double, 3, 1>(1.0)), std::invalid_argument);
+}
+
+TEST(SmallMatrix, Float4x4)
+{
+    std::mt19937 gen(11);
+    for(int trial = 0; trial < 20; ++trial)
+    {
+        const auto a = randomMatrix<float, 4>(gen);
+        const auto b = randomMatrix<float, 4>(gen);
+
+        const auto c = matmul(a, b);
+        for(size_t r = 0; r < 4; ++r)
+        {
+            for(size_t col = 0; col < 4; ++col)
+            {
+                float expected = 0.0f;
+                for(size_t k = 0; k < 4; ++k)
+                    expected += a(r, k)*b(k, col);
+                EXPECT_NEAR(c(r, col), expected, 1e-5f);
+            }
+        }
+
+        const auto t = transpose(a);
+        for(size_t r = 0; r < 4; ++r)
+        {
+            for(size_t col = 0; col < 4; ++col)
+                EXPECT_EQ(t(r, col), a(col, r));
+        }
+
+        //Matches the scalar adjugate
+        const auto inv = inverse(a);
+        float scalar[16] = {};
+        _smallInverse<4>(a.data(), scalar);
+        for(size_t i = 0; i < 16; ++i)
+            EXPECT_NEAR(inv.data()[i], scalar[i], 1e-5f);
+        expectInverse(a, inv, 1e-5);
+    }
+}
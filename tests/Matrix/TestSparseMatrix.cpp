@@ -0,0 +1,180 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/matrix_base.hh"
+#include "Core/sparse_matrix.hh"
+#include "config.hh"
+
+using namespace Limno::_detail;
+
+namespace
+{
+    //About one element in seven non-zero, with a dense row and an empty one
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> sparsePattern(size_t r, size_t c)
+    {
+        LimnoMatrixBase<double, DYNAMIC, DYNAMIC> m(Limno::zeros, r, c);
+        for(size_t i = 0; i < r; ++i)
+            for(size_t j = 0; j < c; ++j)
+                if ((i*13 + j*7) % 7 == 3 || i == 2)
+                    m(i, j) = static_cast<double>(i*100 + j) - 50.0;
+        if (r > 4)
+            for(size_t j = 0; j < c; ++j)
+                m(4, j) = 0.0;
+        return m;
+    }
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> denseProduct(const LimnoMatrixBase<double, DYNAMIC, DYNAMIC>& a,
+        const LimnoMatrixBase<double, DYNAMIC, DYNAMIC>& b)
+    {
+        LimnoMatrixBase<double, DYNAMIC, DYNAMIC> c(Limno::zeros, a.numRows(), b.numCols());
+        for(size_t i = 0; i < a.numRows(); ++i)
+            for(size_t k = 0; k < a.numCols(); ++k)
+                for(size_t j = 0; j < b.numCols(); ++j)
+                    c(i, j) += a(i, k)*b(k, j);
+        return c;
+    }
+
+    template<typename _MatTp1, typename _MatTp2>
+    void expectEqual(const _MatTp1& a, const _MatTp2& b)
+    {
+        ASSERT_EQ(a.numRows(), b.numRows());
+        ASSERT_EQ(a.numCols(), b.numCols());
+        for(size_t i = 0; i < a.numRows(); ++i)
+            for(size_t j = 0; j < a.numCols(); ++j)
+                ASSERT_EQ(a(i, j), b(i, j)) << i << ", " << j;
+    }
+}
+
+TEST(TestSparseMatrix, Assembly)
+{
+    coo_matrix<float, std::uint32_t> coo(3, 4);
+    coo.insert(2, 3, 1.0f);
+    coo.insert(0, 1, 2.0f);
+    coo.insert(2, 0, 3.0f);
+    coo.insert(2, 3, 4.0f);
+    coo.insert(0, 0, 5.0f);
+    EXPECT_EQ(coo.nonZeros(), 5);
+    EXPECT_THROW(coo.insert(3, 0, 1.0f), std::out_of_range);
+
+    const csr_matrix<float, std::uint32_t> csr(coo);
+    EXPECT_EQ(csr.nonZeros(), 4);
+    EXPECT_EQ(csr.offsets(), (std::vector<std::uint32_t>{0, 2, 2, 4}));
+    EXPECT_EQ(csr.indices(), (std::vector<std::uint32_t>{0, 1, 0, 3}));
+    EXPECT_EQ(csr(2, 3), 5.0f);
+    EXPECT_EQ(csr(1, 1), 0.0f);
+
+    const csc_matrix<float, std::uint32_t> csc(coo);
+    EXPECT_EQ(csc.offsets(), (std::vector<std::uint32_t>{0, 2, 3, 3, 4}));
+    EXPECT_EQ(csc.indices(), (std::vector<std::uint32_t>{0, 2, 0, 2}));
+    expectEqual(csc.toDense(), coo.toDense());
+    expectEqual(csr.toDense(), coo.toDense());
+
+    EXPECT_THROW((coo_matrix<float, std::uint8_t>(300, 2)), std::invalid_argument);
+}
+
+TEST(TestSparseMatrix, Conversions)
+{
+    const auto dense = sparsePattern(37, 29);
+    const csr_matrix<double> csr(dense);
+    const csc_matrix<double> csc(dense.view());
+    expectEqual(csr.toDense(), dense);
+    expectEqual(csc.toDense(), dense);
+    expectEqual(csr, dense);
+
+    const csc_matrix<double> converted(csr);
+    EXPECT_EQ(converted.offsets(), csc.offsets());
+    EXPECT_EQ(converted.indices(), csc.indices());
+    EXPECT_EQ(converted.values(), csc.values());
+    const csr_matrix<double> back(converted);
+    EXPECT_EQ(back.values(), csr.values());
+
+    //A transpose only swaps the format
+    const csc_matrix<double> t = csr_matrix<double>(dense.view().transpose()).transpose();
+    EXPECT_EQ(t.indices(), csc.indices());
+    expectEqual(csr_matrix<double>(dense*2.0), dense*2.0);
+}
+
+TEST(TestSparseMatrix, Iteration)
+{
+    const auto dense = sparsePattern(9, 11);
+    csr_matrix<double> csr(dense);
+    size_t count = 0, lastRow = 0;
+    for(const auto [r, c, value] : std::as_const(csr))
+    {
+        EXPECT_EQ(value, dense(r, c));
+        EXPECT_NE(value, 0.0);
+        EXPECT_GE(r, lastRow);
+        lastRow = r;
+        ++count;
+    }
+    EXPECT_EQ(count, csr.size());
+
+    for(auto [r, c, value] : csr)
+        value = static_cast<double>(r + c);
+    EXPECT_EQ(csr(2, 5), 7.0);
+
+    csc_matrix<double> csc(dense);
+    size_t lastCol = 0;
+    for(const auto entry : csc)
+    {
+        EXPECT_GE(entry.col, lastCol);
+        lastCol = entry.col;
+    }
+    #if __cplusplus > 201703L
+    static_assert(Limno::Container<csr_matrix<double>>);
+    static_assert(Limno::Container<coo_matrix<int>>);
+    static_assert(std::forward_iterator<csc_matrix<double>::iterator>);
+    #endif
+
+    EXPECT_EQ(csr_matrix<int>(5, 5).begin(), csr_matrix<int>(5, 5).end());
+}
+
+TEST(TestSparseMatrix, Products)
+{
+    const auto a = sparsePattern(203, 151);
+    const csr_matrix<double> csr(a);
+    const csc_matrix<double> csc(a);
+    for(size_t n : {1, 3, 17})
+    {
+        LimnoMatrixBase<double, DYNAMIC, DYNAMIC> b(151, n);
+        for(size_t i = 0; i < b.numRows(); ++i)
+            for(size_t j = 0; j < n; ++j)
+                b(i, j) = static_cast<double>((i*3 + j) % 11) - 5.0;
+        const auto expected = denseProduct(a, b);
+        expectEqual(matmul(csr, b), expected);
+        expectEqual(matmul(Limno::par, csr, b), expected);
+        expectEqual(matmul(csc, b), expected);
+        expectEqual(matmul(Limno::par, csc, b.view()), expected);
+
+        //Strided operands and results
+        LimnoMatrixBase<double, DYNAMIC, DYNAMIC> t(n, 203);
+        matmul(Limno::par, csr, b, t.view().transpose());
+        expectEqual(t.view().transpose(), expected);
+        matmul(csc, LimnoMatrixBase<double, DYNAMIC, DYNAMIC>(b.view().transpose()).view().transpose(), t.view().transpose());
+        expectEqual(t.view().transpose(), expected);
+    }
+
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> wrong(150, 2);
+    EXPECT_THROW(matmul(csr, wrong), std::invalid_argument);
+    EXPECT_EQ(matmul(Limno::par, csr_matrix<double>(4, 6), LimnoMatrixBase<double, DYNAMIC, DYNAMIC>(Limno::zeros, 6, 2))(3, 1), 0.0);
+
+    //The result may not share storage with the dense operand
+    const auto square = sparsePattern(40, 40);
+    LimnoMatrixBase<double, DYNAMIC, DYNAMIC> x(1.0, 40, 1);
+    EXPECT_THROW(matmul(csr_matrix<double>(square), x, x), std::invalid_argument);
+    EXPECT_THROW(matmul(Limno::par, csc_matrix<double>(square), x.view(), x), std::invalid_argument);
+    EXPECT_EQ(x(0, 0), 1.0);
+}
+
+TEST(TestSparseMatrix, AdoptArrays)
+{
+    const csr_matrix<int, int> m(2, 3, {0, 1, 3}, {2, 0, 1}, {7, 8, 9});
+    EXPECT_EQ(m(0, 2), 7);
+    EXPECT_EQ(m(1, 1), 9);
+    EXPECT_THROW((csr_matrix<int, int>(2, 3, {0, 2, 3}, {2, 0, 1}, {7, 8, 9})), std::invalid_argument);
+    EXPECT_THROW((csr_matrix<int, int>(2, 3, {0, 1, 3}, {2, -1, 1}, {7, 8, 9})), std::invalid_argument);
+    EXPECT_THROW((csr_matrix<int, int>(2, 3, {0, 1, 2}, {2, 0, 1}, {7, 8, 9})), std::invalid_argument);
+}
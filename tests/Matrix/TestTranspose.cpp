@@ -0,0 +1,138 @@
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Core/aligned_allocator.hh"
+#include "Core/matrix_base.hh"
+#include "Core/transpose.hh"
+#include "config.hh"
+
+#include "TestCommon.hh"
+
+using namespace Limno::_detail;
+
+using LimnoTest::grid;
+
+namespace
+{
+    template<typename _MatTp1, typename _MatTp2>
+    void expectTransposed(const _MatTp1& result, const _MatTp2& m)
+    {
+        ASSERT_EQ(result.numRows(), m.numCols());
+        ASSERT_EQ(result.numCols(), m.numRows());
+        for(size_t i = 0; i < m.numRows(); ++i)
+            for(size_t j = 0; j < m.numCols(); ++j)
+                ASSERT_EQ(result(j, i), m(i, j)) << i << ", " << j;
+    }
+
+    //Every tile kernel the host supports, on shapes with ragged edges
+    template<typename _Tp>
+    void checkTileKernels()
+    {
+        for(int isa = 0; isa <= static_cast<int>(simdIsa()); ++isa)
+        {
+            const _transpose_tile_fn<_Tp> kernel = _transposeTileFor<_Tp>(static_cast<_SimdIsa>(isa));
+            for(size_t rows : {1, 3, 8, 13})
+                for(size_t cols : {1, 4, 9, 16})
+                {
+                    const auto m = grid<_Tp>(rows, cols, 1000);
+                    std::vector<_Tp> out(cols*20);
+                    kernel(m.data(), static_cast<std::ptrdiff_t>(m.leadingDim()), out.data(), 20, rows, cols);
+                    for(size_t i = 0; i < rows; ++i)
+                        for(size_t j = 0; j < cols; ++j)
+                            ASSERT_EQ(out[j*20 + i], m(i, j));
+                }
+        }
+    }
+}
+
+TEST(TestTranspose, TileKernels)
+{
+    checkTileKernels<float>();
+    checkTileKernels<double>();
+    checkTileKernels<std::int16_t>();
+}
+
+TEST(TestTranspose, OutOfPlace)
+{
+    for(const auto& shape : {std::pair<size_t, size_t>{1, 1}, {1, 77}, {77, 1}, {130, 67}, {300, 257}})
+    {
+        const auto d = grid<double>(shape.first, shape.second, 1000);
+        expectTransposed(transpose(d), d);
+        expectTransposed(transpose(Limno::par, d), d);
+        const auto f = grid<float>(shape.first, shape.second, 1000);
+        expectTransposed(transpose(Limno::par, f), f);
+    }
+
+    const auto empty = transpose(LimnoMatrixBase<int, DYNAMIC, DYNAMIC>(0, 5));
+    EXPECT_EQ(empty.numRows(), 5);
+    EXPECT_EQ(empty.numCols(), 0);
+
+    const auto padded = grid<double, DYNAMIC, DYNAMIC, padded_allocator<double>>(37, 21, 1000);
+    const auto paddedT = transpose(Limno::par, padded);
+    static_assert(std::is_same_v<std::decay_t<decltype(paddedT)>, std::decay_t<decltype(padded)>>);
+    expectTransposed(paddedT, padded);
+}
+
+TEST(TestTranspose, StaticShapes)
+{
+    LimnoMatrixBase<int, 40, 24> m;
+    for(size_t i = 0; i < 40; ++i)
+        for(size_t j = 0; j < 24; ++j)
+            m(i, j) = static_cast<int>(i*24 + j);
+    const auto t = transpose(m);
+    static_assert(std::is_same_v<std::decay_t<decltype(t)>, LimnoMatrixBase<int, 24, 40>>);
+    expectTransposed(t, m);
+
+    LimnoMatrixBase<float, 2, 3> small;
+    small(1, 2) = 5.0f;
+    EXPECT_EQ(transpose(Limno::par, small)(2, 1), 5.0f);
+}
+
+TEST(TestTranspose, Views)
+{
+    const auto m = grid<double>(90, 70, 1000);
+    const auto block = m.view().block(5, 3, 60, 41);
+    expectTransposed(transpose(block), block);
+    //A transposed view is column-major, so its transpose is a copy of rows
+    expectTransposed(transpose(Limno::par, m.view().transpose()), m.view().transpose());
+    const auto stepped = m.view().slice(1, 90, 3, 0, 70, 2);
+    expectTransposed(transpose(stepped), stepped);
+}
+
+TEST(TestTranspose, InPlace)
+{
+    for(size_t n : {1, 31, 32, 33, 100})
+    {
+        const auto original = grid<float>(n, n, 1000);
+        auto m = original;
+        transposeInPlace(m);
+        expectTransposed(m, original);
+        transposeInPlace(Limno::par, m);
+        expectTransposed(transpose(m), original);
+    }
+
+    const auto paddedOriginal = grid<double, DYNAMIC, DYNAMIC, padded_allocator<double>>(45, 45, 1000);
+    auto padded = paddedOriginal;
+    transposeInPlace(Limno::par, padded);
+    expectTransposed(padded, paddedOriginal);
+
+    LimnoMatrixBase<double, 5, 5> fixed;
+    for(size_t i = 0; i < 25; ++i)
+        fixed(i/5, i % 5) = static_cast<double>(i);
+    transposeInPlace(fixed);
+    EXPECT_EQ(fixed(0, 4), 20.0);
+    EXPECT_EQ(fixed(4, 0), 4.0);
+
+    //Other shapes take new storage
+    const auto wide = grid<int>(3, 200, 1000);
+    auto reshaped = wide;
+    transposeInPlace(Limno::par, reshaped);
+    expectTransposed(reshaped, wide);
+
+    LimnoMatrixBase<int, DYNAMIC, 3> tall(4, 3);
+    EXPECT_THROW(transposeInPlace(tall), std::invalid_argument);
+}
@@ -0,0 +1,66 @@
+#ifndef TEST_COMMON_HH
+#define TEST_COMMON_HH 1
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "Core/construction.hh"
+#include "Core/matrix_base.hh"
+#include "config.hh"
+
+namespace LimnoTest
+{
+    using Limno::_detail::DYNAMIC;
+    using Limno::_detail::LimnoMatrixBase;
+    using Limno::_detail::runtimeDim;
+
+    //numRows x numCols matrix with element (r, c) set to f(r, c). Static
+    //extents default to their own size
+    template<typename _Tp, int _Nrows = DYNAMIC, int _Ncols = DYNAMIC, typename _AllocTp = std::allocator<_Tp>, typename _FuncTp>
+    LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> generate(size_t numRows, size_t numCols, _FuncTp f)
+    {
+        LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> m;
+        if constexpr(runtimeDim<_Nrows, _Ncols>)
+            m = LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp>(Limno::uninitialized, numRows, numCols);
+        for(size_t r = 0; r < numRows; ++r)
+            for(size_t c = 0; c < numCols; ++c)
+                m(r, c) = f(r, c);
+        return m;
+    }
+
+    //Element (r, c) is start plus its row-major index
+    template<typename _Tp = double, int _Nrows = DYNAMIC, int _Ncols = DYNAMIC, typename _AllocTp = std::allocator<_Tp>>
+    LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> iota(size_t numRows = _Nrows, size_t numCols = _Ncols, _Tp start = _Tp{})
+    {
+        return generate<_Tp, _Nrows, _Ncols, _AllocTp>(numRows, numCols,
+            [&](size_t r, size_t c) { return static_cast<_Tp>(r*numCols + c) + start; });
+    }
+
+    //Element (r, c) is r*rowStep + c, so its position can be read off its
+    //value
+    template<typename _Tp = double, int _Nrows = DYNAMIC, int _Ncols = DYNAMIC, typename _AllocTp = std::allocator<_Tp>>
+    LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> grid(size_t numRows = _Nrows, size_t numCols = _Ncols, size_t rowStep = 10)
+    {
+        return generate<_Tp, _Nrows, _Ncols, _AllocTp>(numRows, numCols,
+            [&](size_t r, size_t c) { return static_cast<_Tp>(r*rowStep + c); });
+    }
+
+    //Scrambled integers in [-11, 11], exact in every element type, so sums
+    //and products in any order agree. Different seeds give different values
+    template<typename _Tp = double, int _Nrows = DYNAMIC, int _Ncols = DYNAMIC, typename _AllocTp = std::allocator<_Tp>>
+    LimnoMatrixBase<_Tp, _Nrows, _Ncols, _AllocTp> pattern(size_t numRows = _Nrows, size_t numCols = _Ncols, size_t seed = 0)
+    {
+        return generate<_Tp, _Nrows, _Ncols, _AllocTp>(numRows, numCols,
+            [&](size_t r, size_t c) { return static_cast<_Tp>((r*31 + c*17 + seed*5) % 23) - static_cast<_Tp>(11); });
+    }
+
+    //Path of a scratch file in the temporary directory
+    inline std::string tempPath(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / ("limno_" + name)).string();
+    }
+}
+
+#endif